@@ -0,0 +1,123 @@
+#ifndef AFFINE3_H
+#define AFFINE3_H
+
+#include "verified_math/vec3.h"
+#include "verified_math/mat33.h"
+#include "verified_math/mat44.h"
+
+namespace verified_math {
+
+  /*
+    A 3-D affine transform x -> linear * x + translation, i.e. a Mat44
+    whose last row is the implicit 0 0 0 1.
+   */
+  template<typename Scalar>
+  class Affine3 {
+  public:
+    Mat33<Scalar> linear;
+    Vec3<Scalar> translation;
+
+    Affine3<Scalar> (const Mat33<Scalar>& _linear, const Vec3<Scalar>& _translation)
+      : linear{_linear}, translation{_translation} { }
+
+    // Takes the upper 3x4 block; the last row of m is assumed to be 0 0 0 1.
+    explicit Affine3<Scalar> (const Mat44<Scalar>& m)
+      : linear{m.x11, m.x12, m.x13,
+	       m.x21, m.x22, m.x23,
+	       m.x31, m.x32, m.x33},
+	translation{m.x14, m.x24, m.x34} { }
+  };
+
+  /*
+    A 3-D rigid transform x -> rotation * x + translation. The rotation is
+    assumed orthonormal, which is what makes the inverse cheap.
+   */
+  template<typename Scalar>
+  class Rigid3 {
+  public:
+    Mat33<Scalar> rotation;
+    Vec3<Scalar> translation;
+
+    Rigid3<Scalar> (const Mat33<Scalar>& _rotation, const Vec3<Scalar>& _translation)
+      : rotation{_rotation}, translation{_translation} { }
+
+    // Takes the upper 3x4 block; the last row of m is assumed to be 0 0 0 1.
+    explicit Rigid3<Scalar> (const Mat44<Scalar>& m)
+      : rotation{m.x11, m.x12, m.x13,
+		 m.x21, m.x22, m.x23,
+		 m.x31, m.x32, m.x33},
+	translation{m.x14, m.x24, m.x34} { }
+
+    operator Affine3<Scalar>() const {
+      return Affine3<Scalar>{rotation, translation};
+    }
+  };
+
+  /*
+    Conversion to the homogeneous 4x4 form.
+   */
+  template<typename Scalar>
+  Mat44<Scalar> to_mat44(const Affine3<Scalar>& a) {
+    const Mat33<Scalar>& l = a.linear;
+    const Vec3<Scalar>& t = a.translation;
+    return Mat44<Scalar> {
+      l.x11, l.x12, l.x13, t.x1,
+	l.x21, l.x22, l.x23, t.x2,
+	l.x31, l.x32, l.x33, t.x3,
+	Scalar(0), Scalar(0), Scalar(0), Scalar(1)
+    };
+  }
+
+  template<typename Scalar>
+  Mat44<Scalar> to_mat44(const Rigid3<Scalar>& r) {
+    return to_mat44(Affine3<Scalar>{r.rotation, r.translation});
+  }
+
+  /*
+    Application to points.
+   */
+  template<typename Scalar>
+  Vec3<Scalar> operator*(const Affine3<Scalar>& a, const Vec3<Scalar>& x) {
+    return a.linear * x + a.translation;
+  }
+
+  template<typename Scalar>
+  Vec3<Scalar> operator*(const Rigid3<Scalar>& r, const Vec3<Scalar>& x) {
+    return r.rotation * x + r.translation;
+  }
+
+  /*
+    Composition: (a1 * a2)(x) = a1(a2(x)). The implicit 0 0 0 1 row is
+    never multiplied out.
+   */
+  template<typename Scalar>
+  Affine3<Scalar> operator*(const Affine3<Scalar>& a1, const Affine3<Scalar>& a2) {
+    return Affine3<Scalar>{a1.linear * a2.linear,
+	a1.linear * a2.translation + a1.translation};
+  }
+
+  template<typename Scalar>
+  Rigid3<Scalar> operator*(const Rigid3<Scalar>& r1, const Rigid3<Scalar>& r2) {
+    return Rigid3<Scalar>{r1.rotation * r2.rotation,
+	r1.rotation * r2.translation + r1.translation};
+  }
+
+  /*
+    Inverses. The affine inverse needs a single 3x3 inverse; the rigid
+    inverse is a transpose and a negated, rotated translation.
+   */
+  template<typename Scalar>
+  Affine3<Scalar> inverse(const Affine3<Scalar>& a) {
+    auto inv_linear = inverse(a.linear);
+    return Affine3<Scalar>{inv_linear, Scalar(-1) * (inv_linear * a.translation)};
+  }
+
+  template<typename Scalar>
+  Rigid3<Scalar> inverse(const Rigid3<Scalar>& r) {
+    auto inv_rotation = transpose(r.rotation);
+    return Rigid3<Scalar>{inv_rotation, Scalar(-1) * (inv_rotation * r.translation)};
+  }
+
+}
+
+#endif // AFFINE3_H
@@ -0,0 +1,92 @@
+#ifndef ALIGNED_ALLOCATOR_H
+#define ALIGNED_ALLOCATOR_H
+
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include <vector>
+
+#if defined(_WIN32)
+#include <malloc.h>
+#endif
+
+namespace verified_math {
+
+  /*
+    Alignment used for SIMD lanes: wide enough for a 256-bit AVX register.
+   */
+  const std::size_t simd_alignment = 32;
+
+  /*
+    A std allocator returning memory aligned to Alignment bytes, so that
+    containers of scalars can be read with aligned vector loads.
+   */
+  template<typename T, std::size_t Alignment = simd_alignment>
+  class aligned_allocator {
+  public:
+    typedef T value_type;
+    typedef T* pointer;
+    typedef const T* const_pointer;
+    typedef T& reference;
+    typedef const T& const_reference;
+    typedef std::size_t size_type;
+    typedef std::ptrdiff_t difference_type;
+
+    template<typename U>
+    struct rebind {
+      typedef aligned_allocator<U, Alignment> other;
+    };
+
+    aligned_allocator() { }
+
+    template<typename U>
+    aligned_allocator(const aligned_allocator<U, Alignment>&) { }
+
+    T* allocate(std::size_t n) {
+      if (n == 0) {
+	return nullptr;
+      }
+      void* p = nullptr;
+#if defined(_WIN32)
+      p = _aligned_malloc(n * sizeof(T), Alignment);
+#else
+      if (posix_memalign(&p, Alignment, n * sizeof(T)) != 0) {
+	p = nullptr;
+      }
+#endif
+      if (p == nullptr) {
+	throw std::bad_alloc();
+      }
+      return static_cast<T*>(p);
+    }
+
+    void deallocate(T* p, std::size_t) {
+#if defined(_WIN32)
+      _aligned_free(p);
+#else
+      std::free(p);
+#endif
+    }
+  };
+
+  template<typename T, typename U, std::size_t Alignment>
+  bool operator==(const aligned_allocator<T, Alignment>&, const aligned_allocator<U, Alignment>&) {
+    return true;
+  }
+
+  template<typename T, typename U, std::size_t Alignment>
+  bool operator!=(const aligned_allocator<T, Alignment>&, const aligned_allocator<U, Alignment>&) {
+    return false;
+  }
+
+  /*
+    A std::vector whose storage is SIMD-aligned. Use it for over-aligned
+    element types such as Vec3A<double>, which std::allocator does not
+    align under C++11.
+   */
+  template<typename T>
+  using aligned_vector = std::vector<T, aligned_allocator<T> >;
+
+}
+
+#endif // ALIGNED_ALLOCATOR_H
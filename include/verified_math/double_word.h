@@ -0,0 +1,269 @@
+#ifndef DOUBLE_WORD_H
+#define DOUBLE_WORD_H
+
+#include "verified_math/error_free.h"
+#include "verified_math/scalar_math.h"
+
+#include <cmath>
+#include <limits>
+
+namespace verified_math {
+
+  /*
+    An unevaluated sum hi + lo of two T with |lo| <= ulp(hi) / 2, for use
+    as the Scalar of the vector, matrix, quaternion and decomposition
+    templates when T loses too many digits: DoubleDouble carries 106
+    significant bits and FloatFloat 48, with the exponent range of T.
+    Plain T and integer operands convert implicitly.
+
+    The arithmetic is that of Joldes, Muller and Popescu, "Tight and
+    rigorous error bounds for basic building blocks of double-word
+    arithmetic" (2017), on top of detail::two_sum and two_product. With
+    u = epsilon(T) / 2 the relative errors are at most 3 u^2 for
+    addition, 5 u^2 for multiplication (7 u^2 without FMA) and 15 u^2
+    for division. sqrt, sin, cos and acos are accurate to a few u^2 for
+    moderate arguments; sin and cos reduce by a two-word pi / 2, which
+    loses accuracy as |x| grows.
+   */
+  template<typename T>
+  class DoubleWord {
+  public:
+    // Uninitialized, as T is; the templates declare arrays of Scalar.
+    DoubleWord() = default;
+
+    constexpr DoubleWord(T x)
+      : h(x), l(0) { }
+
+    // hi + lo, which need not be normalized.
+    DoubleWord(T hi, T lo) {
+      detail::two_sum(hi, lo, h, l);
+    }
+
+    constexpr T hi() const { return h; }
+    constexpr T lo() const { return l; }
+
+    friend DoubleWord operator+(const DoubleWord& x, const DoubleWord& y) {
+      T sh, sl, th, tl, vh, vl, zh, zl;
+      detail::two_sum(x.h, y.h, sh, sl);
+      detail::two_sum(x.l, y.l, th, tl);
+      detail::fast_two_sum(sh, sl + th, vh, vl);
+      detail::fast_two_sum(vh, tl + vl, zh, zl);
+      return DoubleWord(zh, zl, Normalized());
+    }
+
+    friend DoubleWord operator-(const DoubleWord& x, const DoubleWord& y) {
+      return x + -y;
+    }
+
+    friend DoubleWord operator-(const DoubleWord& x) {
+      return DoubleWord(-x.h, -x.l, Normalized());
+    }
+
+    friend DoubleWord operator*(const DoubleWord& x, const DoubleWord& y) {
+      T ch, cl, zh, zl;
+      detail::two_product(x.h, y.h, ch, cl);
+#if defined(FP_FAST_FMA)
+      const T cross = std::fma(x.l, y.h, std::fma(x.h, y.l, x.l * y.l));
+#else
+      const T cross = x.h * y.l + x.l * y.h;
+#endif
+      detail::fast_two_sum(ch, cl + cross, zh, zl);
+      return DoubleWord(zh, zl, Normalized());
+    }
+
+    friend DoubleWord operator/(const DoubleWord& x, const DoubleWord& y) {
+      // One correction of the quotient of the high words: x - t y is
+      // small, so its leading difference is exact.
+      const T t = x.h / y.h;
+      T rh, rl, zh, zl;
+      detail::two_product(y.h, t, rh, rl);
+      const T r = (x.h - rh) + (x.l - (rl + y.l * t));
+      detail::fast_two_sum(t, r / y.h, zh, zl);
+      return DoubleWord(zh, zl, Normalized());
+    }
+
+    DoubleWord& operator+=(const DoubleWord& y) { return *this = *this + y; }
+    DoubleWord& operator-=(const DoubleWord& y) { return *this = *this - y; }
+    DoubleWord& operator*=(const DoubleWord& y) { return *this = *this * y; }
+    DoubleWord& operator/=(const DoubleWord& y) { return *this = *this / y; }
+
+    // Normalized values compare by their high words first.
+    friend bool operator==(const DoubleWord& x, const DoubleWord& y) {
+      return x.h == y.h && x.l == y.l;
+    }
+
+    friend bool operator!=(const DoubleWord& x, const DoubleWord& y) {
+      return !(x == y);
+    }
+
+    friend bool operator<(const DoubleWord& x, const DoubleWord& y) {
+      return x.h < y.h || (x.h == y.h && x.l < y.l);
+    }
+
+    friend bool operator>(const DoubleWord& x, const DoubleWord& y) {
+      return y < x;
+    }
+
+    friend bool operator<=(const DoubleWord& x, const DoubleWord& y) {
+      return x.h < y.h || (x.h == y.h && x.l <= y.l);
+    }
+
+    friend bool operator>=(const DoubleWord& x, const DoubleWord& y) {
+      return y <= x;
+    }
+
+  private:
+    struct Normalized { };
+
+    constexpr DoubleWord(T hi, T lo, Normalized)
+      : h(hi), l(lo) { }
+
+    T h;
+    T l;
+  };
+
+  typedef DoubleWord<double> DoubleDouble;
+  typedef DoubleWord<float> FloatFloat;
+
+  /*
+    The math functions the templates call (see scalar_math.h), found by
+    argument-dependent lookup.
+   */
+  template<typename T>
+  DoubleWord<T> abs(const DoubleWord<T>& x) {
+    return x.hi() < T(0) ? -x : x;
+  }
+
+  template<typename T>
+  DoubleWord<T> fabs(const DoubleWord<T>& x) {
+    return abs(x);
+  }
+
+  template<typename T>
+  bool isfinite(const DoubleWord<T>& x) {
+    return std::isfinite(x.hi());
+  }
+
+  template<typename T>
+  DoubleWord<T> sqrt(const DoubleWord<T>& x) {
+    const T q = std::sqrt(x.hi());
+    if (!(x.hi() > T(0)) || !std::isfinite(x.hi())) {
+      return DoubleWord<T>(q);
+    }
+    // One Newton step from the square root of the high word.
+    T ph, pl;
+    detail::two_product(q, q, ph, pl);
+    return DoubleWord<T>(q, ((x.hi() - ph) - pl + x.lo()) / (2 * q));
+  }
+
+  template<typename T>
+  DoubleWord<T> hypot(const DoubleWord<T>& x, const DoubleWord<T>& y) {
+    const DoubleWord<T> ax = abs(x), ay = abs(y);
+    const DoubleWord<T> big = ax < ay ? ay : ax, small = ax < ay ? ax : ay;
+    if (big.hi() == T(0) || !std::isfinite(big.hi())) {
+      return big;
+    }
+    const DoubleWord<T> r = small / big;
+    return big * sqrt(1 + r * r);
+  }
+
+  namespace detail {
+
+    /*
+      sin x and cos x. x is reduced to r = x - k pi / 2 with |r| <= pi / 4,
+      where the Taylor series run until their terms drop below the
+      precision, at most 15 terms for DoubleDouble.
+     */
+    template<typename T>
+    void sin_cos(const DoubleWord<T>& x, DoubleWord<T>& s, DoubleWord<T>& c) {
+      // pi / 2 to 106 bits, rounded to two T.
+      const double pi_2_hi = 1.5707963267948966, pi_2_lo = 6.123233995736766e-17;
+      const DoubleWord<T> pi_2(T(pi_2_hi), T((pi_2_hi - double(T(pi_2_hi))) + pi_2_lo));
+      const T k = std::nearbyint(x.hi() / pi_2.hi());
+      const DoubleWord<T> r = x - DoubleWord<T>(k) * pi_2;
+      const DoubleWord<T> r2 = r * r;
+      const T eps = std::numeric_limits<T>::epsilon();
+
+      DoubleWord<T> sr = r, cr = 1, term = r;
+      for (int i = 1; i < 20 && abs(term.hi()) > eps * eps * abs(sr.hi()); ++i) {
+	term = -term * r2 / T((2 * i) * (2 * i + 1));
+	sr += term;
+      }
+      term = 1;
+      for (int i = 1; i < 20 && abs(term.hi()) > eps * eps; ++i) {
+	term = -term * r2 / T((2 * i - 1) * (2 * i));
+	cr += term;
+      }
+
+      switch (static_cast<long long>(k) & 3) {
+      case 0: s = sr; c = cr; break;
+      case 1: s = cr; c = -sr; break;
+      case 2: s = -sr; c = -cr; break;
+      default: s = -cr; c = sr; break;
+      }
+    }
+
+  }
+
+  template<typename T>
+  DoubleWord<T> sin(const DoubleWord<T>& x) {
+    DoubleWord<T> s(0), c(0);
+    detail::sin_cos(x, s, c);
+    return s;
+  }
+
+  template<typename T>
+  DoubleWord<T> cos(const DoubleWord<T>& x) {
+    DoubleWord<T> s(0), c(0);
+    detail::sin_cos(x, s, c);
+    return c;
+  }
+
+  template<typename T>
+  DoubleWord<T> acos(const DoubleWord<T>& x) {
+    const T a0 = std::acos(x.hi());
+    if (!(abs(x.hi()) <= T(1))) {
+      return DoubleWord<T>(a0);
+    }
+    // acos x is the angle of (x, y) with y = sqrt(1 - x^2); one Newton
+    // step from the acos of the high word, a + (y cos a - x sin a).
+    const DoubleWord<T> y = sqrt((1 - x) * (1 + x));
+    DoubleWord<T> s(0), c(0);
+    detail::sin_cos(DoubleWord<T>(a0), s, c);
+    return a0 + (y * c - x * s);
+  }
+
+}
+
+namespace std {
+
+  template<typename T>
+  class numeric_limits<verified_math::DoubleWord<T> > : public numeric_limits<T> {
+    typedef verified_math::DoubleWord<T> D;
+
+  public:
+    static constexpr int digits = 2 * numeric_limits<T>::digits;
+    static constexpr int digits10 = (digits - 1) * 301 / 1000;
+    static constexpr int max_digits10 = digits * 301 / 1000 + 2;
+    static constexpr int min_exponent = numeric_limits<T>::min_exponent + numeric_limits<T>::digits;
+    static constexpr bool is_iec559 = false;
+
+    // The smallest value whose low word still has full precision.
+    static constexpr D min() noexcept {
+      return D(numeric_limits<T>::min() / numeric_limits<T>::epsilon());
+    }
+    static constexpr D max() noexcept { return D(numeric_limits<T>::max()); }
+    static constexpr D lowest() noexcept { return D(numeric_limits<T>::lowest()); }
+    static constexpr D epsilon() noexcept {
+      return D(numeric_limits<T>::epsilon() * numeric_limits<T>::epsilon());
+    }
+    static constexpr D round_error() noexcept { return D(numeric_limits<T>::round_error()); }
+    static constexpr D infinity() noexcept { return D(numeric_limits<T>::infinity()); }
+    static constexpr D quiet_NaN() noexcept { return D(numeric_limits<T>::quiet_NaN()); }
+    static constexpr D signaling_NaN() noexcept { return D(numeric_limits<T>::signaling_NaN()); }
+    static constexpr D denorm_min() noexcept { return D(numeric_limits<T>::denorm_min()); }
+  };
+
+}
+
+#endif // DOUBLE_WORD_H
@@ -0,0 +1,328 @@
+#ifndef EIGEN33_H
+#define EIGEN33_H
+
+#include "verified_math/vec3.h"
+#include "verified_math/vec3_array.h"
+#include "verified_math/mat33.h"
+#include "verified_math/mat33_array.h"
+#include "verified_math/scalar_math.h"
+#include "verified_math/instantiate.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <limits>
+
+namespace verified_math {
+
+  /*
+    The eigendecomposition m = V diag(values) V^T of a symmetric 3x3
+    matrix. The values are in ascending order, and the columns of vectors
+    are the matching unit eigenvectors, oriented so that V is a rotation
+    (det V = +1).
+   */
+  template<typename Scalar>
+  struct SymmetricEigen33 {
+    Vec3<Scalar> values;
+    Mat33<Scalar> vectors;
+  };
+
+  namespace detail {
+
+    // A unit vector orthogonal to the unit vector w.
+    template<typename Scalar>
+    Vec3<Scalar> orthogonal_unit(const Vec3<Scalar>& w) {
+      if (abs(w.x1) > abs(w.x2)) {
+	const Scalar inv = Scalar(1) / sqrt(w.x1 * w.x1 + w.x3 * w.x3);
+	return Vec3<Scalar>(-w.x3 * inv, Scalar(0), w.x1 * inv);
+      }
+      const Scalar inv = Scalar(1) / sqrt(w.x2 * w.x2 + w.x3 * w.x3);
+      return Vec3<Scalar>(Scalar(0), w.x3 * inv, -w.x2 * inv);
+    }
+
+    /*
+      The eigenvector of a simple eigenvalue: the rows of m - value I span
+      a plane, and the largest cross product of two rows is its normal.
+     */
+    template<typename Scalar>
+    Vec3<Scalar> simple_eigenvector(const Mat33<Scalar>& m, Scalar value) {
+      const Vec3<Scalar> r1(m.x11 - value, m.x12, m.x13);
+      const Vec3<Scalar> r2(m.x21, m.x22 - value, m.x23);
+      const Vec3<Scalar> r3(m.x31, m.x32, m.x33 - value);
+      const Vec3<Scalar> c12 = cross(r1, r2);
+      const Vec3<Scalar> c13 = cross(r1, r3);
+      const Vec3<Scalar> c23 = cross(r2, r3);
+      const Scalar d12 = dot(c12, c12), d13 = dot(c13, c13), d23 = dot(c23, c23);
+      if (d12 >= d13 && d12 >= d23) {
+	return (Scalar(1) / sqrt(d12)) * c12;
+      } else if (d13 >= d23) {
+	return (Scalar(1) / sqrt(d13)) * c13;
+      }
+      return (Scalar(1) / sqrt(d23)) * c23;
+    }
+
+    /*
+      The eigenvector of value orthogonal to the unit eigenvector v. In a
+      basis (u, w) of the plane orthogonal to v, m - value I restricts to a
+      singular 2x2 matrix [a b; b c]; its null vector is normal to the
+      larger row. With |m| about 1, a row too small to square is zero to
+      working accuracy, and every vector of the plane will do.
+     */
+    template<typename Scalar>
+    Vec3<Scalar> second_eigenvector(const Mat33<Scalar>& m, const Vec3<Scalar>& v, Scalar value) {
+      const Vec3<Scalar> u = orthogonal_unit(v);
+      const Vec3<Scalar> w = cross(v, u);
+      const Vec3<Scalar> mu = m * u;
+      const Vec3<Scalar> mw = m * w;
+      const Scalar a = dot(u, mu) - value;
+      const Scalar b = dot(u, mw);
+      const Scalar c = dot(w, mw) - value;
+      const Scalar ab = a * a + b * b;
+      const Scalar bc = b * b + c * c;
+      if (ab >= bc) {
+	return ab > Scalar(0) ? (Scalar(1) / sqrt(ab)) * (b * u - a * w) : u;
+      }
+      return (Scalar(1) / sqrt(bc)) * (c * u - b * w);
+    }
+
+    /*
+      Cyclic Jacobi on the symmetric matrix a (only the upper triangle is
+      read), accumulating the rotations into the columns of v. Each
+      rotation zeroes one off-diagonal entry; convergence is quadratic, so
+      a nearly diagonal start finishes in one or two sweeps.
+     */
+    template<typename Scalar>
+    void jacobi(Scalar a[3][3], Scalar v[3][3]) {
+      const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+      const Scalar norm = a[0][0] * a[0][0] + a[1][1] * a[1][1] + a[2][2] * a[2][2] +
+	2 * (a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2]);
+
+      for (int sweep = 0; sweep < 32; ++sweep) {
+	const Scalar off = a[0][1] * a[0][1] + a[0][2] * a[0][2] + a[1][2] * a[1][2];
+	if (off <= eps * eps * norm) {
+	  return;
+	}
+	for (int p = 0; p < 2; ++p) {
+	  for (int q = p + 1; q < 3; ++q) {
+	    const Scalar apq = a[p][q];
+	    if (apq == Scalar(0)) {
+	      continue;
+	    }
+	    const Scalar theta = (a[q][q] - a[p][p]) / (2 * apq);
+	    const Scalar t = (theta >= Scalar(0) ? Scalar(1) : Scalar(-1)) /
+	      (abs(theta) + hypot(theta, Scalar(1)));
+	    const Scalar c = Scalar(1) / sqrt(t * t + Scalar(1));
+	    const Scalar s = t * c;
+
+	    a[p][p] -= t * apq;
+	    a[q][q] += t * apq;
+	    a[p][q] = Scalar(0);
+	    const int r = 3 - p - q;
+	    // a[r][p] and a[r][q], read through the upper triangle.
+	    Scalar& arp = r < p ? a[r][p] : a[p][r];
+	    Scalar& arq = r < q ? a[r][q] : a[q][r];
+	    const Scalar x = arp, y = arq;
+	    arp = c * x - s * y;
+	    arq = s * x + c * y;
+	    for (int k = 0; k < 3; ++k) {
+	      const Scalar vp = v[k][p], vq = v[k][q];
+	      v[k][p] = c * vp - s * vq;
+	      v[k][q] = s * vp + c * vq;
+	    }
+	  }
+	}
+      }
+    }
+
+    /*
+      The analytic decomposition of a symmetric matrix whose largest entry
+      has magnitude about 1. The eigenvalues are the roots of the characteristic
+      cubic in trigonometric form; the eigenvector of the best separated
+      one comes first, from cross products, then the second from a 2x2
+      problem orthogonal to it, and the third is their cross product.
+
+      When the residual |m V - V diag(values)| is not within a few ulps of
+      |m| (clustered eigenvalues, where the cubic loses accuracy), the
+      result is refined by Jacobi on V^T m V, which is then nearly diagonal.
+     */
+    template<typename Scalar>
+    void symmetric_eigen_scaled(const Mat33<Scalar>& m, Scalar values[3], Scalar vectors[3][3]) {
+      const Scalar eps = std::numeric_limits<Scalar>::epsilon();
+      const Scalar off = m.x12 * m.x12 + m.x13 * m.x13 + m.x23 * m.x23;
+      const Scalar q = (m.x11 + m.x22 + m.x33) / 3;
+      const Scalar b11 = m.x11 - q, b22 = m.x22 - q, b33 = m.x33 - q;
+      const Scalar p2 = b11 * b11 + b22 * b22 + b33 * b33 + 2 * off;
+
+      Vec3<Scalar> e1(1, 0, 0), e2(0, 1, 0), e3(0, 0, 1);
+      Scalar l1 = m.x11, l2 = m.x22, l3 = m.x33;
+      if (p2 > Scalar(0) && off > Scalar(0)) {
+	const Scalar p = sqrt(p2 / 6);
+	const Scalar inv_p = Scalar(1) / p;
+	const Mat33<Scalar> b = inv_p * Mat33<Scalar>{
+	  b11, m.x12, m.x13,
+	  m.x12, b22, m.x23,
+	  m.x13, m.x23, b33
+	};
+	const Scalar half_det = std::min(Scalar(1), std::max(Scalar(-1), det(b) / 2));
+	const Scalar angle = acos(half_det) / 3;
+	const Scalar two_pi_3 = Scalar(2.09439510239319549230842892218633526);
+	const Scalar beta3 = 2 * cos(angle);
+	const Scalar beta1 = 2 * cos(angle + two_pi_3);
+	const Scalar beta2 = -(beta1 + beta3);
+	const Mat33<Scalar> s = Mat33<Scalar>{
+	  m.x11, m.x12, m.x13,
+	  m.x12, m.x22, m.x23,
+	  m.x13, m.x23, m.x33
+	};
+	l1 = q + p * beta1;
+	l2 = q + p * beta2;
+	l3 = q + p * beta3;
+	// half_det >= 0: the largest eigenvalue is the best separated.
+	if (half_det >= Scalar(0)) {
+	  e3 = simple_eigenvector(s, l3);
+	  e2 = second_eigenvector(s, e3, l2);
+	  e1 = cross(e2, e3);
+	} else {
+	  e1 = simple_eigenvector(s, l1);
+	  e2 = second_eigenvector(s, e1, l2);
+	  e3 = cross(e1, e2);
+	}
+      }
+
+      const Scalar vs[3][3] = {
+	{e1.x1, e2.x1, e3.x1},
+	{e1.x2, e2.x2, e3.x2},
+	{e1.x3, e2.x3, e3.x3}
+      };
+      const Scalar ls[3] = {l1, l2, l3};
+      const Scalar ms[3][3] = {
+	{m.x11, m.x12, m.x13},
+	{m.x12, m.x22, m.x23},
+	{m.x13, m.x23, m.x33}
+      };
+
+      Scalar residual = Scalar(0);
+      bool finite = true;
+      for (int i = 0; i < 3; ++i) {
+	for (int j = 0; j < 3; ++j) {
+	  const Scalar r = ms[i][0] * vs[0][j] + ms[i][1] * vs[1][j] + ms[i][2] * vs[2][j] -
+	    vs[i][j] * ls[j];
+	  residual += r * r;
+	  finite = finite && isfinite(vs[i][j]);
+	}
+	values[i] = ls[i];
+      }
+      for (int i = 0; i < 3; ++i) {
+	for (int j = 0; j < 3; ++j) {
+	  vectors[i][j] = finite ? vs[i][j] : (i == j ? Scalar(1) : Scalar(0));
+	}
+      }
+      // |m| >= 1 after scaling, so this is a relative bound.
+      if (finite && residual <= (64 * eps) * (64 * eps)) {
+	return;
+      }
+
+      // Refine: a = V^T m V (upper triangle), then Jacobi from V.
+      Scalar mv[3][3];
+      for (int i = 0; i < 3; ++i) {
+	for (int j = 0; j < 3; ++j) {
+	  mv[i][j] = ms[i][0] * vectors[0][j] + ms[i][1] * vectors[1][j] + ms[i][2] * vectors[2][j];
+	}
+      }
+      Scalar a[3][3];
+      for (int i = 0; i < 3; ++i) {
+	for (int j = i; j < 3; ++j) {
+	  a[i][j] = vectors[0][i] * mv[0][j] + vectors[1][i] * mv[1][j] + vectors[2][i] * mv[2][j];
+	}
+      }
+      jacobi(a, vectors);
+      for (int i = 0; i < 3; ++i) {
+	values[i] = a[i][i];
+      }
+    }
+
+  }
+
+  /*
+    Eigenvalues and eigenvectors of a symmetric matrix; only the upper
+    triangle of m is read. The matrix is scaled by its largest entry first
+    (exactly, by a power of two, for float and double), so the result does
+    not overflow or underflow for any finite input.
+   */
+  template<typename Scalar>
+  SymmetricEigen33<Scalar> symmetric_eigen(const Mat33<Scalar>& m) {
+    const Scalar scale = std::max(std::max(std::max(abs(m.x11), abs(m.x12)),
+					   std::max(abs(m.x13), abs(m.x22))),
+				  std::max(abs(m.x23), abs(m.x33)));
+    if (scale == Scalar(0)) {
+      const Scalar z(0), o(1);
+      return SymmetricEigen33<Scalar>{Vec3<Scalar>(z, z, z), Mat33<Scalar>{o, z, z, z, o, z, z, z, o}};
+    }
+
+    const Scalar inv = detail::magnitude_scale(scale);
+    const Scalar unscale = Scalar(1) / inv;
+    Scalar l[3];
+    Scalar v[3][3];
+    detail::symmetric_eigen_scaled(inv * m, l, v);
+
+    // Sort ascending, swapping columns along with the values.
+    for (int i = 0; i < 2; ++i) {
+      for (int j = 0; j < 2 - i; ++j) {
+	if (l[j + 1] < l[j]) {
+	  std::swap(l[j], l[j + 1]);
+	  for (int k = 0; k < 3; ++k) {
+	    std::swap(v[k][j], v[k][j + 1]);
+	  }
+	}
+      }
+    }
+    Mat33<Scalar> vectors{
+      v[0][0], v[0][1], v[0][2],
+      v[1][0], v[1][1], v[1][2],
+      v[2][0], v[2][1], v[2][2]
+    };
+    if (det(vectors) < Scalar(0)) {
+      vectors.x13 = -vectors.x13;
+      vectors.x23 = -vectors.x23;
+      vectors.x33 = -vectors.x33;
+    }
+    return SymmetricEigen33<Scalar>{
+      Vec3<Scalar>(unscale * l[0], unscale * l[1], unscale * l[2]), vectors};
+  }
+
+  /*
+    Batched decomposition of the entries [begin, end): values[i] and
+    vectors[i] are those of symmetric_eigen(m[i]). values and vectors must
+    already hold m.size() entries.
+   */
+  template<typename Scalar>
+  void symmetric_eigen(const Mat33Array<Scalar>& m, Vec3Array<Scalar>& values,
+		       Mat33Array<Scalar>& vectors, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      const SymmetricEigen33<Scalar> e = symmetric_eigen(m[i]);
+      values.set(i, e.values);
+      vectors.set(i, e.vectors);
+    }
+  }
+
+  template<typename Scalar>
+  void symmetric_eigen(const Mat33Array<Scalar>& m, Vec3Array<Scalar>& values,
+		       Mat33Array<Scalar>& vectors) {
+    values.resize(m.size());
+    vectors.resize(m.size());
+    symmetric_eigen(m, values, vectors, 0, m.size());
+  }
+
+  // Explicit instantiations for float and double; see instantiate.h.
+#define VERIFIED_MATH_EIGEN33_TEMPLATES(instantiate, Scalar) \
+  instantiate SymmetricEigen33<Scalar> symmetric_eigen(const Mat33<Scalar>&); \
+  instantiate void symmetric_eigen(const Mat33Array<Scalar>&, Vec3Array<Scalar>&, Mat33Array<Scalar>&, std::size_t, std::size_t); \
+  instantiate void symmetric_eigen(const Mat33Array<Scalar>&, Vec3Array<Scalar>&, Mat33Array<Scalar>&);
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_EIGEN33_TEMPLATES)
+#endif
+
+}
+
+#endif // EIGEN33_H
@@ -0,0 +1,56 @@
+#ifndef ERROR_FREE_H
+#define ERROR_FREE_H
+
+#include <cmath>
+#include <limits>
+
+namespace verified_math {
+
+  namespace detail {
+
+    /*
+      Error-free transformations: the rounded result x of a sum or
+      product together with its rounding error y, so that x + y is the
+      exact result. They hold under round-to-nearest, barring overflow,
+      and are the building blocks of the exact predicates and of
+      DoubleWord.
+
+      two_product uses a fused multiply-add where the target has one
+      (FP_FAST_FMA), and Dekker's splitting otherwise.
+     */
+    template<typename Scalar>
+    inline void two_sum(Scalar a, Scalar b, Scalar& x, Scalar& y) {
+      x = a + b;
+      const Scalar bv = x - a;
+      const Scalar av = x - bv;
+      y = (a - av) + (b - bv);
+    }
+
+    // two_sum for |a| >= |b|.
+    template<typename Scalar>
+    inline void fast_two_sum(Scalar a, Scalar b, Scalar& x, Scalar& y) {
+      x = a + b;
+      y = b - (x - a);
+    }
+
+    // x + y = a * b exactly.
+    template<typename Scalar>
+    inline void two_product(Scalar a, Scalar b, Scalar& x, Scalar& y) {
+      x = a * b;
+#if defined(FP_FAST_FMA)
+      y = std::fma(a, b, -x);
+#else
+      // Dekker: split a and b into halves whose products are exact.
+      const Scalar splitter = Scalar((1 << ((std::numeric_limits<Scalar>::digits + 1) / 2)) + 1);
+      const Scalar ca = splitter * a, cb = splitter * b;
+      const Scalar ahi = ca - (ca - a), bhi = cb - (cb - b);
+      const Scalar alo = a - ahi, blo = b - bhi;
+      y = alo * blo - (((x - ahi * bhi) - alo * bhi) - ahi * blo);
+#endif
+    }
+
+  }
+
+}
+
+#endif // ERROR_FREE_H
@@ -0,0 +1,233 @@
+#ifndef EXPR_H
+#define EXPR_H
+
+#include "verified_math/vec3.h"
+#include "verified_math/vec4.h"
+#include "verified_math/mat33.h"
+#include "verified_math/mat44.h"
+
+#include <cstddef>
+#include <type_traits>
+
+namespace verified_math {
+
+  /*
+    Opt-in expression templates.
+
+    Wrapping operands in lazy() builds an expression tree instead of a
+    temporary per operator, and eval() computes every entry of the result
+    in one loop:
+
+      Mat44<double> r = eval(a * lazy(m1) + b * lazy(m2) - lazy(m3));
+
+    Element-wise nodes (+, -, scaling) are fused. Matrix-matrix and
+    matrix-vector products are evaluated eagerly through the ordinary
+    operators, because each output entry reads a whole row and column and
+    an in-place fused product would read entries it has already written.
+    Terminals hold references, so an expression must not outlive its
+    operands.
+   */
+  namespace expr {
+
+    /*
+      Entry count and flat, row-major entry access for the value types.
+     */
+    template<typename T>
+    struct Shape;
+
+    template<typename S>
+    struct Shape<Vec3<S> > {
+      typedef S Scalar;
+      static const std::size_t size = 3;
+      static Vec3<S> zero() { return Vec3<S>{S(0), S(0), S(0)}; }
+      static const S* data(const Vec3<S>& v) { return &v.x1; }
+      static S* data(Vec3<S>& v) { return &v.x1; }
+    };
+
+    template<typename S>
+    struct Shape<Vec4<S> > {
+      typedef S Scalar;
+      static const std::size_t size = 4;
+      static Vec4<S> zero() { return Vec4<S>{S(0), S(0), S(0), S(0)}; }
+      static const S* data(const Vec4<S>& v) { return &v.x1; }
+      static S* data(Vec4<S>& v) { return &v.x1; }
+    };
+
+    template<typename S>
+    struct Shape<Mat33<S> > {
+      typedef S Scalar;
+      static const std::size_t size = 9;
+      static Mat33<S> zero() { return Mat33<S>{S(0), S(0), S(0), S(0), S(0), S(0), S(0), S(0), S(0)}; }
+      static const S* data(const Mat33<S>& m) { return &m.x11; }
+      static S* data(Mat33<S>& m) { return &m.x11; }
+    };
+
+    template<typename S>
+    struct Shape<Mat44<S> > {
+      typedef S Scalar;
+      static const std::size_t size = 16;
+      static Mat44<S> zero() {
+	return Mat44<S>{S(0), S(0), S(0), S(0), S(0), S(0), S(0), S(0),
+	    S(0), S(0), S(0), S(0), S(0), S(0), S(0), S(0)};
+      }
+      static const S* data(const Mat44<S>& m) { return &m.x11; }
+      static S* data(Mat44<S>& m) { return &m.x11; }
+    };
+
+    /*
+      Base of every expression node (CRTP), so the operators below only
+      apply to expressions.
+     */
+    template<typename E>
+    struct Expr {
+      const E& self() const { return static_cast<const E&>(*this); }
+    };
+
+    // A reference to an existing value.
+    template<typename T>
+    class Terminal : public Expr<Terminal<T> > {
+    public:
+      typedef T result_type;
+      typedef typename Shape<T>::Scalar Scalar;
+
+      explicit Terminal(const T& _value) : value(_value) { }
+
+      Scalar operator[](std::size_t i) const { return Shape<T>::data(value)[i]; }
+
+    private:
+      const T& value;
+    };
+
+    // An owned value, used for the result of an eager product.
+    template<typename T>
+    class Value : public Expr<Value<T> > {
+    public:
+      typedef T result_type;
+      typedef typename Shape<T>::Scalar Scalar;
+
+      explicit Value(const T& _value) : value(_value) { }
+
+      Scalar operator[](std::size_t i) const { return Shape<T>::data(value)[i]; }
+
+    private:
+      T value;
+    };
+
+    template<typename L, typename R>
+    class Add : public Expr<Add<L, R> > {
+      static_assert(std::is_same<typename L::result_type, typename R::result_type>::value,
+		    "operands of an element-wise expression must have the same shape");
+
+    public:
+      typedef typename L::result_type result_type;
+      typedef typename L::Scalar Scalar;
+
+      Add(const L& _l, const R& _r) : l(_l), r(_r) { }
+
+      Scalar operator[](std::size_t i) const { return l[i] + r[i]; }
+
+    private:
+      L l;
+      R r;
+    };
+
+    template<typename L, typename R>
+    class Sub : public Expr<Sub<L, R> > {
+      static_assert(std::is_same<typename L::result_type, typename R::result_type>::value,
+		    "operands of an element-wise expression must have the same shape");
+
+    public:
+      typedef typename L::result_type result_type;
+      typedef typename L::Scalar Scalar;
+
+      Sub(const L& _l, const R& _r) : l(_l), r(_r) { }
+
+      Scalar operator[](std::size_t i) const { return l[i] - r[i]; }
+
+    private:
+      L l;
+      R r;
+    };
+
+    template<typename E>
+    class Scale : public Expr<Scale<E> > {
+    public:
+      typedef typename E::result_type result_type;
+      typedef typename E::Scalar Scalar;
+
+      Scale(Scalar _c, const E& _e) : c(_c), e(_e) { }
+
+      Scalar operator[](std::size_t i) const { return c * e[i]; }
+
+    private:
+      Scalar c;
+      E e;
+    };
+
+    /*
+      Evaluation: one pass over the entries of the result.
+     */
+    template<typename E>
+    typename E::result_type eval(const Expr<E>& x) {
+      typedef typename E::result_type T;
+      const E& e = x.self();
+      T result = Shape<T>::zero();
+      typename Shape<T>::Scalar* out = Shape<T>::data(result);
+      for (std::size_t i = 0; i < Shape<T>::size; ++i) {
+	out[i] = e[i];
+      }
+      return result;
+    }
+
+    /*
+      Sums and differences only of the same shape: a Mat44 plus a Mat33
+      would read past the end of the smaller operand. The operators drop
+      out of overload resolution for other shapes, so such an expression
+      does not compile.
+     */
+    template<typename L, typename R>
+    struct SameShape
+      : std::is_same<typename L::result_type, typename R::result_type> { };
+
+    template<typename L, typename R>
+    typename std::enable_if<SameShape<L, R>::value, Add<L, R> >::type
+    operator+(const Expr<L>& l, const Expr<R>& r) {
+      return Add<L, R>(l.self(), r.self());
+    }
+
+    template<typename L, typename R>
+    typename std::enable_if<SameShape<L, R>::value, Sub<L, R> >::type
+    operator-(const Expr<L>& l, const Expr<R>& r) {
+      return Sub<L, R>(l.self(), r.self());
+    }
+
+    template<typename E>
+    Scale<E> operator*(typename E::Scalar c, const Expr<E>& e) {
+      return Scale<E>(c, e.self());
+    }
+
+    template<typename E>
+    Scale<E> operator*(const Expr<E>& e, typename E::Scalar c) {
+      return Scale<E>(c, e.self());
+    }
+
+    // Products are evaluated eagerly; see above.
+    template<typename L, typename R>
+    auto operator*(const Expr<L>& l, const Expr<R>& r) -> Value<decltype(eval(l) * eval(r))> {
+      typedef decltype(eval(l) * eval(r)) T;
+      return Value<T>(eval(l) * eval(r));
+    }
+
+  }
+
+  using expr::eval;
+
+  // Starts an expression from an existing value.
+  template<typename T>
+  expr::Terminal<T> lazy(const T& value) {
+    return expr::Terminal<T>(value);
+  }
+
+}
+
+#endif // EXPR_H
@@ -0,0 +1,517 @@
+#ifndef FIXED_H
+#define FIXED_H
+
+#include "verified_math/vec3.h"
+#include "verified_math/vec4.h"
+#include "verified_math/mat33.h"
+#include "verified_math/mat44.h"
+#include "verified_math/vec3_array.h"
+#include "verified_math/vec4_array.h"
+#include "verified_math/simd.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+
+namespace verified_math {
+
+  namespace detail {
+
+    // The representation of a fixed-point number of Bits bits and the
+    // type that holds the exact product of two.
+    template<int Bits>
+    struct FixedTypes;
+
+    template<>
+    struct FixedTypes<16> {
+      typedef std::int16_t Rep;
+      typedef std::uint16_t URep;
+      typedef std::int32_t Wide;
+      typedef std::uint32_t UWide;
+    };
+
+    template<>
+    struct FixedTypes<32> {
+      typedef std::int32_t Rep;
+      typedef std::uint32_t URep;
+      typedef std::int64_t Wide;
+      typedef std::uint64_t UWide;
+    };
+
+  }
+
+  /*
+    A signed binary fixed-point number with IntBits integer bits, the
+    sign included, and FracBits fraction bits, for use as the Scalar of
+    the vector and matrix templates where results must be bit-identical
+    on every machine and compiler: every operation is defined on the
+    integer representation, so the scalar code, the vectorized batched
+    kernels and other platforms all agree. Fixed<16, 16> covers
+    [-32768, 32768) in steps of 2^-16; IntBits + FracBits is 16 or 32.
+    int converts implicitly, double only explicitly, as rounding it is
+    the one step that depends on the floating-point environment.
+
+    Addition, subtraction and negation wrap around modulo 2^(IntBits +
+    FracBits) instead of overflowing. Multiplication forms the exact
+    product in the wide type and rounds it to nearest, ties up (towards
+    +infinity), which is a shift and an add. Division truncates towards
+    zero; x / 0 is the largest value of the sign of x, and 0 / 0 is 0.
+
+    dot, cross, det and the matrix-vector products below, batched ones
+    included, are overloads of the templates that keep the products
+    exact in the wide type and round once, or in det once per minor;
+    the other templates, such as the matrix product and inverse, round
+    every product.
+   */
+  template<int IntBits, int FracBits>
+  class Fixed {
+    static_assert(IntBits >= 1 && FracBits >= 1 &&
+		  (IntBits + FracBits == 16 || IntBits + FracBits == 32),
+		  "Fixed needs 16 or 32 bits, with at least one of each kind");
+    typedef detail::FixedTypes<IntBits + FracBits> Types;
+
+  public:
+    typedef typename Types::Rep Rep;
+    typedef typename Types::URep URep;
+    typedef typename Types::Wide Wide;
+    typedef typename Types::UWide UWide;
+
+    static constexpr int int_bits = IntBits;
+    static constexpr int frac_bits = FracBits;
+
+    // Uninitialized, as float is; the templates declare arrays of Scalar.
+    Fixed() = default;
+
+    // Wraps around when x is out of range.
+    constexpr Fixed(int x)
+      : r(wrap(Wide(UWide(x) << FracBits))) { }
+
+    // Rounded to nearest, ties away from zero; x must be in range.
+    explicit constexpr Fixed(double x)
+      : r(Rep(Wide(x * scale() + (x < 0 ? -0.5 : 0.5)))) { }
+
+    // Exact for double; float rounds when IntBits + FracBits > 24.
+    explicit constexpr operator double() const {
+      return double(r) / scale();
+    }
+
+    explicit constexpr operator float() const {
+      return float(double(r) / scale());
+    }
+
+    static constexpr Fixed from_raw(Rep raw) {
+      return Fixed(raw, Raw());
+    }
+
+    // The value times 2^FracBits.
+    constexpr Rep raw() const { return r; }
+
+    friend constexpr Fixed operator+(Fixed x, Fixed y) {
+      return from_raw(wrap(Wide(x.r) + y.r));
+    }
+
+    friend constexpr Fixed operator-(Fixed x, Fixed y) {
+      return from_raw(wrap(Wide(x.r) - y.r));
+    }
+
+    friend constexpr Fixed operator-(Fixed x) {
+      return from_raw(wrap(-Wide(x.r)));
+    }
+
+    friend constexpr Fixed operator*(Fixed x, Fixed y) {
+      return from_raw(round(Wide(x.r) * y.r));
+    }
+
+    friend constexpr Fixed operator/(Fixed x, Fixed y) {
+      return y.r == 0 ?
+	from_raw(x.r == 0 ? Rep(0) : x.r > 0 ? std::numeric_limits<Rep>::max() :
+		 std::numeric_limits<Rep>::min()) :
+	from_raw(wrap(Wide(x.r) * (Wide(1) << FracBits) / y.r));
+    }
+
+    Fixed& operator+=(Fixed y) { return *this = *this + y; }
+    Fixed& operator-=(Fixed y) { return *this = *this - y; }
+    Fixed& operator*=(Fixed y) { return *this = *this * y; }
+    Fixed& operator/=(Fixed y) { return *this = *this / y; }
+
+    friend constexpr bool operator==(Fixed x, Fixed y) { return x.r == y.r; }
+    friend constexpr bool operator!=(Fixed x, Fixed y) { return x.r != y.r; }
+    friend constexpr bool operator<(Fixed x, Fixed y) { return x.r < y.r; }
+    friend constexpr bool operator>(Fixed x, Fixed y) { return x.r > y.r; }
+    friend constexpr bool operator<=(Fixed x, Fixed y) { return x.r <= y.r; }
+    friend constexpr bool operator>=(Fixed x, Fixed y) { return x.r >= y.r; }
+
+    // The low bits of w, as two's complement.
+    static constexpr Rep wrap(Wide w) {
+      return Rep(URep(w));
+    }
+
+    /*
+      A wide value with 2 FracBits fraction bits, such as a product or a
+      sum of products, rounded to nearest with ties up and wrapped. The
+      shift is arithmetic on every compiler this library supports.
+     */
+    static constexpr Rep round(Wide w) {
+      return wrap(Wide(UWide(w) + (UWide(1) << (FracBits - 1))) >> FracBits);
+    }
+
+  private:
+    struct Raw { };
+
+    constexpr Fixed(Rep raw, Raw)
+      : r(raw) { }
+
+    static constexpr double scale() {
+      return double(Wide(1) << FracBits);
+    }
+
+    Rep r;
+  };
+
+  namespace detail {
+
+    /*
+      The exact product of x and y with 2 FracBits fraction bits. It is
+      returned unsigned so that sums of products wrap instead of
+      overflowing; they are exact whenever the rounded result is in
+      range, since the wide type has room for twice the bits.
+     */
+    template<int I, int F>
+    constexpr typename Fixed<I, F>::UWide wide_product(Fixed<I, F> x, Fixed<I, F> y) {
+      return typename Fixed<I, F>::UWide(typename Fixed<I, F>::Wide(x.raw()) * y.raw());
+    }
+
+    template<int I, int F>
+    constexpr Fixed<I, F> round_wide(typename Fixed<I, F>::UWide w) {
+      return Fixed<I, F>::from_raw(Fixed<I, F>::round(typename Fixed<I, F>::Wide(w)));
+    }
+
+    // x1 y1 - x2 y2, rounded once.
+    template<int I, int F>
+    constexpr Fixed<I, F> diff_of_products(Fixed<I, F> x1, Fixed<I, F> y1,
+					   Fixed<I, F> x2, Fixed<I, F> y2) {
+      return round_wide<I, F>(wide_product(x1, y1) - wide_product(x2, y2));
+    }
+
+  }
+
+  /*
+    The math functions the templates call (see scalar_math.h), found by
+    argument-dependent lookup. abs of the most negative value wraps to
+    itself; sqrt is the exact square root rounded down, and 0 for
+    negative x.
+   */
+  template<int I, int F>
+  constexpr Fixed<I, F> abs(Fixed<I, F> x) {
+    return x.raw() < 0 ? -x : x;
+  }
+
+  template<int I, int F>
+  constexpr Fixed<I, F> fabs(Fixed<I, F> x) {
+    return abs(x);
+  }
+
+  template<int I, int F>
+  constexpr bool isfinite(Fixed<I, F>) {
+    return true;
+  }
+
+  template<int I, int F>
+  Fixed<I, F> sqrt(Fixed<I, F> x) {
+    typedef typename Fixed<I, F>::UWide UWide;
+    if (x.raw() <= 0) {
+      return Fixed<I, F>(0);
+    }
+    // The integer square root of raw 2^F, a bit at a time from the top.
+    UWide n = UWide(x.raw()) << F, root = 0;
+    UWide bit = UWide(1) << (2 * (I + F) - 2);
+    while (bit > n) {
+      bit >>= 2;
+    }
+    for (; bit != 0; bit >>= 2) {
+      if (n >= root + bit) {
+	n -= root + bit;
+	root = (root >> 1) + bit;
+      } else {
+	root >>= 1;
+      }
+    }
+    return Fixed<I, F>::from_raw(typename Fixed<I, F>::Rep(root));
+  }
+
+  /*
+    Products with widened intermediates: dot, cross and the entries of
+    matrix-vector products are the exact results rounded once, to
+    nearest with ties up. det rounds each 2x2 minor and then sums the
+    minors times the entries exactly, so its error is at most half a
+    unit per minor, weighted by the entries, plus half a unit; the
+    generic det rounds every product.
+   */
+  template<int I, int F>
+  constexpr Fixed<I, F> dot(Vec3<Fixed<I, F> > x, Vec3<Fixed<I, F> > y) {
+    return detail::round_wide<I, F>(detail::wide_product(x.x1, y.x1) +
+				    detail::wide_product(x.x2, y.x2) +
+				    detail::wide_product(x.x3, y.x3));
+  }
+
+  template<int I, int F>
+  constexpr Fixed<I, F> dot(const Vec4<Fixed<I, F> >& x, const Vec4<Fixed<I, F> >& y) {
+    return detail::round_wide<I, F>(detail::wide_product(x.x1, y.x1) +
+				    detail::wide_product(x.x2, y.x2) +
+				    detail::wide_product(x.x3, y.x3) +
+				    detail::wide_product(x.x4, y.x4));
+  }
+
+  template<int I, int F>
+  constexpr Vec3<Fixed<I, F> > cross(Vec3<Fixed<I, F> > x, Vec3<Fixed<I, F> > y) {
+    return Vec3<Fixed<I, F> >{
+      detail::diff_of_products(x.x2, y.x3, x.x3, y.x2),
+	detail::diff_of_products(x.x3, y.x1, x.x1, y.x3),
+	detail::diff_of_products(x.x1, y.x2, x.x2, y.x1)
+    };
+  }
+
+  template<int I, int F>
+  constexpr Vec3<Fixed<I, F> > operator*(const Mat33<Fixed<I, F> >& m, const Vec3<Fixed<I, F> >& v) {
+    return Vec3<Fixed<I, F> >{
+      dot(Vec3<Fixed<I, F> >{m.x11, m.x12, m.x13}, v),
+	dot(Vec3<Fixed<I, F> >{m.x21, m.x22, m.x23}, v),
+	dot(Vec3<Fixed<I, F> >{m.x31, m.x32, m.x33}, v)
+    };
+  }
+
+  template<int I, int F>
+  constexpr Vec4<Fixed<I, F> > operator*(const Mat44<Fixed<I, F> >& m, const Vec4<Fixed<I, F> >& v) {
+    return Vec4<Fixed<I, F> >{
+      dot(Vec4<Fixed<I, F> >{m.x11, m.x12, m.x13, m.x14}, v),
+	dot(Vec4<Fixed<I, F> >{m.x21, m.x22, m.x23, m.x24}, v),
+	dot(Vec4<Fixed<I, F> >{m.x31, m.x32, m.x33, m.x34}, v),
+	dot(Vec4<Fixed<I, F> >{m.x41, m.x42, m.x43, m.x44}, v)
+    };
+  }
+
+  template<int I, int F>
+  constexpr Fixed<I, F> det(const Mat33<Fixed<I, F> >& m) {
+    return detail::round_wide<I, F>(
+      detail::wide_product(m.x11, detail::diff_of_products(m.x22, m.x33, m.x23, m.x32)) +
+      detail::wide_product(m.x12, detail::diff_of_products(m.x23, m.x31, m.x21, m.x33)) +
+      detail::wide_product(m.x13, detail::diff_of_products(m.x21, m.x32, m.x31, m.x22)));
+  }
+
+  // The Laplace expansion of the generic det, by complementary minors.
+  template<int I, int F>
+  constexpr Fixed<I, F> det(const Mat44<Fixed<I, F> >& m) {
+    return detail::round_wide<I, F>(
+      detail::wide_product(detail::diff_of_products(m.x11, m.x22, m.x21, m.x12),
+			   detail::diff_of_products(m.x33, m.x44, m.x43, m.x34)) -
+      detail::wide_product(detail::diff_of_products(m.x11, m.x23, m.x21, m.x13),
+			   detail::diff_of_products(m.x32, m.x44, m.x42, m.x34)) +
+      detail::wide_product(detail::diff_of_products(m.x11, m.x24, m.x21, m.x14),
+			   detail::diff_of_products(m.x32, m.x43, m.x42, m.x33)) +
+      detail::wide_product(detail::diff_of_products(m.x12, m.x23, m.x22, m.x13),
+			   detail::diff_of_products(m.x31, m.x44, m.x41, m.x34)) -
+      detail::wide_product(detail::diff_of_products(m.x12, m.x24, m.x22, m.x14),
+			   detail::diff_of_products(m.x31, m.x43, m.x41, m.x33)) +
+      detail::wide_product(detail::diff_of_products(m.x13, m.x24, m.x23, m.x14),
+			   detail::diff_of_products(m.x31, m.x42, m.x41, m.x32)));
+  }
+
+  namespace detail {
+
+    /*
+      The batched kernels work on blocks (see pad_block) of fixed_block
+      entries of the representation, so that the widened products
+      vectorize with integer SIMD.
+     */
+    const std::size_t fixed_block = 256;
+
+    template<int N, typename X>
+    void load_fixed_block(const X* const* lanes, std::size_t s, std::size_t n,
+			  typename X::Rep (*out)[fixed_block]) {
+      static_assert(sizeof(X) == sizeof(typename X::Rep), "Fixed must be its representation");
+      for (int k = 0; k < N; ++k) {
+	std::memcpy(out[k], lanes[k] + s, n * sizeof(X));
+	pad_block(out[k], n);
+      }
+    }
+
+    template<int N, typename X>
+    void store_fixed_block(const typename X::Rep (*in)[fixed_block], std::size_t s,
+			   std::size_t n, X* const* lanes) {
+      for (int k = 0; k < N; ++k) {
+	std::memcpy(lanes[k] + s, in[k], n * sizeof(X));
+      }
+    }
+
+    // Rows of m times the vectors of the lanes x, each a widened dot
+    // product accumulated a column at a time.
+    template<int N, typename X>
+    void transform_fixed(const typename X::Rep (&m)[N][N], const X* const* x, X* const* out,
+			 std::size_t begin, std::size_t end) {
+      typedef typename X::Rep Rep;
+      typedef typename X::Wide Wide;
+      typedef typename X::UWide UWide;
+      Rep a[N][fixed_block], o[N][fixed_block];
+      UWide p[fixed_block];
+      for (std::size_t s = begin; s < end; s += fixed_block) {
+	const std::size_t n = end - s < fixed_block ? end - s : fixed_block;
+	load_fixed_block<N>(x, s, n, a);
+	for (int r = 0; r < N; ++r) {
+	  const Wide m0 = m[r][0];
+	  for (std::size_t t = 0; t < fixed_block; ++t) {
+	    p[t] = UWide(m0 * a[0][t]);
+	  }
+	  for (int k = 1; k < N; ++k) {
+	    const Wide mk = m[r][k];
+	    for (std::size_t t = 0; t < fixed_block; ++t) {
+	      p[t] += UWide(mk * a[k][t]);
+	    }
+	  }
+	  for (std::size_t t = 0; t < fixed_block; ++t) {
+	    o[r][t] = X::round(Wide(p[t]));
+	  }
+	}
+	store_fixed_block<N>(o, s, n, out);
+      }
+    }
+
+    template<int N, typename X>
+    void dot_fixed(const X* const* x, const X* const* y, X* out, std::size_t n) {
+      typedef typename X::Rep Rep;
+      typedef typename X::Wide Wide;
+      typedef typename X::UWide UWide;
+      Rep a[N][fixed_block], b[N][fixed_block], d[1][fixed_block];
+      UWide p[fixed_block];
+      for (std::size_t s = 0; s < n; s += fixed_block) {
+	const std::size_t m = n - s < fixed_block ? n - s : fixed_block;
+	load_fixed_block<N>(x, s, m, a);
+	load_fixed_block<N>(y, s, m, b);
+	for (std::size_t t = 0; t < fixed_block; ++t) {
+	  p[t] = UWide(Wide(a[0][t]) * b[0][t]);
+	}
+	for (int k = 1; k < N; ++k) {
+	  for (std::size_t t = 0; t < fixed_block; ++t) {
+	    p[t] += UWide(Wide(a[k][t]) * b[k][t]);
+	  }
+	}
+	for (std::size_t t = 0; t < fixed_block; ++t) {
+	  d[0][t] = X::round(Wide(p[t]));
+	}
+	store_fixed_block<1>(d, s, m, &out);
+      }
+    }
+
+  }
+
+  /*
+    The batched forms of the widened products, which give the same
+    results as the scalar ones entry by entry. The whole-array forms of
+    the templates call these.
+   */
+  template<int I, int F>
+  void transform_vectors(const Mat33<Fixed<I, F> >& m, const Vec3<Fixed<I, F> >* in,
+			 Vec3<Fixed<I, F> >* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = m * in[i];
+    }
+  }
+
+  template<int I, int F>
+  void transform_vectors(const Mat33<Fixed<I, F> >& m, const Vec3Array<Fixed<I, F> >& in,
+			 Vec3Array<Fixed<I, F> >& out, std::size_t begin, std::size_t end) {
+    typedef Fixed<I, F> X;
+    const typename X::Rep r[3][3] = {
+      {m.x11.raw(), m.x12.raw(), m.x13.raw()},
+      {m.x21.raw(), m.x22.raw(), m.x23.raw()},
+      {m.x31.raw(), m.x32.raw(), m.x33.raw()}};
+    const X* const x[3] = {in.x1.data(), in.x2.data(), in.x3.data()};
+    X* const o[3] = {out.x1.data(), out.x2.data(), out.x3.data()};
+    detail::transform_fixed<3>(r, x, o, begin, end);
+  }
+
+  template<int I, int F>
+  void transform_vectors(const Mat44<Fixed<I, F> >& m, const Vec4<Fixed<I, F> >* in,
+			 Vec4<Fixed<I, F> >* out, std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = m * in[i];
+    }
+  }
+
+  template<int I, int F>
+  void transform_vectors(const Mat44<Fixed<I, F> >& m, const Vec4Array<Fixed<I, F> >& in,
+			 Vec4Array<Fixed<I, F> >& out, std::size_t begin, std::size_t end) {
+    typedef Fixed<I, F> X;
+    const typename X::Rep r[4][4] = {
+      {m.x11.raw(), m.x12.raw(), m.x13.raw(), m.x14.raw()},
+      {m.x21.raw(), m.x22.raw(), m.x23.raw(), m.x24.raw()},
+      {m.x31.raw(), m.x32.raw(), m.x33.raw(), m.x34.raw()},
+      {m.x41.raw(), m.x42.raw(), m.x43.raw(), m.x44.raw()}};
+    const X* const x[4] = {in.x1.data(), in.x2.data(), in.x3.data(), in.x4.data()};
+    X* const o[4] = {out.x1.data(), out.x2.data(), out.x3.data(), out.x4.data()};
+    detail::transform_fixed<4>(r, x, o, begin, end);
+  }
+
+  // x and y must be the same size (checked by assert); out must hold
+  // x.size() entries.
+  template<int I, int F>
+  void dot(const Vec3Array<Fixed<I, F> >& x, const Vec3Array<Fixed<I, F> >& y, Fixed<I, F>* out) {
+    assert(y.size() == x.size());
+    typedef Fixed<I, F> X;
+    const X* const a[3] = {x.x1.data(), x.x2.data(), x.x3.data()};
+    const X* const b[3] = {y.x1.data(), y.x2.data(), y.x3.data()};
+    detail::dot_fixed<3>(a, b, out, x.size());
+  }
+
+  template<int I, int F>
+  void dot(const Vec4Array<Fixed<I, F> >& x, const Vec4Array<Fixed<I, F> >& y, Fixed<I, F>* out) {
+    assert(y.size() == x.size());
+    typedef Fixed<I, F> X;
+    const X* const a[4] = {x.x1.data(), x.x2.data(), x.x3.data(), x.x4.data()};
+    const X* const b[4] = {y.x1.data(), y.x2.data(), y.x3.data(), y.x4.data()};
+    detail::dot_fixed<4>(a, b, out, x.size());
+  }
+
+}
+
+namespace std {
+
+  /*
+    Fixed has no infinity or NaN; infinity() is max(), which is what
+    x / 0 gives and what try_inverse reports as the condition of a
+    singular matrix. epsilon() and min() are one unit in the last place.
+   */
+  template<int I, int F>
+  class numeric_limits<verified_math::Fixed<I, F> > {
+    typedef verified_math::Fixed<I, F> X;
+    typedef typename X::Rep Rep;
+
+  public:
+    static constexpr bool is_specialized = true;
+    static constexpr bool is_signed = true;
+    static constexpr bool is_integer = false;
+    static constexpr bool is_exact = true;
+    static constexpr bool has_infinity = false;
+    static constexpr bool has_quiet_NaN = false;
+    static constexpr bool has_signaling_NaN = false;
+    static constexpr bool is_iec559 = false;
+    static constexpr bool is_bounded = true;
+    static constexpr bool is_modulo = true;
+    static constexpr int radix = 2;
+    static constexpr int digits = I + F - 1;
+    static constexpr int digits10 = (digits - 1) * 301 / 1000;
+
+    static constexpr X min() noexcept { return X::from_raw(1); }
+    static constexpr X max() noexcept { return X::from_raw(numeric_limits<Rep>::max()); }
+    static constexpr X lowest() noexcept { return X::from_raw(numeric_limits<Rep>::min()); }
+    static constexpr X epsilon() noexcept { return X::from_raw(1); }
+    static constexpr X round_error() noexcept { return X::from_raw(Rep(1) << (F - 1)); }
+    static constexpr X infinity() noexcept { return max(); }
+    static constexpr X denorm_min() noexcept { return min(); }
+  };
+
+}
+
+#endif // FIXED_H
@@ -0,0 +1,279 @@
+#ifndef HALF_H
+#define HALF_H
+
+#include "verified_math/simd.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+namespace verified_math {
+
+  namespace detail {
+
+    inline float bits_to_float(std::uint32_t u) {
+      float f;
+      std::memcpy(&f, &u, sizeof f);
+      return f;
+    }
+
+    inline std::uint32_t float_to_bits(float f) {
+      std::uint32_t u;
+      std::memcpy(&u, &f, sizeof u);
+      return u;
+    }
+
+    /*
+      IEEE binary16 to float, exactly. The exponent and mantissa move to
+      their float positions and are rebiased by a multiply with 2^112,
+      which also normalizes the subnormal halves; infinities and NaNs are
+      selected afterwards. There are no branches, so loops over it
+      vectorize.
+     */
+    inline float half_to_float(std::uint16_t h) {
+      const std::uint32_t em = h & 0x7fffu;
+      float f = bits_to_float(em << 13) * bits_to_float((127u + 112u) << 23);
+      f = em >= 0x7c00u ? bits_to_float((em << 13) | 0x7f800000u) : f;
+      return bits_to_float(float_to_bits(f) | (std::uint32_t(h & 0x8000u) << 16));
+    }
+
+    /*
+      float to binary16, rounded to nearest even. Magnitudes from 65520 up
+      round to infinity and NaNs become the quiet NaN 0x7e00. Results
+      below 2^-14 are subnormal: adding 0.5 aligns the mantissa so that
+      the float addition does the rounding.
+     */
+    inline std::uint16_t float_to_half(float x) {
+      const std::uint32_t sign = float_to_bits(x) & 0x80000000u;
+      std::uint32_t u = float_to_bits(x) ^ sign;
+      std::uint32_t h;
+      if (u >= (127u + 16u) << 23) {
+	h = u > 0x7f800000u ? 0x7e00u : 0x7c00u;
+      } else if (u < (127u - 14u) << 23) {
+	const std::uint32_t magic = (127u - 1u) << 23;
+	h = float_to_bits(bits_to_float(u) + bits_to_float(magic)) - magic;
+      } else {
+	const std::uint32_t odd = (u >> 13) & 1u;
+	u += ((15u - 127u) << 23) + 0xfffu + odd;
+	h = u >> 13;
+      }
+      return std::uint16_t(h | (sign >> 16));
+    }
+
+    // bfloat16 is the upper half of a float.
+    inline float bfloat16_to_float(std::uint16_t b) {
+      return bits_to_float(std::uint32_t(b) << 16);
+    }
+
+    // Rounded to nearest even; NaNs stay NaN and become quiet.
+    inline std::uint16_t float_to_bfloat16(float x) {
+      const std::uint32_t u = float_to_bits(x);
+      if ((u & 0x7fffffffu) > 0x7f800000u) {
+	return std::uint16_t((u >> 16) | 0x40u);
+      }
+      return std::uint16_t((u + 0x7fffu + ((u >> 16) & 1u)) >> 16);
+    }
+
+  }
+
+  /*
+    Storage-only 16-bit floating-point types, for buffers of normals,
+    directions and other data that tolerate three significant digits but
+    are limited by memory bandwidth. They have no arithmetic: convert to
+    float, compute, and convert back, or use the batched kernels of
+    half_array.h, which do that a block at a time.
+
+    Half is IEEE binary16: 11 significant bits, largest finite value
+    65504, subnormals below 2^-14. BFloat16 keeps float's exponent range
+    with 8 significant bits. Conversion from float rounds to nearest
+    even; conversion to float is exact.
+   */
+  class Half {
+  public:
+    // Uninitialized, as float is; Lane(n) value-initializes to +0.
+    Half() = default;
+
+    explicit Half(float x)
+      : b(detail::float_to_half(x)) { }
+
+    explicit operator float() const {
+      return detail::half_to_float(b);
+    }
+
+    static Half from_bits(std::uint16_t bits) {
+      Half h;
+      h.b = bits;
+      return h;
+    }
+
+    std::uint16_t bits() const { return b; }
+
+  private:
+    std::uint16_t b;
+  };
+
+  class BFloat16 {
+  public:
+    BFloat16() = default;
+
+    explicit BFloat16(float x)
+      : b(detail::float_to_bfloat16(x)) { }
+
+    explicit operator float() const {
+      return detail::bfloat16_to_float(b);
+    }
+
+    static BFloat16 from_bits(std::uint16_t bits) {
+      BFloat16 h;
+      h.b = bits;
+      return h;
+    }
+
+    std::uint16_t bits() const { return b; }
+
+  private:
+    std::uint16_t b;
+  };
+
+  static_assert(sizeof(Half) == 2 && sizeof(BFloat16) == 2,
+		"16-bit storage types must pack into arrays of uint16_t");
+
+#if defined(VERIFIED_MATH_SSE2)
+  namespace detail {
+
+    /*
+      The conversions above on four values at a time, for SSE2 without
+      F16C. The 16-bit values travel in the low halves of 32-bit lanes;
+      pack16 sign-extends them so that the saturating pack keeps their
+      bits.
+     */
+    inline __m128 half_to_float4(__m128i h) {
+      const __m128i em = _mm_and_si128(h, _mm_set1_epi32(0x7fff));
+      const __m128i shifted = _mm_slli_epi32(em, 13);
+      const __m128 f = _mm_mul_ps(_mm_castsi128_ps(shifted),
+				  _mm_castsi128_ps(_mm_set1_epi32((127 + 112) << 23)));
+      const __m128 special = _mm_castsi128_ps(_mm_cmpgt_epi32(em, _mm_set1_epi32(0x7bff)));
+      const __m128 inf_nan = _mm_castsi128_ps(_mm_or_si128(shifted, _mm_set1_epi32(0x7f800000)));
+      const __m128i sign = _mm_slli_epi32(_mm_and_si128(h, _mm_set1_epi32(0x8000)), 16);
+      return _mm_or_ps(_mm_or_ps(_mm_andnot_ps(special, f), _mm_and_ps(special, inf_nan)),
+		       _mm_castsi128_ps(sign));
+    }
+
+    inline __m128i float_to_half4(__m128 x) {
+      const __m128i sign = _mm_and_si128(_mm_castps_si128(x), _mm_set1_epi32(int(0x80000000u)));
+      const __m128i u = _mm_xor_si128(_mm_castps_si128(x), sign);
+
+      const __m128i odd = _mm_and_si128(_mm_srli_epi32(u, 13), _mm_set1_epi32(1));
+      const __m128i normal = _mm_srli_epi32(
+	_mm_add_epi32(_mm_add_epi32(u, _mm_set1_epi32(int(((15u - 127u) << 23) + 0xfffu))), odd), 13);
+      const __m128i magic = _mm_set1_epi32((127 - 1) << 23);
+      const __m128i subnormal = _mm_sub_epi32(
+	_mm_castps_si128(_mm_add_ps(_mm_castsi128_ps(u), _mm_castsi128_ps(magic))), magic);
+      const __m128i is_nan = _mm_cmpgt_epi32(u, _mm_set1_epi32(0x7f800000));
+      const __m128i inf_nan = _mm_or_si128(_mm_set1_epi32(0x7c00),
+					   _mm_and_si128(is_nan, _mm_set1_epi32(0x0200)));
+
+      const __m128i big = _mm_cmpgt_epi32(u, _mm_set1_epi32(((127 + 16) << 23) - 1));
+      const __m128i small = _mm_cmplt_epi32(u, _mm_set1_epi32((127 - 14) << 23));
+      __m128i h = _mm_or_si128(_mm_and_si128(small, subnormal), _mm_andnot_si128(small, normal));
+      h = _mm_or_si128(_mm_and_si128(big, inf_nan), _mm_andnot_si128(big, h));
+      return _mm_or_si128(h, _mm_srli_epi32(sign, 16));
+    }
+
+    inline __m128i float_to_bfloat16_4(__m128 x) {
+      const __m128i u = _mm_castps_si128(x);
+      const __m128i lsb = _mm_and_si128(_mm_srli_epi32(u, 16), _mm_set1_epi32(1));
+      const __m128i rounded = _mm_add_epi32(_mm_add_epi32(u, _mm_set1_epi32(0x7fff)), lsb);
+      const __m128i is_nan = _mm_cmpgt_epi32(_mm_and_si128(u, _mm_set1_epi32(0x7fffffff)),
+					     _mm_set1_epi32(0x7f800000));
+      const __m128i quiet = _mm_or_si128(u, _mm_set1_epi32(0x400000));
+      const __m128i r = _mm_or_si128(_mm_and_si128(is_nan, quiet), _mm_andnot_si128(is_nan, rounded));
+      return _mm_srli_epi32(r, 16);
+    }
+
+    inline __m128i pack16(__m128i lo, __m128i hi) {
+      return _mm_packs_epi32(_mm_srai_epi32(_mm_slli_epi32(lo, 16), 16),
+			     _mm_srai_epi32(_mm_slli_epi32(hi, 16), 16));
+    }
+
+  }
+#endif // VERIFIED_MATH_SSE2
+
+  /*
+    Bulk conversion of n values, eight at a time: Half by F16C
+    (VERIFIED_MATH_F16C) when available, which rounds the same way, and
+    otherwise by SSE2 versions of the functions above; the tail one at a
+    time.
+   */
+  inline void decode(const Half* in, float* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(VERIFIED_MATH_F16C)
+    for (; i + 8 <= n; i += 8) {
+      const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+      _mm256_storeu_ps(out + i, _mm256_cvtph_ps(h));
+    }
+#elif defined(VERIFIED_MATH_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+      const __m128i h = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+      _mm_storeu_ps(out + i, detail::half_to_float4(_mm_unpacklo_epi16(h, zero)));
+      _mm_storeu_ps(out + i + 4, detail::half_to_float4(_mm_unpackhi_epi16(h, zero)));
+    }
+#endif
+    for (; i < n; ++i) {
+      out[i] = detail::half_to_float(in[i].bits());
+    }
+  }
+
+  inline void encode(const float* in, Half* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(VERIFIED_MATH_F16C)
+    for (; i + 8 <= n; i += 8) {
+      const __m128i h = _mm256_cvtps_ph(_mm256_loadu_ps(in + i), _MM_FROUND_TO_NEAREST_INT);
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), h);
+    }
+#elif defined(VERIFIED_MATH_SSE2)
+    for (; i + 8 <= n; i += 8) {
+      const __m128i h = detail::pack16(detail::float_to_half4(_mm_loadu_ps(in + i)),
+				       detail::float_to_half4(_mm_loadu_ps(in + i + 4)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), h);
+    }
+#endif
+    for (; i < n; ++i) {
+      out[i] = Half(in[i]);
+    }
+  }
+
+  // A BFloat16 is the upper half of its float.
+  inline void decode(const BFloat16* in, float* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(VERIFIED_MATH_SSE2)
+    const __m128i zero = _mm_setzero_si128();
+    for (; i + 8 <= n; i += 8) {
+      const __m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(in + i));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_unpacklo_epi16(zero, b));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i + 4), _mm_unpackhi_epi16(zero, b));
+    }
+#endif
+    for (; i < n; ++i) {
+      out[i] = detail::bfloat16_to_float(in[i].bits());
+    }
+  }
+
+  inline void encode(const float* in, BFloat16* out, std::size_t n) {
+    std::size_t i = 0;
+#if defined(VERIFIED_MATH_SSE2)
+    for (; i + 8 <= n; i += 8) {
+      const __m128i b = detail::pack16(detail::float_to_bfloat16_4(_mm_loadu_ps(in + i)),
+				       detail::float_to_bfloat16_4(_mm_loadu_ps(in + i + 4)));
+      _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), b);
+    }
+#endif
+    for (; i < n; ++i) {
+      out[i] = BFloat16(in[i]);
+    }
+  }
+
+}
+
+#endif // HALF_H
@@ -0,0 +1,406 @@
+#ifndef HALF_ARRAY_H
+#define HALF_ARRAY_H
+
+#include "verified_math/half.h"
+#include "verified_math/vec3.h"
+#include "verified_math/vec4.h"
+#include "verified_math/vec3_array.h"
+#include "verified_math/vec4_array.h"
+#include "verified_math/mat33.h"
+#include "verified_math/aligned_allocator.h"
+#include "verified_math/simd.h"
+
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace verified_math {
+
+  /*
+    Structure-of-arrays containers of 3- and 4-vectors stored as Half or
+    BFloat16, at a third (Vec3) or half the bytes of the float arrays.
+    Elements read and write as float vectors; each component is rounded
+    on the way in.
+   */
+  template<typename Storage>
+  class Vec3HalfArray {
+  public:
+    typedef std::vector<Storage, aligned_allocator<Storage> > Lane;
+
+    Lane x1;
+    Lane x2;
+    Lane x3;
+
+    Vec3HalfArray() { }
+
+    explicit Vec3HalfArray(std::size_t n)
+      : x1(n), x2(n), x3(n) { }
+
+    explicit Vec3HalfArray(const Vec3Array<float>& v)
+      : x1(v.size()), x2(v.size()), x3(v.size()) {
+      encode(v.x1.data(), x1.data(), v.size());
+      encode(v.x2.data(), x2.data(), v.size());
+      encode(v.x3.data(), x3.data(), v.size());
+    }
+
+    std::size_t size() const {
+      return x1.size();
+    }
+
+    void resize(std::size_t n) {
+      x1.resize(n);
+      x2.resize(n);
+      x3.resize(n);
+    }
+
+    void push_back(const Vec3<float>& v) {
+      x1.push_back(Storage(v.x1));
+      x2.push_back(Storage(v.x2));
+      x3.push_back(Storage(v.x3));
+    }
+
+    Vec3<float> operator[](std::size_t i) const {
+      return Vec3<float>{float(x1[i]), float(x2[i]), float(x3[i])};
+    }
+
+    void set(std::size_t i, const Vec3<float>& v) {
+      x1[i] = Storage(v.x1);
+      x2[i] = Storage(v.x2);
+      x3[i] = Storage(v.x3);
+    }
+  };
+
+  template<typename Storage>
+  class Vec4HalfArray {
+  public:
+    typedef std::vector<Storage, aligned_allocator<Storage> > Lane;
+
+    Lane x1;
+    Lane x2;
+    Lane x3;
+    Lane x4;
+
+    Vec4HalfArray() { }
+
+    explicit Vec4HalfArray(std::size_t n)
+      : x1(n), x2(n), x3(n), x4(n) { }
+
+    explicit Vec4HalfArray(const Vec4Array<float>& v)
+      : x1(v.size()), x2(v.size()), x3(v.size()), x4(v.size()) {
+      encode(v.x1.data(), x1.data(), v.size());
+      encode(v.x2.data(), x2.data(), v.size());
+      encode(v.x3.data(), x3.data(), v.size());
+      encode(v.x4.data(), x4.data(), v.size());
+    }
+
+    std::size_t size() const {
+      return x1.size();
+    }
+
+    void resize(std::size_t n) {
+      x1.resize(n);
+      x2.resize(n);
+      x3.resize(n);
+      x4.resize(n);
+    }
+
+    void push_back(const Vec4<float>& v) {
+      x1.push_back(Storage(v.x1));
+      x2.push_back(Storage(v.x2));
+      x3.push_back(Storage(v.x3));
+      x4.push_back(Storage(v.x4));
+    }
+
+    Vec4<float> operator[](std::size_t i) const {
+      return Vec4<float>{float(x1[i]), float(x2[i]), float(x3[i]), float(x4[i])};
+    }
+
+    void set(std::size_t i, const Vec4<float>& v) {
+      x1[i] = Storage(v.x1);
+      x2[i] = Storage(v.x2);
+      x3[i] = Storage(v.x3);
+      x4[i] = Storage(v.x4);
+    }
+  };
+
+  // The float arrays, resized to match.
+  template<typename Storage>
+  void decode(const Vec3HalfArray<Storage>& in, Vec3Array<float>& out) {
+    out.resize(in.size());
+    decode(in.x1.data(), out.x1.data(), in.size());
+    decode(in.x2.data(), out.x2.data(), in.size());
+    decode(in.x3.data(), out.x3.data(), in.size());
+  }
+
+  template<typename Storage>
+  void decode(const Vec4HalfArray<Storage>& in, Vec4Array<float>& out) {
+    out.resize(in.size());
+    decode(in.x1.data(), out.x1.data(), in.size());
+    decode(in.x2.data(), out.x2.data(), in.size());
+    decode(in.x3.data(), out.x3.data(), in.size());
+    decode(in.x4.data(), out.x4.data(), in.size());
+  }
+
+  namespace detail {
+
+    /*
+      The kernels below decode half_block entries of each lane into local
+      float blocks (see pad_block), compute in float and encode the
+      results, so that the 16-bit data is read and written once.
+     */
+    const std::size_t half_block = 256;
+
+    template<int N, typename Storage>
+    void decode_block(const std::vector<Storage, aligned_allocator<Storage> >* const* lanes,
+		      std::size_t s, std::size_t n, float (*out)[half_block]) {
+      for (int k = 0; k < N; ++k) {
+	decode(lanes[k]->data() + s, out[k], n);
+	pad_block(out[k], n);
+      }
+    }
+
+    // Into float lanes when out is not null, else into the Storage lanes.
+    template<int N, typename Storage>
+    void store_block(float (*in)[half_block], std::size_t s, std::size_t n,
+		     std::vector<Storage, aligned_allocator<Storage> >* const* half,
+		     float* const* full) {
+      for (int k = 0; k < N; ++k) {
+	if (full) {
+	  std::copy(in[k], in[k] + n, full[k] + s);
+	} else {
+	  encode(in[k], half[k]->data() + s, n);
+	}
+      }
+    }
+
+    template<int N, typename Storage>
+    void dot_half(const std::vector<Storage, aligned_allocator<Storage> >* const* x,
+		  const std::vector<Storage, aligned_allocator<Storage> >* const* y,
+		  float* out, std::size_t begin, std::size_t end) {
+      float a[N][half_block], b[N][half_block], d[half_block];
+      for (std::size_t s = begin; s < end; s += half_block) {
+	const std::size_t n = end - s < half_block ? end - s : half_block;
+	decode_block<N>(x, s, n, a);
+	decode_block<N>(y, s, n, b);
+	for (std::size_t t = 0; t < half_block; ++t) {
+	  float p = a[0][t] * b[0][t];
+	  for (int k = 1; k < N; ++k) {
+	    p += a[k][t] * b[k][t];
+	  }
+	  d[t] = p;
+	}
+	std::copy(d, d + n, out + s);
+      }
+    }
+
+    template<int N, typename Storage>
+    void normalize_half(const std::vector<Storage, aligned_allocator<Storage> >* const* x,
+			std::vector<Storage, aligned_allocator<Storage> >* const* half,
+			float* const* full, std::size_t begin, std::size_t end) {
+      float a[N][half_block], norm[half_block];
+      for (std::size_t s = begin; s < end; s += half_block) {
+	const std::size_t n = end - s < half_block ? end - s : half_block;
+	decode_block<N>(x, s, n, a);
+	for (std::size_t t = 0; t < half_block; ++t) {
+	  float norm2 = a[0][t] * a[0][t];
+	  for (int k = 1; k < N; ++k) {
+	    norm2 += a[k][t] * a[k][t];
+	  }
+	  norm[t] = norm2;
+	}
+	sqrt_lanes(norm, half_block);
+	for (std::size_t t = 0; t < half_block; ++t) {
+	  const bool nonzero = norm[t] > 0.0f;
+	  const float inv = (nonzero ? 1.0f : 0.0f) / (nonzero ? norm[t] : 1.0f);
+	  for (int k = 0; k < N; ++k) {
+	    a[k][t] *= inv;
+	  }
+	}
+	store_block<N>(a, s, n, half, full);
+      }
+    }
+
+    template<typename Storage>
+    void transform_half(const Mat33<float>& m,
+			const std::vector<Storage, aligned_allocator<Storage> >* const* x,
+			std::vector<Storage, aligned_allocator<Storage> >* const* half,
+			float* const* full, std::size_t begin, std::size_t end) {
+      const float m11 = m.x11, m12 = m.x12, m13 = m.x13;
+      const float m21 = m.x21, m22 = m.x22, m23 = m.x23;
+      const float m31 = m.x31, m32 = m.x32, m33 = m.x33;
+      float a[3][half_block], o[3][half_block];
+      for (std::size_t s = begin; s < end; s += half_block) {
+	const std::size_t n = end - s < half_block ? end - s : half_block;
+	decode_block<3>(x, s, n, a);
+	for (std::size_t t = 0; t < half_block; ++t) {
+	  const float v1 = a[0][t], v2 = a[1][t], v3 = a[2][t];
+	  o[0][t] = m11 * v1 + m12 * v2 + m13 * v3;
+	  o[1][t] = m21 * v1 + m22 * v2 + m23 * v3;
+	  o[2][t] = m31 * v1 + m32 * v2 + m33 * v3;
+	}
+	store_block<3>(o, s, n, half, full);
+      }
+    }
+
+  }
+
+  /*
+    Batched kernels on 16-bit storage, computed in float. Each has a form
+    over the entries [begin, end), whose outputs must already hold
+    in.size() entries, and a whole-array form that resizes them. Outputs
+    are rounded to Storage or written as float; half outputs may alias
+    the input.
+   */
+  // dot products; y must be the same size as x (checked by assert) and
+  // out must hold x.size() floats
+  template<typename Storage>
+  void dot(const Vec3HalfArray<Storage>& x, const Vec3HalfArray<Storage>& y, float* out,
+	   std::size_t begin, std::size_t end) {
+    assert(y.size() == x.size());
+    const typename Vec3HalfArray<Storage>::Lane* a[3] = {&x.x1, &x.x2, &x.x3};
+    const typename Vec3HalfArray<Storage>::Lane* b[3] = {&y.x1, &y.x2, &y.x3};
+    detail::dot_half<3>(a, b, out, begin, end);
+  }
+
+  template<typename Storage>
+  void dot(const Vec3HalfArray<Storage>& x, const Vec3HalfArray<Storage>& y, float* out) {
+    dot(x, y, out, 0, x.size());
+  }
+
+  template<typename Storage>
+  void dot(const Vec4HalfArray<Storage>& x, const Vec4HalfArray<Storage>& y, float* out,
+	   std::size_t begin, std::size_t end) {
+    assert(y.size() == x.size());
+    const typename Vec4HalfArray<Storage>::Lane* a[4] = {&x.x1, &x.x2, &x.x3, &x.x4};
+    const typename Vec4HalfArray<Storage>::Lane* b[4] = {&y.x1, &y.x2, &y.x3, &y.x4};
+    detail::dot_half<4>(a, b, out, begin, end);
+  }
+
+  template<typename Storage>
+  void dot(const Vec4HalfArray<Storage>& x, const Vec4HalfArray<Storage>& y, float* out) {
+    dot(x, y, out, 0, x.size());
+  }
+
+  // normalization to unit length; zero vectors stay zero
+  template<typename Storage>
+  void normalize(const Vec3HalfArray<Storage>& x, Vec3HalfArray<Storage>& out,
+		 std::size_t begin, std::size_t end) {
+    const typename Vec3HalfArray<Storage>::Lane* a[3] = {&x.x1, &x.x2, &x.x3};
+    typename Vec3HalfArray<Storage>::Lane* o[3] = {&out.x1, &out.x2, &out.x3};
+    detail::normalize_half<3>(a, o, static_cast<float* const*>(0), begin, end);
+  }
+
+  template<typename Storage>
+  void normalize(const Vec3HalfArray<Storage>& x, Vec3HalfArray<Storage>& out) {
+    out.resize(x.size());
+    normalize(x, out, 0, x.size());
+  }
+
+  template<typename Storage>
+  void normalize(const Vec3HalfArray<Storage>& x, Vec3Array<float>& out,
+		 std::size_t begin, std::size_t end) {
+    const typename Vec3HalfArray<Storage>::Lane* a[3] = {&x.x1, &x.x2, &x.x3};
+    float* const o[3] = {out.x1.data(), out.x2.data(), out.x3.data()};
+    detail::normalize_half<3>(a, static_cast<typename Vec3HalfArray<Storage>::Lane* const*>(0),
+			      o, begin, end);
+  }
+
+  template<typename Storage>
+  void normalize(const Vec3HalfArray<Storage>& x, Vec3Array<float>& out) {
+    out.resize(x.size());
+    normalize(x, out, 0, x.size());
+  }
+
+  template<typename Storage>
+  void normalize(const Vec4HalfArray<Storage>& x, Vec4HalfArray<Storage>& out,
+		 std::size_t begin, std::size_t end) {
+    const typename Vec4HalfArray<Storage>::Lane* a[4] = {&x.x1, &x.x2, &x.x3, &x.x4};
+    typename Vec4HalfArray<Storage>::Lane* o[4] = {&out.x1, &out.x2, &out.x3, &out.x4};
+    detail::normalize_half<4>(a, o, static_cast<float* const*>(0), begin, end);
+  }
+
+  template<typename Storage>
+  void normalize(const Vec4HalfArray<Storage>& x, Vec4HalfArray<Storage>& out) {
+    out.resize(x.size());
+    normalize(x, out, 0, x.size());
+  }
+
+  template<typename Storage>
+  void normalize(const Vec4HalfArray<Storage>& x, Vec4Array<float>& out,
+		 std::size_t begin, std::size_t end) {
+    const typename Vec4HalfArray<Storage>::Lane* a[4] = {&x.x1, &x.x2, &x.x3, &x.x4};
+    float* const o[4] = {out.x1.data(), out.x2.data(), out.x3.data(), out.x4.data()};
+    detail::normalize_half<4>(a, static_cast<typename Vec4HalfArray<Storage>::Lane* const*>(0),
+			      o, begin, end);
+  }
+
+  template<typename Storage>
+  void normalize(const Vec4HalfArray<Storage>& x, Vec4Array<float>& out) {
+    out.resize(x.size());
+    normalize(x, out, 0, x.size());
+  }
+
+  // m * v for every v
+  template<typename Storage>
+  void transform_vectors(const Mat33<float>& m, const Vec3HalfArray<Storage>& in,
+			 Vec3HalfArray<Storage>& out, std::size_t begin, std::size_t end) {
+    const typename Vec3HalfArray<Storage>::Lane* a[3] = {&in.x1, &in.x2, &in.x3};
+    typename Vec3HalfArray<Storage>::Lane* o[3] = {&out.x1, &out.x2, &out.x3};
+    detail::transform_half(m, a, o, static_cast<float* const*>(0), begin, end);
+  }
+
+  template<typename Storage>
+  void transform_vectors(const Mat33<float>& m, const Vec3HalfArray<Storage>& in,
+			 Vec3HalfArray<Storage>& out) {
+    out.resize(in.size());
+    transform_vectors(m, in, out, 0, in.size());
+  }
+
+  template<typename Storage>
+  void transform_vectors(const Mat33<float>& m, const Vec3HalfArray<Storage>& in,
+			 Vec3Array<float>& out, std::size_t begin, std::size_t end) {
+    const typename Vec3HalfArray<Storage>::Lane* a[3] = {&in.x1, &in.x2, &in.x3};
+    float* const o[3] = {out.x1.data(), out.x2.data(), out.x3.data()};
+    detail::transform_half(m, a, static_cast<typename Vec3HalfArray<Storage>::Lane* const*>(0),
+			   o, begin, end);
+  }
+
+  template<typename Storage>
+  void transform_vectors(const Mat33<float>& m, const Vec3HalfArray<Storage>& in,
+			 Vec3Array<float>& out) {
+    out.resize(in.size());
+    transform_vectors(m, in, out, 0, in.size());
+  }
+
+  // Explicit instantiations for Half and BFloat16; see instantiate.h.
+#define VERIFIED_MATH_HALF_ARRAY_TEMPLATES(instantiate, Storage) \
+  instantiate class Vec3HalfArray<Storage>; \
+  instantiate class Vec4HalfArray<Storage>; \
+  instantiate void decode(const Vec3HalfArray<Storage>&, Vec3Array<float>&); \
+  instantiate void decode(const Vec4HalfArray<Storage>&, Vec4Array<float>&); \
+  instantiate void dot(const Vec3HalfArray<Storage>&, const Vec3HalfArray<Storage>&, float*, std::size_t, std::size_t); \
+  instantiate void dot(const Vec3HalfArray<Storage>&, const Vec3HalfArray<Storage>&, float*); \
+  instantiate void dot(const Vec4HalfArray<Storage>&, const Vec4HalfArray<Storage>&, float*, std::size_t, std::size_t); \
+  instantiate void dot(const Vec4HalfArray<Storage>&, const Vec4HalfArray<Storage>&, float*); \
+  instantiate void normalize(const Vec3HalfArray<Storage>&, Vec3HalfArray<Storage>&, std::size_t, std::size_t); \
+  instantiate void normalize(const Vec3HalfArray<Storage>&, Vec3HalfArray<Storage>&); \
+  instantiate void normalize(const Vec3HalfArray<Storage>&, Vec3Array<float>&, std::size_t, std::size_t); \
+  instantiate void normalize(const Vec3HalfArray<Storage>&, Vec3Array<float>&); \
+  instantiate void normalize(const Vec4HalfArray<Storage>&, Vec4HalfArray<Storage>&, std::size_t, std::size_t); \
+  instantiate void normalize(const Vec4HalfArray<Storage>&, Vec4HalfArray<Storage>&); \
+  instantiate void normalize(const Vec4HalfArray<Storage>&, Vec4Array<float>&, std::size_t, std::size_t); \
+  instantiate void normalize(const Vec4HalfArray<Storage>&, Vec4Array<float>&); \
+  instantiate void transform_vectors(const Mat33<float>&, const Vec3HalfArray<Storage>&, Vec3HalfArray<Storage>&, std::size_t, std::size_t); \
+  instantiate void transform_vectors(const Mat33<float>&, const Vec3HalfArray<Storage>&, Vec3HalfArray<Storage>&); \
+  instantiate void transform_vectors(const Mat33<float>&, const Vec3HalfArray<Storage>&, Vec3Array<float>&, std::size_t, std::size_t); \
+  instantiate void transform_vectors(const Mat33<float>&, const Vec3HalfArray<Storage>&, Vec3Array<float>&);
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_HALF_TEMPLATES(VERIFIED_MATH_HALF_ARRAY_TEMPLATES)
+#endif
+
+}
+
+#endif // HALF_ARRAY_H
@@ -0,0 +1,41 @@
+#ifndef INSTANTIATE_H
+#define INSTANTIATE_H
+
+/*
+  Explicit instantiation of the library for float and double.
+
+  Each header lists its types and out-of-line function templates in a
+  macro VERIFIED_MATH_<HEADER>_TEMPLATES(instantiate, Scalar). The
+  libverified_math sources expand the lists with
+  VERIFIED_MATH_DEFINE_TEMPLATES. With VERIFIED_MATH_EXTERN_TEMPLATES
+  defined, which linking the verified_math target does, the headers expand
+  them as extern template declarations. Consumers then call the library's
+  copies instead of compiling their own in every translation unit.
+
+  The lists leave out constexpr and inline functions, which every
+  translation unit instantiates anyway to evaluate or inline them. They
+  also leave out single-value operations such as inverse, which must stay
+  inlinable in the caller's loops. What remains are the batched kernels,
+  the decompositions and the solvers, where a call costs nothing. They
+  are compiled with the library's flags, so build it with the same
+  VERIFIED_MATH_NATIVE / VERIFIED_MATH_NO_SIMD setting as its consumers.
+ */
+#define VERIFIED_MATH_DEFINE_TEMPLATES(list)	\
+  list(template, float)				\
+  list(template, double)
+
+#define VERIFIED_MATH_DECLARE_TEMPLATES(list)	\
+  list(extern template, float)			\
+  list(extern template, double)
+
+// The batched kernels on 16-bit storage (half_array.h), which compute in
+// float, are listed by storage type instead.
+#define VERIFIED_MATH_DEFINE_HALF_TEMPLATES(list)	\
+  list(template, Half)					\
+  list(template, BFloat16)
+
+#define VERIFIED_MATH_DECLARE_HALF_TEMPLATES(list)	\
+  list(extern template, Half)				\
+  list(extern template, BFloat16)
+
+#endif // INSTANTIATE_H
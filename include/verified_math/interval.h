@@ -0,0 +1,229 @@
+#ifndef INTERVAL_H
+#define INTERVAL_H
+
+#include "verified_math/simd.h"
+
+#include <algorithm>
+#include <cfenv>
+#include <limits>
+
+namespace verified_math {
+
+  /*
+    Sets the rounding mode to upward for its lifetime and restores the
+    previous mode on exit. The Interval operations are only correct inside
+    one. Hold one RoundUpward around a whole batch rather than one per
+    operation, since a mode switch costs far more than an interval
+    addition. All other floating-point code in its scope rounds upward too.
+
+    GCC and Clang do not track the rounding mode unless
+    -frounding-math is given. The operations below keep their operands
+    opaque to the optimizer, so they are neither folded at compile time
+    nor moved out of the guarded region.
+   */
+  class RoundUpward {
+  public:
+    RoundUpward() : saved(std::fegetround()) {
+      std::fesetround(FE_UPWARD);
+    }
+
+    ~RoundUpward() {
+      std::fesetround(saved);
+    }
+
+    RoundUpward(const RoundUpward&) = delete;
+    RoundUpward& operator=(const RoundUpward&) = delete;
+
+  private:
+    int saved;
+  };
+
+  namespace detail {
+
+    // An empty asm statement the optimizer cannot see through.
+    template<typename T>
+    inline T opaque(T x) {
+#if defined(__GNUC__) && (defined(__x86_64__) || defined(__i386__)) && defined(__SSE2__)
+      asm volatile("" : "+x"(x));
+      return x;
+#else
+      volatile T v = x;
+      return v;
+#endif
+    }
+
+  }
+
+  /*
+    A closed interval [lo, hi] with outward rounding, for use as the
+    Scalar of Vec3, Vec4, Mat33 and Mat44. det(m) and inverse(m) over
+    interval matrices enclose the exact result for every real matrix
+    inside m. Point matrices (Interval(x) entries) get a guaranteed
+    enclosure of the exact det or inverse of the double matrix.
+
+    The lower bound is stored negated, so every bound rounds upward: lo
+    rounded down is -((-lo) rounded up). Addition is then one addition of
+    the pairs (-lo, hi), and a product is the maximum of four. With SSE2
+    the pair is held in one register.
+
+    Dividing by an interval that contains zero gives (-inf, inf). Products
+    of an unbounded interval with zero are NaN.
+   */
+  template<typename T>
+  class Interval {
+  public:
+    Interval(T x)
+      : neg_lo(-x), up(x) { }
+
+    Interval(T lo, T hi)
+      : neg_lo(-lo), up(hi) { }
+
+    T lo() const { return -neg_lo; }
+    T hi() const { return up; }
+
+    template<typename U>
+    friend Interval<U> operator+(const Interval<U>& a, const Interval<U>& b);
+    template<typename U>
+    friend Interval<U> operator-(const Interval<U>& a, const Interval<U>& b);
+    template<typename U>
+    friend Interval<U> operator-(const Interval<U>& a);
+    template<typename U>
+    friend Interval<U> operator*(const Interval<U>& a, const Interval<U>& b);
+    template<typename U>
+    friend Interval<U> operator/(const Interval<U>& a, const Interval<U>& b);
+
+  private:
+    static Interval<T> negated(T neg_lo, T hi) {
+      Interval<T> r(T(0));
+      r.neg_lo = detail::opaque(neg_lo);
+      r.up = detail::opaque(hi);
+      return r;
+    }
+
+    T neg_lo;
+    T up;
+  };
+
+  /*
+    Every operand goes through detail::opaque: the compiler otherwise
+    rewrites (-x) * y as -(x * y) and x / (-y) as -(x / y), which are only
+    equal under round-to-nearest.
+   */
+  template<typename T>
+  Interval<T> operator+(const Interval<T>& a, const Interval<T>& b) {
+    return Interval<T>::negated(detail::opaque(a.neg_lo) + detail::opaque(b.neg_lo),
+				detail::opaque(a.up) + detail::opaque(b.up));
+  }
+
+  template<typename T>
+  Interval<T> operator-(const Interval<T>& a, const Interval<T>& b) {
+    return Interval<T>::negated(detail::opaque(a.neg_lo) + detail::opaque(b.up),
+				detail::opaque(a.up) + detail::opaque(b.neg_lo));
+  }
+
+  template<typename T>
+  Interval<T> operator-(const Interval<T>& a) {
+    return Interval<T>::negated(a.up, a.neg_lo);
+  }
+
+  template<typename T>
+  Interval<T> operator*(const Interval<T>& a, const Interval<T>& b) {
+    const T na = detail::opaque(a.neg_lo), ah = detail::opaque(a.up);
+    const T nb = detail::opaque(b.neg_lo), bh = detail::opaque(b.up);
+    const T ma = detail::opaque(-na), mh = detail::opaque(-ah);
+    // lo * lo = na * nb, and so on; negating an operand is exact.
+    return Interval<T>::negated(
+      std::max(std::max(ma * nb, na * bh), std::max(ah * nb, mh * bh)),
+      std::max(std::max(na * nb, ma * bh), std::max(mh * nb, ah * bh)));
+  }
+
+  template<typename T>
+  Interval<T> operator/(const Interval<T>& a, const Interval<T>& b) {
+    const T nb = detail::opaque(b.neg_lo), bh = detail::opaque(b.up);
+    if (nb >= T(0) && bh >= T(0)) {
+      const T inf = std::numeric_limits<T>::infinity();
+      return Interval<T>(-inf, inf);
+    }
+    // 1 / b = [1 / hi, 1 / lo], both bounds rounded up as -1 / x.
+    const T m1 = detail::opaque(T(-1));
+    return a * Interval<T>::negated(m1 / bh, m1 / nb);
+  }
+
+#if defined(VERIFIED_MATH_SSE2)
+  /*
+    SSE2 Interval<double>: the register holds (-lo, hi), so addition is
+    one addpd, subtraction an addpd with b's lanes swapped, and a product
+    four mulpd and three maxpd.
+   */
+  template<>
+  class Interval<double> {
+  public:
+    Interval(double x)
+      : v(_mm_set_pd(x, -x)) { }
+
+    Interval(double lo, double hi)
+      : v(_mm_set_pd(hi, -lo)) { }
+
+    double lo() const { return -_mm_cvtsd_f64(v); }
+    double hi() const { return _mm_cvtsd_f64(_mm_unpackhi_pd(v, v)); }
+
+    friend Interval<double> operator+(const Interval<double>& a, const Interval<double>& b) {
+      return Interval<double>(_mm_add_pd(detail::opaque(a.v), b.v));
+    }
+
+    friend Interval<double> operator-(const Interval<double>& a, const Interval<double>& b) {
+      return Interval<double>(_mm_add_pd(detail::opaque(a.v), swap(b.v)));
+    }
+
+    friend Interval<double> operator-(const Interval<double>& a) {
+      return Interval<double>(swap(a.v));
+    }
+
+    friend Interval<double> operator*(const Interval<double>& a, const Interval<double>& b) {
+      const __m128d sign = _mm_set1_pd(-0.0);
+      const __m128d x = detail::opaque(a.v);
+      const __m128d na = _mm_unpacklo_pd(x, x);
+      const __m128d ah = _mm_unpackhi_pd(x, x);
+      const __m128d bs = swap(b.v);
+      // Lane 0 collects the candidates for -lo, lane 1 those for hi.
+      const __m128d m1 = _mm_mul_pd(na, bs);
+      const __m128d m2 = _mm_mul_pd(detail::opaque(_mm_xor_pd(na, sign)), b.v);
+      const __m128d m3 = _mm_mul_pd(ah, b.v);
+      const __m128d m4 = _mm_mul_pd(detail::opaque(_mm_xor_pd(ah, sign)), bs);
+      return Interval<double>(_mm_max_pd(_mm_max_pd(m1, m2), _mm_max_pd(m3, m4)));
+    }
+
+    friend Interval<double> operator/(const Interval<double>& a, const Interval<double>& b) {
+      if (_mm_movemask_pd(_mm_cmpge_pd(b.v, _mm_setzero_pd())) == 3) {
+	const double inf = std::numeric_limits<double>::infinity();
+	return Interval<double>(-inf, inf);
+      }
+      const __m128d m1 = detail::opaque(_mm_set1_pd(-1.0));
+      return a * Interval<double>(_mm_div_pd(m1, swap(b.v)));
+    }
+
+  private:
+    explicit Interval(__m128d x)
+      : v(detail::opaque(x)) { }
+
+    static __m128d swap(__m128d x) {
+      return _mm_shuffle_pd(x, x, 1);
+    }
+
+    __m128d v;
+  };
+#endif // VERIFIED_MATH_SSE2
+
+  template<typename T>
+  bool contains(const Interval<T>& a, T x) {
+    return a.lo() <= x && x <= a.hi();
+  }
+
+  template<typename T>
+  T width(const Interval<T>& a) {
+    return a.hi() - a.lo();
+  }
+
+}
+
+#endif // INTERVAL_H
@@ -0,0 +1,273 @@
+#ifndef MAT_H
+#define MAT_H
+
+#include "verified_math/vec.h"
+#include "verified_math/mat_kernels.h"
+#include "verified_math/mat33.h"
+#include "verified_math/mat44.h"
+#include "verified_math/scalar_math.h"
+
+#include <cmath>
+#include <cstddef>
+
+namespace verified_math {
+
+  /*
+    A fixed-size R x C matrix stored contiguously in row-major order. Like
+    Vec it is an aggregate: Mat<2, 2, double>{1, 2, 3, 4} fills it row by
+    row and Mat<R, C, Scalar>{} is zero.
+
+    The operators are the kernels in mat_kernels.h, which Mat33 and Mat44
+    forward to as well; those keep their named fields, and to_mat, to_mat33
+    and to_mat44 convert between the representations.
+   */
+  template<std::size_t R, std::size_t C, typename Scalar>
+  struct Mat {
+    alignas(detail::StorageAlignment<Scalar, R * C>::value) Scalar data[R * C];
+
+    Scalar& operator()(std::size_t i, std::size_t j) { return data[i * C + j]; }
+    constexpr const Scalar& operator()(std::size_t i, std::size_t j) const { return data[i * C + j]; }
+
+    static constexpr std::size_t rows() { return R; }
+    static constexpr std::size_t cols() { return C; }
+
+    static Mat<R, C, Scalar> identity() {
+      Mat<R, C, Scalar> result = Mat<R, C, Scalar>();
+      auto f = [&](std::size_t k) {
+	result.data[k] = (k / C == k % C) ? Scalar(1) : Scalar(0);
+      };
+      detail::Unroll<0, R * C>::run(f);
+      return result;
+    }
+
+    constexpr Scalar l2_norm() const {
+      return detail::sum_of_squares(*this);
+    }
+  };
+
+  namespace detail {
+
+    template<std::size_t R, std::size_t C, typename Scalar>
+    struct Entries<Mat<R, C, Scalar> > {
+      typedef Scalar scalar;
+      static constexpr std::size_t rows = R;
+      static constexpr std::size_t cols = C;
+
+      static constexpr const Scalar& at(const Mat<R, C, Scalar>& m, std::size_t k) {
+	return m.data[k];
+      }
+    };
+
+  }
+
+  template<std::size_t R, std::size_t C, typename Scalar>
+  constexpr Mat<R, C, Scalar> operator+(const Mat<R, C, Scalar>& m1, const Mat<R, C, Scalar>& m2) {
+    return detail::add(m1, m2);
+  }
+
+  template<std::size_t R, std::size_t C, typename Scalar>
+  constexpr Mat<R, C, Scalar> operator-(const Mat<R, C, Scalar>& m1, const Mat<R, C, Scalar>& m2) {
+    return detail::subtract(m1, m2);
+  }
+
+  template<std::size_t R, std::size_t C, typename Scalar>
+  constexpr Mat<R, C, Scalar> operator*(const Scalar c, const Mat<R, C, Scalar>& m) {
+    return detail::scale_left(c, m);
+  }
+
+  template<std::size_t R, std::size_t C, typename Scalar>
+  constexpr Mat<R, C, Scalar> operator*(const Mat<R, C, Scalar>& m, const Scalar c) {
+    return detail::scale_right(m, c);
+  }
+
+  template<std::size_t R, std::size_t C, typename Scalar>
+  constexpr Vec<R, Scalar> operator*(const Mat<R, C, Scalar>& m, const Vec<C, Scalar>& v) {
+    return detail::multiply<Vec<R, Scalar> >(m, v);
+  }
+
+  // Entry (i, j) accumulates over k in order, like the Mat33/Mat44 products.
+  template<std::size_t R, std::size_t K, std::size_t C, typename Scalar>
+  constexpr Mat<R, C, Scalar> operator*(const Mat<R, K, Scalar>& m1, const Mat<K, C, Scalar>& m2) {
+    return detail::multiply<Mat<R, C, Scalar> >(m1, m2);
+  }
+
+  template<std::size_t R, std::size_t C, typename Scalar>
+  constexpr Mat<C, R, Scalar> transpose(const Mat<R, C, Scalar>& m) {
+    return detail::transposed<Mat<C, R, Scalar> >(m);
+  }
+
+  template<std::size_t N, typename Scalar>
+  constexpr Scalar trace(const Mat<N, N, Scalar>& m) {
+    return detail::trace(m);
+  }
+
+  namespace detail {
+
+    /*
+      Determinant and inverse of square matrices. Sizes 1 to 4 use closed
+      forms; larger sizes use Gaussian elimination with partial pivoting.
+     */
+    template<std::size_t N, typename Scalar>
+    struct Square {
+      static Scalar det(Mat<N, N, Scalar> a) {
+	Scalar result = Scalar(1);
+	for (std::size_t k = 0; k < N; ++k) {
+	  std::size_t p = k;
+	  for (std::size_t i = k + 1; i < N; ++i) {
+	    if (fabs(a.data[i * N + k]) > fabs(a.data[p * N + k])) {
+	      p = i;
+	    }
+	  }
+	  if (a.data[p * N + k] == Scalar(0)) {
+	    return Scalar(0);
+	  }
+	  if (p != k) {
+	    for (std::size_t j = 0; j < N; ++j) {
+	      Scalar t = a.data[k * N + j];
+	      a.data[k * N + j] = a.data[p * N + j];
+	      a.data[p * N + j] = t;
+	    }
+	    result = -result;
+	  }
+	  const Scalar pivot = a.data[k * N + k];
+	  result = result * pivot;
+	  for (std::size_t i = k + 1; i < N; ++i) {
+	    const Scalar l = a.data[i * N + k] / pivot;
+	    for (std::size_t j = k + 1; j < N; ++j) {
+	      a.data[i * N + j] = a.data[i * N + j] - l * a.data[k * N + j];
+	    }
+	  }
+	}
+	return result;
+      }
+
+      // Gauss-Jordan elimination on [a | I].
+      static Mat<N, N, Scalar> inverse(Mat<N, N, Scalar> a) {
+	Mat<N, N, Scalar> inv = Mat<N, N, Scalar>::identity();
+	for (std::size_t k = 0; k < N; ++k) {
+	  std::size_t p = k;
+	  for (std::size_t i = k + 1; i < N; ++i) {
+	    if (fabs(a.data[i * N + k]) > fabs(a.data[p * N + k])) {
+	      p = i;
+	    }
+	  }
+	  if (p != k) {
+	    for (std::size_t j = 0; j < N; ++j) {
+	      Scalar t = a.data[k * N + j];
+	      a.data[k * N + j] = a.data[p * N + j];
+	      a.data[p * N + j] = t;
+	      t = inv.data[k * N + j];
+	      inv.data[k * N + j] = inv.data[p * N + j];
+	      inv.data[p * N + j] = t;
+	    }
+	  }
+	  const Scalar r = Scalar(1) / a.data[k * N + k];
+	  for (std::size_t j = 0; j < N; ++j) {
+	    a.data[k * N + j] = a.data[k * N + j] * r;
+	    inv.data[k * N + j] = inv.data[k * N + j] * r;
+	  }
+	  for (std::size_t i = 0; i < N; ++i) {
+	    if (i == k) {
+	      continue;
+	    }
+	    const Scalar l = a.data[i * N + k];
+	    for (std::size_t j = 0; j < N; ++j) {
+	      a.data[i * N + j] = a.data[i * N + j] - l * a.data[k * N + j];
+	      inv.data[i * N + j] = inv.data[i * N + j] - l * inv.data[k * N + j];
+	    }
+	  }
+	}
+	return inv;
+      }
+    };
+
+    template<typename Scalar>
+    struct Square<1, Scalar> {
+      static Scalar det(const Mat<1, 1, Scalar>& m) {
+	return m.data[0];
+      }
+
+      static Mat<1, 1, Scalar> inverse(const Mat<1, 1, Scalar>& m) {
+	return Mat<1, 1, Scalar>{{Scalar(1) / m.data[0]}};
+      }
+    };
+
+    template<typename Scalar>
+    struct Square<2, Scalar> {
+      static Scalar det(const Mat<2, 2, Scalar>& m) {
+	return m.data[0] * m.data[3] - m.data[1] * m.data[2];
+      }
+
+      static Mat<2, 2, Scalar> inverse(const Mat<2, 2, Scalar>& m) {
+	const Scalar r = Scalar(1) / det(m);
+	return Mat<2, 2, Scalar>{{m.data[3] * r, -m.data[1] * r,
+	      -m.data[2] * r, m.data[0] * r}};
+      }
+    };
+
+    // 3x3 and 4x4: the closed forms that Mat33 and Mat44 use.
+    template<typename Scalar>
+    struct Square<3, Scalar> {
+      static Scalar det(const Mat<3, 3, Scalar>& m) {
+	return det3(m);
+      }
+
+      static Mat<3, 3, Scalar> inverse(const Mat<3, 3, Scalar>& m) {
+	return inverse3(m);
+      }
+    };
+
+    template<typename Scalar>
+    struct Square<4, Scalar> {
+      static Scalar det(const Mat<4, 4, Scalar>& m) {
+	return det4(m);
+      }
+
+      static Mat<4, 4, Scalar> inverse(const Mat<4, 4, Scalar>& m) {
+	return inverse4(m);
+      }
+    };
+
+  }
+
+  template<std::size_t N, typename Scalar>
+  Scalar det(const Mat<N, N, Scalar>& m) {
+    return detail::Square<N, Scalar>::det(m);
+  }
+
+  template<std::size_t N, typename Scalar>
+  Mat<N, N, Scalar> inverse(const Mat<N, N, Scalar>& m) {
+    return detail::Square<N, Scalar>::inverse(m);
+  }
+
+  template<std::size_t N, typename Scalar>
+  Scalar condition_number(const Mat<N, N, Scalar>& m) {
+    return m.l2_norm() * inverse(m).l2_norm();
+  }
+
+  /*
+    Conversions to and from the named-field matrices.
+   */
+  template<typename Scalar>
+  constexpr Mat<3, 3, Scalar> to_mat(const Mat33<Scalar>& m) {
+    return detail::convert<Mat<3, 3, Scalar> >(m);
+  }
+
+  template<typename Scalar>
+  constexpr Mat<4, 4, Scalar> to_mat(const Mat44<Scalar>& m) {
+    return detail::convert<Mat<4, 4, Scalar> >(m);
+  }
+
+  template<typename Scalar>
+  constexpr Mat33<Scalar> to_mat33(const Mat<3, 3, Scalar>& m) {
+    return detail::convert<Mat33<Scalar> >(m);
+  }
+
+  template<typename Scalar>
+  constexpr Mat44<Scalar> to_mat44(const Mat<4, 4, Scalar>& m) {
+    return detail::convert<Mat44<Scalar> >(m);
+  }
+
+}
+
+#endif // MAT_H
@@ -2,11 +2,20 @@
 #define MAT33_H
 
 #include "verified_math/vec3.h"
+#include "verified_math/vec3_array.h"
+#include "verified_math/mat_kernels.h"
+#include "verified_math/scalar_math.h"
+#include "verified_math/instantiate.h"
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
 
 namespace verified_math {
   
   /*
-    A 3x3 matrix.
+    A 3x3 matrix. The operators forward to the kernels in mat_kernels.h,
+    which Mat<3, 3> shares.
    */
   template<typename Scalar>
   class Mat33 {
@@ -15,104 +24,195 @@ namespace verified_math {
     Scalar x21 {0}; Scalar x22 {0}; Scalar x23 {0};
     Scalar x31 {0}; Scalar x32 {0}; Scalar x33 {0};
 
-    Mat33<Scalar> (Scalar _x11, Scalar _x12, Scalar _x13,
+    constexpr Mat33<Scalar> (Scalar _x11, Scalar _x12, Scalar _x13,
 		   Scalar _x21, Scalar _x22, Scalar _x23,
 		   Scalar _x31, Scalar _x32, Scalar _x33) 
     : x11{_x11}, x12{_x12}, x13{_x13},
-      x21{_x21}, x22{_x22}, x23{_x32},
+      x21{_x21}, x22{_x22}, x23{_x23},
       x31{_x31}, x32{_x32}, x33{_x33} { }
 
-      Scalar l2_norm() const {
-	return x11 * x11 + x12 * x12 + x13 * x13 +
-	  x21 * x21 + x22 * x22 + x23 * x23 +
-	  x31 * x31 + x32 * x32 + x33 * x33;
+      constexpr Scalar l2_norm() const {
+	return detail::sum_of_squares(*this);
       }
   };
 
-  template<typename Scalar>
-  Mat33<Scalar> operator+(const Mat33<Scalar>& m1, const Mat33<Scalar>& m2) {
-    return Mat33<Scalar>{
-      m1.x11 + m2.x11, m1.x12 + m2.x12, m1.x13 + m2.x13,
-	m1.x21 + m2.x21, m1.x22 + m2.x22, m1.x23 + m2.x23,
-	m1.x31 + m2.x31, m1.x32 + m2.x32, m1.x33 + m2.x33
+  namespace detail {
+
+    template<typename Scalar>
+    struct Entries<Mat33<Scalar> > {
+      typedef Scalar scalar;
+      static constexpr std::size_t rows = 3;
+      static constexpr std::size_t cols = 3;
+      static constexpr Scalar Mat33<Scalar>::* fields[9] = {
+	&Mat33<Scalar>::x11, &Mat33<Scalar>::x12, &Mat33<Scalar>::x13,
+	&Mat33<Scalar>::x21, &Mat33<Scalar>::x22, &Mat33<Scalar>::x23,
+	&Mat33<Scalar>::x31, &Mat33<Scalar>::x32, &Mat33<Scalar>::x33};
+
+      static constexpr const Scalar& at(const Mat33<Scalar>& m, std::size_t k) {
+	return m.*fields[k];
+      }
     };
+
+    template<typename Scalar>
+    constexpr Scalar Mat33<Scalar>::* Entries<Mat33<Scalar> >::fields[9];
+
   }
 
   template<typename Scalar>
-  Mat33<Scalar> operator-(const Mat33<Scalar>& m1, const Mat33<Scalar>& m2) {
-    return Mat33<Scalar> {
-      m1.x11 - m2.x11, m1.x12 - m2.x12, m1.x13 - m2.x13,
-	m1.x21 - m2.x21, m1.x22 - m2.x22, m1.x23 - m2.x23,
-	m1.x31 - m2.x31, m1.x32 - m2.x32, m1.x33 - m2.x33
-    };
+  constexpr Mat33<Scalar> operator+(const Mat33<Scalar>& m1, const Mat33<Scalar>& m2) {
+    return detail::add(m1, m2);
   }
 
   template<typename Scalar>
-  Mat33<Scalar> operator*(const Scalar c, const Mat33<Scalar> m) {
-    return Mat33<Scalar>{
-      c * m.x11, c * m.x12, c * m.x13,
-	c * m.x21, c * m.x22, c * m.x23,
-	c * m.x31, c * m.x32, c * m.x33
-    };
+  constexpr Mat33<Scalar> operator-(const Mat33<Scalar>& m1, const Mat33<Scalar>& m2) {
+    return detail::subtract(m1, m2);
   }
 
   template<typename Scalar>
-  Mat33<Scalar> operator*(const Mat33<Scalar> m, const Scalar c) {
-    return Mat33<Scalar>{
-      m.x11 * c, m.x12 * c, m.x13 * c,
-	m.x21 * c, m.x22 * c, m.x23 * c,
-	m.x31 * c, m.x32 * c, m.x33 * c
-    };
+  constexpr Mat33<Scalar> operator*(const Scalar c, const Mat33<Scalar> m) {
+    return detail::scale_left(c, m);
   }
 
   template<typename Scalar>
-  Vec3<Scalar> operator*(const Mat33<Scalar>& m, const Vec3<Scalar>& v) { 
-    return Vec3<Scalar> {
-      m.x11 * v.x1 + m.x12 * v.x2 + m.x13 * v.x3,
-	m.x21 * v.x1 + m.x22 * v.x2 + m.x23 * v.x3,
-	m.x31 * v.x1 + m.x32 * v.x2 + m.x33 * v.x3
-    };
+  constexpr Mat33<Scalar> operator*(const Mat33<Scalar> m, const Scalar c) {
+    return detail::scale_right(m, c);
   }
 
   template<typename Scalar>
-  Mat33<Scalar> operator*(const Mat33<Scalar>& m1, const Mat33<Scalar>& m2) {
-    return Mat33<Scalar> { m1.x11 * m2.x11 + m1.x12 * m2.x21 + m1.x13 * m2.x31,
-			  m1.x11 * m2.x12 + m1.x12 * m2.x22 + m1.x13 * m2.x32,
-			  m1.x11 * m2.x13 + m1.x12 * m2.x23 + m1.x13 * m2.x33,
-			  
-			  m1.x21 * m2.x11 + m1.x22 * m2.x21 + m1.x23 * m2.x31,
-			  m1.x21 * m2.x12 + m1.x22 * m2.x22 + m1.x23 * m2.x32,
-			  m1.x21 * m2.x13 + m1.x22 * m2.x23 + m1.x23 * m2.x33,
-			  
-			  m1.x31 * m2.x11 + m1.x32 * m2.x21 + m1.x33 * m2.x31,
-			  m1.x31 * m2.x12 + m1.x32 * m2.x22 + m1.x33 * m2.x32,
-			  m1.x31 * m2.x13 + m1.x32 * m2.x23 + m1.x33 * m2.x33
-    };
+  constexpr Vec3<Scalar> operator*(const Mat33<Scalar>& m, const Vec3<Scalar>& v) {
+    return detail::multiply<Vec3<Scalar> >(m, v);
   }
 
+  /*
+    Batched transforms: out[i] = m * in[i]. The matrix entries are loaded
+    once and kept in locals for the whole loop. out may alias in.
+   */
   template<typename Scalar>
-  Mat33<Scalar> transpose(const Mat33<Scalar>& m) {
-    return Mat33<Scalar> {
-      m.x11, m.x21, m.x31,
-	m.x12, m.x22, m.x32,
-	m.x13, m.x23, m.x33
-    };
+  void transform_vectors(const Mat33<Scalar>& m, const Vec3<Scalar>* in,
+			 Vec3<Scalar>* out, std::size_t n) {
+    const Scalar m11 = m.x11, m12 = m.x12, m13 = m.x13;
+    const Scalar m21 = m.x21, m22 = m.x22, m23 = m.x23;
+    const Scalar m31 = m.x31, m32 = m.x32, m33 = m.x33;
+    for (std::size_t i = 0; i < n; ++i) {
+      const Scalar v1 = in[i].x1, v2 = in[i].x2, v3 = in[i].x3;
+      out[i] = Vec3<Scalar>{
+	m11 * v1 + m12 * v2 + m13 * v3,
+	m21 * v1 + m22 * v2 + m23 * v3,
+	m31 * v1 + m32 * v2 + m33 * v3
+      };
+    }
+  }
+
+  // SoA over the entries [begin, end); out must already hold in.size() vectors.
+  template<typename Scalar>
+  void transform_vectors(const Mat33<Scalar>& m, const Vec3Array<Scalar>& in,
+			 Vec3Array<Scalar>& out, std::size_t begin, std::size_t end) {
+    const Scalar m11 = m.x11, m12 = m.x12, m13 = m.x13;
+    const Scalar m21 = m.x21, m22 = m.x22, m23 = m.x23;
+    const Scalar m31 = m.x31, m32 = m.x32, m33 = m.x33;
+    const Scalar* a1 = in.x1.data(); const Scalar* a2 = in.x2.data(); const Scalar* a3 = in.x3.data();
+    Scalar* o1 = out.x1.data(); Scalar* o2 = out.x2.data(); Scalar* o3 = out.x3.data();
+    for (std::size_t i = begin; i < end; ++i) {
+      const Scalar v1 = a1[i], v2 = a2[i], v3 = a3[i];
+      o1[i] = m11 * v1 + m12 * v2 + m13 * v3;
+      o2[i] = m21 * v1 + m22 * v2 + m23 * v3;
+      o3[i] = m31 * v1 + m32 * v2 + m33 * v3;
+    }
+  }
+
+  template<typename Scalar>
+  void transform_vectors(const Mat33<Scalar>& m, const Vec3Array<Scalar>& in,
+			 Vec3Array<Scalar>& out) {
+    out.resize(in.size());
+    transform_vectors(m, in, out, 0, in.size());
   }
 
   template<typename Scalar>
-  Scalar det(const Mat33<Scalar>& m) {
-    return m.x11 * (m.x22 * m.x33 - m.x23 * m.x32) +
-      m.x12 * (m.x23 * m.x31 - m.x21 * m.x33) +
-      m.x13 * (m.x21 * m.x32 - m.x31 * m.x22);
+  constexpr Mat33<Scalar> operator*(const Mat33<Scalar>& m1, const Mat33<Scalar>& m2) {
+    return detail::multiply<Mat33<Scalar> >(m1, m2);
+  }
+
+  template<typename Scalar>
+  constexpr Mat33<Scalar> transpose(const Mat33<Scalar>& m) {
+    return detail::transposed<Mat33<Scalar> >(m);
+  }
+
+  template<typename Scalar>
+  constexpr Scalar det(const Mat33<Scalar>& m) {
+    return detail::det3(m);
+  }
+
+  // transpose of the cofactor matrix, so that m * adjugate(m) = det(m) I
+  template<typename Scalar>
+  constexpr Mat33<Scalar> adjugate(const Mat33<Scalar>& m) {
+    return detail::adjugate3(m);
   }
 
   template<typename Scalar>
   Mat33<Scalar> inverse(const Mat33<Scalar>& m) {
-    return (1.0 / det(m)) * Mat33<Scalar>{
-      (m.x22 * m.x33 - m.x23 * m.x32), -(m.x12 * m.x33 - m.x13 * m.x32), (m.x12 * m.x23 - m.x13 * m.x22),
-	-(m.x21 * m.x33 - m.x23 * m.x31), (m.x11 * m.x33 - m.x13 * m.x31), -(m.x11 * m.x23 - m.x13 * m.x21),
-	(m.x21 * m.x32 - m.x22 * m.x31), -(m.x11 * m.x32 - m.x12 * m.x31), (m.x11 * m.x22 - m.x12 * 21)
-    };
+    return detail::inverse3(m);
+  }
+
+  /*
+    The result of try_inverse. When ok is false the inverse is zero and the
+    condition estimate is infinite.
+   */
+  template<typename Matrix, typename Scalar>
+  struct InverseResult {
+    Matrix inverse;
+    Scalar det;
+    Scalar condition_estimate;
+    bool ok;
+  };
+
+  /*
+    Inverse, determinant and Frobenius condition number |m| |m^-1| from a
+    single adjugate. The matrix is rejected (ok = false) when
+    |det| <= tol * |r1| |r2| |r3|, where ri are the rows, as in the batched
+    det_inverse, and the same power-of-two row scaling keeps the test
+    finite across the exponent range of float and double; no division by
+    a zero determinant happens. Note that condition_number returns the
+    square of the Frobenius condition number.
+   */
+  template<typename Scalar>
+  InverseResult<Mat33<Scalar>, Scalar> try_inverse(const Mat33<Scalar>& m,
+						   Scalar tol = 64 * std::numeric_limits<Scalar>::epsilon()) {
+    // The test and the adjugate are evaluated on the rows scaled by
+    // powers of two, as in the batched det_inverse.
+    const Scalar s1 = detail::row_scale(m.x11, m.x12, m.x13);
+    const Scalar s2 = detail::row_scale(m.x21, m.x22, m.x23);
+    const Scalar s3 = detail::row_scale(m.x31, m.x32, m.x33);
+    const Mat33<Scalar> ms{
+      s1 * m.x11, s1 * m.x12, s1 * m.x13,
+	s2 * m.x21, s2 * m.x22, s2 * m.x23,
+	s3 * m.x31, s3 * m.x32, s3 * m.x33};
+    const Mat33<Scalar> adj = adjugate(ms);
+    const Scalar ds = ms.x11 * adj.x11 + ms.x12 * adj.x21 + ms.x13 * adj.x31;
+    const Scalar d = ((ds * detail::binade_scale(s1)) * detail::binade_scale(s2)) * detail::binade_scale(s3);
+
+    const Scalar r1 = ms.x11 * ms.x11 + ms.x12 * ms.x12 + ms.x13 * ms.x13;
+    const Scalar r2 = ms.x21 * ms.x21 + ms.x22 * ms.x22 + ms.x23 * ms.x23;
+    const Scalar r3 = ms.x31 * ms.x31 + ms.x32 * ms.x32 + ms.x33 * ms.x33;
+    if (!(ds * ds > tol * tol * (r1 * r2 * r3))) {
+      const Scalar z(0);
+      return InverseResult<Mat33<Scalar>, Scalar>{
+	Mat33<Scalar>{z, z, z, z, z, z, z, z, z}, d,
+	  std::numeric_limits<Scalar>::infinity(), false};
+    }
+
+    // inverse(S m) = inverse(m) inverse(S), so column k picks up sk.
+    const Scalar inv_d = Scalar(1) / ds;
+    const Scalar inv_d1 = inv_d * s1, inv_d2 = inv_d * s2, inv_d3 = inv_d * s3;
+    const Mat33<Scalar> inv{
+      adj.x11 * inv_d1, adj.x12 * inv_d2, adj.x13 * inv_d3,
+	adj.x21 * inv_d1, adj.x22 * inv_d2, adj.x23 * inv_d3,
+	adj.x31 * inv_d1, adj.x32 * inv_d2, adj.x33 * inv_d3};
+
+    // |m| |m^-1| = |g m| |(g m)^-1| for g the scale of the largest row.
+    const Scalar g12 = s1 < s2 ? s1 : s2;
+    const Scalar g = g12 < s3 ? g12 : s3;
+    return InverseResult<Mat33<Scalar>, Scalar>{
+      inv, d, sqrt((g * m).l2_norm() * (detail::binade_scale(g) * inv).l2_norm()), true};
   }
 
   template<typename Scalar>
@@ -124,10 +224,21 @@ namespace verified_math {
   }
 
   template<typename Scalar>
-  Scalar trace(const Mat33<Scalar>& m) {
-    return m.x11 + m.x22 + m.x33;
+  constexpr Scalar trace(const Mat33<Scalar>& m) {
+    return detail::trace(m);
   }
 
+  // Explicit instantiations for float and double; see instantiate.h.
+#define VERIFIED_MATH_MAT33_TEMPLATES(instantiate, Scalar) \
+  instantiate class Mat33<Scalar>; \
+  instantiate void transform_vectors(const Mat33<Scalar>&, const Vec3<Scalar>*, Vec3<Scalar>*, std::size_t); \
+  instantiate void transform_vectors(const Mat33<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&, std::size_t, std::size_t); \
+  instantiate void transform_vectors(const Mat33<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&);
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_MAT33_TEMPLATES)
+#endif
+
 }
 
 #endif // MAT33_H
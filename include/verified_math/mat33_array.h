@@ -0,0 +1,199 @@
+#ifndef MAT33_ARRAY_H
+#define MAT33_ARRAY_H
+
+#include "verified_math/mat33.h"
+#include "verified_math/aligned_allocator.h"
+#include "verified_math/instantiate.h"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace verified_math {
+
+  /*
+    A structure-of-arrays container of 3x3 matrices. Each entry is stored
+    in its own contiguous, aligned lane, so batched kernels vectorize
+    across matrices.
+   */
+  template<typename Scalar>
+  class Mat33Array {
+  public:
+    typedef std::vector<Scalar, aligned_allocator<Scalar> > Lane;
+
+    Lane x11;
+    Lane x12;
+    Lane x13;
+    Lane x21;
+    Lane x22;
+    Lane x23;
+    Lane x31;
+    Lane x32;
+    Lane x33;
+
+    Mat33Array() { }
+
+    explicit Mat33Array(std::size_t n)
+      : x11(n), x12(n), x13(n), x21(n), x22(n), x23(n), x31(n), x32(n), x33(n) { }
+
+    Mat33Array(const Mat33<Scalar>* m, std::size_t n)
+      : x11(n), x12(n), x13(n), x21(n), x22(n), x23(n), x31(n), x32(n), x33(n) {
+      for (std::size_t i = 0; i < n; ++i) {
+	set(i, m[i]);
+      }
+    }
+
+    std::size_t size() const {
+      return x11.size();
+    }
+
+    void resize(std::size_t n) {
+      x11.resize(n);
+      x12.resize(n);
+      x13.resize(n);
+      x21.resize(n);
+      x22.resize(n);
+      x23.resize(n);
+      x31.resize(n);
+      x32.resize(n);
+      x33.resize(n);
+    }
+
+    void push_back(const Mat33<Scalar>& m) {
+      x11.push_back(m.x11);
+      x12.push_back(m.x12);
+      x13.push_back(m.x13);
+      x21.push_back(m.x21);
+      x22.push_back(m.x22);
+      x23.push_back(m.x23);
+      x31.push_back(m.x31);
+      x32.push_back(m.x32);
+      x33.push_back(m.x33);
+    }
+
+    // Element i as a Mat33, for interop with the single-matrix API.
+    Mat33<Scalar> operator[](std::size_t i) const {
+      return Mat33<Scalar>{
+	x11[i], x12[i], x13[i],
+	x21[i], x22[i], x23[i],
+	x31[i], x32[i], x33[i]
+      };
+    }
+
+    void set(std::size_t i, const Mat33<Scalar>& m) {
+      x11[i] = m.x11;
+      x12[i] = m.x12;
+      x13[i] = m.x13;
+      x21[i] = m.x21;
+      x22[i] = m.x22;
+      x23[i] = m.x23;
+      x31[i] = m.x31;
+      x32[i] = m.x32;
+      x33[i] = m.x33;
+    }
+  };
+
+  /*
+    Batched determinant and inverse over the entries [begin, end).
+
+    The cofactors are computed once and shared between det and the
+    adjugate. An entry is flagged singular (ok[i] = 0, inverse set to zero)
+    when |det| <= tol * |r1| |r2| |r3|, where ri are the rows. That ratio is
+    1 for orthogonal matrices and 0 for singular ones, so it doubles as a
+    cheap, scale-invariant conditioning test, and no division by a zero
+    determinant ever happens. The test is evaluated on the matrix with
+    each float or double row scaled by a power of two (detail::row_scale),
+    so it neither overflows nor underflows for well-conditioned input
+    anywhere in the exponent range. inv must already hold m.size()
+    matrices.
+   */
+  template<typename Scalar>
+  void det_inverse(const Mat33Array<Scalar>& m, Scalar* det, Mat33Array<Scalar>& inv,
+		   unsigned char* ok, Scalar tol, std::size_t begin, std::size_t end) {
+    const Scalar* a11 = m.x11.data(); const Scalar* a12 = m.x12.data(); const Scalar* a13 = m.x13.data();
+    const Scalar* a21 = m.x21.data(); const Scalar* a22 = m.x22.data(); const Scalar* a23 = m.x23.data();
+    const Scalar* a31 = m.x31.data(); const Scalar* a32 = m.x32.data(); const Scalar* a33 = m.x33.data();
+    Scalar* b11 = inv.x11.data(); Scalar* b12 = inv.x12.data(); Scalar* b13 = inv.x13.data();
+    Scalar* b21 = inv.x21.data(); Scalar* b22 = inv.x22.data(); Scalar* b23 = inv.x23.data();
+    Scalar* b31 = inv.x31.data(); Scalar* b32 = inv.x32.data(); Scalar* b33 = inv.x33.data();
+    const Scalar tol2 = tol * tol;
+
+    for (std::size_t i = begin; i < end; ++i) {
+      // Each row is scaled by a power of two, exactly; see row_scale.
+      const Scalar s1 = detail::row_scale(a11[i], a12[i], a13[i]);
+      const Scalar s2 = detail::row_scale(a21[i], a22[i], a23[i]);
+      const Scalar s3 = detail::row_scale(a31[i], a32[i], a33[i]);
+      const Scalar m11 = s1 * a11[i], m12 = s1 * a12[i], m13 = s1 * a13[i];
+      const Scalar m21 = s2 * a21[i], m22 = s2 * a22[i], m23 = s2 * a23[i];
+      const Scalar m31 = s3 * a31[i], m32 = s3 * a32[i], m33 = s3 * a33[i];
+
+      // First column of the adjugate, shared with the determinant.
+      const Scalar c11 = m22 * m33 - m23 * m32;
+      const Scalar c21 = m23 * m31 - m21 * m33;
+      const Scalar c31 = m21 * m32 - m22 * m31;
+      const Scalar d = m11 * c11 + m12 * c21 + m13 * c31;
+
+      const Scalar r1 = m11 * m11 + m12 * m12 + m13 * m13;
+      const Scalar r2 = m21 * m21 + m22 * m22 + m23 * m23;
+      const Scalar r3 = m31 * m31 + m32 * m32 + m33 * m33;
+      const bool good = d * d > tol2 * (r1 * r2 * r3);
+      const Scalar inv_d = good ? Scalar(1) / (good ? d : Scalar(1)) : Scalar(0);
+
+      // inverse(S m) = inverse(m) inverse(S), so column k picks up sk.
+      const Scalar inv_d1 = inv_d * s1, inv_d2 = inv_d * s2, inv_d3 = inv_d * s3;
+
+      det[i] = ((d * detail::binade_scale(s1)) * detail::binade_scale(s2)) * detail::binade_scale(s3);
+      ok[i] = good ? 1 : 0;
+      b11[i] = c11 * inv_d1;
+      b12[i] = (m13 * m32 - m12 * m33) * inv_d2;
+      b13[i] = (m12 * m23 - m13 * m22) * inv_d3;
+      b21[i] = c21 * inv_d1;
+      b22[i] = (m11 * m33 - m13 * m31) * inv_d2;
+      b23[i] = (m13 * m21 - m11 * m23) * inv_d3;
+      b31[i] = c31 * inv_d1;
+      b32[i] = (m12 * m31 - m11 * m32) * inv_d2;
+      b33[i] = (m11 * m22 - m12 * m21) * inv_d3;
+    }
+  }
+
+  // Whole-array form; inv is resized, det and ok must hold m.size() entries.
+  template<typename Scalar>
+  void det_inverse(const Mat33Array<Scalar>& m, Scalar* det, Mat33Array<Scalar>& inv,
+		   unsigned char* ok, Scalar tol = 64 * std::numeric_limits<Scalar>::epsilon()) {
+    inv.resize(m.size());
+    det_inverse(m, det, inv, ok, tol, 0, m.size());
+  }
+
+  // Batched determinants of the entries [begin, end).
+  template<typename Scalar>
+  void det(const Mat33Array<Scalar>& m, Scalar* out, std::size_t begin, std::size_t end) {
+    const Scalar* a11 = m.x11.data(); const Scalar* a12 = m.x12.data(); const Scalar* a13 = m.x13.data();
+    const Scalar* a21 = m.x21.data(); const Scalar* a22 = m.x22.data(); const Scalar* a23 = m.x23.data();
+    const Scalar* a31 = m.x31.data(); const Scalar* a32 = m.x32.data(); const Scalar* a33 = m.x33.data();
+    for (std::size_t i = begin; i < end; ++i) {
+      out[i] = a11[i] * (a22[i] * a33[i] - a23[i] * a32[i]) +
+	a12[i] * (a23[i] * a31[i] - a21[i] * a33[i]) +
+	a13[i] * (a21[i] * a32[i] - a31[i] * a22[i]);
+    }
+  }
+
+  template<typename Scalar>
+  void det(const Mat33Array<Scalar>& m, Scalar* out) {
+    det(m, out, 0, m.size());
+  }
+
+  // Explicit instantiations for float and double; see instantiate.h.
+#define VERIFIED_MATH_MAT33_ARRAY_TEMPLATES(instantiate, Scalar) \
+  instantiate class Mat33Array<Scalar>; \
+  instantiate void det_inverse(const Mat33Array<Scalar>&, Scalar*, Mat33Array<Scalar>&, unsigned char*, Scalar, std::size_t, std::size_t); \
+  instantiate void det_inverse(const Mat33Array<Scalar>&, Scalar*, Mat33Array<Scalar>&, unsigned char*, Scalar); \
+  instantiate void det(const Mat33Array<Scalar>&, Scalar*, std::size_t, std::size_t); \
+  instantiate void det(const Mat33Array<Scalar>&, Scalar*);
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_MAT33_ARRAY_TEMPLATES)
+#endif
+
+}
+
+#endif // MAT33_ARRAY_H
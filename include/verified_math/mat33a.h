@@ -0,0 +1,161 @@
+#ifndef MAT33A_H
+#define MAT33A_H
+
+#include "verified_math/vec3a.h"
+#include "verified_math/mat33.h"
+#include "verified_math/simd.h"
+#include "verified_math/instantiate.h"
+
+#include <cstddef>
+
+namespace verified_math {
+
+  /*
+    A 3x3 matrix with each row padded to four lanes, aligned like Vec3A.
+    Every row starts on a 16-byte (float) or 32-byte (double) boundary, so
+    no row straddles a cache line and rows load with aligned SIMD loads.
+    The pad lanes are zero.
+
+    Convert to and from Mat33 with the explicit constructor and to_mat33;
+    the rest of the math API is on Mat33.
+   */
+  template<typename Scalar>
+  class alignas(4 * sizeof(Scalar)) Mat33A {
+  public:
+    Scalar x11 {0}; Scalar x12 {0}; Scalar x13 {0}; Scalar pad1 {0};
+    Scalar x21 {0}; Scalar x22 {0}; Scalar x23 {0}; Scalar pad2 {0};
+    Scalar x31 {0}; Scalar x32 {0}; Scalar x33 {0}; Scalar pad3 {0};
+
+    constexpr Mat33A<Scalar> (Scalar _x11, Scalar _x12, Scalar _x13,
+			      Scalar _x21, Scalar _x22, Scalar _x23,
+			      Scalar _x31, Scalar _x32, Scalar _x33)
+      : x11{_x11}, x12{_x12}, x13{_x13}, pad1{0},
+	x21{_x21}, x22{_x22}, x23{_x23}, pad2{0},
+	x31{_x31}, x32{_x32}, x33{_x33}, pad3{0} { }
+
+    constexpr explicit Mat33A<Scalar> (const Mat33<Scalar>& m)
+      : x11{m.x11}, x12{m.x12}, x13{m.x13}, pad1{0},
+	x21{m.x21}, x22{m.x22}, x23{m.x23}, pad2{0},
+	x31{m.x31}, x32{m.x32}, x33{m.x33}, pad3{0} { }
+  };
+
+  template<typename Scalar>
+  constexpr Mat33<Scalar> to_mat33(const Mat33A<Scalar>& m) {
+    return Mat33<Scalar>{
+      m.x11, m.x12, m.x13,
+	m.x21, m.x22, m.x23,
+	m.x31, m.x32, m.x33
+    };
+  }
+
+  template<typename Scalar>
+  constexpr Vec3A<Scalar> operator*(const Mat33A<Scalar>& m, const Vec3A<Scalar>& v) {
+    return Vec3A<Scalar> {
+      m.x11 * v.x1 + m.x12 * v.x2 + m.x13 * v.x3,
+	m.x21 * v.x1 + m.x22 * v.x2 + m.x23 * v.x3,
+	m.x31 * v.x1 + m.x32 * v.x2 + m.x33 * v.x3
+    };
+  }
+
+  template<typename Scalar>
+  constexpr Mat33A<Scalar> operator*(const Mat33A<Scalar>& m1, const Mat33A<Scalar>& m2) {
+    return Mat33A<Scalar> { m1.x11 * m2.x11 + m1.x12 * m2.x21 + m1.x13 * m2.x31,
+			    m1.x11 * m2.x12 + m1.x12 * m2.x22 + m1.x13 * m2.x32,
+			    m1.x11 * m2.x13 + m1.x12 * m2.x23 + m1.x13 * m2.x33,
+
+			    m1.x21 * m2.x11 + m1.x22 * m2.x21 + m1.x23 * m2.x31,
+			    m1.x21 * m2.x12 + m1.x22 * m2.x22 + m1.x23 * m2.x32,
+			    m1.x21 * m2.x13 + m1.x22 * m2.x23 + m1.x23 * m2.x33,
+
+			    m1.x31 * m2.x11 + m1.x32 * m2.x21 + m1.x33 * m2.x31,
+			    m1.x31 * m2.x12 + m1.x32 * m2.x22 + m1.x33 * m2.x32,
+			    m1.x31 * m2.x13 + m1.x32 * m2.x23 + m1.x33 * m2.x33 };
+  }
+
+  /*
+    Batched transform: out[i] = m * in[i]. out may alias in.
+   */
+  template<typename Scalar>
+  void transform_vectors(const Mat33A<Scalar>& m, const Vec3A<Scalar>* in,
+			 Vec3A<Scalar>* out, std::size_t n) {
+    const Scalar m11 = m.x11, m12 = m.x12, m13 = m.x13;
+    const Scalar m21 = m.x21, m22 = m.x22, m23 = m.x23;
+    const Scalar m31 = m.x31, m32 = m.x32, m33 = m.x33;
+    for (std::size_t i = 0; i < n; ++i) {
+      const Scalar v1 = in[i].x1, v2 = in[i].x2, v3 = in[i].x3;
+      out[i] = Vec3A<Scalar>{
+	m11 * v1 + m12 * v2 + m13 * v3,
+	m21 * v1 + m22 * v2 + m23 * v3,
+	m31 * v1 + m32 * v2 + m33 * v3
+      };
+    }
+  }
+
+#if defined(VERIFIED_MATH_SSE2)
+  /*
+    SSE overloads for float. Every row and vector is one aligned load; the
+    zero pad lanes stay zero. Like the Mat44 overloads they are not
+    constexpr, and the terms are summed in the same order as the templates.
+   */
+  inline Vec3A<float> operator*(const Mat33A<float>& m, const Vec3A<float>& v) {
+    const __m128 x = _mm_load_ps(&v.x1);
+    __m128 p1 = _mm_mul_ps(_mm_load_ps(&m.x11), x);
+    __m128 p2 = _mm_mul_ps(_mm_load_ps(&m.x21), x);
+    __m128 p3 = _mm_mul_ps(_mm_load_ps(&m.x31), x);
+    __m128 p4 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(p1, p2, p3, p4);
+
+    Vec3A<float> result = v;
+    _mm_store_ps(&result.x1, _mm_add_ps(_mm_add_ps(_mm_add_ps(p1, p2), p3), p4));
+    return result;
+  }
+
+  inline Mat33A<float> operator*(const Mat33A<float>& m1, const Mat33A<float>& m2) {
+    const __m128 b1 = _mm_load_ps(&m2.x11);
+    const __m128 b2 = _mm_load_ps(&m2.x21);
+    const __m128 b3 = _mm_load_ps(&m2.x31);
+    const float* a = &m1.x11;
+
+    Mat33A<float> result = m1;
+    float* r = &result.x11;
+    for (int i = 0; i < 12; i += 4) {
+      __m128 row = _mm_mul_ps(_mm_set1_ps(a[i]), b1);
+      row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i + 1]), b2));
+      row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i + 2]), b3));
+      _mm_store_ps(r + i, row);
+    }
+    return result;
+  }
+
+  // The columns of m are formed once; each vector is then three
+  // broadcasts, three multiplies, two adds and one aligned store.
+  inline void transform_vectors(const Mat33A<float>& m, const Vec3A<float>* in,
+				Vec3A<float>* out, std::size_t n) {
+    __m128 c1 = _mm_load_ps(&m.x11);
+    __m128 c2 = _mm_load_ps(&m.x21);
+    __m128 c3 = _mm_load_ps(&m.x31);
+    __m128 c4 = _mm_setzero_ps();
+    _MM_TRANSPOSE4_PS(c1, c2, c3, c4);
+
+    for (std::size_t i = 0; i < n; ++i) {
+      const __m128 v = _mm_load_ps(&in[i].x1);
+      __m128 r = _mm_mul_ps(c1, _mm_shuffle_ps(v, v, _MM_SHUFFLE(0, 0, 0, 0)));
+      r = _mm_add_ps(r, _mm_mul_ps(c2, _mm_shuffle_ps(v, v, _MM_SHUFFLE(1, 1, 1, 1))));
+      r = _mm_add_ps(r, _mm_mul_ps(c3, _mm_shuffle_ps(v, v, _MM_SHUFFLE(2, 2, 2, 2))));
+      _mm_store_ps(&out[i].x1, r);
+    }
+  }
+#endif // VERIFIED_MATH_SSE2
+
+  // Explicit instantiations for float and double; see instantiate.h.
+#define VERIFIED_MATH_MAT33A_TEMPLATES(instantiate, Scalar) \
+  instantiate class Mat33A<Scalar>; \
+  instantiate void transform_vectors(const Mat33A<Scalar>&, const Vec3A<Scalar>*, Vec3A<Scalar>*, std::size_t);
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_MAT33A_TEMPLATES)
+#endif
+
+}
+
+#endif // MAT33A_H
@@ -2,12 +2,21 @@
 #define MAT44_H
 
 #include "verified_math/vec4.h"
+#include "verified_math/vec4_array.h"
 #include "verified_math/mat33.h"
+#include "verified_math/simd.h"
+#include "verified_math/scalar_math.h"
+#include "verified_math/instantiate.h"
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
 
 namespace verified_math {
 
   /*
-    A 4x4 matrix.
+    A 4x4 matrix. The operators forward to the kernels in mat_kernels.h,
+    which Mat<4, 4> shares.
    */
   template<typename Scalar>
   class Mat44 {
@@ -17,7 +26,7 @@ namespace verified_math {
     Scalar x31{0}; Scalar x32{0}; Scalar x33{0}; Scalar x34{0};
     Scalar x41{0}; Scalar x42{0}; Scalar x43{0}; Scalar x44{0};
 
-    Mat44<Scalar> (Scalar _x11, Scalar _x12, Scalar _x13, Scalar _x14,
+    constexpr Mat44<Scalar> (Scalar _x11, Scalar _x12, Scalar _x13, Scalar _x14,
 		   Scalar _x21, Scalar _x22, Scalar _x23, Scalar _x24,
 		   Scalar _x31, Scalar _x32, Scalar _x33, Scalar _x34,
 		   Scalar _x41, Scalar _x42, Scalar _x43, Scalar _x44)
@@ -26,147 +35,499 @@ namespace verified_math {
         x31{_x31}, x32{_x32}, x33{_x33}, x34{_x34},
         x41{_x41}, x42{_x42}, x43{_x43}, x44{_x44} { }
 
-	Scalar l2_norm() const {
-	  return x11 * x11 + x12 * x12 + x13 * x13 + x14 * x14 +
-	    x21 * x21 + x22 * x22 + x23 * x23 + x24 * x24 +
-	    x31 * x31 + x32 * x32 + x33 * x33 + x34 * x34 +
-	    x41 * x41 + x42 * x42 + x43 * x43 + x44 * x44;
+	constexpr Scalar l2_norm() const {
+	  return detail::sum_of_squares(*this);
 	}
   };
 
-  template<typename Scalar>
-  Mat44<Scalar> operator+(const Mat44<Scalar>& m1, const Mat44<Scalar>& m2) {
-    return Mat44<Scalar>{
-      m1.x11 + m2.x11, m1.x12 + m2.x12, m1.x13 + m2.x13, m1.x14 + m2.x14,
-	m1.x21 + m2.x21, m1.x22 + m2.x22, m1.x23 + m2.x23, m1.x24 + m2.x24,
-	m1.x31 + m2.x31, m1.x32 + m2.x32, m1.x33 + m2.x33, m1.x34 + m2.x34,
-	m1.x41 + m2.x41, m1.x42 + m2.x42, m1.x43 + m2.x43, m1.x44 + m2.x44
+  namespace detail {
+
+    template<typename Scalar>
+    struct Entries<Mat44<Scalar> > {
+      typedef Scalar scalar;
+      static constexpr std::size_t rows = 4;
+      static constexpr std::size_t cols = 4;
+      static constexpr Scalar Mat44<Scalar>::* fields[16] = {
+	&Mat44<Scalar>::x11, &Mat44<Scalar>::x12, &Mat44<Scalar>::x13, &Mat44<Scalar>::x14,
+	&Mat44<Scalar>::x21, &Mat44<Scalar>::x22, &Mat44<Scalar>::x23, &Mat44<Scalar>::x24,
+	&Mat44<Scalar>::x31, &Mat44<Scalar>::x32, &Mat44<Scalar>::x33, &Mat44<Scalar>::x34,
+	&Mat44<Scalar>::x41, &Mat44<Scalar>::x42, &Mat44<Scalar>::x43, &Mat44<Scalar>::x44};
+
+      static constexpr const Scalar& at(const Mat44<Scalar>& m, std::size_t k) {
+	return m.*fields[k];
+      }
     };
+
+    template<typename Scalar>
+    constexpr Scalar Mat44<Scalar>::* Entries<Mat44<Scalar> >::fields[16];
+
   }
 
   template<typename Scalar>
-  Mat44<Scalar> operator-(const Mat44<Scalar>& m1, const Mat44<Scalar>& m2) {
-    return Mat44<Scalar> {
-      m1.x11 - m2.x11, m1.x12 - m2.x12, m1.x13 - m2.x13, m1.x14- m2.x14,
-	m1.x21 - m2.x21, m1.x22 - m2.x22, m1.x23 - m2.x23, m1.x24 - m2.x24,
-	m1.x31 - m2.x31, m1.x32 - m2.x32, m1.x33 - m2.x33, m1.x34 - m2.x34,
-	m1.x41 - m2.x41, m1.x42 - m2.x42, m1.x43 - m2.x43, m1.x44 - m2.x44
-    };
+  constexpr Mat44<Scalar> operator+(const Mat44<Scalar>& m1, const Mat44<Scalar>& m2) {
+    return detail::add(m1, m2);
   }
 
   template<typename Scalar>
-  Mat44<Scalar> operator*(const Scalar c, const Mat44<Scalar> m) {
-    return Mat44<Scalar>{
-      c * m.x11, c * m.x12, c * m.x13, c * m.x14,
-	c * m.x21, c * m.x22, c * m.x23, c * m.x24,
-	c * m.x31, c * m.x32, c * m.x33, c * m.x34,
-	c * m.x41, c * m.x42, c * m.x43, c * m.x44
-     };
+  constexpr Mat44<Scalar> operator-(const Mat44<Scalar>& m1, const Mat44<Scalar>& m2) {
+    return detail::subtract(m1, m2);
   }
 
   template<typename Scalar>
-  Mat44<Scalar> operator*(const Mat44<Scalar> m, const Scalar c) {
-    return Mat44<Scalar>{
-      m.x11 * c, m.x12 * c, m.x13 * c, m.x14 * c,
-	m.x21 * c, m.x22 * c, m.x23 * c, m.x24 * c,
-	m.x31 * c, m.x32 * c, m.x33 * c, m.x34 * c,
-	m.x41 * c, m.x42 * c, m.x43 * c, m.x44 * c
-    };
+  constexpr Mat44<Scalar> operator*(const Scalar c, const Mat44<Scalar> m) {
+    return detail::scale_left(c, m);
   }
 
   template<typename Scalar>
-  Vec4<Scalar> operator*(const Mat44<Scalar>& m, const Vec4<Scalar>& v) { 
-    return Vec4<Scalar> {
-      m.x11 * v.x1 + m.x12 * v.x2 + m.x13 * v.x3 + m.x14 * v.x4,
-	m.x21 * v.x1 + m.x22 * v.x2 + m.x23 * v.x3 + m.x24 * v.x4,
-	m.x31 * v.x1 + m.x32 * v.x2 + m.x33 * v.x3 + m.x34 * v.x4,
-	m.x41 * v.x1 + m.x42 * v.x2 + m.x43 * v.x3 + m.x44 * v.x4
-    };
+  constexpr Mat44<Scalar> operator*(const Mat44<Scalar> m, const Scalar c) {
+    return detail::scale_right(m, c);
   }
 
-    template<typename Scalar>
-  Mat44<Scalar> operator*(const Mat44<Scalar>& m1, const Mat44<Scalar>& m2) {
-    return Mat44<Scalar> {m1.x11 * m2.x11 + m1.x12 * m2.x21 + m1.x13 * m2.x31 + m1.x14 * m2.x41,
-			  m1.x11 * m2.x12 + m1.x12 * m2.x22 + m1.x13 * m2.x32 + m1.x14 * m2.x42,
-			  m1.x11 * m2.x13 + m1.x12 * m2.x23 + m1.x13 * m2.x33 + m1.x14 * m2.x43,
-                          m1.x11 * m2.x14 + m1.x12 * m2.x24 + m1.x13 * m2.x34 + m1.x14 * m2.x44,
-			  
-			  m1.x21 * m2.x11 + m1.x22 * m2.x21 + m1.x23 * m2.x31 + m1.x24 * m2.x41,
-			  m1.x21 * m2.x12 + m1.x22 * m2.x22 + m1.x23 * m2.x32 + m1.x24 * m2.x42,
-			  m1.x21 * m2.x13 + m1.x22 * m2.x23 + m1.x23 * m2.x33 + m1.x24 * m2.x43,
-			  m1.x21 * m2.x14 + m1.x22 * m2.x24 + m1.x23 * m2.x34 + m1.x24 * m2.x44,
-			  
-			  m1.x31 * m2.x11 + m1.x32 * m2.x21 + m1.x33 * m2.x31 + m1.x34 * m2.x41,
-			  m1.x31 * m2.x12 + m1.x32 * m2.x22 + m1.x33 * m2.x32 + m1.x34 * m2.x42,
-                          m1.x31 * m2.x13 + m1.x32 * m2.x23 + m1.x33 * m2.x33 + m1.x34 * m2.x43,
-	                  m1.x31 * m2.x14 + m1.x32 * m2.x24 + m1.x33 * m2.x34 + m1.x34 * m2.x44,
-
-			  m1.x41 * m2.x11 + m1.x42 * m2.x21 + m1.x43 * m2.x31 + m1.x44 * m2.x41,
-			  m1.x41 * m2.x12 + m1.x42 * m2.x22 + m1.x43 * m2.x32 + m1.x44 * m2.x42,
-                          m1.x41 * m2.x13 + m1.x42 * m2.x23 + m1.x43 * m2.x33 + m1.x44 * m2.x43,
-	                  m1.x41 * m2.x14 + m1.x42 * m2.x24 + m1.x43 * m2.x34 + m1.x44 * m2.x44
-    };
+  template<typename Scalar>
+  constexpr Vec4<Scalar> operator*(const Mat44<Scalar>& m, const Vec4<Scalar>& v) {
+    return detail::multiply<Vec4<Scalar> >(m, v);
   }
 
+  /*
+    Batched transforms. The matrix entries are loaded once and kept in
+    locals for the whole loop, and out may alias in.
+
+    transform_vectors computes out[i] = m * in[i] for homogeneous 4-vectors.
+    transform_points maps 3-D points (implicit w = 1) through m and divides
+    by the resulting w. transform_points_affine assumes the last row of m is
+    0 0 0 1, skips it and the divide.
+   */
   template<typename Scalar>
-  Mat44<Scalar> transpose(const Mat44<Scalar>& m) {
-    return Mat44<Scalar> {
-        m.x11, m.x21, m.x31, m.x41,
-	m.x12, m.x22, m.x32, m.x42,
-	m.x13, m.x23, m.x33, m.x43,
-	m.x14, m.x24, m.x34, m.x44
-    };
+  void transform_vectors(const Mat44<Scalar>& m, const Vec4<Scalar>* in,
+			 Vec4<Scalar>* out, std::size_t n) {
+    const Scalar m11 = m.x11, m12 = m.x12, m13 = m.x13, m14 = m.x14;
+    const Scalar m21 = m.x21, m22 = m.x22, m23 = m.x23, m24 = m.x24;
+    const Scalar m31 = m.x31, m32 = m.x32, m33 = m.x33, m34 = m.x34;
+    const Scalar m41 = m.x41, m42 = m.x42, m43 = m.x43, m44 = m.x44;
+    for (std::size_t i = 0; i < n; ++i) {
+      const Scalar v1 = in[i].x1, v2 = in[i].x2, v3 = in[i].x3, v4 = in[i].x4;
+      out[i] = Vec4<Scalar>{
+	m11 * v1 + m12 * v2 + m13 * v3 + m14 * v4,
+	m21 * v1 + m22 * v2 + m23 * v3 + m24 * v4,
+	m31 * v1 + m32 * v2 + m33 * v3 + m34 * v4,
+	m41 * v1 + m42 * v2 + m43 * v3 + m44 * v4
+      };
+    }
   }
 
+  // SoA over the entries [begin, end); out must already hold in.size() vectors.
+  template<typename Scalar>
+  void transform_vectors(const Mat44<Scalar>& m, const Vec4Array<Scalar>& in,
+			 Vec4Array<Scalar>& out, std::size_t begin, std::size_t end) {
+    const Scalar m11 = m.x11, m12 = m.x12, m13 = m.x13, m14 = m.x14;
+    const Scalar m21 = m.x21, m22 = m.x22, m23 = m.x23, m24 = m.x24;
+    const Scalar m31 = m.x31, m32 = m.x32, m33 = m.x33, m34 = m.x34;
+    const Scalar m41 = m.x41, m42 = m.x42, m43 = m.x43, m44 = m.x44;
+    const Scalar* a1 = in.x1.data(); const Scalar* a2 = in.x2.data();
+    const Scalar* a3 = in.x3.data(); const Scalar* a4 = in.x4.data();
+    Scalar* o1 = out.x1.data(); Scalar* o2 = out.x2.data();
+    Scalar* o3 = out.x3.data(); Scalar* o4 = out.x4.data();
+    for (std::size_t i = begin; i < end; ++i) {
+      const Scalar v1 = a1[i], v2 = a2[i], v3 = a3[i], v4 = a4[i];
+      o1[i] = m11 * v1 + m12 * v2 + m13 * v3 + m14 * v4;
+      o2[i] = m21 * v1 + m22 * v2 + m23 * v3 + m24 * v4;
+      o3[i] = m31 * v1 + m32 * v2 + m33 * v3 + m34 * v4;
+      o4[i] = m41 * v1 + m42 * v2 + m43 * v3 + m44 * v4;
+    }
+  }
 
   template<typename Scalar>
-  Scalar det(const Mat44<Scalar>& m) {
+  void transform_vectors(const Mat44<Scalar>& m, const Vec4Array<Scalar>& in,
+			 Vec4Array<Scalar>& out) {
+    out.resize(in.size());
+    transform_vectors(m, in, out, 0, in.size());
+  }
 
-    auto m1 = Mat33<Scalar>{ m.x22, m.x23, m.x24,
-			     m.x32, m.x33, m.x34,
-			     m.x42, m.x43, m.x44};
+  template<typename Scalar>
+  void transform_points(const Mat44<Scalar>& m, const Vec3<Scalar>* in,
+			Vec3<Scalar>* out, std::size_t n) {
+    const Scalar m11 = m.x11, m12 = m.x12, m13 = m.x13, m14 = m.x14;
+    const Scalar m21 = m.x21, m22 = m.x22, m23 = m.x23, m24 = m.x24;
+    const Scalar m31 = m.x31, m32 = m.x32, m33 = m.x33, m34 = m.x34;
+    const Scalar m41 = m.x41, m42 = m.x42, m43 = m.x43, m44 = m.x44;
+    for (std::size_t i = 0; i < n; ++i) {
+      const Scalar v1 = in[i].x1, v2 = in[i].x2, v3 = in[i].x3;
+      const Scalar inv_w = Scalar(1) / (m41 * v1 + m42 * v2 + m43 * v3 + m44);
+      out[i] = Vec3<Scalar>{
+	(m11 * v1 + m12 * v2 + m13 * v3 + m14) * inv_w,
+	(m21 * v1 + m22 * v2 + m23 * v3 + m24) * inv_w,
+	(m31 * v1 + m32 * v2 + m33 * v3 + m34) * inv_w
+      };
+    }
+  }
 
-    auto m2 = Mat33<Scalar>{ m.x21, m.x23, m.x24,
-			     m.x31, m.x33, m.x34,
-			     m.x41, m.x43, m.x44};
+  template<typename Scalar>
+  void transform_points(const Mat44<Scalar>& m, const Vec3Array<Scalar>& in,
+			Vec3Array<Scalar>& out) {
+    const std::size_t n = in.size();
+    out.resize(n);
+    const Scalar m11 = m.x11, m12 = m.x12, m13 = m.x13, m14 = m.x14;
+    const Scalar m21 = m.x21, m22 = m.x22, m23 = m.x23, m24 = m.x24;
+    const Scalar m31 = m.x31, m32 = m.x32, m33 = m.x33, m34 = m.x34;
+    const Scalar m41 = m.x41, m42 = m.x42, m43 = m.x43, m44 = m.x44;
+    const Scalar* a1 = in.x1.data(); const Scalar* a2 = in.x2.data(); const Scalar* a3 = in.x3.data();
+    Scalar* o1 = out.x1.data(); Scalar* o2 = out.x2.data(); Scalar* o3 = out.x3.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      const Scalar v1 = a1[i], v2 = a2[i], v3 = a3[i];
+      const Scalar inv_w = Scalar(1) / (m41 * v1 + m42 * v2 + m43 * v3 + m44);
+      o1[i] = (m11 * v1 + m12 * v2 + m13 * v3 + m14) * inv_w;
+      o2[i] = (m21 * v1 + m22 * v2 + m23 * v3 + m24) * inv_w;
+      o3[i] = (m31 * v1 + m32 * v2 + m33 * v3 + m34) * inv_w;
+    }
+  }
 
-    auto m3 = Mat33<Scalar>{ m.x21, m.x22, m.x24,
-			     m.x31, m.x32, m.x34,
-			     m.x41, m.x42, m.x44};
+  template<typename Scalar>
+  void transform_points_affine(const Mat44<Scalar>& m, const Vec3<Scalar>* in,
+			       Vec3<Scalar>* out, std::size_t n) {
+    const Scalar m11 = m.x11, m12 = m.x12, m13 = m.x13, m14 = m.x14;
+    const Scalar m21 = m.x21, m22 = m.x22, m23 = m.x23, m24 = m.x24;
+    const Scalar m31 = m.x31, m32 = m.x32, m33 = m.x33, m34 = m.x34;
+    for (std::size_t i = 0; i < n; ++i) {
+      const Scalar v1 = in[i].x1, v2 = in[i].x2, v3 = in[i].x3;
+      out[i] = Vec3<Scalar>{
+	m11 * v1 + m12 * v2 + m13 * v3 + m14,
+	m21 * v1 + m22 * v2 + m23 * v3 + m24,
+	m31 * v1 + m32 * v2 + m33 * v3 + m34
+      };
+    }
+  }
 
-    auto m4 = Mat33<Scalar>{ m.x21, m.x22, m.x23,
-			     m.x31, m.x32, m.x33,
-			     m.x41, m.x42, m.x43};
+  template<typename Scalar>
+  void transform_points_affine(const Mat44<Scalar>& m, const Vec3Array<Scalar>& in,
+			       Vec3Array<Scalar>& out) {
+    const std::size_t n = in.size();
+    out.resize(n);
+    const Scalar m11 = m.x11, m12 = m.x12, m13 = m.x13, m14 = m.x14;
+    const Scalar m21 = m.x21, m22 = m.x22, m23 = m.x23, m24 = m.x24;
+    const Scalar m31 = m.x31, m32 = m.x32, m33 = m.x33, m34 = m.x34;
+    const Scalar* a1 = in.x1.data(); const Scalar* a2 = in.x2.data(); const Scalar* a3 = in.x3.data();
+    Scalar* o1 = out.x1.data(); Scalar* o2 = out.x2.data(); Scalar* o3 = out.x3.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      const Scalar v1 = a1[i], v2 = a2[i], v3 = a3[i];
+      o1[i] = m11 * v1 + m12 * v2 + m13 * v3 + m14;
+      o2[i] = m21 * v1 + m22 * v2 + m23 * v3 + m24;
+      o3[i] = m31 * v1 + m32 * v2 + m33 * v3 + m34;
+    }
+  }
 
-    auto det = m.x11 * verified_math::det(m1) -
-      m.x12 * verified_math::det(m2) +
-      m.x13 * verified_math::det(m3) -
-      m.x14 * verified_math::det(m4);
-    
-    return det;
+  /*
+    The matrix product as a constexpr template for every Scalar, the kernel
+    Mat<4, 4> uses too. operator* forwards to it, and so do the SIMD
+    overloads below in constant expressions.
+   */
+  template<typename Scalar>
+  constexpr Mat44<Scalar> product(const Mat44<Scalar>& m1, const Mat44<Scalar>& m2) {
+    return detail::multiply<Mat44<Scalar> >(m1, m2);
+  }
+
+  template<typename Scalar>
+  constexpr Mat44<Scalar> operator*(const Mat44<Scalar>& m1, const Mat44<Scalar>& m2) {
+    return product(m1, m2);
+  }
+
+#if defined(VERIFIED_MATH_SSE2)
+  /*
+    SIMD specializations of the matrix product.
+
+    Row i of m1 * m2 is accumulated as m1.xi1 * row1(m2) + m1.xi2 * row2(m2)
+    + m1.xi3 * row3(m2) + m1.xi4 * row4(m2), in that order, which is the same
+    evaluation order as the scalar template above. Without FMA the results
+    are therefore bit-for-bit identical to the scalar path. With FMA
+    (VERIFIED_MATH_FMA) the last three terms are fused, so each entry may
+    differ from the scalar result by the rounding of those products, i.e. a
+    few ULP of the largest term.
+
+    The rows are loaded directly from the sixteen fields, which are laid out
+    contiguously in row-major order. Where the compiler can detect constant
+    evaluation (VERIFIED_MATH_HAS_IS_CONSTANT_EVALUATED) the overloads are
+    constexpr and use product() at compile time; otherwise call product()
+    directly in constant expressions.
+   */
+  static_assert(sizeof(Mat44<float>) == 16 * sizeof(float),
+		"Mat44<float> must be 16 packed floats");
+  static_assert(sizeof(Mat44<double>) == 16 * sizeof(double),
+		"Mat44<double> must be 16 packed doubles");
+
+  namespace detail {
+
+    inline Mat44<float> simd_product(const Mat44<float>& m1, const Mat44<float>& m2) {
+      const float* a = &m1.x11;
+      const float* b = &m2.x11;
+      Mat44<float> result = m1;
+      float* r = &result.x11;
+
+#if defined(VERIFIED_MATH_AVX)
+      // Two output rows per iteration, one in each 128-bit half.
+      __m256 b1 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b));
+      __m256 b2 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 4));
+      __m256 b3 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 8));
+      __m256 b4 = _mm256_broadcast_ps(reinterpret_cast<const __m128*>(b + 12));
+
+      for (int i = 0; i < 16; i += 8) {
+	__m256 a1 = _mm256_set_m128(_mm_set1_ps(a[i + 4]), _mm_set1_ps(a[i]));
+	__m256 a2 = _mm256_set_m128(_mm_set1_ps(a[i + 5]), _mm_set1_ps(a[i + 1]));
+	__m256 a3 = _mm256_set_m128(_mm_set1_ps(a[i + 6]), _mm_set1_ps(a[i + 2]));
+	__m256 a4 = _mm256_set_m128(_mm_set1_ps(a[i + 7]), _mm_set1_ps(a[i + 3]));
+
+	__m256 row = _mm256_mul_ps(a1, b1);
+#if defined(VERIFIED_MATH_FMA)
+	row = _mm256_fmadd_ps(a2, b2, row);
+	row = _mm256_fmadd_ps(a3, b3, row);
+	row = _mm256_fmadd_ps(a4, b4, row);
+#else
+	row = _mm256_add_ps(row, _mm256_mul_ps(a2, b2));
+	row = _mm256_add_ps(row, _mm256_mul_ps(a3, b3));
+	row = _mm256_add_ps(row, _mm256_mul_ps(a4, b4));
+#endif
+	_mm256_storeu_ps(r + i, row);
+      }
+#else
+      __m128 b1 = _mm_loadu_ps(b);
+      __m128 b2 = _mm_loadu_ps(b + 4);
+      __m128 b3 = _mm_loadu_ps(b + 8);
+      __m128 b4 = _mm_loadu_ps(b + 12);
+
+      for (int i = 0; i < 16; i += 4) {
+	__m128 row = _mm_mul_ps(_mm_set1_ps(a[i]), b1);
+	row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i + 1]), b2));
+	row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i + 2]), b3));
+	row = _mm_add_ps(row, _mm_mul_ps(_mm_set1_ps(a[i + 3]), b4));
+	_mm_storeu_ps(r + i, row);
+      }
+#endif
+      return result;
+    }
+
+    inline Mat44<double> simd_product(const Mat44<double>& m1, const Mat44<double>& m2) {
+      const double* a = &m1.x11;
+      const double* b = &m2.x11;
+      Mat44<double> result = m1;
+      double* r = &result.x11;
+
+#if defined(VERIFIED_MATH_AVX)
+      __m256d b1 = _mm256_loadu_pd(b);
+      __m256d b2 = _mm256_loadu_pd(b + 4);
+      __m256d b3 = _mm256_loadu_pd(b + 8);
+      __m256d b4 = _mm256_loadu_pd(b + 12);
+
+      for (int i = 0; i < 16; i += 4) {
+	__m256d row = _mm256_mul_pd(_mm256_set1_pd(a[i]), b1);
+#if defined(VERIFIED_MATH_FMA)
+	row = _mm256_fmadd_pd(_mm256_set1_pd(a[i + 1]), b2, row);
+	row = _mm256_fmadd_pd(_mm256_set1_pd(a[i + 2]), b3, row);
+	row = _mm256_fmadd_pd(_mm256_set1_pd(a[i + 3]), b4, row);
+#else
+	row = _mm256_add_pd(row, _mm256_mul_pd(_mm256_set1_pd(a[i + 1]), b2));
+	row = _mm256_add_pd(row, _mm256_mul_pd(_mm256_set1_pd(a[i + 2]), b3));
+	row = _mm256_add_pd(row, _mm256_mul_pd(_mm256_set1_pd(a[i + 3]), b4));
+#endif
+	_mm256_storeu_pd(r + i, row);
+      }
+#else
+      // SSE2 only: each row is handled as two halves of two doubles.
+      for (int half = 0; half < 4; half += 2) {
+	__m128d b1 = _mm_loadu_pd(b + half);
+	__m128d b2 = _mm_loadu_pd(b + 4 + half);
+	__m128d b3 = _mm_loadu_pd(b + 8 + half);
+	__m128d b4 = _mm_loadu_pd(b + 12 + half);
+
+	for (int i = 0; i < 16; i += 4) {
+	  __m128d row = _mm_mul_pd(_mm_set1_pd(a[i]), b1);
+	  row = _mm_add_pd(row, _mm_mul_pd(_mm_set1_pd(a[i + 1]), b2));
+	  row = _mm_add_pd(row, _mm_mul_pd(_mm_set1_pd(a[i + 2]), b3));
+	  row = _mm_add_pd(row, _mm_mul_pd(_mm_set1_pd(a[i + 3]), b4));
+	  _mm_storeu_pd(r + i + half, row);
+	}
+      }
+#endif
+      return result;
+    }
+
+  }
+
+#if defined(VERIFIED_MATH_HAS_IS_CONSTANT_EVALUATED)
+  constexpr Mat44<float> operator*(const Mat44<float>& m1, const Mat44<float>& m2) {
+    return __builtin_is_constant_evaluated() ? product(m1, m2) : detail::simd_product(m1, m2);
+  }
+
+  constexpr Mat44<double> operator*(const Mat44<double>& m1, const Mat44<double>& m2) {
+    return __builtin_is_constant_evaluated() ? product(m1, m2) : detail::simd_product(m1, m2);
+  }
+#else
+  inline Mat44<float> operator*(const Mat44<float>& m1, const Mat44<float>& m2) {
+    return detail::simd_product(m1, m2);
+  }
+
+  inline Mat44<double> operator*(const Mat44<double>& m1, const Mat44<double>& m2) {
+    return detail::simd_product(m1, m2);
+  }
+#endif
+#endif // VERIFIED_MATH_SSE2
+
+  template<typename Scalar>
+  constexpr Mat44<Scalar> transpose(const Mat44<Scalar>& m) {
+    return detail::transposed<Mat44<Scalar> >(m);
+  }
+
+
+  // Laplace expansion by complementary 2x2 minors; see mat_kernels.h.
+  template<typename Scalar>
+  constexpr Scalar det(const Mat44<Scalar>& m) {
+    return detail::det4(m);
+  }
+
+  // Transpose of the cofactor matrix, so that m * adjugate(m) = det(m) I.
+  template<typename Scalar>
+  Mat44<Scalar> adjugate(const Mat44<Scalar>& m) {
+    return detail::adjugate4(m);
   }
 
   template<typename Scalar>
   Mat44<Scalar> inverse(const Mat44<Scalar>& m) {
-    // TODO fixme
-    return (1.0 / det(m)) * Mat44<Scalar>{
-      m.x22 * m.x33 * m.x44 + m.x23 * m.x34 * m.x42 + m.x24 * m.x32 * m.x43 - m.x22 * m.x34 * m.x43 - m.x23 * m.x32 * m.x44 - m.x24 * m.x33 * m.x42,
-	m.x12 * m.x34 * m.x43 + m.x13 * m.x32 * m.x44 + m.x14 * m.x33 * m.x42 - m.x12 * m.x33 * m.x44 - m.x13 * m.x34 * m.x42 - m.x14 * m.x32 * m.x43,
-	m.x12 * m.x23 * m.x44 + m.x13 *m.x24 *m.x42 + m.x14 *m.x22 *m.x43 - m.x12 *m.x33 *m.x44 - m.x13 *m.x22 *m.x44 - m.x14 *m.x23 *m.x42,
-	m.x12 *m.x24 *m.x33 + m.x13 *m.x22 *m.x34 + m.x14 *m.x23 *m.x32 - m.x12 *m.x23 *m.x34 - m.x13 *m.x24 *m.x32 - m.x14 *m.x22 *m.x33,
-	m.x21 *m.x34 *m.x43 + m.x23 *m.x31 *m.x44 + m.x24 *m.x33 *m.x41 - m.x21 *m.x33 *m.x44 - m.x23 *m.x34 *m.x41 - m.x24 *m.x31 *m.x43,
-	m.x11 *m.x33 *m.x44 + m.x13 *m.x34 *m.x41 + m.x14 *m.x31 *m.x43 - m.x11 *m.x34 *m.x43 - m.x13 *m.x31 *m.x44 - m.x14 *m.x33 *m.x41,
-	m.x11 *m.x24 *m.x43 + m.x13 *m.x21 *m.x44 + m.x14 *m.x23 *m.x41 - m.x11 *m.x23 *m.x44 - m.x13 * m.x24 *m.x41 - m.x14 *m.x21 * m.x43,
-	m.x11 *m.x23 *m.x34 + m.x13 *m.x24 *m.x31 + m.x14 *m.x21 *m.x33 - m.x11 *m.x24*m.x33 - m.x13 *m.x21 *m.x34 - m.x14 *m.x23 *m.x31,
-	m.x21 *m.x32 * m.x44 + m.x22 *m.x34 * m.x41 + m.x24 *m.x31 *m.x42 - m.x21 *m.x34 *m.x42 - m.x22 *m.x31 *m.x44 - m.x24 *m.x32 *m.x41,
-        m.x11 *m.x34 *m.x42 + m.x12 *m.x31 *m.x44 + m.x14 *m.x32 *m.x41 - m.x11 *m.x32 *m.x44 - m.x12 *m.x34 *m.x41 - m.x14 *m.x31 *m.x42,
-	m.x11 *m.x22 *m.x44 + m.x12 *m.x24 *m.x41 + m.x14 *m.x21 *m.x42 - m.x11 *m.x24 *m.x42 - m.x12 *m.x21 *m.x44 - m.x14 *m.x22 *m.x41,
-	m.x11 *m.x24 *m.x32 + m.x12 *m.x21 *m.x34 + m.x14 *m.x22 *m.x31 - m.x11 *m.x22 *m.x34 - m.x12 *m.x24 *m.x31 - m.x14 *m.x21 *m.x32,
-	m.x21 *m.x33 *m.x42 + m.x22 *m.x31 *m.x43 + m.x23 *m.x32 *m.x41 - m.x21 *m.x32 *m.x43 - m.x22 *m.x33 *m.x41 - m.x23 *m.x31 *m.x42,
-	m.x11 *m.x32 *m.x43 + m.x12 *m.x33 *m.x41 + m.x13 *m.x31 *m.x42 - m.x11 *m.x33 *m.x42 - m.x12 *m.x31 *m.x43 - m.x13 *m.x32 *m.x41,
-	m.x11 *m.x23 *m.x42 + m.x12 *m.x21 *m.x43 + m.x13 *m.x22 *m.x41 - m.x11 *m.x22 *m.x43 - m.x12 *m.x23 *m.x41 - m.x13 *m.x21 *m.x42,
-	m.x11 *m.x22 *m.x33 + m.x12 * m.x23 *m.x41 + m.x13 *m.x21 *m.x32 - m.x11 *m.x23 *m.x32 - m.x12 *m.x21 *m.x33 - m.x13 *m.x22 *m.x31
-    };
+    return detail::inverse4(m);
+  }
+
+#if defined(VERIFIED_MATH_SSE2)
+  /*
+    SSE inverse for float by 2x2 blocks. With m = [A B; C D] in 2x2 blocks
+    (each held in one register as a row-major 2x2 matrix) and # the 2x2
+    adjugate,
+
+      det(m) = |A||D| + |B||C| - tr((A# B)(D# C))
+
+    and the blocks of the adjugate follow from the same products, so the
+    whole inverse is a few dozen vector operations. It is not constexpr;
+    call inverse<float> explicitly for the scalar template.
+   */
+  namespace detail {
+
+    // Row-major 2x2 matrix products on one register each.
+    inline __m128 mat2_mul(__m128 a, __m128 b) {
+      return _mm_add_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(3, 0, 3, 0))),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+				   _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+    }
+
+    // a# b
+    inline __m128 mat2_adj_mul(__m128 a, __m128 b) {
+      return _mm_sub_ps(_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(0, 0, 3, 3)), b),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 2, 1, 1)),
+				   _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 0, 3, 2))));
+    }
+
+    // a b#
+    inline __m128 mat2_mul_adj(__m128 a, __m128 b) {
+      return _mm_sub_ps(_mm_mul_ps(a, _mm_shuffle_ps(b, b, _MM_SHUFFLE(0, 3, 0, 3))),
+			_mm_mul_ps(_mm_shuffle_ps(a, a, _MM_SHUFFLE(2, 3, 0, 1)),
+				   _mm_shuffle_ps(b, b, _MM_SHUFFLE(1, 2, 1, 2))));
+    }
+
+  }
+
+  inline Mat44<float> inverse(const Mat44<float>& m) {
+    const float* p = &m.x11;
+    const __m128 r1 = _mm_loadu_ps(p);
+    const __m128 r2 = _mm_loadu_ps(p + 4);
+    const __m128 r3 = _mm_loadu_ps(p + 8);
+    const __m128 r4 = _mm_loadu_ps(p + 12);
+
+    const __m128 a = _mm_movelh_ps(r1, r2);
+    const __m128 b = _mm_movehl_ps(r2, r1);
+    const __m128 c = _mm_movelh_ps(r3, r4);
+    const __m128 d = _mm_movehl_ps(r4, r3);
+
+    // |A|, |B|, |C|, |D|
+    const __m128 dets = _mm_sub_ps(
+      _mm_mul_ps(_mm_shuffle_ps(r1, r3, _MM_SHUFFLE(2, 0, 2, 0)),
+		 _mm_shuffle_ps(r2, r4, _MM_SHUFFLE(3, 1, 3, 1))),
+      _mm_mul_ps(_mm_shuffle_ps(r1, r3, _MM_SHUFFLE(3, 1, 3, 1)),
+		 _mm_shuffle_ps(r2, r4, _MM_SHUFFLE(2, 0, 2, 0))));
+    const __m128 det_a = _mm_shuffle_ps(dets, dets, _MM_SHUFFLE(0, 0, 0, 0));
+    const __m128 det_b = _mm_shuffle_ps(dets, dets, _MM_SHUFFLE(1, 1, 1, 1));
+    const __m128 det_c = _mm_shuffle_ps(dets, dets, _MM_SHUFFLE(2, 2, 2, 2));
+    const __m128 det_d = _mm_shuffle_ps(dets, dets, _MM_SHUFFLE(3, 3, 3, 3));
+
+    const __m128 dc = detail::mat2_adj_mul(d, c);
+    const __m128 ab = detail::mat2_adj_mul(a, b);
+
+    __m128 x = _mm_sub_ps(_mm_mul_ps(det_d, a), detail::mat2_mul(b, dc));
+    __m128 w = _mm_sub_ps(_mm_mul_ps(det_a, d), detail::mat2_mul(c, ab));
+    __m128 y = _mm_sub_ps(_mm_mul_ps(det_b, c), detail::mat2_mul_adj(d, ab));
+    __m128 z = _mm_sub_ps(_mm_mul_ps(det_c, b), detail::mat2_mul_adj(a, dc));
+
+    // tr((A# B)(D# C)), summed across the register without SSE3.
+    __m128 tr = _mm_mul_ps(ab, _mm_shuffle_ps(dc, dc, _MM_SHUFFLE(3, 1, 2, 0)));
+    tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(2, 3, 0, 1)));
+    tr = _mm_add_ps(tr, _mm_shuffle_ps(tr, tr, _MM_SHUFFLE(1, 0, 3, 2)));
+
+    const __m128 det = _mm_sub_ps(_mm_add_ps(_mm_mul_ps(det_a, det_d), _mm_mul_ps(det_b, det_c)), tr);
+    const __m128 inv_det = _mm_div_ps(_mm_setr_ps(1.0f, -1.0f, -1.0f, 1.0f), det);
+
+    x = _mm_mul_ps(x, inv_det);
+    y = _mm_mul_ps(y, inv_det);
+    z = _mm_mul_ps(z, inv_det);
+    w = _mm_mul_ps(w, inv_det);
+
+    Mat44<float> result = m;
+    float* r = &result.x11;
+    _mm_storeu_ps(r, _mm_shuffle_ps(x, y, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(r + 4, _mm_shuffle_ps(x, y, _MM_SHUFFLE(0, 2, 0, 2)));
+    _mm_storeu_ps(r + 8, _mm_shuffle_ps(z, w, _MM_SHUFFLE(1, 3, 1, 3)));
+    _mm_storeu_ps(r + 12, _mm_shuffle_ps(z, w, _MM_SHUFFLE(0, 2, 0, 2)));
+    return result;
+  }
+#endif // VERIFIED_MATH_SSE2
+
+  /*
+    Inverse, determinant and Frobenius condition number from a single
+    adjugate, with the same rejection test and row scaling as
+    try_inverse(Mat33): ok = false when |det| <= tol * |r1| |r2| |r3| |r4|.
+   */
+  template<typename Scalar>
+  InverseResult<Mat44<Scalar>, Scalar> try_inverse(const Mat44<Scalar>& m,
+						   Scalar tol = 64 * std::numeric_limits<Scalar>::epsilon()) {
+    const Scalar s1 = detail::row_scale(m.x11, m.x12, m.x13, m.x14);
+    const Scalar s2 = detail::row_scale(m.x21, m.x22, m.x23, m.x24);
+    const Scalar s3 = detail::row_scale(m.x31, m.x32, m.x33, m.x34);
+    const Scalar s4 = detail::row_scale(m.x41, m.x42, m.x43, m.x44);
+    const Mat44<Scalar> ms{
+      s1 * m.x11, s1 * m.x12, s1 * m.x13, s1 * m.x14,
+	s2 * m.x21, s2 * m.x22, s2 * m.x23, s2 * m.x24,
+	s3 * m.x31, s3 * m.x32, s3 * m.x33, s3 * m.x34,
+	s4 * m.x41, s4 * m.x42, s4 * m.x43, s4 * m.x44};
+    const Mat44<Scalar> adj = adjugate(ms);
+    const Scalar ds = ms.x11 * adj.x11 + ms.x12 * adj.x21 + ms.x13 * adj.x31 + ms.x14 * adj.x41;
+    const Scalar d = (((ds * detail::binade_scale(s1)) * detail::binade_scale(s2))
+		      * detail::binade_scale(s3)) * detail::binade_scale(s4);
+
+    const Scalar r1 = ms.x11 * ms.x11 + ms.x12 * ms.x12 + ms.x13 * ms.x13 + ms.x14 * ms.x14;
+    const Scalar r2 = ms.x21 * ms.x21 + ms.x22 * ms.x22 + ms.x23 * ms.x23 + ms.x24 * ms.x24;
+    const Scalar r3 = ms.x31 * ms.x31 + ms.x32 * ms.x32 + ms.x33 * ms.x33 + ms.x34 * ms.x34;
+    const Scalar r4 = ms.x41 * ms.x41 + ms.x42 * ms.x42 + ms.x43 * ms.x43 + ms.x44 * ms.x44;
+    if (!(ds * ds > tol * tol * (r1 * r2 * r3 * r4))) {
+      const Scalar z(0);
+      return InverseResult<Mat44<Scalar>, Scalar>{
+	Mat44<Scalar>{z, z, z, z, z, z, z, z, z, z, z, z, z, z, z, z}, d,
+	  std::numeric_limits<Scalar>::infinity(), false};
+    }
+
+    const Scalar inv_d = Scalar(1) / ds;
+    const Scalar inv_d1 = inv_d * s1, inv_d2 = inv_d * s2, inv_d3 = inv_d * s3, inv_d4 = inv_d * s4;
+    const Mat44<Scalar> inv{
+      adj.x11 * inv_d1, adj.x12 * inv_d2, adj.x13 * inv_d3, adj.x14 * inv_d4,
+	adj.x21 * inv_d1, adj.x22 * inv_d2, adj.x23 * inv_d3, adj.x24 * inv_d4,
+	adj.x31 * inv_d1, adj.x32 * inv_d2, adj.x33 * inv_d3, adj.x34 * inv_d4,
+	adj.x41 * inv_d1, adj.x42 * inv_d2, adj.x43 * inv_d3, adj.x44 * inv_d4};
+
+    const Scalar g12 = s1 < s2 ? s1 : s2, g34 = s3 < s4 ? s3 : s4;
+    const Scalar g = g12 < g34 ? g12 : g34;
+    return InverseResult<Mat44<Scalar>, Scalar>{
+      inv, d, sqrt((g * m).l2_norm() * (detail::binade_scale(g) * inv).l2_norm()), true};
   }
 
   template<typename Scalar>
@@ -178,10 +539,25 @@ namespace verified_math {
   }
 
   template<typename Scalar>
-  Scalar trace(const Mat44<Scalar>& m) {
-    return m.x11 + m.x22 + m.x33 + m.x44;
+  constexpr Scalar trace(const Mat44<Scalar>& m) {
+    return detail::trace(m);
   }
 
+  // Explicit instantiations for float and double; see instantiate.h.
+#define VERIFIED_MATH_MAT44_TEMPLATES(instantiate, Scalar) \
+  instantiate class Mat44<Scalar>; \
+  instantiate void transform_vectors(const Mat44<Scalar>&, const Vec4<Scalar>*, Vec4<Scalar>*, std::size_t); \
+  instantiate void transform_vectors(const Mat44<Scalar>&, const Vec4Array<Scalar>&, Vec4Array<Scalar>&, std::size_t, std::size_t); \
+  instantiate void transform_vectors(const Mat44<Scalar>&, const Vec4Array<Scalar>&, Vec4Array<Scalar>&); \
+  instantiate void transform_points(const Mat44<Scalar>&, const Vec3<Scalar>*, Vec3<Scalar>*, std::size_t); \
+  instantiate void transform_points(const Mat44<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&); \
+  instantiate void transform_points_affine(const Mat44<Scalar>&, const Vec3<Scalar>*, Vec3<Scalar>*, std::size_t); \
+  instantiate void transform_points_affine(const Mat44<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&);
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_MAT44_TEMPLATES)
+#endif
+
 }
 
 
@@ -0,0 +1,264 @@
+#ifndef MAT44_ARRAY_H
+#define MAT44_ARRAY_H
+
+#include "verified_math/mat44.h"
+#include "verified_math/aligned_allocator.h"
+#include "verified_math/instantiate.h"
+
+#include <cstddef>
+#include <limits>
+#include <vector>
+
+namespace verified_math {
+
+  /*
+    A structure-of-arrays container of 4x4 matrices. Each entry is stored
+    in its own contiguous, aligned lane, so batched kernels vectorize
+    across matrices.
+   */
+  template<typename Scalar>
+  class Mat44Array {
+  public:
+    typedef std::vector<Scalar, aligned_allocator<Scalar> > Lane;
+
+    Lane x11;
+    Lane x12;
+    Lane x13;
+    Lane x14;
+    Lane x21;
+    Lane x22;
+    Lane x23;
+    Lane x24;
+    Lane x31;
+    Lane x32;
+    Lane x33;
+    Lane x34;
+    Lane x41;
+    Lane x42;
+    Lane x43;
+    Lane x44;
+
+    Mat44Array() { }
+
+    explicit Mat44Array(std::size_t n)
+      : x11(n), x12(n), x13(n), x14(n), x21(n), x22(n), x23(n), x24(n), x31(n), x32(n), x33(n), x34(n), x41(n), x42(n), x43(n), x44(n) { }
+
+    Mat44Array(const Mat44<Scalar>* m, std::size_t n)
+      : x11(n), x12(n), x13(n), x14(n), x21(n), x22(n), x23(n), x24(n), x31(n), x32(n), x33(n), x34(n), x41(n), x42(n), x43(n), x44(n) {
+      for (std::size_t i = 0; i < n; ++i) {
+	set(i, m[i]);
+      }
+    }
+
+    std::size_t size() const {
+      return x11.size();
+    }
+
+    void resize(std::size_t n) {
+      x11.resize(n);
+      x12.resize(n);
+      x13.resize(n);
+      x14.resize(n);
+      x21.resize(n);
+      x22.resize(n);
+      x23.resize(n);
+      x24.resize(n);
+      x31.resize(n);
+      x32.resize(n);
+      x33.resize(n);
+      x34.resize(n);
+      x41.resize(n);
+      x42.resize(n);
+      x43.resize(n);
+      x44.resize(n);
+    }
+
+    void push_back(const Mat44<Scalar>& m) {
+      x11.push_back(m.x11);
+      x12.push_back(m.x12);
+      x13.push_back(m.x13);
+      x14.push_back(m.x14);
+      x21.push_back(m.x21);
+      x22.push_back(m.x22);
+      x23.push_back(m.x23);
+      x24.push_back(m.x24);
+      x31.push_back(m.x31);
+      x32.push_back(m.x32);
+      x33.push_back(m.x33);
+      x34.push_back(m.x34);
+      x41.push_back(m.x41);
+      x42.push_back(m.x42);
+      x43.push_back(m.x43);
+      x44.push_back(m.x44);
+    }
+
+    // Element i as a Mat44, for interop with the single-matrix API.
+    Mat44<Scalar> operator[](std::size_t i) const {
+      return Mat44<Scalar>{
+	x11[i], x12[i], x13[i], x14[i],
+	x21[i], x22[i], x23[i], x24[i],
+	x31[i], x32[i], x33[i], x34[i],
+	x41[i], x42[i], x43[i], x44[i]
+      };
+    }
+
+    void set(std::size_t i, const Mat44<Scalar>& m) {
+      x11[i] = m.x11;
+      x12[i] = m.x12;
+      x13[i] = m.x13;
+      x14[i] = m.x14;
+      x21[i] = m.x21;
+      x22[i] = m.x22;
+      x23[i] = m.x23;
+      x24[i] = m.x24;
+      x31[i] = m.x31;
+      x32[i] = m.x32;
+      x33[i] = m.x33;
+      x34[i] = m.x34;
+      x41[i] = m.x41;
+      x42[i] = m.x42;
+      x43[i] = m.x43;
+      x44[i] = m.x44;
+    }
+  };
+
+  /*
+    Batched determinant and inverse over the entries [begin, end).
+
+    Both come from the twelve 2x2 sub-determinants of the top two and
+    bottom two rows (Laplace expansion by complementary minors), which are
+    computed once per matrix. An entry is flagged singular (ok[i] = 0,
+    inverse set to zero) when |det| <= tol * |r1| |r2| |r3| |r4|, where ri
+    are the rows, evaluated on power-of-two scaled rows; see the
+    Mat33Array version. inv must already hold m.size() matrices.
+   */
+  template<typename Scalar>
+  void det_inverse(const Mat44Array<Scalar>& m, Scalar* det, Mat44Array<Scalar>& inv,
+		   unsigned char* ok, Scalar tol, std::size_t begin, std::size_t end) {
+    const Scalar* a11 = m.x11.data(); const Scalar* a12 = m.x12.data(); const Scalar* a13 = m.x13.data(); const Scalar* a14 = m.x14.data();
+    const Scalar* a21 = m.x21.data(); const Scalar* a22 = m.x22.data(); const Scalar* a23 = m.x23.data(); const Scalar* a24 = m.x24.data();
+    const Scalar* a31 = m.x31.data(); const Scalar* a32 = m.x32.data(); const Scalar* a33 = m.x33.data(); const Scalar* a34 = m.x34.data();
+    const Scalar* a41 = m.x41.data(); const Scalar* a42 = m.x42.data(); const Scalar* a43 = m.x43.data(); const Scalar* a44 = m.x44.data();
+    Scalar* b11 = inv.x11.data(); Scalar* b12 = inv.x12.data(); Scalar* b13 = inv.x13.data(); Scalar* b14 = inv.x14.data();
+    Scalar* b21 = inv.x21.data(); Scalar* b22 = inv.x22.data(); Scalar* b23 = inv.x23.data(); Scalar* b24 = inv.x24.data();
+    Scalar* b31 = inv.x31.data(); Scalar* b32 = inv.x32.data(); Scalar* b33 = inv.x33.data(); Scalar* b34 = inv.x34.data();
+    Scalar* b41 = inv.x41.data(); Scalar* b42 = inv.x42.data(); Scalar* b43 = inv.x43.data(); Scalar* b44 = inv.x44.data();
+    const Scalar tol2 = tol * tol;
+
+    for (std::size_t i = begin; i < end; ++i) {
+      // Each row is scaled by a power of two, exactly; see row_scale.
+      const Scalar w1 = detail::row_scale(a11[i], a12[i], a13[i], a14[i]);
+      const Scalar w2 = detail::row_scale(a21[i], a22[i], a23[i], a24[i]);
+      const Scalar w3 = detail::row_scale(a31[i], a32[i], a33[i], a34[i]);
+      const Scalar w4 = detail::row_scale(a41[i], a42[i], a43[i], a44[i]);
+      const Scalar m11 = w1 * a11[i], m12 = w1 * a12[i], m13 = w1 * a13[i], m14 = w1 * a14[i];
+      const Scalar m21 = w2 * a21[i], m22 = w2 * a22[i], m23 = w2 * a23[i], m24 = w2 * a24[i];
+      const Scalar m31 = w3 * a31[i], m32 = w3 * a32[i], m33 = w3 * a33[i], m34 = w3 * a34[i];
+      const Scalar m41 = w4 * a41[i], m42 = w4 * a42[i], m43 = w4 * a43[i], m44 = w4 * a44[i];
+
+      // 2x2 minors of rows 1-2 and of rows 3-4.
+      const Scalar s0 = m11 * m22 - m21 * m12;
+      const Scalar s1 = m11 * m23 - m21 * m13;
+      const Scalar s2 = m11 * m24 - m21 * m14;
+      const Scalar s3 = m12 * m23 - m22 * m13;
+      const Scalar s4 = m12 * m24 - m22 * m14;
+      const Scalar s5 = m13 * m24 - m23 * m14;
+
+      const Scalar c5 = m33 * m44 - m43 * m34;
+      const Scalar c4 = m32 * m44 - m42 * m34;
+      const Scalar c3 = m32 * m43 - m42 * m33;
+      const Scalar c2 = m31 * m44 - m41 * m34;
+      const Scalar c1 = m31 * m43 - m41 * m33;
+      const Scalar c0 = m31 * m42 - m41 * m32;
+
+      const Scalar d = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+
+      const Scalar r1 = m11 * m11 + m12 * m12 + m13 * m13 + m14 * m14;
+      const Scalar r2 = m21 * m21 + m22 * m22 + m23 * m23 + m24 * m24;
+      const Scalar r3 = m31 * m31 + m32 * m32 + m33 * m33 + m34 * m34;
+      const Scalar r4 = m41 * m41 + m42 * m42 + m43 * m43 + m44 * m44;
+      const bool good = d * d > tol2 * ((r1 * r2) * (r3 * r4));
+      const Scalar inv_d = good ? Scalar(1) / (good ? d : Scalar(1)) : Scalar(0);
+
+      // inverse(S m) = inverse(m) inverse(S), so column k picks up wk.
+      const Scalar inv_d1 = inv_d * w1, inv_d2 = inv_d * w2, inv_d3 = inv_d * w3, inv_d4 = inv_d * w4;
+
+      det[i] = (((d * detail::binade_scale(w1)) * detail::binade_scale(w2))
+		* detail::binade_scale(w3)) * detail::binade_scale(w4);
+      ok[i] = good ? 1 : 0;
+      b11[i] = ( m22 * c5 - m23 * c4 + m24 * c3) * inv_d1;
+      b12[i] = (-m12 * c5 + m13 * c4 - m14 * c3) * inv_d2;
+      b13[i] = ( m42 * s5 - m43 * s4 + m44 * s3) * inv_d3;
+      b14[i] = (-m32 * s5 + m33 * s4 - m34 * s3) * inv_d4;
+
+      b21[i] = (-m21 * c5 + m23 * c2 - m24 * c1) * inv_d1;
+      b22[i] = ( m11 * c5 - m13 * c2 + m14 * c1) * inv_d2;
+      b23[i] = (-m41 * s5 + m43 * s2 - m44 * s1) * inv_d3;
+      b24[i] = ( m31 * s5 - m33 * s2 + m34 * s1) * inv_d4;
+
+      b31[i] = ( m21 * c4 - m22 * c2 + m24 * c0) * inv_d1;
+      b32[i] = (-m11 * c4 + m12 * c2 - m14 * c0) * inv_d2;
+      b33[i] = ( m41 * s4 - m42 * s2 + m44 * s0) * inv_d3;
+      b34[i] = (-m31 * s4 + m32 * s2 - m34 * s0) * inv_d4;
+
+      b41[i] = (-m21 * c3 + m22 * c1 - m23 * c0) * inv_d1;
+      b42[i] = ( m11 * c3 - m12 * c1 + m13 * c0) * inv_d2;
+      b43[i] = (-m41 * s3 + m42 * s1 - m43 * s0) * inv_d3;
+      b44[i] = ( m31 * s3 - m32 * s1 + m33 * s0) * inv_d4;
+    }
+  }
+
+  // Whole-array form; inv is resized, det and ok must hold m.size() entries.
+  template<typename Scalar>
+  void det_inverse(const Mat44Array<Scalar>& m, Scalar* det, Mat44Array<Scalar>& inv,
+		   unsigned char* ok, Scalar tol = 64 * std::numeric_limits<Scalar>::epsilon()) {
+    inv.resize(m.size());
+    det_inverse(m, det, inv, ok, tol, 0, m.size());
+  }
+
+  // Batched determinants of the entries [begin, end).
+  template<typename Scalar>
+  void det(const Mat44Array<Scalar>& m, Scalar* out, std::size_t begin, std::size_t end) {
+    const Scalar* a11 = m.x11.data(); const Scalar* a12 = m.x12.data(); const Scalar* a13 = m.x13.data(); const Scalar* a14 = m.x14.data();
+    const Scalar* a21 = m.x21.data(); const Scalar* a22 = m.x22.data(); const Scalar* a23 = m.x23.data(); const Scalar* a24 = m.x24.data();
+    const Scalar* a31 = m.x31.data(); const Scalar* a32 = m.x32.data(); const Scalar* a33 = m.x33.data(); const Scalar* a34 = m.x34.data();
+    const Scalar* a41 = m.x41.data(); const Scalar* a42 = m.x42.data(); const Scalar* a43 = m.x43.data(); const Scalar* a44 = m.x44.data();
+    for (std::size_t i = begin; i < end; ++i) {
+      const Scalar s0 = a11[i] * a22[i] - a21[i] * a12[i];
+      const Scalar s1 = a11[i] * a23[i] - a21[i] * a13[i];
+      const Scalar s2 = a11[i] * a24[i] - a21[i] * a14[i];
+      const Scalar s3 = a12[i] * a23[i] - a22[i] * a13[i];
+      const Scalar s4 = a12[i] * a24[i] - a22[i] * a14[i];
+      const Scalar s5 = a13[i] * a24[i] - a23[i] * a14[i];
+
+      const Scalar c5 = a33[i] * a44[i] - a43[i] * a34[i];
+      const Scalar c4 = a32[i] * a44[i] - a42[i] * a34[i];
+      const Scalar c3 = a32[i] * a43[i] - a42[i] * a33[i];
+      const Scalar c2 = a31[i] * a44[i] - a41[i] * a34[i];
+      const Scalar c1 = a31[i] * a43[i] - a41[i] * a33[i];
+      const Scalar c0 = a31[i] * a42[i] - a41[i] * a32[i];
+
+      out[i] = s0 * c5 - s1 * c4 + s2 * c3 + s3 * c2 - s4 * c1 + s5 * c0;
+    }
+  }
+
+  template<typename Scalar>
+  void det(const Mat44Array<Scalar>& m, Scalar* out) {
+    det(m, out, 0, m.size());
+  }
+
+  // Explicit instantiations for float and double; see instantiate.h.
+#define VERIFIED_MATH_MAT44_ARRAY_TEMPLATES(instantiate, Scalar) \
+  instantiate class Mat44Array<Scalar>; \
+  instantiate void det_inverse(const Mat44Array<Scalar>&, Scalar*, Mat44Array<Scalar>&, unsigned char*, Scalar, std::size_t, std::size_t); \
+  instantiate void det_inverse(const Mat44Array<Scalar>&, Scalar*, Mat44Array<Scalar>&, unsigned char*, Scalar); \
+  instantiate void det(const Mat44Array<Scalar>&, Scalar*, std::size_t, std::size_t); \
+  instantiate void det(const Mat44Array<Scalar>&, Scalar*);
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_MAT44_ARRAY_TEMPLATES)
+#endif
+
+}
+
+#endif // MAT44_ARRAY_H
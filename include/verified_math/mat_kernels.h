@@ -0,0 +1,339 @@
+#ifndef MAT_KERNELS_H
+#define MAT_KERNELS_H
+
+#include "verified_math/vec.h"
+
+#include <cstddef>
+
+namespace verified_math {
+
+  namespace detail {
+
+    /*
+      The one implementation of the matrix operations behind Mat, Mat33 and
+      Mat44 (and their products with Vec, Vec3 and Vec4).
+
+      A type M takes part by specializing Entries<M> with its scalar type,
+      its shape and at(m, k), entry k in row-major order; vectors are single
+      columns. Results are built as Out{x...} from all entries in row-major
+      order, which the named-field constructors and the Mat and Vec
+      aggregates all accept. Each kernel is a single return statement over a
+      pack of indices, or a recursion over a template size, so it is
+      constexpr under C++11 and every index is a constant after inlining.
+     */
+    template<typename M>
+    struct Entries;
+
+    template<typename M>
+    constexpr const typename Entries<M>::scalar& entry(const M& m, std::size_t k) {
+      return Entries<M>::at(m, k);
+    }
+
+    // Indices<0, ..., N - 1> as MakeIndices<N>::type.
+    template<std::size_t... K>
+    struct Indices { };
+
+    template<std::size_t N, std::size_t... K>
+    struct MakeIndices : MakeIndices<N - 1, N - 1, K...> { };
+
+    template<std::size_t... K>
+    struct MakeIndices<0, K...> {
+      typedef Indices<K...> type;
+    };
+
+    template<typename M>
+    using EntryIndices = typename MakeIndices<Entries<M>::rows * Entries<M>::cols>::type;
+
+    template<std::size_t N, typename Scalar>
+    struct Entries<Vec<N, Scalar> > {
+      typedef Scalar scalar;
+      static constexpr std::size_t rows = N;
+      static constexpr std::size_t cols = 1;
+
+      static constexpr const Scalar& at(const Vec<N, Scalar>& v, std::size_t k) {
+	return v.data[k];
+      }
+    };
+
+    // The named fields through a constexpr table of pointers to members.
+    template<typename Scalar>
+    struct Entries<Vec3<Scalar> > {
+      typedef Scalar scalar;
+      static constexpr std::size_t rows = 3;
+      static constexpr std::size_t cols = 1;
+      static constexpr Scalar Vec3<Scalar>::* fields[3] = {
+	&Vec3<Scalar>::x1, &Vec3<Scalar>::x2, &Vec3<Scalar>::x3};
+
+      static constexpr const Scalar& at(const Vec3<Scalar>& v, std::size_t k) {
+	return v.*fields[k];
+      }
+    };
+
+    template<typename Scalar>
+    constexpr Scalar Vec3<Scalar>::* Entries<Vec3<Scalar> >::fields[3];
+
+    template<typename Scalar>
+    struct Entries<Vec4<Scalar> > {
+      typedef Scalar scalar;
+      static constexpr std::size_t rows = 4;
+      static constexpr std::size_t cols = 1;
+      static constexpr Scalar Vec4<Scalar>::* fields[4] = {
+	&Vec4<Scalar>::x1, &Vec4<Scalar>::x2, &Vec4<Scalar>::x3, &Vec4<Scalar>::x4};
+
+      static constexpr const Scalar& at(const Vec4<Scalar>& v, std::size_t k) {
+	return v.*fields[k];
+      }
+    };
+
+    template<typename Scalar>
+    constexpr Scalar Vec4<Scalar>::* Entries<Vec4<Scalar> >::fields[4];
+
+    /*
+      Entrywise kernels, and conversion between two types of the same shape.
+     */
+    template<typename Out, typename M, std::size_t... K>
+    constexpr Out convert(const M& m, Indices<K...>) {
+      return Out{entry(m, K)...};
+    }
+
+    template<typename Out, typename M>
+    constexpr Out convert(const M& m) {
+      return convert<Out>(m, EntryIndices<M>());
+    }
+
+    template<typename M, std::size_t... K>
+    constexpr M add(const M& a, const M& b, Indices<K...>) {
+      return M{(entry(a, K) + entry(b, K))...};
+    }
+
+    template<typename M>
+    constexpr M add(const M& a, const M& b) {
+      return add(a, b, EntryIndices<M>());
+    }
+
+    template<typename M, std::size_t... K>
+    constexpr M subtract(const M& a, const M& b, Indices<K...>) {
+      return M{(entry(a, K) - entry(b, K))...};
+    }
+
+    template<typename M>
+    constexpr M subtract(const M& a, const M& b) {
+      return subtract(a, b, EntryIndices<M>());
+    }
+
+    // c * m and m * c keep the order of the factors.
+    template<typename M, std::size_t... K>
+    constexpr M scale_left(const typename Entries<M>::scalar c, const M& m, Indices<K...>) {
+      return M{(c * entry(m, K))...};
+    }
+
+    template<typename M>
+    constexpr M scale_left(const typename Entries<M>::scalar c, const M& m) {
+      return scale_left(c, m, EntryIndices<M>());
+    }
+
+    template<typename M, std::size_t... K>
+    constexpr M scale_right(const M& m, const typename Entries<M>::scalar c, Indices<K...>) {
+      return M{(entry(m, K) * c)...};
+    }
+
+    template<typename M>
+    constexpr M scale_right(const M& m, const typename Entries<M>::scalar c) {
+      return scale_right(m, c, EntryIndices<M>());
+    }
+
+    // Entry k of the C x R result is entry (k % R, k / R) of the R x C m.
+    template<typename Out, typename M, std::size_t... K>
+    constexpr Out transposed(const M& m, Indices<K...>) {
+      return Out{entry(m, K % Entries<M>::rows * Entries<M>::cols + K / Entries<M>::rows)...};
+    }
+
+    template<typename Out, typename M>
+    constexpr Out transposed(const M& m) {
+      return transposed<Out>(m, EntryIndices<M>());
+    }
+
+    /*
+      Sums accumulated left to right, which fixes the rounding: the first n
+      diagonal entries, the first n squared entries, and row i of a times
+      column j of b over the first n terms.
+     */
+    template<std::size_t n>
+    struct Sum {
+      template<typename M>
+      static constexpr typename Entries<M>::scalar diagonal(const M& m) {
+	return Sum<n - 1>::diagonal(m) + entry(m, (n - 1) * (Entries<M>::cols + 1));
+      }
+
+      template<typename M>
+      static constexpr typename Entries<M>::scalar squares(const M& m) {
+	return Sum<n - 1>::squares(m) + entry(m, n - 1) * entry(m, n - 1);
+      }
+
+      template<typename A, typename B>
+      static constexpr typename Entries<A>::scalar row_column(const A& a, const B& b,
+							      std::size_t i, std::size_t j) {
+	return Sum<n - 1>::row_column(a, b, i, j) +
+	  entry(a, i * Entries<A>::cols + n - 1) * entry(b, (n - 1) * Entries<B>::cols + j);
+      }
+    };
+
+    template<>
+    struct Sum<1> {
+      template<typename M>
+      static constexpr typename Entries<M>::scalar diagonal(const M& m) {
+	return entry(m, 0);
+      }
+
+      template<typename M>
+      static constexpr typename Entries<M>::scalar squares(const M& m) {
+	return entry(m, 0) * entry(m, 0);
+      }
+
+      template<typename A, typename B>
+      static constexpr typename Entries<A>::scalar row_column(const A& a, const B& b,
+							      std::size_t i, std::size_t j) {
+	return entry(a, i * Entries<A>::cols) * entry(b, j);
+      }
+    };
+
+    template<typename M>
+    constexpr typename Entries<M>::scalar trace(const M& m) {
+      return Sum<Entries<M>::rows>::diagonal(m);
+    }
+
+    template<typename M>
+    constexpr typename Entries<M>::scalar sum_of_squares(const M& m) {
+      return Sum<Entries<M>::rows * Entries<M>::cols>::squares(m);
+    }
+
+    // The product a b, matrix by matrix or matrix by vector.
+    template<typename Out, typename A, typename B, std::size_t... K>
+    constexpr Out multiply(const A& a, const B& b, Indices<K...>) {
+      return Out{Sum<Entries<A>::cols>::row_column(a, b, K / Entries<Out>::cols,
+						   K % Entries<Out>::cols)...};
+    }
+
+    template<typename Out, typename A, typename B>
+    constexpr Out multiply(const A& a, const B& b) {
+      return multiply<Out>(a, b, EntryIndices<Out>());
+    }
+
+    /*
+      Closed forms for 3x3 matrices: the determinant by expansion along the
+      first row, and the adjugate, the transpose of the cofactor matrix, so
+      that m adjugate(m) = det(m) I.
+     */
+    template<typename M>
+    constexpr typename Entries<M>::scalar det3(const M& m) {
+      return entry(m, 0) * (entry(m, 4) * entry(m, 8) - entry(m, 5) * entry(m, 7)) +
+	entry(m, 1) * (entry(m, 5) * entry(m, 6) - entry(m, 3) * entry(m, 8)) +
+	entry(m, 2) * (entry(m, 3) * entry(m, 7) - entry(m, 6) * entry(m, 4));
+    }
+
+    template<typename M>
+    constexpr M adjugate3(const M& m) {
+      return M{
+	(entry(m, 4) * entry(m, 8) - entry(m, 5) * entry(m, 7)),
+	  -(entry(m, 1) * entry(m, 8) - entry(m, 2) * entry(m, 7)),
+	  (entry(m, 1) * entry(m, 5) - entry(m, 2) * entry(m, 4)),
+	  -(entry(m, 3) * entry(m, 8) - entry(m, 5) * entry(m, 6)),
+	  (entry(m, 0) * entry(m, 8) - entry(m, 2) * entry(m, 6)),
+	  -(entry(m, 0) * entry(m, 5) - entry(m, 2) * entry(m, 3)),
+	  (entry(m, 3) * entry(m, 7) - entry(m, 4) * entry(m, 6)),
+	  -(entry(m, 0) * entry(m, 7) - entry(m, 1) * entry(m, 6)),
+	  (entry(m, 0) * entry(m, 4) - entry(m, 1) * entry(m, 3))
+      };
+    }
+
+    template<typename M>
+    M inverse3(const M& m) {
+      return scale_left(typename Entries<M>::scalar(1) / det3(m), adjugate3(m));
+    }
+
+    /*
+      Closed forms for 4x4 matrices. The determinant is the Laplace expansion
+      by complementary 2x2 minors of rows 1-2 and rows 3-4, in a single
+      return statement so that it is constexpr under C++11.
+
+      The adjugate computes the twelve minors once, rows 1-2 (s0-s5) and
+      rows 3-4 (c0-c5); every cofactor is a sum of three products of an
+      entry with a minor, for 24 multiplies in the minors and 48 in the
+      cofactors. The inverse takes the determinant as the first row of m
+      times the first column of the adjugate, so it costs 4 more multiplies.
+     */
+    template<typename M>
+    constexpr typename Entries<M>::scalar det4(const M& m) {
+      return (entry(m, 0) * entry(m, 5) - entry(m, 4) * entry(m, 1)) *
+	(entry(m, 10) * entry(m, 15) - entry(m, 14) * entry(m, 11)) -
+	(entry(m, 0) * entry(m, 6) - entry(m, 4) * entry(m, 2)) *
+	(entry(m, 9) * entry(m, 15) - entry(m, 13) * entry(m, 11)) +
+	(entry(m, 0) * entry(m, 7) - entry(m, 4) * entry(m, 3)) *
+	(entry(m, 9) * entry(m, 14) - entry(m, 13) * entry(m, 10)) +
+	(entry(m, 1) * entry(m, 6) - entry(m, 5) * entry(m, 2)) *
+	(entry(m, 8) * entry(m, 15) - entry(m, 12) * entry(m, 11)) -
+	(entry(m, 1) * entry(m, 7) - entry(m, 5) * entry(m, 3)) *
+	(entry(m, 8) * entry(m, 14) - entry(m, 12) * entry(m, 10)) +
+	(entry(m, 2) * entry(m, 7) - entry(m, 6) * entry(m, 3)) *
+	(entry(m, 8) * entry(m, 13) - entry(m, 12) * entry(m, 9));
+    }
+
+    template<typename M>
+    M adjugate4(const M& m) {
+      typedef typename Entries<M>::scalar Scalar;
+      const Scalar a0 = entry(m, 0), a1 = entry(m, 1), a2 = entry(m, 2), a3 = entry(m, 3);
+      const Scalar a4 = entry(m, 4), a5 = entry(m, 5), a6 = entry(m, 6), a7 = entry(m, 7);
+      const Scalar a8 = entry(m, 8), a9 = entry(m, 9), a10 = entry(m, 10), a11 = entry(m, 11);
+      const Scalar a12 = entry(m, 12), a13 = entry(m, 13), a14 = entry(m, 14), a15 = entry(m, 15);
+
+      const Scalar s0 = a0 * a5 - a4 * a1;
+      const Scalar s1 = a0 * a6 - a4 * a2;
+      const Scalar s2 = a0 * a7 - a4 * a3;
+      const Scalar s3 = a1 * a6 - a5 * a2;
+      const Scalar s4 = a1 * a7 - a5 * a3;
+      const Scalar s5 = a2 * a7 - a6 * a3;
+
+      const Scalar c5 = a10 * a15 - a14 * a11;
+      const Scalar c4 = a9 * a15 - a13 * a11;
+      const Scalar c3 = a9 * a14 - a13 * a10;
+      const Scalar c2 = a8 * a15 - a12 * a11;
+      const Scalar c1 = a8 * a14 - a12 * a10;
+      const Scalar c0 = a8 * a13 - a12 * a9;
+
+      return M{
+	 a5 * c5 - a6 * c4 + a7 * c3,
+	  -a1 * c5 + a2 * c4 - a3 * c3,
+	  a13 * s5 - a14 * s4 + a15 * s3,
+	  -a9 * s5 + a10 * s4 - a11 * s3,
+
+	  -a4 * c5 + a6 * c2 - a7 * c1,
+	  a0 * c5 - a2 * c2 + a3 * c1,
+	  -a12 * s5 + a14 * s2 - a15 * s1,
+	  a8 * s5 - a10 * s2 + a11 * s1,
+
+	  a4 * c4 - a5 * c2 + a7 * c0,
+	  -a0 * c4 + a1 * c2 - a3 * c0,
+	  a12 * s4 - a13 * s2 + a15 * s0,
+	  -a8 * s4 + a9 * s2 - a11 * s0,
+
+	  -a4 * c3 + a5 * c1 - a6 * c0,
+	  a0 * c3 - a1 * c1 + a2 * c0,
+	  -a12 * s3 + a13 * s1 - a14 * s0,
+	  a8 * s3 - a9 * s1 + a10 * s0
+      };
+    }
+
+    template<typename M>
+    M inverse4(const M& m) {
+      typedef typename Entries<M>::scalar Scalar;
+      const M adj = adjugate4(m);
+      const Scalar d = entry(m, 0) * entry(adj, 0) + entry(m, 1) * entry(adj, 4) +
+	entry(m, 2) * entry(adj, 8) + entry(m, 3) * entry(adj, 12);
+      return scale_left(Scalar(1) / d, adj);
+    }
+
+  }
+
+}
+
+#endif // MAT_KERNELS_H
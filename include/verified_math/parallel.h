@@ -0,0 +1,176 @@
+#ifndef PARALLEL_H
+#define PARALLEL_H
+
+#include "verified_math/mat33.h"
+#include "verified_math/mat44.h"
+#include "verified_math/mat33_array.h"
+#include "verified_math/mat44_array.h"
+#include "verified_math/eigen33.h"
+#include "verified_math/svd33.h"
+#include "verified_math/solve.h"
+#include "verified_math/thread_pool.h"
+#include "verified_math/instantiate.h"
+
+#include <cstddef>
+#include <limits>
+
+namespace verified_math {
+
+  /*
+    Parallel versions of the batched kernels. Each splits its range with
+    parallel_for and runs the serial [begin, end) kernel on every chunk, so
+    the results are identical to the serial ones. Below the partition's
+    serial threshold they simply call the serial kernel.
+   */
+  namespace detail {
+
+    inline Partition with_bytes(Partition p, std::size_t bytes_per_item) {
+      if (p.bytes_per_item == 0) {
+	p.bytes_per_item = bytes_per_item;
+      }
+      return p;
+    }
+
+  }
+
+  template<typename Scalar>
+  void parallel_transform(const Mat33<Scalar>& m, const Vec3<Scalar>* in, Vec3<Scalar>* out,
+			  std::size_t n, const Partition& p = Partition()) {
+    parallel_for(0, n, [&](std::size_t b, std::size_t e) {
+	transform_vectors(m, in + b, out + b, e - b);
+      }, detail::with_bytes(p, 2 * sizeof(Vec3<Scalar>)));
+  }
+
+  template<typename Scalar>
+  void parallel_transform(const Mat33<Scalar>& m, const Vec3Array<Scalar>& in,
+			  Vec3Array<Scalar>& out, const Partition& p = Partition()) {
+    out.resize(in.size());
+    parallel_for(0, in.size(), [&](std::size_t b, std::size_t e) {
+	transform_vectors(m, in, out, b, e);
+      }, detail::with_bytes(p, 6 * sizeof(Scalar)));
+  }
+
+  template<typename Scalar>
+  void parallel_transform(const Mat44<Scalar>& m, const Vec4<Scalar>* in, Vec4<Scalar>* out,
+			  std::size_t n, const Partition& p = Partition()) {
+    parallel_for(0, n, [&](std::size_t b, std::size_t e) {
+	transform_vectors(m, in + b, out + b, e - b);
+      }, detail::with_bytes(p, 2 * sizeof(Vec4<Scalar>)));
+  }
+
+  template<typename Scalar>
+  void parallel_transform(const Mat44<Scalar>& m, const Vec4Array<Scalar>& in,
+			  Vec4Array<Scalar>& out, const Partition& p = Partition()) {
+    out.resize(in.size());
+    parallel_for(0, in.size(), [&](std::size_t b, std::size_t e) {
+	transform_vectors(m, in, out, b, e);
+      }, detail::with_bytes(p, 8 * sizeof(Scalar)));
+  }
+
+  // Batched det_inverse; det and ok must hold m.size() entries.
+  template<typename Scalar>
+  void parallel_det_inverse(const Mat33Array<Scalar>& m, Scalar* det, Mat33Array<Scalar>& inv,
+			    unsigned char* ok, const Partition& p = Partition(),
+			    Scalar tol = 64 * std::numeric_limits<Scalar>::epsilon()) {
+    inv.resize(m.size());
+    parallel_for(0, m.size(), [&](std::size_t b, std::size_t e) {
+	det_inverse(m, det, inv, ok, tol, b, e);
+      }, detail::with_bytes(p, 19 * sizeof(Scalar) + 1));
+  }
+
+  template<typename Scalar>
+  void parallel_det_inverse(const Mat44Array<Scalar>& m, Scalar* det, Mat44Array<Scalar>& inv,
+			    unsigned char* ok, const Partition& p = Partition(),
+			    Scalar tol = 64 * std::numeric_limits<Scalar>::epsilon()) {
+    inv.resize(m.size());
+    parallel_for(0, m.size(), [&](std::size_t b, std::size_t e) {
+	det_inverse(m, det, inv, ok, tol, b, e);
+      }, detail::with_bytes(p, 33 * sizeof(Scalar) + 1));
+  }
+
+  // Batched symmetric_eigen; values and vectors are resized.
+  template<typename Scalar>
+  void parallel_symmetric_eigen(const Mat33Array<Scalar>& m, Vec3Array<Scalar>& values,
+				Mat33Array<Scalar>& vectors, const Partition& p = Partition()) {
+    values.resize(m.size());
+    vectors.resize(m.size());
+    parallel_for(0, m.size(), [&](std::size_t b, std::size_t e) {
+	symmetric_eigen(m, values, vectors, b, e);
+      }, detail::with_bytes(p, 21 * sizeof(Scalar)));
+  }
+
+  // Batched svd; u, sigma and v are resized.
+  template<typename Scalar>
+  void parallel_svd(const Mat33Array<Scalar>& m, Mat33Array<Scalar>& u, Vec3Array<Scalar>& sigma,
+		    Mat33Array<Scalar>& v, const Partition& p = Partition()) {
+    u.resize(m.size());
+    sigma.resize(m.size());
+    v.resize(m.size());
+    parallel_for(0, m.size(), [&](std::size_t b, std::size_t e) {
+	svd(m, u, sigma, v, b, e);
+      }, detail::with_bytes(p, 30 * sizeof(Scalar)));
+  }
+
+  // Batched LU solve; x is resized, ok must hold m.size() entries.
+  template<typename Scalar>
+  void parallel_solve(const Mat33Array<Scalar>& m, const Vec3Array<Scalar>& b,
+		      Vec3Array<Scalar>& x, unsigned char* ok, const Partition& p = Partition()) {
+    x.resize(m.size());
+    parallel_for(0, m.size(), [&](std::size_t s, std::size_t e) {
+	solve(m, b, x, ok, s, e);
+      }, detail::with_bytes(p, 15 * sizeof(Scalar) + 1));
+  }
+
+  template<typename Scalar>
+  void parallel_solve(const Mat44Array<Scalar>& m, const Vec4Array<Scalar>& b,
+		      Vec4Array<Scalar>& x, unsigned char* ok, const Partition& p = Partition()) {
+    x.resize(m.size());
+    parallel_for(0, m.size(), [&](std::size_t s, std::size_t e) {
+	solve(m, b, x, ok, s, e);
+      }, detail::with_bytes(p, 24 * sizeof(Scalar) + 1));
+  }
+
+  // Batched mixed-precision refinement; x is resized, converged must hold
+  // m.size() entries.
+  template<typename Scalar, typename Low = float>
+  void parallel_refined_solve(const Mat33Array<Scalar>& m, const Vec3Array<Scalar>& b,
+			      Vec3Array<Scalar>& x, unsigned char* converged,
+			      const Partition& p = Partition(), int iterations = 2) {
+    x.resize(m.size());
+    parallel_for(0, m.size(), [&](std::size_t s, std::size_t e) {
+	refined_solve<Scalar, Low>(m, b, x, converged, iterations, s, e);
+      }, detail::with_bytes(p, 15 * sizeof(Scalar) + 1));
+  }
+
+  template<typename Scalar, typename Low = float>
+  void parallel_refined_solve(const Mat44Array<Scalar>& m, const Vec4Array<Scalar>& b,
+			      Vec4Array<Scalar>& x, unsigned char* converged,
+			      const Partition& p = Partition(), int iterations = 2) {
+    x.resize(m.size());
+    parallel_for(0, m.size(), [&](std::size_t s, std::size_t e) {
+	refined_solve<Scalar, Low>(m, b, x, converged, iterations, s, e);
+      }, detail::with_bytes(p, 24 * sizeof(Scalar) + 1));
+  }
+
+  // Explicit instantiations for float and double; see instantiate.h.
+#define VERIFIED_MATH_PARALLEL_TEMPLATES(instantiate, Scalar) \
+  instantiate void parallel_transform(const Mat33<Scalar>&, const Vec3<Scalar>*, Vec3<Scalar>*, std::size_t, const Partition&); \
+  instantiate void parallel_transform(const Mat33<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&, const Partition&); \
+  instantiate void parallel_transform(const Mat44<Scalar>&, const Vec4<Scalar>*, Vec4<Scalar>*, std::size_t, const Partition&); \
+  instantiate void parallel_transform(const Mat44<Scalar>&, const Vec4Array<Scalar>&, Vec4Array<Scalar>&, const Partition&); \
+  instantiate void parallel_det_inverse(const Mat33Array<Scalar>&, Scalar*, Mat33Array<Scalar>&, unsigned char*, const Partition&, Scalar); \
+  instantiate void parallel_det_inverse(const Mat44Array<Scalar>&, Scalar*, Mat44Array<Scalar>&, unsigned char*, const Partition&, Scalar); \
+  instantiate void parallel_symmetric_eigen(const Mat33Array<Scalar>&, Vec3Array<Scalar>&, Mat33Array<Scalar>&, const Partition&); \
+  instantiate void parallel_svd(const Mat33Array<Scalar>&, Mat33Array<Scalar>&, Vec3Array<Scalar>&, Mat33Array<Scalar>&, const Partition&); \
+  instantiate void parallel_solve(const Mat33Array<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&, unsigned char*, const Partition&); \
+  instantiate void parallel_solve(const Mat44Array<Scalar>&, const Vec4Array<Scalar>&, Vec4Array<Scalar>&, unsigned char*, const Partition&); \
+  instantiate void parallel_refined_solve(const Mat33Array<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&, unsigned char*, const Partition&, int); \
+  instantiate void parallel_refined_solve(const Mat44Array<Scalar>&, const Vec4Array<Scalar>&, Vec4Array<Scalar>&, unsigned char*, const Partition&, int);
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_PARALLEL_TEMPLATES)
+#endif
+
+}
+
+#endif // PARALLEL_H
@@ -0,0 +1,326 @@
+#ifndef PREDICATES_H
+#define PREDICATES_H
+
+#include "verified_math/vec3.h"
+#include "verified_math/mat33.h"
+#include "verified_math/error_free.h"
+#include "verified_math/instantiate.h"
+
+#include <cmath>
+#include <limits>
+
+namespace verified_math {
+
+  namespace detail {
+
+    /*
+      Expansion arithmetic after Shewchuk, "Adaptive Precision
+      Floating-Point Arithmetic and Fast Robust Geometric Predicates"
+      (1997). An expansion is an array of nonoverlapping Scalars in
+      increasing order of magnitude whose exact sum is the value it
+      represents; the last component has the sign of that value. The
+      operations are exact under round-to-nearest only, so the predicates
+      must not be called inside a RoundUpward.
+
+      h = e + f with zero components dropped; h has room for elen + flen
+      components. Returns the length of h, at least one.
+     */
+    template<typename Scalar>
+    int sum_expansions(int elen, const Scalar* e, int flen, const Scalar* f, Scalar* h) {
+      int i = 0, j = 0, n = 0;
+      Scalar q = std::abs(f[0]) > std::abs(e[0]) ? e[i++] : f[j++];
+      while (i < elen || j < flen) {
+	const Scalar next = j == flen || (i < elen && std::abs(f[j]) > std::abs(e[i])) ?
+	  e[i++] : f[j++];
+	Scalar r;
+	two_sum(q, next, q, r);
+	if (r != Scalar(0)) {
+	  h[n++] = r;
+	}
+      }
+      if (q != Scalar(0) || n == 0) {
+	h[n++] = q;
+      }
+      return n;
+    }
+
+    /*
+      h = b e with zero components dropped; h has room for 2 elen
+      components. Returns the length of h, at least one.
+     */
+    template<typename Scalar>
+    int scale_expansion(int elen, const Scalar* e, Scalar b, Scalar* h) {
+      int n = 0;
+      Scalar q, r;
+      two_product(e[0], b, q, r);
+      if (r != Scalar(0)) {
+	h[n++] = r;
+      }
+      for (int i = 1; i < elen; ++i) {
+	Scalar p, p0, s;
+	two_product(e[i], b, p, p0);
+	two_sum(q, p0, s, r);
+	if (r != Scalar(0)) {
+	  h[n++] = r;
+	}
+	fast_two_sum(p, s, q, r);
+	if (r != Scalar(0)) {
+	  h[n++] = r;
+	}
+      }
+      if (q != Scalar(0) || n == 0) {
+	h[n++] = q;
+      }
+      return n;
+    }
+
+    // p.x1 q.x2 - q.x1 p.x2 in up to four components.
+    template<typename Scalar>
+    int cross_xy(const Vec3<Scalar>& p, const Vec3<Scalar>& q, Scalar* h) {
+      Scalar s[2], t[2];
+      two_product(p.x1, q.x2, s[1], s[0]);
+      two_product(-q.x1, p.x2, t[1], t[0]);
+      return sum_expansions(2, s, 2, t, h);
+    }
+
+    // e + f + g for expansions of up to four components, in up to twelve.
+    template<typename Scalar>
+    int sum_cross(const Scalar* e, int elen, const Scalar* f, int flen,
+		  const Scalar* g, int glen, Scalar* h) {
+      Scalar t[8];
+      const int tlen = sum_expansions(elen, e, flen, f, t);
+      return sum_expansions(tlen, t, glen, g, h);
+    }
+
+    /*
+      det[a - d; b - d; c - d] exactly, in up to 96 components. This is
+      the 4 x 4 determinant with rows (p.x1, p.x2, p.x3, 1), expanded
+      along the third column over the 2 x 2 minors of the first two.
+     */
+    template<typename Scalar>
+    int orient3d_expansion(const Vec3<Scalar>& a, const Vec3<Scalar>& b,
+			   const Vec3<Scalar>& c, const Vec3<Scalar>& d, Scalar* h) {
+      Scalar ab[4], bc[4], cd[4], da[4], ac[4], ca[4], bd[4], db[4];
+      const int ablen = cross_xy(a, b, ab), bclen = cross_xy(b, c, bc);
+      const int cdlen = cross_xy(c, d, cd), dalen = cross_xy(d, a, da);
+      const int aclen = cross_xy(a, c, ac), calen = cross_xy(c, a, ca);
+      const int bdlen = cross_xy(b, d, bd), dblen = cross_xy(d, b, db);
+
+      Scalar bcd[12], cda[12], dab[12], abc[12];
+      const int bcdlen = sum_cross(bc, bclen, db, dblen, cd, cdlen, bcd);
+      const int cdalen = sum_cross(ac, aclen, da, dalen, cd, cdlen, cda);
+      const int dablen = sum_cross(ab, ablen, da, dalen, bd, bdlen, dab);
+      const int abclen = sum_cross(ab, ablen, ca, calen, bc, bclen, abc);
+
+      Scalar adet[24], bdet[24], cdet[24], ddet[24], abdet[48], cddet[48];
+      const int alen = scale_expansion(bcdlen, bcd, a.x3, adet);
+      const int blen = scale_expansion(cdalen, cda, -b.x3, bdet);
+      const int clen = scale_expansion(dablen, dab, c.x3, cdet);
+      const int dlen = scale_expansion(abclen, abc, -d.x3, ddet);
+      const int ablen2 = sum_expansions(alen, adet, blen, bdet, abdet);
+      const int cdlen2 = sum_expansions(clen, cdet, dlen, ddet, cddet);
+      return sum_expansions(ablen2, abdet, cdlen2, cddet, h);
+    }
+
+    // The exact sign of orient3d, for when the filter fails.
+    template<typename Scalar>
+    Scalar orient3d_exact(const Vec3<Scalar>& a, const Vec3<Scalar>& b,
+			  const Vec3<Scalar>& c, const Vec3<Scalar>& d) {
+      Scalar h[96];
+      return h[orient3d_expansion(a, b, c, d, h) - 1];
+    }
+
+    /*
+      orient3d when the filter fails, with the filter's permanent. The
+      determinant of the rounded differences is first computed exactly;
+      Shewchuk's second error bound tells whether their rounding can have
+      changed its sign. If it can and the differences were exact anyway,
+      as for points on a grid, it is still the answer. Only otherwise is
+      the determinant recomputed from the points.
+     */
+    template<typename Scalar>
+    Scalar orient3d_adapt(const Vec3<Scalar>& a, const Vec3<Scalar>& b,
+			  const Vec3<Scalar>& c, const Vec3<Scalar>& d, Scalar permanent) {
+      const Vec3<Scalar> ra = a - d, rb = b - d, rc = c - d;
+      Scalar bc[4], ca[4], ab[4];
+      const int bclen = cross_xy(rb, rc, bc), calen = cross_xy(rc, ra, ca);
+      const int ablen = cross_xy(ra, rb, ab);
+      Scalar adet[8], bdet[8], cdet[8], abdet[16], fin[24];
+      const int alen = scale_expansion(bclen, bc, ra.x3, adet);
+      const int blen = scale_expansion(calen, ca, rb.x3, bdet);
+      const int clen = scale_expansion(ablen, ab, rc.x3, cdet);
+      const int ablen2 = sum_expansions(alen, adet, blen, bdet, abdet);
+      const int len = sum_expansions(ablen2, abdet, clen, cdet, fin);
+
+      Scalar estimate = fin[0];
+      for (int i = 1; i < len; ++i) {
+	estimate += fin[i];
+      }
+      const Scalar u = std::numeric_limits<Scalar>::epsilon() / 2;
+      const Scalar bound = (Scalar(3) + Scalar(28) * u) * u * permanent;
+      if (estimate >= bound || -estimate >= bound) {
+	return estimate;
+      }
+
+      // Whether every difference was exact.
+      const Scalar* x[4] = {&a.x1, &b.x1, &c.x1, &d.x1};
+      bool exact = true;
+      for (int i = 0; i < 3; ++i) {
+	for (int j = 0; j < 3; ++j) {
+	  Scalar r, t;
+	  two_sum(x[i][j], -x[3][j], r, t);
+	  exact = exact && t == Scalar(0);
+	}
+      }
+      return exact ? fin[len - 1] : orient3d_exact(a, b, c, d);
+    }
+
+    /*
+      The exact sign of insphere, for when the filter fails: the 5 x 5
+      determinant with rows (p.x1, p.x2, p.x3, |p|^2, 1), expanded along
+      its fourth column. Each cofactor is an orient3d_expansion, scaled by
+      |p|^2 one coordinate at a time. Uses about 110 KB of stack.
+     */
+    template<typename Scalar>
+    Scalar insphere_exact(const Vec3<Scalar>& a, const Vec3<Scalar>& b, const Vec3<Scalar>& c,
+			  const Vec3<Scalar>& d, const Vec3<Scalar>& e) {
+      const Vec3<Scalar>* p[5] = {&a, &b, &c, &d, &e};
+      Scalar sum[2][5 * 1152];
+      int len = 1, cur = 0;
+      sum[0][0] = Scalar(0);
+      for (int i = 0; i < 5; ++i) {
+	const Vec3<Scalar>* q[4];
+	for (int j = 0, k = 0; j < 5; ++j) {
+	  if (j != i) {
+	    q[k++] = p[j];
+	  }
+	}
+	Scalar det[96];
+	const int dlen = orient3d_expansion(*q[0], *q[1], *q[2], *q[3], det);
+
+	// The cofactor signs alternate, starting with a negative one.
+	const Scalar sign = i % 2 == 0 ? Scalar(-1) : Scalar(1);
+	const Scalar x[3] = {p[i]->x1, p[i]->x2, p[i]->x3};
+	Scalar t[192], squared[3][384], xy[768], lifted[1152];
+	int slen[3];
+	for (int k = 0; k < 3; ++k) {
+	  const int tlen = scale_expansion(dlen, det, sign * x[k], t);
+	  slen[k] = scale_expansion(tlen, t, x[k], squared[k]);
+	}
+	const int xylen = sum_expansions(slen[0], squared[0], slen[1], squared[1], xy);
+	const int llen = sum_expansions(xylen, xy, slen[2], squared[2], lifted);
+	len = sum_expansions(len, sum[cur], llen, lifted, sum[1 - cur]);
+	cur = 1 - cur;
+      }
+      return sum[cur][len - 1];
+    }
+
+  }
+
+  /*
+    Robust geometric predicates for meshing. The sign of the result is
+    exact for all finite inputs that do not overflow or underflow; its
+    magnitude is only an approximation.
+
+    Each predicate first evaluates its determinant in Scalar with
+    Shewchuk's a priori error bound, which settles all but nearly
+    degenerate inputs for the cost of the determinant and a permanent of
+    the same shape. Only when the bound fails does a library call take
+    over with expansion arithmetic: orient3d tries the exact determinant
+    of the rounded differences first (about 20 times the filter), and
+    otherwise, like insphere, recomputes the determinant exactly from the
+    points (some hundred times the filter for orient3d, and more for
+    insphere).
+
+    orient3d(a, b, c, d) has the sign of det[a - d; b - d; c - d], and
+    is positive when d lies below the plane through a, b and c, seen as
+    counterclockwise from above; zero when the four points are coplanar.
+   */
+  template<typename Scalar>
+  Scalar orient3d(const Vec3<Scalar>& a, const Vec3<Scalar>& b,
+		  const Vec3<Scalar>& c, const Vec3<Scalar>& d) {
+    const Mat33<Scalar> m{
+      a.x1 - d.x1, a.x2 - d.x2, a.x3 - d.x3,
+      b.x1 - d.x1, b.x2 - d.x2, b.x3 - d.x3,
+      c.x1 - d.x1, c.x2 - d.x2, c.x3 - d.x3
+    };
+    // The same products as det(m), so they are computed once.
+    const Scalar value = det(m);
+    const Scalar permanent =
+      std::abs(m.x11) * (std::abs(m.x22 * m.x33) + std::abs(m.x23 * m.x32)) +
+      std::abs(m.x12) * (std::abs(m.x23 * m.x31) + std::abs(m.x21 * m.x33)) +
+      std::abs(m.x13) * (std::abs(m.x21 * m.x32) + std::abs(m.x31 * m.x22));
+    const Scalar u = std::numeric_limits<Scalar>::epsilon() / 2;
+    const Scalar bound = (Scalar(7) + Scalar(56) * u) * u * permanent;
+    if (value > bound || -value > bound) {
+      return value;
+    }
+    return detail::orient3d_adapt(a, b, c, d, permanent);
+  }
+
+  /*
+    insphere(a, b, c, d, e) has the sign of the 4 x 4 determinant with
+    rows (p - e, |p - e|^2) for p = a, b, c, d. For a, b, c, d with
+    orient3d(a, b, c, d) > 0 it is positive when e lies inside their
+    circumsphere, negative outside and zero on it; the sign flips for the
+    other orientation.
+   */
+  template<typename Scalar>
+  Scalar insphere(const Vec3<Scalar>& a, const Vec3<Scalar>& b, const Vec3<Scalar>& c,
+		  const Vec3<Scalar>& d, const Vec3<Scalar>& e) {
+    const Scalar aex = a.x1 - e.x1, aey = a.x2 - e.x2, aez = a.x3 - e.x3;
+    const Scalar bex = b.x1 - e.x1, bey = b.x2 - e.x2, bez = b.x3 - e.x3;
+    const Scalar cex = c.x1 - e.x1, cey = c.x2 - e.x2, cez = c.x3 - e.x3;
+    const Scalar dex = d.x1 - e.x1, dey = d.x2 - e.x2, dez = d.x3 - e.x3;
+
+    // 2 x 2 minors of the first two columns, then 3 x 3 of the first three.
+    const Scalar aexbey = aex * bey, bexaey = bex * aey;
+    const Scalar bexcey = bex * cey, cexbey = cex * bey;
+    const Scalar cexdey = cex * dey, dexcey = dex * cey;
+    const Scalar dexaey = dex * aey, aexdey = aex * dey;
+    const Scalar aexcey = aex * cey, cexaey = cex * aey;
+    const Scalar bexdey = bex * dey, dexbey = dex * bey;
+    const Scalar ab = aexbey - bexaey, bc = bexcey - cexbey, cd = cexdey - dexcey;
+    const Scalar da = dexaey - aexdey, ac = aexcey - cexaey, bd = bexdey - dexbey;
+
+    const Scalar abc = aez * bc - bez * ac + cez * ab;
+    const Scalar bcd = bez * cd - cez * bd + dez * bc;
+    const Scalar cda = cez * da + dez * ac + aez * cd;
+    const Scalar dab = dez * ab + aez * bd + bez * da;
+
+    const Scalar alift = aex * aex + aey * aey + aez * aez;
+    const Scalar blift = bex * bex + bey * bey + bez * bez;
+    const Scalar clift = cex * cex + cey * cey + cez * cez;
+    const Scalar dlift = dex * dex + dey * dey + dez * dez;
+    const Scalar value = (dlift * abc - clift * dab) + (blift * cda - alift * bcd);
+
+    const Scalar az = std::abs(aez), bz = std::abs(bez), cz = std::abs(cez), dz = std::abs(dez);
+    const Scalar abp = std::abs(aexbey) + std::abs(bexaey), bcp = std::abs(bexcey) + std::abs(cexbey);
+    const Scalar cdp = std::abs(cexdey) + std::abs(dexcey), dap = std::abs(dexaey) + std::abs(aexdey);
+    const Scalar acp = std::abs(aexcey) + std::abs(cexaey), bdp = std::abs(bexdey) + std::abs(dexbey);
+    const Scalar permanent =
+      (cdp * bz + bdp * cz + bcp * dz) * alift +
+      (dap * cz + acp * dz + cdp * az) * blift +
+      (abp * dz + bdp * az + dap * bz) * clift +
+      (bcp * az + acp * bz + abp * cz) * dlift;
+    const Scalar u = std::numeric_limits<Scalar>::epsilon() / 2;
+    const Scalar bound = (Scalar(16) + Scalar(224) * u) * u * permanent;
+    if (value > bound || -value > bound) {
+      return value;
+    }
+    return detail::insphere_exact(a, b, c, d, e);
+  }
+
+  // Explicit instantiations for float and double; see instantiate.h.
+  // The filters stay inline; the exact fallbacks are library calls.
+#define VERIFIED_MATH_PREDICATES_TEMPLATES(instantiate, Scalar) \
+  instantiate Scalar detail::orient3d_adapt(const Vec3<Scalar>&, const Vec3<Scalar>&, const Vec3<Scalar>&, const Vec3<Scalar>&, Scalar); \
+  instantiate Scalar detail::insphere_exact(const Vec3<Scalar>&, const Vec3<Scalar>&, const Vec3<Scalar>&, const Vec3<Scalar>&, const Vec3<Scalar>&);
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_PREDICATES_TEMPLATES)
+#endif
+
+}
+
+#endif // PREDICATES_H
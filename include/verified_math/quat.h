@@ -0,0 +1,236 @@
+#ifndef QUAT_H
+#define QUAT_H
+
+#include "verified_math/vec3.h"
+#include "verified_math/vec3_array.h"
+#include "verified_math/mat33.h"
+#include "verified_math/mat44.h"
+#include "verified_math/scalar_math.h"
+#include "verified_math/instantiate.h"
+
+#include <cmath>
+#include <cstddef>
+
+namespace verified_math {
+
+  /*
+    A quaternion w + x i + y j + z k. Unit quaternions represent rotations:
+    32 bytes for double against 72 for a Mat33, and composition is a
+    16-multiply Hamilton product against 27 for a 3x3 product.
+
+    As for the matrices, q1 * q2 is the rotation q2 followed by q1, so
+    to_mat33(q1 * q2) == to_mat33(q1) * to_mat33(q2).
+   */
+  template<typename Scalar>
+  class Quat {
+  public:
+    Scalar w {1};
+    Scalar x {0};
+    Scalar y {0};
+    Scalar z {0};
+
+    constexpr Quat<Scalar>(Scalar _w, Scalar _x, Scalar _y, Scalar _z)
+      : w{_w}, x{_x}, y{_y}, z{_z} { }
+
+    // Like the matrix types, this is the squared norm.
+    constexpr Scalar l2_norm() const {
+      return w * w + x * x + y * y + z * z;
+    }
+  };
+
+  /*
+    Basic quaternion algebra.
+  */
+  template<typename Scalar>
+  constexpr Quat<Scalar> operator+(const Quat<Scalar>& a, const Quat<Scalar>& b) {
+    return Quat<Scalar>(a.w + b.w, a.x + b.x, a.y + b.y, a.z + b.z);
+  }
+
+  template<typename Scalar>
+  constexpr Quat<Scalar> operator-(const Quat<Scalar>& a, const Quat<Scalar>& b) {
+    return Quat<Scalar>(a.w - b.w, a.x - b.x, a.y - b.y, a.z - b.z);
+  }
+
+  template<typename Scalar>
+  constexpr Quat<Scalar> operator*(Scalar c, const Quat<Scalar>& q) {
+    return Quat<Scalar>(c * q.w, c * q.x, c * q.y, c * q.z);
+  }
+
+  template<typename Scalar>
+  constexpr Quat<Scalar> operator*(const Quat<Scalar>& q, Scalar c) {
+    return Quat<Scalar>(q.w * c, q.x * c, q.y * c, q.z * c);
+  }
+
+  // Hamilton product
+  template<typename Scalar>
+  constexpr Quat<Scalar> operator*(const Quat<Scalar>& a, const Quat<Scalar>& b) {
+    return Quat<Scalar>(a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+			a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+			a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+			a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w);
+  }
+
+  template<typename Scalar>
+  constexpr Quat<Scalar> conjugate(const Quat<Scalar>& q) {
+    return Quat<Scalar>(q.w, -q.x, -q.y, -q.z);
+  }
+
+  template<typename Scalar>
+  constexpr Scalar dot(const Quat<Scalar>& a, const Quat<Scalar>& b) {
+    return a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+  }
+
+  template<typename Scalar>
+  Quat<Scalar> normalize(const Quat<Scalar>& q) {
+    return (Scalar(1) / sqrt(q.l2_norm())) * q;
+  }
+
+  template<typename Scalar>
+  Quat<Scalar> inverse(const Quat<Scalar>& q) {
+    return (Scalar(1) / q.l2_norm()) * conjugate(q);
+  }
+
+  // rotation by angle (radians) about a unit axis
+  template<typename Scalar>
+  Quat<Scalar> from_axis_angle(const Vec3<Scalar>& axis, Scalar angle) {
+    const Scalar s = sin(angle / 2);
+    return Quat<Scalar>(cos(angle / 2), s * axis.x1, s * axis.x2, s * axis.x3);
+  }
+
+  /*
+    Rotation of a vector by a unit quaternion q = (w, u), in the
+    cross-product form
+
+      t = 2 (u x v),  v' = v + w t + u x t
+
+    which is 18 multiplies and 12 adds, against 28 multiplies for
+    q v conj(q) expanded.
+   */
+  template<typename Scalar>
+  constexpr Vec3<Scalar> rotate(const Quat<Scalar>& q, const Vec3<Scalar>& v) {
+    return v + q.w * (Scalar(2) * cross(Vec3<Scalar>(q.x, q.y, q.z), v)) +
+      cross(Vec3<Scalar>(q.x, q.y, q.z), Scalar(2) * cross(Vec3<Scalar>(q.x, q.y, q.z), v));
+  }
+
+  template<typename Scalar>
+  constexpr Mat33<Scalar> to_mat33(const Quat<Scalar>& q);
+
+  /*
+    Batched rotation: out[i] = rotate(q, in[i]). out may alias in. The
+    quaternion is converted to a matrix once, after which each vector costs
+    9 multiplies and 6 adds.
+   */
+  template<typename Scalar>
+  void rotate(const Quat<Scalar>& q, const Vec3<Scalar>* in, Vec3<Scalar>* out, std::size_t n) {
+    transform_vectors(to_mat33(q), in, out, n);
+  }
+
+  template<typename Scalar>
+  void rotate(const Quat<Scalar>& q, const Vec3Array<Scalar>& in, Vec3Array<Scalar>& out) {
+    transform_vectors(to_mat33(q), in, out);
+  }
+
+  /*
+    Conversions to and from rotation matrices. q must be a unit
+    quaternion, and m a rotation.
+   */
+  template<typename Scalar>
+  constexpr Mat33<Scalar> to_mat33(const Quat<Scalar>& q) {
+    return Mat33<Scalar>{
+      Scalar(1) - Scalar(2) * (q.y * q.y + q.z * q.z),
+	Scalar(2) * (q.x * q.y - q.w * q.z),
+	Scalar(2) * (q.x * q.z + q.w * q.y),
+
+	Scalar(2) * (q.x * q.y + q.w * q.z),
+	Scalar(1) - Scalar(2) * (q.x * q.x + q.z * q.z),
+	Scalar(2) * (q.y * q.z - q.w * q.x),
+
+	Scalar(2) * (q.x * q.z - q.w * q.y),
+	Scalar(2) * (q.y * q.z + q.w * q.x),
+	Scalar(1) - Scalar(2) * (q.x * q.x + q.y * q.y)
+    };
+  }
+
+  template<typename Scalar>
+  constexpr Mat44<Scalar> to_mat44(const Quat<Scalar>& q) {
+    return Mat44<Scalar>{
+      Scalar(1) - Scalar(2) * (q.y * q.y + q.z * q.z),
+	Scalar(2) * (q.x * q.y - q.w * q.z),
+	Scalar(2) * (q.x * q.z + q.w * q.y),
+	Scalar(0),
+
+	Scalar(2) * (q.x * q.y + q.w * q.z),
+	Scalar(1) - Scalar(2) * (q.x * q.x + q.z * q.z),
+	Scalar(2) * (q.y * q.z - q.w * q.x),
+	Scalar(0),
+
+	Scalar(2) * (q.x * q.z - q.w * q.y),
+	Scalar(2) * (q.y * q.z + q.w * q.x),
+	Scalar(1) - Scalar(2) * (q.x * q.x + q.y * q.y),
+	Scalar(0),
+
+	Scalar(0), Scalar(0), Scalar(0), Scalar(1)
+    };
+  }
+
+  /*
+    Shepperd's method: the square root is taken of the largest of 4w^2,
+    4x^2, 4y^2 and 4z^2, so it never divides by a small number. The result
+    has w >= 0 when the trace is positive; q and -q are the same rotation.
+   */
+  template<typename Scalar>
+  Quat<Scalar> from_mat33(const Mat33<Scalar>& m) {
+    const Scalar trace = m.x11 + m.x22 + m.x33;
+    if (trace > Scalar(0)) {
+      const Scalar s = Scalar(2) * sqrt(trace + Scalar(1));
+      return Quat<Scalar>(s / 4, (m.x32 - m.x23) / s, (m.x13 - m.x31) / s, (m.x21 - m.x12) / s);
+    } else if (m.x11 > m.x22 && m.x11 > m.x33) {
+      const Scalar s = Scalar(2) * sqrt(Scalar(1) + m.x11 - m.x22 - m.x33);
+      return Quat<Scalar>((m.x32 - m.x23) / s, s / 4, (m.x12 + m.x21) / s, (m.x13 + m.x31) / s);
+    } else if (m.x22 > m.x33) {
+      const Scalar s = Scalar(2) * sqrt(Scalar(1) + m.x22 - m.x11 - m.x33);
+      return Quat<Scalar>((m.x13 - m.x31) / s, (m.x12 + m.x21) / s, s / 4, (m.x23 + m.x32) / s);
+    } else {
+      const Scalar s = Scalar(2) * sqrt(Scalar(1) + m.x33 - m.x11 - m.x22);
+      return Quat<Scalar>((m.x21 - m.x12) / s, (m.x13 + m.x31) / s, (m.x23 + m.x32) / s, s / 4);
+    }
+  }
+
+  /*
+    Interpolation between unit quaternions along the shorter arc. nlerp
+    normalizes the linear blend; it is cheap and has the right endpoints
+    but not constant angular speed. slerp has constant speed and falls
+    back to nlerp when a and b are so close that sin(theta) is inaccurate.
+   */
+  template<typename Scalar>
+  Quat<Scalar> nlerp(const Quat<Scalar>& a, const Quat<Scalar>& b, Scalar t) {
+    const Quat<Scalar> c = dot(a, b) < Scalar(0) ? Scalar(-1) * b : b;
+    return normalize((Scalar(1) - t) * a + t * c);
+  }
+
+  template<typename Scalar>
+  Quat<Scalar> slerp(const Quat<Scalar>& a, const Quat<Scalar>& b, Scalar t) {
+    Scalar d = dot(a, b);
+    const Quat<Scalar> c = d < Scalar(0) ? Scalar(-1) * b : b;
+    d = fabs(d);
+    if (d > Scalar(0.9995)) {
+      return nlerp(a, c, t);
+    }
+    const Scalar theta = acos(d);
+    const Scalar inv_sin = Scalar(1) / sin(theta);
+    return (sin((Scalar(1) - t) * theta) * inv_sin) * a + (sin(t * theta) * inv_sin) * c;
+  }
+
+  // Explicit instantiations for float and double; see instantiate.h.
+#define VERIFIED_MATH_QUAT_TEMPLATES(instantiate, Scalar) \
+  instantiate class Quat<Scalar>; \
+  instantiate void rotate(const Quat<Scalar>&, const Vec3<Scalar>*, Vec3<Scalar>*, std::size_t); \
+  instantiate void rotate(const Quat<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&);
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_QUAT_TEMPLATES)
+#endif
+
+}
+
+#endif // QUAT_H
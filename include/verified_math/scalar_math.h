@@ -0,0 +1,125 @@
+#ifndef SCALAR_MATH_H
+#define SCALAR_MATH_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+
+namespace verified_math {
+
+  /*
+    The math functions the templates apply to Scalar. They call them
+    unqualified, as sqrt(x) rather than std::sqrt(x), so that for a class
+    Scalar such as DoubleWord argument-dependent lookup finds its own
+    overloads, whichever header was included first.
+   */
+  using std::abs;
+  using std::fabs;
+  using std::sqrt;
+  using std::hypot;
+  using std::sin;
+  using std::cos;
+  using std::acos;
+  using std::isfinite;
+
+  namespace detail {
+
+    /*
+      A power of two s with |x| s in [1, 2), clamped to the normal range
+      so that s and 1 / s are finite, nonzero and exact. It is read off
+      the exponent bits, without a division, for float and double; other
+      Scalar types are not rescaled (s = 1). The reciprocal of s is
+      binade_scale(s).
+     */
+    template<typename Scalar>
+    Scalar binade_scale(const Scalar&) {
+      return Scalar(1);
+    }
+
+    inline float binade_scale(float x) {
+      std::uint32_t u;
+      std::memcpy(&u, &x, sizeof u);
+      std::uint32_t e = (u >> 23) & 0xffu;
+      e = e < 1u ? 1u : e > 253u ? 253u : e;
+      u = (254u - e) << 23;
+      float s;
+      std::memcpy(&s, &u, sizeof s);
+      return s;
+    }
+
+    inline double binade_scale(double x) {
+      std::uint64_t u;
+      std::memcpy(&u, &x, sizeof u);
+      std::uint64_t e = (u >> 52) & 0x7ffu;
+      e = e < 1u ? 1u : e > 2045u ? 2045u : e;
+      u = (2046u - e) << 52;
+      double s;
+      std::memcpy(&s, &u, sizeof s);
+      return s;
+    }
+
+    /*
+      The binade scale of the largest entry of a row. Multiplying the row
+      by it is exact and leaves the ratio |det| / (|r1| ... |rN|) of the
+      rejection tests unchanged, but keeps the squared determinant and the
+      product of squared row norms far from overflow and underflow. Only
+      float and double rows are rescaled.
+     */
+    template<typename Scalar>
+    Scalar row_scale(const Scalar&, const Scalar&, const Scalar&) {
+      return Scalar(1);
+    }
+
+    template<typename Scalar>
+    Scalar row_scale(const Scalar&, const Scalar&, const Scalar&, const Scalar&) {
+      return Scalar(1);
+    }
+
+    template<typename Real>
+    Real binade_scale_max(Real x, Real y, Real z, Real w) {
+      x = std::fabs(x); y = std::fabs(y); z = std::fabs(z); w = std::fabs(w);
+      const Real xy = x < y ? y : x, zw = z < w ? w : z;
+      return binade_scale(xy < zw ? zw : xy);
+    }
+
+    inline float row_scale(float a, float b, float c) {
+      return binade_scale_max(a, b, c, 0.0f);
+    }
+
+    inline float row_scale(float a, float b, float c, float d) {
+      return binade_scale_max(a, b, c, d);
+    }
+
+    inline double row_scale(double a, double b, double c) {
+      return binade_scale_max(a, b, c, 0.0);
+    }
+
+    inline double row_scale(double a, double b, double c, double d) {
+      return binade_scale_max(a, b, c, d);
+    }
+
+    /*
+      The factor that brings a largest entry x > 0 to magnitude about one:
+      binade_scale(x) for float and double, so that scaling by it and by
+      its reciprocal is exact and finite even for subnormal x, and 1 / x
+      for other Scalar types.
+     */
+    template<typename Scalar>
+    Scalar magnitude_scale(const Scalar& x) {
+      return Scalar(1) / x;
+    }
+
+    inline float magnitude_scale(float x) {
+      return binade_scale(x);
+    }
+
+    inline double magnitude_scale(double x) {
+      return binade_scale(x);
+    }
+
+  }
+
+}
+
+#endif // SCALAR_MATH_H
@@ -0,0 +1,120 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+/*
+  Compile-time selection of the SIMD code paths.
+
+  The instruction sets are picked up from the compiler's target flags
+  (e.g. -msse2, -mavx, -mfma or -march=native). Define
+  VERIFIED_MATH_NO_SIMD to force the portable scalar templates everywhere.
+ */
+#if !defined(VERIFIED_MATH_NO_SIMD)
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define VERIFIED_MATH_SSE2 1
+#include <emmintrin.h>
+#endif
+
+#if defined(__AVX__)
+#define VERIFIED_MATH_AVX 1
+#include <immintrin.h>
+#endif
+
+#if defined(__AVX__) && defined(__FMA__)
+#define VERIFIED_MATH_FMA 1
+#endif
+
+// Hardware half <-> float conversion (vcvtph2ps / vcvtps2ph).
+#if defined(__F16C__)
+#define VERIFIED_MATH_F16C 1
+#include <immintrin.h>
+#endif
+
+#endif // VERIFIED_MATH_NO_SIMD
+
+/*
+  Whether __builtin_is_constant_evaluated is available (GCC 9, Clang 9,
+  MSVC 19.25 and later), so that SIMD overloads can fall back to the
+  constexpr templates in constant expressions.
+ */
+#if defined(__has_builtin)
+#if __has_builtin(__builtin_is_constant_evaluated)
+#define VERIFIED_MATH_HAS_IS_CONSTANT_EVALUATED 1
+#endif
+#elif (defined(__GNUC__) && !defined(__clang__) && __GNUC__ >= 9) || \
+  (defined(_MSC_VER) && _MSC_VER >= 1925)
+#define VERIFIED_MATH_HAS_IS_CONSTANT_EVALUATED 1
+#endif
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+
+namespace verified_math {
+
+  namespace detail {
+
+    /*
+      The block kernels of the batched types copy a block of entries of
+      each lane into local arrays and compute from those. The loops then
+      cannot alias the lanes and always run over the whole block, the
+      tail past the n entries copied zeroed by pad_block, so that their
+      constant trip count vectorizes even under the cheap cost model of
+      -O2.
+     */
+    template<std::size_t block, typename T>
+    void pad_block(T (&x)[block], std::size_t n) {
+      std::fill(x + n, x + block, T(0));
+    }
+
+    /*
+      Square roots of the n lanes of x, for the block kernels. std::sqrt
+      keeps its own loop scalar, as it may have to set errno, so the SIMD
+      paths take the roots directly and the loops around them stay
+      vectorizable.
+     */
+    template<typename Scalar>
+    void sqrt_lanes(Scalar* x, std::size_t n) {
+      using std::sqrt;
+      for (std::size_t t = 0; t < n; ++t) {
+	x[t] = sqrt(x[t]);
+      }
+    }
+
+    inline void sqrt_lanes(float* x, std::size_t n) {
+      std::size_t t = 0;
+#if defined(VERIFIED_MATH_AVX)
+      for (; t < n / 8 * 8; t += 8) {
+	_mm256_storeu_ps(x + t, _mm256_sqrt_ps(_mm256_loadu_ps(x + t)));
+      }
+#elif defined(VERIFIED_MATH_SSE2)
+      for (; t < n / 4 * 4; t += 4) {
+	_mm_storeu_ps(x + t, _mm_sqrt_ps(_mm_loadu_ps(x + t)));
+      }
+#endif
+      for (; t < n; ++t) {
+	x[t] = std::sqrt(x[t]);
+      }
+    }
+
+    inline void sqrt_lanes(double* x, std::size_t n) {
+      std::size_t t = 0;
+#if defined(VERIFIED_MATH_AVX)
+      for (; t < n / 4 * 4; t += 4) {
+	_mm256_storeu_pd(x + t, _mm256_sqrt_pd(_mm256_loadu_pd(x + t)));
+      }
+#elif defined(VERIFIED_MATH_SSE2)
+      for (; t < n / 2 * 2; t += 2) {
+	_mm_storeu_pd(x + t, _mm_sqrt_pd(_mm_loadu_pd(x + t)));
+      }
+#endif
+      for (; t < n; ++t) {
+	x[t] = std::sqrt(x[t]);
+      }
+    }
+
+  }
+
+}
+
+#endif // SIMD_H
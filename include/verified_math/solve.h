@@ -0,0 +1,615 @@
+#ifndef SOLVE_H
+#define SOLVE_H
+
+#include "verified_math/vec3.h"
+#include "verified_math/vec4.h"
+#include "verified_math/vec3_array.h"
+#include "verified_math/vec4_array.h"
+#include "verified_math/mat33.h"
+#include "verified_math/mat44.h"
+#include "verified_math/mat33_array.h"
+#include "verified_math/mat44_array.h"
+#include "verified_math/scalar_math.h"
+#include "verified_math/instantiate.h"
+
+#include <cmath>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+
+namespace verified_math {
+
+  namespace detail {
+
+    /*
+      LU factorization with partial pivoting, PA = LU, of the row-major
+      N x N matrix at m. The loops have constant bounds and are fully
+      unrolled by the compiler. The unit lower factor L sits below the
+      diagonal of a, U on and above it, and the reciprocals of the pivots
+      are kept so that solving does no division.
+
+      ok is false when |det| <= tol * |r1| ... |rN| (rows ri), the test of
+      try_inverse. As there, each float or double row is first scaled by
+      a power of two (detail::row_scale), so the test holds across the
+      exponent range; the scaling is exact, is kept in scale and is
+      applied to b when solving, so it costs no division.
+     */
+    template<int N, typename Scalar>
+    class LuFactor {
+    public:
+      Scalar a[N][N];
+      Scalar inv_pivot[N];
+      Scalar scale[N];
+      int perm[N];
+      Scalar det;
+      bool ok;
+
+      LuFactor(const Scalar* m, Scalar tol) {
+	Scalar rows = Scalar(1);
+	for (int i = 0; i < N; ++i) {
+	  Scalar top = Scalar(0);
+	  for (int j = 0; j < N; ++j) {
+	    const Scalar x = abs(m[N * i + j]);
+	    top = x > top ? x : top;
+	  }
+	  scale[i] = binade_scale(top);
+	  Scalar r = Scalar(0);
+	  for (int j = 0; j < N; ++j) {
+	    a[i][j] = scale[i] * m[N * i + j];
+	    r += a[i][j] * a[i][j];
+	  }
+	  rows *= r;
+	  perm[i] = i;
+	}
+
+	det = Scalar(1);
+	for (int k = 0; k < N; ++k) {
+	  int p = k;
+	  for (int i = k + 1; i < N; ++i) {
+	    if (abs(a[i][k]) > abs(a[p][k])) {
+	      p = i;
+	    }
+	  }
+	  if (p != k) {
+	    for (int j = 0; j < N; ++j) {
+	      const Scalar t = a[k][j];
+	      a[k][j] = a[p][j];
+	      a[p][j] = t;
+	    }
+	    const int t = perm[k];
+	    perm[k] = perm[p];
+	    perm[p] = t;
+	    det = -det;
+	  }
+
+	  const Scalar pivot = a[k][k];
+	  det *= pivot;
+	  inv_pivot[k] = Scalar(1) / pivot;
+	  for (int i = k + 1; i < N; ++i) {
+	    const Scalar l = a[i][k] * inv_pivot[k];
+	    a[i][k] = l;
+	    for (int j = k + 1; j < N; ++j) {
+	      a[i][j] -= l * a[k][j];
+	    }
+	  }
+	}
+	ok = det * det > tol * tol * rows;
+	for (int i = 0; i < N; ++i) {
+	  det *= binade_scale(scale[i]);
+	}
+      }
+
+      // Solves A x = b; b is read through the permutation and the row
+      // scaling into x.
+      void solve(const Scalar* b, Scalar* x) const {
+	for (int i = 0; i < N; ++i) {
+	  Scalar s = b[perm[i]] * scale[perm[i]];
+	  for (int j = 0; j < i; ++j) {
+	    s -= a[i][j] * x[j];
+	  }
+	  x[i] = s;
+	}
+	for (int i = N - 1; i >= 0; --i) {
+	  Scalar s = x[i];
+	  for (int j = i + 1; j < N; ++j) {
+	    s -= a[i][j] * x[j];
+	  }
+	  x[i] = s * inv_pivot[i];
+	}
+      }
+    };
+
+    /*
+      Cholesky factorization A = L L^T of the symmetric row-major N x N
+      matrix at m; only the lower triangle is read. ok is false when a
+      pivot falls to tol times its diagonal entry or below, i.e. when A is
+      not (numerically) positive definite.
+     */
+    template<int N, typename Scalar>
+    class CholeskyFactor {
+    public:
+      Scalar l[N][N];
+      Scalar inv_diag[N];
+      bool ok;
+
+      CholeskyFactor(const Scalar* m, Scalar tol) {
+	ok = true;
+	for (int j = 0; j < N; ++j) {
+	  Scalar d = m[N * j + j];
+	  for (int k = 0; k < j; ++k) {
+	    d -= l[j][k] * l[j][k];
+	  }
+	  ok = ok && d > tol * m[N * j + j];
+	  const Scalar ljj = sqrt(ok ? d : Scalar(1));
+	  l[j][j] = ljj;
+	  inv_diag[j] = Scalar(1) / ljj;
+	  for (int i = j + 1; i < N; ++i) {
+	    Scalar s = m[N * i + j];
+	    for (int k = 0; k < j; ++k) {
+	      s -= l[i][k] * l[j][k];
+	    }
+	    l[i][j] = s * inv_diag[j];
+	  }
+	}
+      }
+
+      void solve(const Scalar* b, Scalar* x) const {
+	for (int i = 0; i < N; ++i) {
+	  Scalar s = b[i];
+	  for (int j = 0; j < i; ++j) {
+	    s -= l[i][j] * x[j];
+	  }
+	  x[i] = s * inv_diag[i];
+	}
+	for (int i = N - 1; i >= 0; --i) {
+	  Scalar s = x[i];
+	  for (int j = i + 1; j < N; ++j) {
+	    s -= l[j][i] * x[j];
+	  }
+	  x[i] = s * inv_diag[i];
+	}
+      }
+    };
+
+  }
+
+  /*
+    Factor-once, solve-many LU with partial pivoting. Solving costs
+    N^2 multiply-adds against N^3 / 3 for the factorization; check ok()
+    before trusting the solutions.
+   */
+  template<typename Scalar>
+  class Lu33 {
+  public:
+    explicit Lu33(const Mat33<Scalar>& m, Scalar tol = 64 * std::numeric_limits<Scalar>::epsilon())
+      : f(&m.x11, tol) { }
+
+    bool ok() const { return f.ok; }
+    Scalar det() const { return f.det; }
+
+    Vec3<Scalar> solve(const Vec3<Scalar>& b) const {
+      const Scalar in[3] = {b.x1, b.x2, b.x3};
+      Scalar x[3];
+      f.solve(in, x);
+      return Vec3<Scalar>(x[0], x[1], x[2]);
+    }
+
+  private:
+    detail::LuFactor<3, Scalar> f;
+  };
+
+  template<typename Scalar>
+  class Lu44 {
+  public:
+    explicit Lu44(const Mat44<Scalar>& m, Scalar tol = 64 * std::numeric_limits<Scalar>::epsilon())
+      : f(&m.x11, tol) { }
+
+    bool ok() const { return f.ok; }
+    Scalar det() const { return f.det; }
+
+    Vec4<Scalar> solve(const Vec4<Scalar>& b) const {
+      const Scalar in[4] = {b.x1, b.x2, b.x3, b.x4};
+      Scalar x[4];
+      f.solve(in, x);
+      return Vec4<Scalar>(x[0], x[1], x[2], x[3]);
+    }
+
+  private:
+    detail::LuFactor<4, Scalar> f;
+  };
+
+  /*
+    Factor-once, solve-many Cholesky for symmetric positive definite
+    matrices, about half the work of LU. Only the lower triangle is read.
+   */
+  template<typename Scalar>
+  class Cholesky33 {
+  public:
+    explicit Cholesky33(const Mat33<Scalar>& m,
+			Scalar tol = 64 * std::numeric_limits<Scalar>::epsilon())
+      : f(&m.x11, tol) { }
+
+    bool ok() const { return f.ok; }
+
+    Vec3<Scalar> solve(const Vec3<Scalar>& b) const {
+      const Scalar in[3] = {b.x1, b.x2, b.x3};
+      Scalar x[3];
+      f.solve(in, x);
+      return Vec3<Scalar>(x[0], x[1], x[2]);
+    }
+
+  private:
+    detail::CholeskyFactor<3, Scalar> f;
+  };
+
+  template<typename Scalar>
+  class Cholesky44 {
+  public:
+    explicit Cholesky44(const Mat44<Scalar>& m,
+			Scalar tol = 64 * std::numeric_limits<Scalar>::epsilon())
+      : f(&m.x11, tol) { }
+
+    bool ok() const { return f.ok; }
+
+    Vec4<Scalar> solve(const Vec4<Scalar>& b) const {
+      const Scalar in[4] = {b.x1, b.x2, b.x3, b.x4};
+      Scalar x[4];
+      f.solve(in, x);
+      return Vec4<Scalar>(x[0], x[1], x[2], x[3]);
+    }
+
+  private:
+    detail::CholeskyFactor<4, Scalar> f;
+  };
+
+  /*
+    Solves m x = b by LU with partial pivoting. This is backward stable,
+    where inverse(m) * b loses accuracy with the condition of m, but at
+    these sizes it is not faster: the adjugate has no serial division
+    chain. Like inverse, these do not check for singularity; use
+    Lu33 / Lu44 and ok() for that.
+   */
+  template<typename Scalar>
+  Vec3<Scalar> solve(const Mat33<Scalar>& m, const Vec3<Scalar>& b) {
+    return Lu33<Scalar>(m).solve(b);
+  }
+
+  template<typename Scalar>
+  Vec4<Scalar> solve(const Mat44<Scalar>& m, const Vec4<Scalar>& b) {
+    return Lu44<Scalar>(m).solve(b);
+  }
+
+  /*
+    Batched solves of m[i] x[i] = b[i] over the entries [begin, end); x
+    must already hold m.size() vectors. ok[i] is the factorization's ok().
+   */
+  template<typename Scalar>
+  void solve(const Mat33Array<Scalar>& m, const Vec3Array<Scalar>& b, Vec3Array<Scalar>& x,
+	     unsigned char* ok, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      const Lu33<Scalar> lu(m[i]);
+      x.set(i, lu.solve(b[i]));
+      ok[i] = lu.ok() ? 1 : 0;
+    }
+  }
+
+  // Whole-array form; x is resized, ok must hold m.size() entries.
+  template<typename Scalar>
+  void solve(const Mat33Array<Scalar>& m, const Vec3Array<Scalar>& b, Vec3Array<Scalar>& x,
+	     unsigned char* ok) {
+    x.resize(m.size());
+    solve(m, b, x, ok, 0, m.size());
+  }
+
+  template<typename Scalar>
+  void solve(const Mat44Array<Scalar>& m, const Vec4Array<Scalar>& b, Vec4Array<Scalar>& x,
+	     unsigned char* ok, std::size_t begin, std::size_t end) {
+    for (std::size_t i = begin; i < end; ++i) {
+      const Lu44<Scalar> lu(m[i]);
+      x.set(i, lu.solve(b[i]));
+      ok[i] = lu.ok() ? 1 : 0;
+    }
+  }
+
+  template<typename Scalar>
+  void solve(const Mat44Array<Scalar>& m, const Vec4Array<Scalar>& b, Vec4Array<Scalar>& x,
+	     unsigned char* ok) {
+    x.resize(m.size());
+    solve(m, b, x, ok, 0, m.size());
+  }
+
+  /*
+    Mixed-precision iterative refinement: m x = b solved to the accuracy
+    of Scalar with only the inverse X computed in Low, by default float.
+    x starts at X b; each iteration computes the residual r = b - m x in
+    Scalar and adds the correction X r. Each iteration shrinks the error
+    by about rho = kappa u_Low, where kappa is the Frobenius condition
+    number |m| |X| (the square root of condition_number) and u_Low is
+    half of epsilon(Low). After k iterations the error is about
+    rho^(k + 1).
+
+    converged is true when that has fallen to kappa u_Scalar, the accuracy
+    of a solve in Scalar. With double, float and the default two
+    iterations this holds for kappa up to about 700; each further
+    iteration raises the limit. converged is also false when the Low
+    inverse is rejected as by try_inverse; x is then zero. m is scaled by
+    its largest entry before rounding to Low, so its range is that of
+    Scalar.
+   */
+  template<typename Vector, typename Scalar>
+  struct RefinedSolution {
+    Vector x;
+    Scalar condition_estimate;
+    bool converged;
+  };
+
+  namespace detail {
+
+    // The largest kappa^2 for which the refinement converges: solving
+    // (kappa u_Low)^(k + 1) <= kappa u_Scalar for kappa gives
+    // (u_Scalar / u_Low)^(1 / k) / u_Low, which tends to 1 / u_Low.
+    template<typename Scalar, typename Low>
+    Scalar refinement_limit(int iterations) {
+      const double u = double(std::numeric_limits<Scalar>::epsilon()) / 2;
+      const double u_low = double(std::numeric_limits<Low>::epsilon()) / 2;
+      if (iterations <= 0) {
+	return u_low <= u ? std::numeric_limits<Scalar>::infinity() : Scalar(0);
+      }
+      return Scalar(std::pow(u / u_low, 2.0 / iterations) / (u_low * u_low));
+    }
+
+    // Entry i of the lanes of an N x N matrix, times c and rounded to Low.
+    template<typename Low, typename Scalar>
+    Mat33<Low> narrow(const Scalar* const* m, std::size_t i, Scalar c, std::integral_constant<int, 3>) {
+      return Mat33<Low>{
+	Low(c * m[0][i]), Low(c * m[1][i]), Low(c * m[2][i]),
+	Low(c * m[3][i]), Low(c * m[4][i]), Low(c * m[5][i]),
+	Low(c * m[6][i]), Low(c * m[7][i]), Low(c * m[8][i])};
+    }
+
+    template<typename Low, typename Scalar>
+    Mat44<Low> narrow(const Scalar* const* m, std::size_t i, Scalar c, std::integral_constant<int, 4>) {
+      return Mat44<Low>{
+	Low(c * m[0][i]), Low(c * m[1][i]), Low(c * m[2][i]), Low(c * m[3][i]),
+	Low(c * m[4][i]), Low(c * m[5][i]), Low(c * m[6][i]), Low(c * m[7][i]),
+	Low(c * m[8][i]), Low(c * m[9][i]), Low(c * m[10][i]), Low(c * m[11][i]),
+	Low(c * m[12][i]), Low(c * m[13][i]), Low(c * m[14][i]), Low(c * m[15][i])};
+    }
+
+    // 1 / max |m_ij|, or 1 for a zero matrix. Any approximate inverse
+    // serves, so the scale need not be exact.
+    template<int N, typename Scalar>
+    Scalar refinement_scale(const Scalar* const* m, std::size_t i) {
+      Scalar big = Scalar(0);
+      for (int k = 0; k < N * N; ++k) {
+	big = abs(m[k][i]) > big ? abs(m[k][i]) : big;
+      }
+      return big > Scalar(0) ? Scalar(1) / big : Scalar(1);
+    }
+
+    /*
+      The refinement of the n entries from begin, given the lanes of m, b
+      and x, row-major; a single matrix is one entry of lanes of length
+      one. The Low inverses and the solutions are kept in local arrays,
+      which cannot alias the lanes, so that each loop can vectorize across
+      matrices, the 3x3 Low inversion over twice as many lanes as the
+      others. Rejection is an added infinity rather than a branch, which
+      the vectorizer could not if-convert.
+     */
+    const std::size_t refine_block = 128;
+
+    template<int N, typename Scalar, typename Low>
+    void refine_block_lanes(const Scalar* const* m, const Scalar* const* b, Scalar* const* x,
+			    Scalar* kappa2, bool* converged, int iterations,
+			    std::size_t begin, std::size_t n) {
+      Scalar scale[refine_block];
+      Low inv[N * N][refine_block];
+      Scalar rejected[refine_block];
+      Scalar xs[N][refine_block];
+
+      for (std::size_t t = 0; t < n; ++t) {
+	scale[t] = refinement_scale<N>(m, begin + t);
+      }
+
+      // The inverses by the adjugate, rejected as by try_inverse.
+      const Low tol = 64 * std::numeric_limits<Low>::epsilon();
+      for (std::size_t t = 0; t < n; ++t) {
+	const auto a = narrow<Low>(m, begin + t, scale[t], std::integral_constant<int, N>());
+	const auto adj = adjugate(a);
+	const Low* e = &a.x11;
+	const Low* f = &adj.x11;
+	Low d = Low(0), rows = Low(1);
+	for (int i = 0; i < N; ++i) {
+	  d += e[i] * f[N * i];
+	  Low r = Low(0);
+	  for (int j = 0; j < N; ++j) {
+	    r += e[N * i + j] * e[N * i + j];
+	  }
+	  rows *= r;
+	}
+	const bool good = d * d > tol * tol * rows;
+	const Low inv_d = Low(1) / (good ? d : Low(1));
+	const Low g = good ? Low(1) : Low(0);
+	rejected[t] = good ? Scalar(0) : std::numeric_limits<Scalar>::infinity();
+	for (int i = 0; i < N; ++i) {
+	  for (int j = 0; j < N; ++j) {
+	    inv[N * i + j][t] = g * (f[N * i + j] * inv_d);
+	  }
+	}
+      }
+
+      for (std::size_t t = 0; t < n; ++t) {
+	for (int i = 0; i < N; ++i) {
+	  Scalar s = Scalar(0);
+	  for (int j = 0; j < N; ++j) {
+	    s += Scalar(inv[N * i + j][t]) * b[j][begin + t];
+	  }
+	  xs[i][t] = scale[t] * s;
+	}
+      }
+
+      for (int k = 0; k < iterations; ++k) {
+	for (std::size_t t = 0; t < n; ++t) {
+	  Scalar r[N];
+	  for (int i = 0; i < N; ++i) {
+	    Scalar s = b[i][begin + t];
+	    for (int j = 0; j < N; ++j) {
+	      s -= m[N * i + j][begin + t] * xs[j][t];
+	    }
+	    r[i] = s;
+	  }
+	  for (int i = 0; i < N; ++i) {
+	    Scalar s = Scalar(0);
+	    for (int j = 0; j < N; ++j) {
+	      s += Scalar(inv[N * i + j][t]) * r[j];
+	    }
+	    xs[i][t] += scale[t] * s;
+	  }
+	}
+      }
+
+      // kappa^2 = |m|^2 |X|^2 with X = scale inv, infinite if rejected.
+      const Scalar limit = refinement_limit<Scalar, Low>(iterations);
+      Scalar k2s[refine_block];
+      for (std::size_t t = 0; t < n; ++t) {
+	Scalar norm = Scalar(0), norm_inv = Scalar(0);
+	for (int i = 0; i < N; ++i) {
+	  for (int j = 0; j < N; ++j) {
+	    const Scalar a = m[N * i + j][begin + t], c = Scalar(inv[N * i + j][t]);
+	    norm += a * a;
+	    norm_inv += c * c;
+	  }
+	}
+	k2s[t] = norm * norm_inv * (scale[t] * scale[t]) + rejected[t];
+      }
+      for (std::size_t t = 0; t < n; ++t) {
+	kappa2[t] = k2s[t];
+	converged[t] = k2s[t] <= limit;
+      }
+      for (int i = 0; i < N; ++i) {
+	for (std::size_t t = 0; t < n; ++t) {
+	  x[i][begin + t] = xs[i][t];
+	}
+      }
+    }
+
+  }
+
+  template<typename Scalar, typename Low = float>
+  RefinedSolution<Vec3<Scalar>, Scalar> refined_solve(const Mat33<Scalar>& m, const Vec3<Scalar>& b,
+						       int iterations = 2) {
+    const Scalar* a = &m.x11;
+    const Scalar* const lanes[9] = {a, a + 1, a + 2, a + 3, a + 4, a + 5, a + 6, a + 7, a + 8};
+    const Scalar* const bl[3] = {&b.x1, &b.x2, &b.x3};
+    Scalar x[3];
+    Scalar* const xl[3] = {x, x + 1, x + 2};
+    Scalar kappa2;
+    bool converged;
+    detail::refine_block_lanes<3, Scalar, Low>(lanes, bl, xl, &kappa2, &converged, iterations, 0, 1);
+    return RefinedSolution<Vec3<Scalar>, Scalar>{
+      Vec3<Scalar>(x[0], x[1], x[2]), sqrt(kappa2), converged};
+  }
+
+  template<typename Scalar, typename Low = float>
+  RefinedSolution<Vec4<Scalar>, Scalar> refined_solve(const Mat44<Scalar>& m, const Vec4<Scalar>& b,
+						       int iterations = 2) {
+    const Scalar* a = &m.x11;
+    const Scalar* const lanes[16] = {
+      a, a + 1, a + 2, a + 3, a + 4, a + 5, a + 6, a + 7,
+      a + 8, a + 9, a + 10, a + 11, a + 12, a + 13, a + 14, a + 15};
+    const Scalar* const bl[4] = {&b.x1, &b.x2, &b.x3, &b.x4};
+    Scalar x[4];
+    Scalar* const xl[4] = {x, x + 1, x + 2, x + 3};
+    Scalar kappa2;
+    bool converged;
+    detail::refine_block_lanes<4, Scalar, Low>(lanes, bl, xl, &kappa2, &converged, iterations, 0, 1);
+    return RefinedSolution<Vec4<Scalar>, Scalar>{
+      Vec4<Scalar>(x[0], x[1], x[2], x[3]), sqrt(kappa2), converged};
+  }
+
+  /*
+    Batched refinement over the entries [begin, end), in blocks of
+    detail::refine_block; x must already hold m.size() vectors.
+    converged[i] is that of the single-value refined_solve, which runs the
+    same kernel on one entry.
+   */
+  template<typename Scalar, typename Low = float>
+  void refined_solve(const Mat33Array<Scalar>& m, const Vec3Array<Scalar>& b, Vec3Array<Scalar>& x,
+		     unsigned char* converged, int iterations, std::size_t begin, std::size_t end) {
+    const Scalar* const a[9] = {
+      m.x11.data(), m.x12.data(), m.x13.data(),
+      m.x21.data(), m.x22.data(), m.x23.data(),
+      m.x31.data(), m.x32.data(), m.x33.data()};
+    const Scalar* const bl[3] = {b.x1.data(), b.x2.data(), b.x3.data()};
+    Scalar* const xl[3] = {x.x1.data(), x.x2.data(), x.x3.data()};
+    Scalar kappa2[detail::refine_block];
+    bool ok[detail::refine_block];
+
+    for (std::size_t s = begin; s < end; s += detail::refine_block) {
+      const std::size_t n = end - s < detail::refine_block ? end - s : detail::refine_block;
+      detail::refine_block_lanes<3, Scalar, Low>(a, bl, xl, kappa2, ok, iterations, s, n);
+      for (std::size_t t = 0; t < n; ++t) {
+	converged[s + t] = ok[t] ? 1 : 0;
+      }
+    }
+  }
+
+  // Whole-array form; x is resized, converged must hold m.size() entries.
+  template<typename Scalar, typename Low = float>
+  void refined_solve(const Mat33Array<Scalar>& m, const Vec3Array<Scalar>& b, Vec3Array<Scalar>& x,
+		     unsigned char* converged, int iterations = 2) {
+    x.resize(m.size());
+    refined_solve<Scalar, Low>(m, b, x, converged, iterations, 0, m.size());
+  }
+
+  template<typename Scalar, typename Low = float>
+  void refined_solve(const Mat44Array<Scalar>& m, const Vec4Array<Scalar>& b, Vec4Array<Scalar>& x,
+		     unsigned char* converged, int iterations, std::size_t begin, std::size_t end) {
+    const Scalar* const a[16] = {
+      m.x11.data(), m.x12.data(), m.x13.data(), m.x14.data(),
+      m.x21.data(), m.x22.data(), m.x23.data(), m.x24.data(),
+      m.x31.data(), m.x32.data(), m.x33.data(), m.x34.data(),
+      m.x41.data(), m.x42.data(), m.x43.data(), m.x44.data()};
+    const Scalar* const bl[4] = {b.x1.data(), b.x2.data(), b.x3.data(), b.x4.data()};
+    Scalar* const xl[4] = {x.x1.data(), x.x2.data(), x.x3.data(), x.x4.data()};
+    Scalar kappa2[detail::refine_block];
+    bool ok[detail::refine_block];
+
+    for (std::size_t s = begin; s < end; s += detail::refine_block) {
+      const std::size_t n = end - s < detail::refine_block ? end - s : detail::refine_block;
+      detail::refine_block_lanes<4, Scalar, Low>(a, bl, xl, kappa2, ok, iterations, s, n);
+      for (std::size_t t = 0; t < n; ++t) {
+	converged[s + t] = ok[t] ? 1 : 0;
+      }
+    }
+  }
+
+  template<typename Scalar, typename Low = float>
+  void refined_solve(const Mat44Array<Scalar>& m, const Vec4Array<Scalar>& b, Vec4Array<Scalar>& x,
+		     unsigned char* converged, int iterations = 2) {
+    x.resize(m.size());
+    refined_solve<Scalar, Low>(m, b, x, converged, iterations, 0, m.size());
+  }
+
+  // Explicit instantiations for float and double; see instantiate.h.
+#define VERIFIED_MATH_SOLVE_TEMPLATES(instantiate, Scalar) \
+  instantiate Vec3<Scalar> solve(const Mat33<Scalar>&, const Vec3<Scalar>&); \
+  instantiate Vec4<Scalar> solve(const Mat44<Scalar>&, const Vec4<Scalar>&); \
+  instantiate void solve(const Mat33Array<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&, unsigned char*, std::size_t, std::size_t); \
+  instantiate void solve(const Mat33Array<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&, unsigned char*); \
+  instantiate void solve(const Mat44Array<Scalar>&, const Vec4Array<Scalar>&, Vec4Array<Scalar>&, unsigned char*, std::size_t, std::size_t); \
+  instantiate void solve(const Mat44Array<Scalar>&, const Vec4Array<Scalar>&, Vec4Array<Scalar>&, unsigned char*); \
+  instantiate RefinedSolution<Vec3<Scalar>, Scalar> refined_solve(const Mat33<Scalar>&, const Vec3<Scalar>&, int); \
+  instantiate RefinedSolution<Vec4<Scalar>, Scalar> refined_solve(const Mat44<Scalar>&, const Vec4<Scalar>&, int); \
+  instantiate void refined_solve(const Mat33Array<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&, unsigned char*, int, std::size_t, std::size_t); \
+  instantiate void refined_solve(const Mat33Array<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&, unsigned char*, int); \
+  instantiate void refined_solve(const Mat44Array<Scalar>&, const Vec4Array<Scalar>&, Vec4Array<Scalar>&, unsigned char*, int, std::size_t, std::size_t); \
+  instantiate void refined_solve(const Mat44Array<Scalar>&, const Vec4Array<Scalar>&, Vec4Array<Scalar>&, unsigned char*, int);
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_SOLVE_TEMPLATES)
+#endif
+
+}
+
+#endif // SOLVE_H
@@ -0,0 +1,296 @@
+#ifndef THREAD_POOL_H
+#define THREAD_POOL_H
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdlib>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace verified_math {
+
+  /*
+    A small work-stealing thread pool.
+
+    Each worker owns a task queue. A worker takes work from the back of its
+    own queue and, when that is empty, steals from the front of the others.
+    A pool of size n runs n - 1 worker threads; the thread that waits for a
+    batch of tasks runs tasks too, so a pool of size 1 runs everything on
+    the caller and nested parallel loops cannot deadlock.
+   */
+  class ThreadPool {
+  public:
+    // threads == 0 selects the hardware concurrency.
+    explicit ThreadPool(unsigned threads = 0)
+      : stopping(false), queued(0) {
+      if (threads == 0) {
+	threads = std::max(1u, std::thread::hardware_concurrency());
+      }
+      for (unsigned i = 0; i < threads; ++i) {
+	queues.push_back(std::unique_ptr<Queue>(new Queue()));
+      }
+      for (unsigned i = 1; i < threads; ++i) {
+	workers.push_back(std::thread([this, i]() { work(i); }));
+      }
+    }
+
+    ~ThreadPool() {
+      {
+	std::lock_guard<std::mutex> lock(sleep_mutex);
+	stopping = true;
+      }
+      wake.notify_all();
+      for (std::size_t i = 0; i < workers.size(); ++i) {
+	workers[i].join();
+      }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // The number of threads that run tasks, counting the waiting caller.
+    unsigned size() const {
+      return static_cast<unsigned>(queues.size());
+    }
+
+    // Queues a task on the given worker (modulo size()); queue 0 belongs
+    // to whichever thread is waiting.
+    void submit(std::function<void()> task, unsigned worker = 0) {
+      Queue& q = *queues[worker % queues.size()];
+      {
+	// Count under the queue lock so a thief never sees the task before
+	// the count (locks are always taken queue first, then sleep_mutex).
+	std::lock_guard<std::mutex> lock(q.mutex);
+	q.tasks.push_back(std::move(task));
+	std::lock_guard<std::mutex> count_lock(sleep_mutex);
+	++queued;
+      }
+      wake.notify_one();
+    }
+
+    // Runs one queued task, preferring the given queue. Returns false if
+    // every queue was empty.
+    bool run_one(unsigned worker = 0) {
+      std::function<void()> task;
+      if (!take(worker % queues.size(), task)) {
+	return false;
+      }
+      task();
+      return true;
+    }
+
+    /*
+      The pool shared by the parallel algorithms when none is given. Its
+      size is the VERIFIED_MATH_THREADS environment variable if set, and
+      the hardware concurrency otherwise.
+     */
+    static ThreadPool& global() {
+      static ThreadPool pool(global_size());
+      return pool;
+    }
+
+  private:
+    struct Queue {
+      std::mutex mutex;
+      std::deque<std::function<void()> > tasks;
+    };
+
+    static unsigned global_size() {
+      const char* value = std::getenv("VERIFIED_MATH_THREADS");
+      return value != nullptr ? static_cast<unsigned>(std::strtoul(value, nullptr, 10)) : 0u;
+    }
+
+    bool take(std::size_t self, std::function<void()>& task) {
+      const std::size_t n = queues.size();
+      for (std::size_t k = 0; k < n; ++k) {
+	Queue& q = *queues[(self + k) % n];
+	std::lock_guard<std::mutex> lock(q.mutex);
+	if (q.tasks.empty()) {
+	  continue;
+	}
+	// Own queue from the back (most recently queued, still in cache);
+	// others from the front (oldest, farthest from their owner's work).
+	if (k == 0) {
+	  task = std::move(q.tasks.back());
+	  q.tasks.pop_back();
+	} else {
+	  task = std::move(q.tasks.front());
+	  q.tasks.pop_front();
+	}
+	std::lock_guard<std::mutex> count_lock(sleep_mutex);
+	--queued;
+	return true;
+      }
+      return false;
+    }
+
+    void work(std::size_t self) {
+      for (;;) {
+	std::function<void()> task;
+	if (take(self, task)) {
+	  task();
+	  continue;
+	}
+	std::unique_lock<std::mutex> lock(sleep_mutex);
+	wake.wait(lock, [this]() { return stopping || queued > 0; });
+	if (stopping && queued == 0) {
+	  return;
+	}
+      }
+    }
+
+    std::vector<std::unique_ptr<Queue> > queues;
+    std::vector<std::thread> workers;
+    std::mutex sleep_mutex;
+    std::condition_variable wake;
+    bool stopping;
+    std::size_t queued;
+  };
+
+  /*
+    How a parallel algorithm splits its range.
+
+    Ranges shorter than serial_threshold run serially on the caller. Longer
+    ones are cut into chunks sized so that one chunk's working set
+    (bytes_per_item each; 0 lets the algorithm choose) fits in
+    cache_bytes, rounded to a multiple of 64 items so chunks start on
+    cache-line and SIMD boundaries, with at most size() * chunks_per_thread
+    chunks. Consecutive chunks go to the same
+    worker, so each thread walks one contiguous part of the range; with a
+    first-touch allocation policy that keeps threads on NUMA-local pages
+    from call to call. Stealing rebalances uneven work.
+   */
+  struct Partition {
+    ThreadPool* pool;
+    std::size_t serial_threshold;
+    std::size_t bytes_per_item;
+    std::size_t cache_bytes;
+    std::size_t chunks_per_thread;
+
+    explicit Partition(ThreadPool* _pool = nullptr, std::size_t _serial_threshold = 16384,
+		       std::size_t _bytes_per_item = 0)
+      : pool(_pool), serial_threshold(_serial_threshold), bytes_per_item(_bytes_per_item),
+	cache_bytes(256 * 1024), chunks_per_thread(8) { }
+
+    ThreadPool& executor() const {
+      return pool != nullptr ? *pool : ThreadPool::global();
+    }
+
+    std::size_t chunk_size(std::size_t n, unsigned threads) const {
+      const std::size_t line = 64;
+      const std::size_t bytes = bytes_per_item != 0 ? bytes_per_item : 64;
+      std::size_t chunk = std::max<std::size_t>(line, cache_bytes / bytes);
+      const std::size_t max_chunks = std::max<std::size_t>(1, threads * chunks_per_thread);
+      chunk = std::max(chunk, (n + max_chunks - 1) / max_chunks);
+      return (chunk + line - 1) / line * line;
+    }
+  };
+
+  /*
+    Calls f(b, e) over disjoint subranges [b, e) covering [begin, end),
+    possibly concurrently, and returns when all calls have finished. The
+    first exception thrown by f is rethrown here.
+   */
+  template<typename F>
+  void parallel_for(std::size_t begin, std::size_t end, F f, const Partition& p = Partition()) {
+    if (end <= begin) {
+      return;
+    }
+    const std::size_t n = end - begin;
+    ThreadPool& pool = p.executor();
+    if (n < p.serial_threshold || pool.size() == 1) {
+      f(begin, end);
+      return;
+    }
+
+    const std::size_t chunk = p.chunk_size(n, pool.size());
+    const std::size_t chunks = (n + chunk - 1) / chunk;
+    std::atomic<std::size_t> remaining(chunks);
+    std::mutex error_mutex;
+    std::exception_ptr error;
+
+    for (std::size_t c = 0; c < chunks; ++c) {
+      const std::size_t b = begin + c * chunk;
+      const std::size_t e = std::min(end, b + chunk);
+      const unsigned worker = static_cast<unsigned>(c * pool.size() / chunks);
+      pool.submit([&, b, e]() {
+	  try {
+	    f(b, e);
+	  } catch (...) {
+	    std::lock_guard<std::mutex> lock(error_mutex);
+	    if (!error) {
+	      error = std::current_exception();
+	    }
+	  }
+	  remaining.fetch_sub(1);
+	}, worker);
+    }
+
+    // Help until every chunk has run.
+    while (remaining.load() > 0) {
+      if (!pool.run_one(0)) {
+	std::this_thread::yield();
+      }
+    }
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  /*
+    out[i] = op(in[i]) for i in [0, n). out may alias in.
+   */
+  template<typename T, typename U, typename Op>
+  void parallel_transform(const T* in, U* out, std::size_t n, Op op,
+			  const Partition& p = Partition()) {
+    parallel_for(0, n, [=](std::size_t b, std::size_t e) {
+	for (std::size_t i = b; i < e; ++i) {
+	  out[i] = op(in[i]);
+	}
+      }, p);
+  }
+
+  /*
+    Reduces [begin, end): map(b, e) gives the partial result of a subrange
+    and combine folds partial results, starting from identity. Partial
+    results are combined in range order, so with a fixed Partition and
+    thread count the result is deterministic even for floating point.
+   */
+  template<typename T, typename Map, typename Combine>
+  T parallel_reduce(std::size_t begin, std::size_t end, T identity, Map map, Combine combine,
+		    const Partition& p = Partition()) {
+    if (end <= begin) {
+      return identity;
+    }
+    const std::size_t n = end - begin;
+    ThreadPool& pool = p.executor();
+    if (n < p.serial_threshold || pool.size() == 1) {
+      return combine(identity, map(begin, end));
+    }
+
+    const std::size_t chunk = p.chunk_size(n, pool.size());
+    std::vector<T> partial((n + chunk - 1) / chunk, identity);
+    parallel_for(begin, end, [&](std::size_t b, std::size_t e) {
+	// Chunks never straddle the chunk grid, so b identifies the slot.
+	for (std::size_t c = b; c < e; c += chunk) {
+	  partial[(c - begin) / chunk] = map(c, std::min(e, c + chunk));
+	}
+      }, p);
+
+    T result = identity;
+    for (std::size_t i = 0; i < partial.size(); ++i) {
+      result = combine(result, partial[i]);
+    }
+    return result;
+  }
+
+}
+
+#endif // THREAD_POOL_H
@@ -0,0 +1,140 @@
+#ifndef VEC_H
+#define VEC_H
+
+#include "verified_math/vec3.h"
+#include "verified_math/vec4.h"
+
+#include <cstddef>
+
+namespace verified_math {
+
+  namespace detail {
+
+    /*
+      Compile-time unrolling: Unroll<0, N>::run(f) calls f(0), ..., f(N - 1)
+      with no loop, so the indices are constants after inlining.
+     */
+    template<std::size_t I, std::size_t N>
+    struct Unroll {
+      template<typename F>
+      static void run(F& f) {
+	f(I);
+	Unroll<I + 1, N>::run(f);
+      }
+    };
+
+    template<std::size_t N>
+    struct Unroll<N, N> {
+      template<typename F>
+      static void run(F&) { }
+    };
+
+    /*
+      Storage alignment: 32 or 16 bytes when the storage is a whole number of
+      SIMD registers, otherwise the natural alignment, so sizeof never grows.
+     */
+    template<typename Scalar, std::size_t Count>
+    struct StorageAlignment {
+      static const std::size_t bytes = Count * sizeof(Scalar);
+      static const std::size_t value =
+	bytes % 32 == 0 ? 32 : (bytes % 16 == 0 ? 16 : alignof(Scalar));
+    };
+
+  }
+
+  /*
+    A fixed-size N-vector. It is an aggregate, so Vec<3, double>{{1, 2, 3}}
+    (or with brace elision Vec<3, double>{1, 2, 3}) initializes it, and
+    Vec<N, Scalar>{} is zero.
+   */
+  template<std::size_t N, typename Scalar>
+  struct Vec {
+    alignas(detail::StorageAlignment<Scalar, N>::value) Scalar data[N];
+
+    Scalar& operator[](std::size_t i) { return data[i]; }
+    constexpr const Scalar& operator[](std::size_t i) const { return data[i]; }
+
+    static constexpr std::size_t size() { return N; }
+  };
+
+  /*
+    Basic vector algebra.
+  */
+  template<std::size_t N, typename Scalar>
+  Vec<N, Scalar> operator+(const Vec<N, Scalar>& x, const Vec<N, Scalar>& y) {
+    Vec<N, Scalar> result;
+    auto f = [&](std::size_t i) { result.data[i] = x.data[i] + y.data[i]; };
+    detail::Unroll<0, N>::run(f);
+    return result;
+  }
+
+  template<std::size_t N, typename Scalar>
+  Vec<N, Scalar> operator-(const Vec<N, Scalar>& x, const Vec<N, Scalar>& y) {
+    Vec<N, Scalar> result;
+    auto f = [&](std::size_t i) { result.data[i] = x.data[i] - y.data[i]; };
+    detail::Unroll<0, N>::run(f);
+    return result;
+  }
+
+  template<std::size_t N, typename Scalar>
+  Vec<N, Scalar> operator*(const Scalar c, const Vec<N, Scalar>& x) {
+    Vec<N, Scalar> result;
+    auto f = [&](std::size_t i) { result.data[i] = c * x.data[i]; };
+    detail::Unroll<0, N>::run(f);
+    return result;
+  }
+
+  template<std::size_t N, typename Scalar>
+  Vec<N, Scalar> operator*(const Vec<N, Scalar>& x, const Scalar c) {
+    Vec<N, Scalar> result;
+    auto f = [&](std::size_t i) { result.data[i] = x.data[i] * c; };
+    detail::Unroll<0, N>::run(f);
+    return result;
+  }
+
+  /*
+    Vector multiplications
+  */
+  // dot product
+  template<std::size_t N, typename Scalar>
+  Scalar dot(const Vec<N, Scalar>& x, const Vec<N, Scalar>& y) {
+    Scalar result = x.data[0] * y.data[0];
+    auto f = [&](std::size_t i) { result = result + x.data[i] * y.data[i]; };
+    detail::Unroll<1, N>::run(f);
+    return result;
+  }
+
+  // cross product
+  template<typename Scalar>
+  Vec<3, Scalar> cross(const Vec<3, Scalar>& x, const Vec<3, Scalar>& y) {
+    return Vec<3, Scalar>{{x.data[1] * y.data[2] - x.data[2] * y.data[1],
+	  x.data[2] * y.data[0] - x.data[0] * y.data[2],
+	  x.data[0] * y.data[1] - x.data[1] * y.data[0]}};
+  }
+
+  /*
+    Conversions to and from the named-field vectors.
+   */
+  template<typename Scalar>
+  Vec<3, Scalar> to_vec(const Vec3<Scalar>& v) {
+    return Vec<3, Scalar>{{v.x1, v.x2, v.x3}};
+  }
+
+  template<typename Scalar>
+  Vec<4, Scalar> to_vec(const Vec4<Scalar>& v) {
+    return Vec<4, Scalar>{{v.x1, v.x2, v.x3, v.x4}};
+  }
+
+  template<typename Scalar>
+  Vec3<Scalar> to_vec3(const Vec<3, Scalar>& v) {
+    return Vec3<Scalar>{v.data[0], v.data[1], v.data[2]};
+  }
+
+  template<typename Scalar>
+  Vec4<Scalar> to_vec4(const Vec<4, Scalar>& v) {
+    return Vec4<Scalar>{v.data[0], v.data[1], v.data[2], v.data[3]};
+  }
+
+}
+
+#endif // VEC_H
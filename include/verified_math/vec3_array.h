@@ -0,0 +1,183 @@
+#ifndef VEC3_ARRAY_H
+#define VEC3_ARRAY_H
+
+#include "verified_math/vec3.h"
+#include "verified_math/aligned_allocator.h"
+#include "verified_math/scalar_math.h"
+#include "verified_math/instantiate.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace verified_math {
+
+  /*
+    A structure-of-arrays container of 3-vectors. Each component is stored
+    in its own contiguous, aligned lane, so the batched kernels below
+    vectorize across elements.
+   */
+  template<typename Scalar>
+  class Vec3Array {
+  public:
+    typedef std::vector<Scalar, aligned_allocator<Scalar> > Lane;
+
+    Lane x1;
+    Lane x2;
+    Lane x3;
+
+    Vec3Array() { }
+
+    explicit Vec3Array(std::size_t n)
+      : x1(n), x2(n), x3(n) { }
+
+    Vec3Array(const Vec3<Scalar>* v, std::size_t n)
+      : x1(n), x2(n), x3(n) {
+      for (std::size_t i = 0; i < n; ++i) {
+	set(i, v[i]);
+      }
+    }
+
+    std::size_t size() const {
+      return x1.size();
+    }
+
+    void resize(std::size_t n) {
+      x1.resize(n);
+      x2.resize(n);
+      x3.resize(n);
+    }
+
+    void push_back(const Vec3<Scalar>& v) {
+      x1.push_back(v.x1);
+      x2.push_back(v.x2);
+      x3.push_back(v.x3);
+    }
+
+    // Element i as a Vec3, for interop with the single-vector API.
+    Vec3<Scalar> operator[](std::size_t i) const {
+      return Vec3<Scalar>{x1[i], x2[i], x3[i]};
+    }
+
+    void set(std::size_t i, const Vec3<Scalar>& v) {
+      x1[i] = v.x1;
+      x2[i] = v.x2;
+      x3[i] = v.x3;
+    }
+  };
+
+  /*
+    Batched vector algebra. x and y must be the same size (checked by
+    assert). Outputs are resized to match the inputs and may alias them.
+  */
+  template<typename Scalar>
+  void add(const Vec3Array<Scalar>& x, const Vec3Array<Scalar>& y, Vec3Array<Scalar>& out) {
+    const std::size_t n = x.size();
+    assert(y.size() == n);
+    out.resize(n);
+    const Scalar* a1 = x.x1.data(); const Scalar* a2 = x.x2.data(); const Scalar* a3 = x.x3.data();
+    const Scalar* b1 = y.x1.data(); const Scalar* b2 = y.x2.data(); const Scalar* b3 = y.x3.data();
+    Scalar* o1 = out.x1.data(); Scalar* o2 = out.x2.data(); Scalar* o3 = out.x3.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      o1[i] = a1[i] + b1[i];
+      o2[i] = a2[i] + b2[i];
+      o3[i] = a3[i] + b3[i];
+    }
+  }
+
+  template<typename Scalar>
+  void sub(const Vec3Array<Scalar>& x, const Vec3Array<Scalar>& y, Vec3Array<Scalar>& out) {
+    const std::size_t n = x.size();
+    assert(y.size() == n);
+    out.resize(n);
+    const Scalar* a1 = x.x1.data(); const Scalar* a2 = x.x2.data(); const Scalar* a3 = x.x3.data();
+    const Scalar* b1 = y.x1.data(); const Scalar* b2 = y.x2.data(); const Scalar* b3 = y.x3.data();
+    Scalar* o1 = out.x1.data(); Scalar* o2 = out.x2.data(); Scalar* o3 = out.x3.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      o1[i] = a1[i] - b1[i];
+      o2[i] = a2[i] - b2[i];
+      o3[i] = a3[i] - b3[i];
+    }
+  }
+
+  template<typename Scalar>
+  void scale(Scalar c, const Vec3Array<Scalar>& x, Vec3Array<Scalar>& out) {
+    const std::size_t n = x.size();
+    out.resize(n);
+    const Scalar* a1 = x.x1.data(); const Scalar* a2 = x.x2.data(); const Scalar* a3 = x.x3.data();
+    Scalar* o1 = out.x1.data(); Scalar* o2 = out.x2.data(); Scalar* o3 = out.x3.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      o1[i] = c * a1[i];
+      o2[i] = c * a2[i];
+      o3[i] = c * a3[i];
+    }
+  }
+
+  /*
+    Batched vector multiplications
+  */
+  // dot products; out must hold x.size() scalars
+  template<typename Scalar>
+  void dot(const Vec3Array<Scalar>& x, const Vec3Array<Scalar>& y, Scalar* out) {
+    const std::size_t n = x.size();
+    assert(y.size() == n);
+    const Scalar* a1 = x.x1.data(); const Scalar* a2 = x.x2.data(); const Scalar* a3 = x.x3.data();
+    const Scalar* b1 = y.x1.data(); const Scalar* b2 = y.x2.data(); const Scalar* b3 = y.x3.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = a1[i] * b1[i] + a2[i] * b2[i] + a3[i] * b3[i];
+    }
+  }
+
+  // cross products
+  template<typename Scalar>
+  void cross(const Vec3Array<Scalar>& x, const Vec3Array<Scalar>& y, Vec3Array<Scalar>& out) {
+    const std::size_t n = x.size();
+    assert(y.size() == n);
+    out.resize(n);
+    const Scalar* a1 = x.x1.data(); const Scalar* a2 = x.x2.data(); const Scalar* a3 = x.x3.data();
+    const Scalar* b1 = y.x1.data(); const Scalar* b2 = y.x2.data(); const Scalar* b3 = y.x3.data();
+    Scalar* o1 = out.x1.data(); Scalar* o2 = out.x2.data(); Scalar* o3 = out.x3.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      Scalar c1 = a2[i] * b3[i] - a3[i] * b2[i];
+      Scalar c2 = a3[i] * b1[i] - a1[i] * b3[i];
+      Scalar c3 = a1[i] * b2[i] - a2[i] * b1[i];
+      o1[i] = c1;
+      o2[i] = c2;
+      o3[i] = c3;
+    }
+  }
+
+  // normalization to unit length; zero vectors stay zero
+  template<typename Scalar>
+  void normalize(const Vec3Array<Scalar>& x, Vec3Array<Scalar>& out) {
+    const std::size_t n = x.size();
+    out.resize(n);
+    const Scalar* a1 = x.x1.data(); const Scalar* a2 = x.x2.data(); const Scalar* a3 = x.x3.data();
+    Scalar* o1 = out.x1.data(); Scalar* o2 = out.x2.data(); Scalar* o3 = out.x3.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      Scalar norm2 = a1[i] * a1[i] + a2[i] * a2[i] + a3[i] * a3[i];
+      Scalar inv = norm2 > Scalar(0) ? Scalar(1) / sqrt(norm2) : Scalar(0);
+      o1[i] = a1[i] * inv;
+      o2[i] = a2[i] * inv;
+      o3[i] = a3[i] * inv;
+    }
+  }
+
+  // Explicit instantiations for float and double; see instantiate.h.
+#define VERIFIED_MATH_VEC3_ARRAY_TEMPLATES(instantiate, Scalar) \
+  instantiate class Vec3Array<Scalar>; \
+  instantiate void add(const Vec3Array<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&); \
+  instantiate void sub(const Vec3Array<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&); \
+  instantiate void scale(Scalar, const Vec3Array<Scalar>&, Vec3Array<Scalar>&); \
+  instantiate void dot(const Vec3Array<Scalar>&, const Vec3Array<Scalar>&, Scalar*); \
+  instantiate void cross(const Vec3Array<Scalar>&, const Vec3Array<Scalar>&, Vec3Array<Scalar>&); \
+  instantiate void normalize(const Vec3Array<Scalar>&, Vec3Array<Scalar>&);
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_VEC3_ARRAY_TEMPLATES)
+#endif
+
+}
+
+#endif // VEC3_ARRAY_H
@@ -0,0 +1,88 @@
+#ifndef VEC3A_H
+#define VEC3A_H
+
+#include "verified_math/vec3.h"
+#include "verified_math/instantiate.h"
+
+namespace verified_math {
+
+  /*
+    A 3-vector padded to four lanes and aligned to 4 * sizeof(Scalar)
+    bytes (16 for float, 32 for double), so that it is read and written
+    with one aligned SIMD load or store. The pad lane is zero and every
+    operation keeps it zero.
+
+    Store these in an aligned_vector; convert to and from Vec3 with the
+    explicit constructor and to_vec3.
+   */
+  template<typename Scalar>
+  class alignas(4 * sizeof(Scalar)) Vec3A {
+  public:
+    Scalar x1 {0};
+    Scalar x2 {0};
+    Scalar x3 {0};
+    Scalar pad {0};
+
+    constexpr Vec3A<Scalar>(Scalar _x1, Scalar _x2, Scalar _x3)
+      : x1{_x1}, x2{_x2}, x3{_x3}, pad{0} { }
+
+    constexpr explicit Vec3A<Scalar>(const Vec3<Scalar>& v)
+      : x1{v.x1}, x2{v.x2}, x3{v.x3}, pad{0} { }
+  };
+
+  template<typename Scalar>
+  constexpr Vec3<Scalar> to_vec3(const Vec3A<Scalar>& v) {
+    return Vec3<Scalar>(v.x1, v.x2, v.x3);
+  }
+
+  /*
+    Basic vector algebra.
+  */
+  template<typename Scalar>
+  constexpr Vec3A<Scalar> operator+(const Vec3A<Scalar>& x, const Vec3A<Scalar>& y) {
+    return Vec3A<Scalar>(x.x1 + y.x1, x.x2 + y.x2, x.x3 + y.x3);
+  }
+
+  template<typename Scalar>
+  constexpr Vec3A<Scalar> operator-(const Vec3A<Scalar>& x, const Vec3A<Scalar>& y) {
+    return Vec3A<Scalar>(x.x1 - y.x1, x.x2 - y.x2, x.x3 - y.x3);
+  }
+
+  template<typename Scalar>
+  constexpr Vec3A<Scalar> operator*(Scalar c, const Vec3A<Scalar>& x) {
+    return Vec3A<Scalar>(c * x.x1, c * x.x2, c * x.x3);
+  }
+
+  template<typename Scalar>
+  constexpr Vec3A<Scalar> operator*(const Vec3A<Scalar>& x, Scalar c) {
+    return Vec3A<Scalar>(x.x1 * c, x.x2 * c, x.x3 * c);
+  }
+
+  /*
+    Vector multiplications
+  */
+  // dot product
+  template<typename Scalar>
+  constexpr Scalar dot(const Vec3A<Scalar>& x, const Vec3A<Scalar>& y) {
+    return (x.x1 * y.x1 + x.x2 * y.x2 + x.x3 * y.x3);
+  }
+
+  // cross product
+  template<typename Scalar>
+  constexpr Vec3A<Scalar> cross(const Vec3A<Scalar>& x, const Vec3A<Scalar>& y) {
+    return Vec3A<Scalar>(x.x2 * y.x3 - x.x3 * y.x2,
+			 x.x3 * y.x1 - x.x1 * y.x3,
+			 x.x1 * y.x2 - x.x2 * y.x1);
+  }
+
+  // Explicit instantiations for float and double; see instantiate.h.
+#define VERIFIED_MATH_VEC3A_TEMPLATES(instantiate, Scalar) \
+  instantiate class Vec3A<Scalar>;
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_VEC3A_TEMPLATES)
+#endif
+
+}
+
+#endif // VEC3A_H
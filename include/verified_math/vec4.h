@@ -1,6 +1,8 @@
 #ifndef VEC4_H
 #define VEC4_H
 
+#include "verified_math/instantiate.h"
+
 namespace verified_math {
 
   template <typename Scalar>
@@ -11,7 +13,7 @@ namespace verified_math {
     Scalar x3 {0.0};
     Scalar x4 {0.0};
 
-    Vec4<Scalar>(Scalar _x1, Scalar _x2, Scalar _x3, Scalar _x4)
+    constexpr Vec4<Scalar>(Scalar _x1, Scalar _x2, Scalar _x3, Scalar _x4)
       : x1{_x1}, x2{_x2}, x3{_x3}, x4{_x4} { }
   };
 
@@ -19,25 +21,25 @@ namespace verified_math {
     Basic vector algebra.
   */
   template<typename Scalar>
-  Vec4<Scalar> operator+(const Vec4<Scalar>& x, const Vec4<Scalar>& y) {
+  constexpr Vec4<Scalar> operator+(const Vec4<Scalar>& x, const Vec4<Scalar>& y) {
     return Vec4<Scalar>(x.x1 + y.x1, x.x2 + y.x2, 
 			x.x3 + y.x3, x.x4 + y.x4);
   }
 
   template<typename Scalar>
-  Vec4<Scalar> operator-(const Vec4<Scalar>& x, const Vec4<Scalar>& y) {
+  constexpr Vec4<Scalar> operator-(const Vec4<Scalar>& x, const Vec4<Scalar>& y) {
     return Vec4<Scalar>(x.x1 - y.x1, x.x2 - y.x2, 
 			x.x3 - y.x3, x.x4 - y.x4);
   }
 
   template<typename Scalar>
-  Vec4<Scalar> operator*(const Scalar c, const Vec4<Scalar>& x) {
+  constexpr Vec4<Scalar> operator*(const Scalar c, const Vec4<Scalar>& x) {
     return Vec4<Scalar>(c * x.x1, c * x.x2, 
 			c * x.x3, c * x.x4);
   }
 
   template<typename Scalar>
-  Vec4<Scalar> operator*(const Vec4<Scalar>& x, Scalar c) {
+  constexpr Vec4<Scalar> operator*(const Vec4<Scalar>& x, Scalar c) {
     return Vec4<Scalar>(x.x1 * c, x.x2 * c, 
 			x.x3 * c, x.x4 * c);
   }
@@ -47,11 +49,19 @@ namespace verified_math {
   */
   // dot product
   template<typename Scalar>
-  Scalar dot(const Vec4<Scalar>& x, const Vec4<Scalar>& y) {
+  constexpr Scalar dot(const Vec4<Scalar>& x, const Vec4<Scalar>& y) {
     return (x.x1 * y.x1 + x.x2 * y.x2 + 
 	    x.x3 * y.x3 + x.x4 * y.x4);
   }
 
+  // Explicit instantiations for float and double; see instantiate.h.
+#define VERIFIED_MATH_VEC4_TEMPLATES(instantiate, Scalar) \
+  instantiate class Vec4<Scalar>;
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_VEC4_TEMPLATES)
+#endif
+
 }
 
 #endif // VEC3_H
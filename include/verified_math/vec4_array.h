@@ -0,0 +1,171 @@
+#ifndef VEC4_ARRAY_H
+#define VEC4_ARRAY_H
+
+#include "verified_math/vec4.h"
+#include "verified_math/aligned_allocator.h"
+#include "verified_math/scalar_math.h"
+#include "verified_math/instantiate.h"
+
+#include <cassert>
+#include <cmath>
+#include <cstddef>
+#include <vector>
+
+namespace verified_math {
+
+  /*
+    A structure-of-arrays container of 4-vectors. Each component is stored
+    in its own contiguous, aligned lane, so the batched kernels below
+    vectorize across elements.
+   */
+  template<typename Scalar>
+  class Vec4Array {
+  public:
+    typedef std::vector<Scalar, aligned_allocator<Scalar> > Lane;
+
+    Lane x1;
+    Lane x2;
+    Lane x3;
+    Lane x4;
+
+    Vec4Array() { }
+
+    explicit Vec4Array(std::size_t n)
+      : x1(n), x2(n), x3(n), x4(n) { }
+
+    Vec4Array(const Vec4<Scalar>* v, std::size_t n)
+      : x1(n), x2(n), x3(n), x4(n) {
+      for (std::size_t i = 0; i < n; ++i) {
+	set(i, v[i]);
+      }
+    }
+
+    std::size_t size() const {
+      return x1.size();
+    }
+
+    void resize(std::size_t n) {
+      x1.resize(n);
+      x2.resize(n);
+      x3.resize(n);
+      x4.resize(n);
+    }
+
+    void push_back(const Vec4<Scalar>& v) {
+      x1.push_back(v.x1);
+      x2.push_back(v.x2);
+      x3.push_back(v.x3);
+      x4.push_back(v.x4);
+    }
+
+    // Element i as a Vec4, for interop with the single-vector API.
+    Vec4<Scalar> operator[](std::size_t i) const {
+      return Vec4<Scalar>{x1[i], x2[i], x3[i], x4[i]};
+    }
+
+    void set(std::size_t i, const Vec4<Scalar>& v) {
+      x1[i] = v.x1;
+      x2[i] = v.x2;
+      x3[i] = v.x3;
+      x4[i] = v.x4;
+    }
+  };
+
+  /*
+    Batched vector algebra. x and y must be the same size (checked by
+    assert). Outputs are resized to match the inputs and may alias them.
+  */
+  template<typename Scalar>
+  void add(const Vec4Array<Scalar>& x, const Vec4Array<Scalar>& y, Vec4Array<Scalar>& out) {
+    const std::size_t n = x.size();
+    assert(y.size() == n);
+    out.resize(n);
+    const Scalar* a1 = x.x1.data(); const Scalar* a2 = x.x2.data(); const Scalar* a3 = x.x3.data(); const Scalar* a4 = x.x4.data();
+    const Scalar* b1 = y.x1.data(); const Scalar* b2 = y.x2.data(); const Scalar* b3 = y.x3.data(); const Scalar* b4 = y.x4.data();
+    Scalar* o1 = out.x1.data(); Scalar* o2 = out.x2.data(); Scalar* o3 = out.x3.data(); Scalar* o4 = out.x4.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      o1[i] = a1[i] + b1[i];
+      o2[i] = a2[i] + b2[i];
+      o3[i] = a3[i] + b3[i];
+      o4[i] = a4[i] + b4[i];
+    }
+  }
+
+  template<typename Scalar>
+  void sub(const Vec4Array<Scalar>& x, const Vec4Array<Scalar>& y, Vec4Array<Scalar>& out) {
+    const std::size_t n = x.size();
+    assert(y.size() == n);
+    out.resize(n);
+    const Scalar* a1 = x.x1.data(); const Scalar* a2 = x.x2.data(); const Scalar* a3 = x.x3.data(); const Scalar* a4 = x.x4.data();
+    const Scalar* b1 = y.x1.data(); const Scalar* b2 = y.x2.data(); const Scalar* b3 = y.x3.data(); const Scalar* b4 = y.x4.data();
+    Scalar* o1 = out.x1.data(); Scalar* o2 = out.x2.data(); Scalar* o3 = out.x3.data(); Scalar* o4 = out.x4.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      o1[i] = a1[i] - b1[i];
+      o2[i] = a2[i] - b2[i];
+      o3[i] = a3[i] - b3[i];
+      o4[i] = a4[i] - b4[i];
+    }
+  }
+
+  template<typename Scalar>
+  void scale(Scalar c, const Vec4Array<Scalar>& x, Vec4Array<Scalar>& out) {
+    const std::size_t n = x.size();
+    out.resize(n);
+    const Scalar* a1 = x.x1.data(); const Scalar* a2 = x.x2.data(); const Scalar* a3 = x.x3.data(); const Scalar* a4 = x.x4.data();
+    Scalar* o1 = out.x1.data(); Scalar* o2 = out.x2.data(); Scalar* o3 = out.x3.data(); Scalar* o4 = out.x4.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      o1[i] = c * a1[i];
+      o2[i] = c * a2[i];
+      o3[i] = c * a3[i];
+      o4[i] = c * a4[i];
+    }
+  }
+
+  /*
+    Batched vector multiplications
+  */
+  // dot products; out must hold x.size() scalars
+  template<typename Scalar>
+  void dot(const Vec4Array<Scalar>& x, const Vec4Array<Scalar>& y, Scalar* out) {
+    const std::size_t n = x.size();
+    assert(y.size() == n);
+    const Scalar* a1 = x.x1.data(); const Scalar* a2 = x.x2.data(); const Scalar* a3 = x.x3.data(); const Scalar* a4 = x.x4.data();
+    const Scalar* b1 = y.x1.data(); const Scalar* b2 = y.x2.data(); const Scalar* b3 = y.x3.data(); const Scalar* b4 = y.x4.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      out[i] = a1[i] * b1[i] + a2[i] * b2[i] + a3[i] * b3[i] + a4[i] * b4[i];
+    }
+  }
+
+  // normalization to unit length; zero vectors stay zero
+  template<typename Scalar>
+  void normalize(const Vec4Array<Scalar>& x, Vec4Array<Scalar>& out) {
+    const std::size_t n = x.size();
+    out.resize(n);
+    const Scalar* a1 = x.x1.data(); const Scalar* a2 = x.x2.data(); const Scalar* a3 = x.x3.data(); const Scalar* a4 = x.x4.data();
+    Scalar* o1 = out.x1.data(); Scalar* o2 = out.x2.data(); Scalar* o3 = out.x3.data(); Scalar* o4 = out.x4.data();
+    for (std::size_t i = 0; i < n; ++i) {
+      Scalar norm2 = a1[i] * a1[i] + a2[i] * a2[i] + a3[i] * a3[i] + a4[i] * a4[i];
+      Scalar inv = norm2 > Scalar(0) ? Scalar(1) / sqrt(norm2) : Scalar(0);
+      o1[i] = a1[i] * inv;
+      o2[i] = a2[i] * inv;
+      o3[i] = a3[i] * inv;
+      o4[i] = a4[i] * inv;
+    }
+  }
+
+  // Explicit instantiations for float and double; see instantiate.h.
+#define VERIFIED_MATH_VEC4_ARRAY_TEMPLATES(instantiate, Scalar) \
+  instantiate class Vec4Array<Scalar>; \
+  instantiate void add(const Vec4Array<Scalar>&, const Vec4Array<Scalar>&, Vec4Array<Scalar>&); \
+  instantiate void sub(const Vec4Array<Scalar>&, const Vec4Array<Scalar>&, Vec4Array<Scalar>&); \
+  instantiate void scale(Scalar, const Vec4Array<Scalar>&, Vec4Array<Scalar>&); \
+  instantiate void dot(const Vec4Array<Scalar>&, const Vec4Array<Scalar>&, Scalar*); \
+  instantiate void normalize(const Vec4Array<Scalar>&, Vec4Array<Scalar>&);
+
+#if defined(VERIFIED_MATH_EXTERN_TEMPLATES)
+  VERIFIED_MATH_DECLARE_TEMPLATES(VERIFIED_MATH_VEC4_ARRAY_TEMPLATES)
+#endif
+
+}
+
+#endif // VEC4_ARRAY_H
@@ -0,0 +1,172 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+/*
+  A small Google-Benchmark-style harness.
+
+  Each benchmark is a body run for a given number of iterations; one
+  iteration performs items_per_iteration operations, each reading and
+  writing bytes_per_item bytes and performing flops_per_item floating-point
+  operations (nominal counts). The runner grows the iteration count until
+  a run takes at least the minimum time, then reports ns/op, GB/s and
+  FLOP/s in console, JSON or CSV form.
+ */
+namespace bench {
+
+  // Keeps the compiler from optimizing away a computed value.
+  template<typename T>
+  inline void do_not_optimize(const T& value) {
+#if defined(__GNUC__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+  }
+
+  struct Benchmark {
+    std::string name;
+    std::function<void(std::size_t)> body;
+    std::size_t items_per_iteration;
+    double bytes_per_item;
+    double flops_per_item;
+  };
+
+  struct Result {
+    std::string name;
+    std::size_t iterations;
+    double ns_per_op;
+    double gb_per_second;
+    double gflop_per_second;
+  };
+
+  inline std::vector<Benchmark>& registry() {
+    static std::vector<Benchmark> benchmarks;
+    return benchmarks;
+  }
+
+  inline void add(const std::string& name, std::function<void(std::size_t)> body,
+		  std::size_t items_per_iteration, double bytes_per_item, double flops_per_item) {
+    Benchmark b = {name, body, items_per_iteration, bytes_per_item, flops_per_item};
+    registry().push_back(b);
+  }
+
+  inline Result run(const Benchmark& b, double min_seconds) {
+    typedef std::chrono::steady_clock Clock;
+    std::size_t iterations = 1;
+    double seconds = 0.0;
+    for (;;) {
+      Clock::time_point start = Clock::now();
+      b.body(iterations);
+      seconds = std::chrono::duration<double>(Clock::now() - start).count();
+      if (seconds >= min_seconds || iterations >= (std::size_t(1) << 40)) {
+	break;
+      }
+      // Aim 40% past the target to avoid another round.
+      double scale = seconds > 0.0 ? 1.4 * min_seconds / seconds : 10.0;
+      scale = std::min(std::max(scale, 2.0), 100.0);
+      iterations = static_cast<std::size_t>(iterations * scale);
+    }
+
+    const double ops = double(iterations) * double(b.items_per_iteration);
+    Result r;
+    r.name = b.name;
+    r.iterations = iterations;
+    r.ns_per_op = seconds * 1e9 / ops;
+    r.gb_per_second = b.bytes_per_item * ops / seconds / 1e9;
+    r.gflop_per_second = b.flops_per_item * ops / seconds / 1e9;
+    return r;
+  }
+
+  enum Format { console, json, csv };
+
+  inline void print_header(Format format) {
+    if (format == console) {
+      std::printf("%-44s %14s %12s %10s %12s\n", "benchmark", "iterations", "ns/op", "GB/s", "GFLOP/s");
+    } else if (format == csv) {
+      std::printf("name,iterations,ns_per_op,gb_per_second,gflop_per_second\n");
+    } else {
+      std::printf("{\n  \"benchmarks\": [\n");
+    }
+  }
+
+  inline void print_result(Format format, const Result& r, bool first) {
+    if (format == console) {
+      std::printf("%-44s %14zu %12.3f %10.3f %12.3f\n", r.name.c_str(), r.iterations,
+		  r.ns_per_op, r.gb_per_second, r.gflop_per_second);
+    } else if (format == csv) {
+      std::printf("%s,%zu,%.6g,%.6g,%.6g\n", r.name.c_str(), r.iterations,
+		  r.ns_per_op, r.gb_per_second, r.gflop_per_second);
+    } else {
+      std::printf("%s    {\"name\": \"%s\", \"iterations\": %zu, \"ns_per_op\": %.6g, "
+		  "\"gb_per_second\": %.6g, \"gflop_per_second\": %.6g}",
+		  first ? "" : ",\n", r.name.c_str(), r.iterations,
+		  r.ns_per_op, r.gb_per_second, r.gflop_per_second);
+    }
+    std::fflush(stdout);
+  }
+
+  inline void print_footer(Format format) {
+    if (format == json) {
+      std::printf("\n  ]\n}\n");
+    }
+  }
+
+  /*
+    Runs every registered benchmark whose name contains the --filter
+    substring. Options: --format=console|json|csv, --filter=<substring>,
+    --min_time=<seconds>; --help prints them.
+   */
+  inline int main(int argc, char** argv) {
+    Format format = console;
+    std::string filter;
+    double min_seconds = 0.2;
+
+    for (int i = 1; i < argc; ++i) {
+      const char* arg = argv[i];
+      if (std::strcmp(arg, "--format=json") == 0) {
+	format = json;
+      } else if (std::strcmp(arg, "--format=csv") == 0) {
+	format = csv;
+      } else if (std::strcmp(arg, "--format=console") == 0) {
+	format = console;
+      } else if (std::strncmp(arg, "--filter=", 9) == 0) {
+	filter = arg + 9;
+      } else if (std::strncmp(arg, "--min_time=", 11) == 0) {
+	min_seconds = std::atof(arg + 11);
+      } else {
+	const bool help = std::strcmp(arg, "--help") == 0 || std::strcmp(arg, "-h") == 0;
+	std::fprintf(help ? stdout : stderr,
+		     "usage: %s [--format=console|json|csv] [--filter=<substring>] "
+		     "[--min_time=<seconds>]\n", argv[0]);
+	return help ? 0 : 1;
+      }
+    }
+
+    print_header(format);
+    bool first = true;
+    for (std::size_t i = 0; i < registry().size(); ++i) {
+      const Benchmark& b = registry()[i];
+      if (!filter.empty() && b.name.find(filter) == std::string::npos) {
+	continue;
+      }
+      print_result(format, run(b, min_seconds), first);
+      first = false;
+    }
+    print_footer(format);
+    return 0;
+  }
+
+}
+
+#endif // BENCH_H
@@ -0,0 +1,703 @@
+#include "verified_math/vec3.h"
+#include "verified_math/vec4.h"
+#include "verified_math/mat33.h"
+#include "verified_math/mat44.h"
+#include "verified_math/vec3_array.h"
+#include "verified_math/vec4_array.h"
+#include "verified_math/mat33_array.h"
+#include "verified_math/mat44_array.h"
+#include "verified_math/mat33a.h"
+#include "verified_math/quat.h"
+#include "verified_math/eigen33.h"
+#include "verified_math/svd33.h"
+#include "verified_math/solve.h"
+#include "verified_math/parallel.h"
+#include "verified_math/interval.h"
+#include "verified_math/predicates.h"
+#include "verified_math/double_word.h"
+#include "verified_math/half_array.h"
+#include "verified_math/fixed.h"
+
+#include "bench.h"
+
+#include <cmath>
+#include <cstddef>
+#include <random>
+#include <string>
+#include <vector>
+
+/*
+  Benchmarks of the public operations for float and double, one value at
+  a time and batched. FLOP counts are the nominal counts of the textbook
+  formulas (a multiply-add counts as two).
+ */
+namespace {
+  using namespace verified_math;
+
+  // Single-value benchmarks cycle through a pool of inputs that fits in L1.
+  const std::size_t pool = 256;
+
+  // Batched benchmarks run over arrays of this many elements.
+  const std::size_t batch = 4096;
+
+  // Serial and parallel batched benchmarks compare over this many elements.
+  const std::size_t large_batch = std::size_t(1) << 20;
+
+  template<typename Scalar>
+  struct Inputs {
+    std::vector<Vec3<Scalar> > v3;
+    std::vector<Vec4<Scalar> > v4;
+    std::vector<Mat33<Scalar> > m33;
+    std::vector<Mat44<Scalar> > m44;
+    std::vector<Quat<Scalar> > q;
+
+    explicit Inputs(std::size_t n) {
+      std::mt19937 rng(42);
+      std::uniform_real_distribution<double> u(-1.0, 1.0);
+      auto r = [&]() { return Scalar(u(rng)); };
+      for (std::size_t i = 0; i < n; ++i) {
+	v3.push_back(Vec3<Scalar>{r(), r(), r()});
+	v4.push_back(Vec4<Scalar>{r(), r(), r(), r()});
+	// Diagonally dominant, so inverses are well defined.
+	m33.push_back(Mat33<Scalar>{
+	    r() + 4, r(), r(),
+	    r(), r() + 4, r(),
+	    r(), r(), r() + 4});
+	m44.push_back(Mat44<Scalar>{
+	    r() + 4, r(), r(), r(),
+	    r(), r() + 4, r(), r(),
+	    r(), r(), r() + 4, r(),
+	    r(), r(), r(), r() + 4});
+	q.push_back(normalize(Quat<Scalar>{r(), r(), r(), r()}));
+      }
+    }
+  };
+
+  std::string name(const char* op, const char* type) {
+    return std::string(op) + "<" + type + ">";
+  }
+
+  // Registers a single-value benchmark: f(i) computes one result from the
+  // inputs at pool index i.
+  template<typename F>
+  void single(const std::string& n, F f, double bytes, double flops) {
+    bench::add(n, [=](std::size_t iterations) {
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  auto result = f(i & (pool - 1));
+	  bench::do_not_optimize(result);
+	}
+      }, 1, bytes, flops);
+  }
+
+  template<typename Scalar>
+  void register_single(const char* type) {
+    const Inputs<Scalar> in(pool);
+    const double s = sizeof(Scalar);
+    const std::size_t mask = pool - 1;
+
+    single(name("vec3_dot", type), [=](std::size_t i) {
+	return dot(in.v3[i], in.v3[(i + 1) & mask]); }, 7 * s, 5);
+    single(name("vec3_cross", type), [=](std::size_t i) {
+	return cross(in.v3[i], in.v3[(i + 1) & mask]); }, 9 * s, 9);
+    single(name("vec4_dot", type), [=](std::size_t i) {
+	return dot(in.v4[i], in.v4[(i + 1) & mask]); }, 9 * s, 7);
+    single(name("vec3_mul_scalar", type), [=](std::size_t i) {
+	return Scalar(2) * in.v3[i]; }, 6 * s, 3);
+    single(name("vec4_mul_scalar", type), [=](std::size_t i) {
+	return Scalar(2) * in.v4[i]; }, 8 * s, 4);
+
+    single(name("mat33_mul_scalar", type), [=](std::size_t i) {
+	return Scalar(2) * in.m33[i]; }, 18 * s, 9);
+    single(name("mat33_mul_vec3", type), [=](std::size_t i) {
+	return in.m33[i] * in.v3[i]; }, 15 * s, 15);
+    single(name("mat33_mul_mat33", type), [=](std::size_t i) {
+	return in.m33[i] * in.m33[(i + 1) & mask]; }, 27 * s, 45);
+    single(name("mat33_transpose", type), [=](std::size_t i) {
+	return transpose(in.m33[i]); }, 18 * s, 0);
+    single(name("mat33_det", type), [=](std::size_t i) {
+	return det(in.m33[i]); }, 10 * s, 14);
+    single(name("mat33_inverse", type), [=](std::size_t i) {
+	return inverse(in.m33[i]); }, 18 * s, 51);
+    single(name("mat33_condition_number", type), [=](std::size_t i) {
+	return condition_number(in.m33[i]); }, 10 * s, 85);
+    single(name("mat33_try_inverse", type), [=](std::size_t i) {
+	return try_inverse(in.m33[i]); }, 20 * s, 80);
+    // Reads the upper triangle, so the inputs act as symmetric matrices.
+    single(name("mat33_symmetric_eigen", type), [=](std::size_t i) {
+	return symmetric_eigen(in.m33[i]); }, 18 * s, 150);
+    single(name("mat33_svd", type), [=](std::size_t i) {
+	return svd(in.m33[i]); }, 30 * s, 600);
+    single(name("mat33_polar", type), [=](std::size_t i) {
+	return polar(in.m33[i]); }, 27 * s, 700);
+    single(name("mat33_solve", type), [=](std::size_t i) {
+	return solve(in.m33[i], in.v3[i]); }, 15 * s, 60);
+    // Reads the lower triangle; the diagonally dominant inputs act as
+    // positive definite matrices.
+    single(name("mat33_cholesky_solve", type), [=](std::size_t i) {
+	return Cholesky33<Scalar>(in.m33[i]).solve(in.v3[i]); }, 12 * s, 40);
+
+    single(name("mat44_mul_scalar", type), [=](std::size_t i) {
+	return Scalar(2) * in.m44[i]; }, 32 * s, 16);
+    single(name("mat44_mul_vec4", type), [=](std::size_t i) {
+	return in.m44[i] * in.v4[i]; }, 24 * s, 28);
+    single(name("mat44_mul_mat44", type), [=](std::size_t i) {
+	return in.m44[i] * in.m44[(i + 1) & mask]; }, 48 * s, 112);
+    single(name("mat44_transpose", type), [=](std::size_t i) {
+	return transpose(in.m44[i]); }, 32 * s, 0);
+    single(name("mat44_det", type), [=](std::size_t i) {
+	return det(in.m44[i]); }, 17 * s, 63);
+    single(name("mat44_inverse", type), [=](std::size_t i) {
+	return inverse(in.m44[i]); }, 32 * s, 352);
+    single(name("mat44_condition_number", type), [=](std::size_t i) {
+	return condition_number(in.m44[i]); }, 17 * s, 414);
+    single(name("mat44_solve", type), [=](std::size_t i) {
+	return solve(in.m44[i], in.v4[i]); }, 24 * s, 120);
+    single(name("mat44_cholesky_solve", type), [=](std::size_t i) {
+	return Cholesky44<Scalar>(in.m44[i]).solve(in.v4[i]); }, 18 * s, 70);
+    single(name("mat44_try_inverse", type), [=](std::size_t i) {
+	return try_inverse(in.m44[i]); }, 34 * s, 200);
+
+    single(name("quat_mul_quat", type), [=](std::size_t i) {
+	return in.q[i] * in.q[(i + 1) & mask]; }, 12 * s, 28);
+    single(name("quat_rotate", type), [=](std::size_t i) {
+	return rotate(in.q[i], in.v3[i]); }, 10 * s, 30);
+    single(name("quat_to_mat33", type), [=](std::size_t i) {
+	return to_mat33(in.q[i]); }, 13 * s, 30);
+    single(name("quat_from_mat33", type), [=](std::size_t i) {
+	return from_mat33(to_mat33(in.q[i])); }, 13 * s, 45);
+    single(name("quat_slerp", type), [=](std::size_t i) {
+	return slerp(in.q[i], in.q[(i + 1) & mask], Scalar(0.3)); }, 12 * s, 30);
+
+    // orient3d against the plain det it filters. The degenerate points
+    // lie on the plane z = x + y, exactly on a grid or up to rounding, or
+    // on the unit sphere up to rounding, so every call fails the filter.
+    std::vector<Vec3<Scalar> > grid, plane, sphere;
+    for (std::size_t i = 0; i < pool; ++i) {
+      const Vec3<Scalar>& v = in.v3[i];
+      const Scalar x = std::floor(v.x1 * 1024), y = std::floor(v.x2 * 1024);
+      grid.push_back(Vec3<Scalar>{x, y, x + y});
+      plane.push_back(Vec3<Scalar>{v.x1, v.x2, v.x1 + v.x2});
+      sphere.push_back((Scalar(1) / std::sqrt(dot(v, v))) * v);
+    }
+    single(name("orient3d_det", type), [=](std::size_t i) {
+	const Vec3<Scalar> d = in.v3[(i + 3) & mask];
+	return det(Mat33<Scalar>{
+	    in.v3[i].x1 - d.x1, in.v3[i].x2 - d.x2, in.v3[i].x3 - d.x3,
+	    in.v3[(i + 1) & mask].x1 - d.x1, in.v3[(i + 1) & mask].x2 - d.x2, in.v3[(i + 1) & mask].x3 - d.x3,
+	    in.v3[(i + 2) & mask].x1 - d.x1, in.v3[(i + 2) & mask].x2 - d.x2, in.v3[(i + 2) & mask].x3 - d.x3}); },
+      12 * s, 23);
+    single(name("orient3d", type), [=](std::size_t i) {
+	return orient3d(in.v3[i], in.v3[(i + 1) & mask], in.v3[(i + 2) & mask],
+			in.v3[(i + 3) & mask]); }, 12 * s, 23);
+    single(name("orient3d_grid_coplanar", type), [=](std::size_t i) {
+	return orient3d(grid[i], grid[(i + 1) & mask], grid[(i + 2) & mask],
+			grid[(i + 3) & mask]); }, 12 * s, 23);
+    single(name("orient3d_coplanar", type), [=](std::size_t i) {
+	return orient3d(plane[i], plane[(i + 1) & mask], plane[(i + 2) & mask],
+			plane[(i + 3) & mask]); }, 12 * s, 23);
+    single(name("insphere", type), [=](std::size_t i) {
+	return insphere(in.v3[i], in.v3[(i + 1) & mask], in.v3[(i + 2) & mask],
+			in.v3[(i + 3) & mask], in.v3[(i + 4) & mask]); }, 15 * s, 77);
+    single(name("insphere_cospherical", type), [=](std::size_t i) {
+	return insphere(sphere[i], sphere[(i + 1) & mask], sphere[(i + 2) & mask],
+			sphere[(i + 3) & mask], sphere[(i + 4) & mask]); }, 15 * s, 77);
+  }
+
+  template<typename Scalar>
+  void register_batched(const char* type) {
+    const Inputs<Scalar> in(batch);
+    const double s = sizeof(Scalar);
+
+    const Vec3Array<Scalar> a3(in.v3.data(), batch);
+    const Vec4Array<Scalar> a4(in.v4.data(), batch);
+    const Mat33Array<Scalar> am33(in.m33.data(), batch);
+    const Mat44Array<Scalar> am44(in.m44.data(), batch);
+    const Mat33<Scalar> m33 = in.m33[0];
+    const Mat44<Scalar> m44 = in.m44[0];
+
+    bench::add(name("batch_vec3_add", type), [=](std::size_t iterations) {
+	Vec3Array<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  add(a3, a3, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, batch, 9 * s, 3);
+
+    bench::add(name("batch_vec3_scale", type), [=](std::size_t iterations) {
+	Vec3Array<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  scale(Scalar(2), a3, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, batch, 6 * s, 3);
+
+    bench::add(name("batch_vec3_dot", type), [=](std::size_t iterations) {
+	std::vector<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  dot(a3, a3, out.data());
+	  bench::do_not_optimize(out[0]);
+	}
+      }, batch, 7 * s, 5);
+
+    bench::add(name("batch_vec3_cross", type), [=](std::size_t iterations) {
+	Vec3Array<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  cross(a3, a3, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, batch, 9 * s, 9);
+
+    bench::add(name("batch_vec3_normalize", type), [=](std::size_t iterations) {
+	Vec3Array<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  normalize(a3, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, batch, 6 * s, 10);
+
+    bench::add(name("batch_vec4_scale", type), [=](std::size_t iterations) {
+	Vec4Array<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  scale(Scalar(2), a4, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, batch, 8 * s, 4);
+
+    bench::add(name("batch_vec4_dot", type), [=](std::size_t iterations) {
+	std::vector<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  dot(a4, a4, out.data());
+	  bench::do_not_optimize(out[0]);
+	}
+      }, batch, 9 * s, 7);
+
+    bench::add(name("batch_mat33_transform_vectors_aos", type), [=](std::size_t iterations) {
+	std::vector<Vec3<Scalar> > out(in.v3);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  transform_vectors(m33, in.v3.data(), out.data(), batch);
+	  bench::do_not_optimize(out[0]);
+	}
+      }, batch, 6 * s, 15);
+
+    bench::add(name("batch_quat_rotate_aos", type), [=](std::size_t iterations) {
+	std::vector<Vec3<Scalar> > out(in.v3);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  rotate(in.q[0], in.v3.data(), out.data(), batch);
+	  bench::do_not_optimize(out[0]);
+	}
+      }, batch, 6 * s, 15);
+
+    bench::add(name("batch_mat33_transform_vectors_padded", type), [=](std::size_t iterations) {
+	aligned_vector<Vec3A<Scalar> > padded;
+	for (std::size_t i = 0; i < batch; ++i) {
+	  padded.push_back(Vec3A<Scalar>(in.v3[i]));
+	}
+	aligned_vector<Vec3A<Scalar> > out(padded);
+	const Mat33A<Scalar> ma(m33);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  transform_vectors(ma, padded.data(), out.data(), batch);
+	  bench::do_not_optimize(out[0]);
+	}
+      }, batch, 8 * s, 15);
+
+    bench::add(name("batch_mat33_transform_vectors_soa", type), [=](std::size_t iterations) {
+	Vec3Array<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  transform_vectors(m33, a3, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, batch, 6 * s, 15);
+
+    bench::add(name("batch_mat44_transform_vectors_aos", type), [=](std::size_t iterations) {
+	std::vector<Vec4<Scalar> > out(in.v4);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  transform_vectors(m44, in.v4.data(), out.data(), batch);
+	  bench::do_not_optimize(out[0]);
+	}
+      }, batch, 8 * s, 28);
+
+    bench::add(name("batch_mat44_transform_vectors_soa", type), [=](std::size_t iterations) {
+	Vec4Array<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  transform_vectors(m44, a4, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, batch, 8 * s, 28);
+
+    bench::add(name("batch_mat44_transform_points_affine_soa", type), [=](std::size_t iterations) {
+	Vec3Array<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  transform_points_affine(m44, a3, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, batch, 6 * s, 18);
+
+    bench::add(name("batch_mat33_det", type), [=](std::size_t iterations) {
+	std::vector<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  det(am33, out.data());
+	  bench::do_not_optimize(out[0]);
+	}
+      }, batch, 10 * s, 14);
+
+    bench::add(name("batch_mat33_det_inverse", type), [=](std::size_t iterations) {
+	std::vector<Scalar> d(batch);
+	std::vector<unsigned char> ok(batch);
+	Mat33Array<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  det_inverse(am33, d.data(), out, ok.data());
+	  bench::do_not_optimize(out.x11[0]);
+	}
+      }, batch, 19 * s + 1, 51);
+
+    bench::add(name("batch_mat33_symmetric_eigen", type), [=](std::size_t iterations) {
+	Vec3Array<Scalar> values(batch);
+	Mat33Array<Scalar> vectors(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  symmetric_eigen(am33, values, vectors);
+	  bench::do_not_optimize(values.x1[0]);
+	}
+      }, batch, 21 * s, 150);
+
+    bench::add(name("batch_mat33_svd", type), [=](std::size_t iterations) {
+	Mat33Array<Scalar> u(batch), v(batch);
+	Vec3Array<Scalar> sigma(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  svd(am33, u, sigma, v);
+	  bench::do_not_optimize(sigma.x1[0]);
+	}
+      }, batch, 30 * s, 600);
+
+    bench::add(name("batch_mat33_solve", type), [=](std::size_t iterations) {
+	std::vector<unsigned char> ok(batch);
+	Vec3Array<Scalar> x(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  solve(am33, a3, x, ok.data());
+	  bench::do_not_optimize(x.x1[0]);
+	}
+      }, batch, 15 * s + 1, 60);
+
+    bench::add(name("batch_mat44_det", type), [=](std::size_t iterations) {
+	std::vector<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  det(am44, out.data());
+	  bench::do_not_optimize(out[0]);
+	}
+      }, batch, 17 * s, 47);
+
+    bench::add(name("batch_mat44_det_inverse", type), [=](std::size_t iterations) {
+	std::vector<Scalar> d(batch);
+	std::vector<unsigned char> ok(batch);
+	Mat44Array<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  det_inverse(am44, d.data(), out, ok.data());
+	  bench::do_not_optimize(out.x11[0]);
+	}
+      }, batch, 33 * s + 1, 187);
+
+    bench::add(name("batch_mat44_solve", type), [=](std::size_t iterations) {
+	std::vector<unsigned char> ok(batch);
+	Vec4Array<Scalar> x(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  solve(am44, a4, x, ok.data());
+	  bench::do_not_optimize(x.x1[0]);
+	}
+      }, batch, 24 * s + 1, 120);
+  }
+
+  template<typename Scalar>
+  void register_parallel(const char* type) {
+    const Inputs<Scalar> in(1);
+    const Mat44<Scalar> m = in.m44[0];
+    const double s = sizeof(Scalar);
+
+    Vec4Array<Scalar> a(large_batch);
+    for (std::size_t i = 0; i < large_batch; ++i) {
+      a.set(i, in.v4[0]);
+    }
+
+    bench::add(name("large_mat44_transform_vectors_soa", type), [=](std::size_t iterations) {
+	Vec4Array<Scalar> out(large_batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  transform_vectors(m, a, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, large_batch, 8 * s, 28);
+
+    bench::add(name("large_mat44_parallel_transform_soa", type), [=](std::size_t iterations) {
+	Vec4Array<Scalar> out(large_batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  parallel_transform(m, a, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, large_batch, 8 * s, 28);
+  }
+}
+
+namespace {
+  typedef Interval<double> IntervalD;
+
+  Mat33<IntervalD> to_interval(const Mat33<double>& m) {
+    const double* e = &m.x11;
+    return Mat33<IntervalD>{
+      e[0], e[1], e[2], e[3], e[4], e[5], e[6], e[7], e[8]};
+  }
+
+  Mat44<IntervalD> to_interval(const Mat44<double>& m) {
+    const double* e = &m.x11;
+    return Mat44<IntervalD>{
+      e[0], e[1], e[2], e[3], e[4], e[5], e[6], e[7],
+      e[8], e[9], e[10], e[11], e[12], e[13], e[14], e[15]};
+  }
+
+  // Like single, but the timed loop runs under one RoundUpward, as a
+  // batch of verified computations would.
+  template<typename F>
+  void single_rounded(const std::string& n, F f, double bytes, double flops) {
+    bench::add(n, [=](std::size_t iterations) {
+	RoundUpward guard;
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  auto result = f(i & (pool - 1));
+	  bench::do_not_optimize(result);
+	}
+      }, 1, bytes, flops);
+  }
+
+  // The interval counterparts of the double benchmarks; flops count the
+  // double operations they replace.
+  void register_interval() {
+    const Inputs<double> in(pool);
+    std::vector<Mat33<IntervalD> > m33;
+    std::vector<Mat44<IntervalD> > m44;
+    for (std::size_t i = 0; i < pool; ++i) {
+      m33.push_back(to_interval(in.m33[i]));
+      m44.push_back(to_interval(in.m44[i]));
+    }
+    const double s = sizeof(IntervalD);
+    const std::size_t mask = pool - 1;
+
+    single_rounded("mat33_mul_mat33<interval>", [=](std::size_t i) {
+	return m33[i] * m33[(i + 1) & mask]; }, 27 * s, 45);
+    single_rounded("mat33_det<interval>", [=](std::size_t i) {
+	return det(m33[i]); }, 10 * s, 14);
+    single_rounded("mat33_inverse<interval>", [=](std::size_t i) {
+	return inverse(m33[i]); }, 18 * s, 51);
+    single_rounded("mat44_mul_mat44<interval>", [=](std::size_t i) {
+	return m44[i] * m44[(i + 1) & mask]; }, 48 * s, 112);
+    single_rounded("mat44_det<interval>", [=](std::size_t i) {
+	return det(m44[i]); }, 17 * s, 63);
+    single_rounded("mat44_inverse<interval>", [=](std::size_t i) {
+	return inverse(m44[i]); }, 32 * s, 352);
+  }
+}
+
+namespace {
+  // Double solves through a float inverse and two refinement iterations,
+  // against the double LU solves of register_single and register_batched.
+  void register_refined() {
+    const Inputs<double> in(batch);
+    const double s = sizeof(double);
+    const std::size_t mask = pool - 1;
+
+    single("mat33_refined_solve<double>", [=](std::size_t i) {
+	return refined_solve(in.m33[i & mask], in.v3[i & mask]); }, 12 * s, 80);
+    single("mat44_refined_solve<double>", [=](std::size_t i) {
+	return refined_solve(in.m44[i & mask], in.v4[i & mask]); }, 20 * s, 160);
+
+    const Vec3Array<double> a3(in.v3.data(), batch);
+    const Vec4Array<double> a4(in.v4.data(), batch);
+    const Mat33Array<double> am33(in.m33.data(), batch);
+    const Mat44Array<double> am44(in.m44.data(), batch);
+
+    bench::add("batch_mat33_refined_solve<double>", [=](std::size_t iterations) {
+	std::vector<unsigned char> converged(batch);
+	Vec3Array<double> x(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  refined_solve(am33, a3, x, converged.data());
+	  bench::do_not_optimize(x.x1[0]);
+	}
+      }, batch, 15 * s + 1, 80);
+
+    bench::add("batch_mat44_refined_solve<double>", [=](std::size_t iterations) {
+	std::vector<unsigned char> converged(batch);
+	Vec4Array<double> x(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  refined_solve(am44, a4, x, converged.data());
+	  bench::do_not_optimize(x.x1[0]);
+	}
+      }, batch, 24 * s + 1, 160);
+  }
+}
+
+namespace {
+  // The DoubleDouble counterparts of the double benchmarks; flops count
+  // the double operations they replace.
+  void register_double_word() {
+    const Inputs<DoubleDouble> in(pool);
+    const double s = sizeof(DoubleDouble);
+    const std::size_t mask = pool - 1;
+
+    single("vec3_dot<double_double>", [=](std::size_t i) {
+	return dot(in.v3[i], in.v3[(i + 1) & mask]); }, 7 * s, 5);
+    single("mat33_mul_mat33<double_double>", [=](std::size_t i) {
+	return in.m33[i] * in.m33[(i + 1) & mask]; }, 27 * s, 45);
+    single("mat33_det<double_double>", [=](std::size_t i) {
+	return det(in.m33[i]); }, 10 * s, 14);
+    single("mat33_inverse<double_double>", [=](std::size_t i) {
+	return inverse(in.m33[i]); }, 18 * s, 51);
+    single("mat44_mul_mat44<double_double>", [=](std::size_t i) {
+	return in.m44[i] * in.m44[(i + 1) & mask]; }, 48 * s, 112);
+    single("mat44_det<double_double>", [=](std::size_t i) {
+	return det(in.m44[i]); }, 17 * s, 63);
+    single("mat44_inverse<double_double>", [=](std::size_t i) {
+	return inverse(in.m44[i]); }, 32 * s, 352);
+  }
+}
+
+namespace {
+  // The kernels on 16-bit storage against float storage, over arrays of
+  // large_batch vectors that do not fit in cache; bytes count the storage.
+  template<typename Storage>
+  void register_half(const char* type, const Vec3Array<float>& f, const Mat33<float>& m) {
+    const Vec3HalfArray<Storage> a(f);
+    const double s = sizeof(Storage);
+
+    bench::add(name("large_vec3_dot", type), [=](std::size_t iterations) {
+	std::vector<float> out(large_batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  dot(a, a, out.data());
+	  bench::do_not_optimize(out[0]);
+	}
+      }, large_batch, 6 * s + 4, 5);
+
+    bench::add(name("large_vec3_normalize", type), [=](std::size_t iterations) {
+	Vec3HalfArray<Storage> out(large_batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  normalize(a, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, large_batch, 6 * s, 10);
+
+    bench::add(name("large_vec3_normalize_to_float", type), [=](std::size_t iterations) {
+	Vec3Array<float> out(large_batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  normalize(a, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, large_batch, 3 * s + 12, 10);
+
+    bench::add(name("large_mat33_transform_vectors_soa", type), [=](std::size_t iterations) {
+	Vec3HalfArray<Storage> out(large_batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  transform_vectors(m, a, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, large_batch, 6 * s, 15);
+  }
+
+  void register_half() {
+    const Inputs<float> in(batch);
+    Vec3Array<float> f(large_batch);
+    for (std::size_t i = 0; i < large_batch; ++i) {
+      f.set(i, in.v3[i % batch]);
+    }
+    const Mat33<float> m = in.m33[0];
+    const double s = sizeof(float);
+
+    bench::add("large_vec3_dot<float>", [=](std::size_t iterations) {
+	std::vector<float> out(large_batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  dot(f, f, out.data());
+	  bench::do_not_optimize(out[0]);
+	}
+      }, large_batch, 7 * s, 5);
+
+    bench::add("large_vec3_normalize<float>", [=](std::size_t iterations) {
+	Vec3Array<float> out(large_batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  normalize(f, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, large_batch, 6 * s, 10);
+
+    bench::add("large_mat33_transform_vectors_soa<float>", [=](std::size_t iterations) {
+	Vec3Array<float> out(large_batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  transform_vectors(m, f, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, large_batch, 6 * s, 15);
+
+    register_half<Half>("half", f, m);
+    register_half<BFloat16>("bfloat16", f, m);
+  }
+}
+
+namespace {
+  // The fixed-point counterparts of the float benchmarks; flops count the
+  // float operations they replace.
+  template<typename Scalar>
+  void register_fixed(const char* type) {
+    const Inputs<Scalar> in(batch);
+    const double s = sizeof(Scalar);
+    const std::size_t mask = pool - 1;
+
+    single(name("vec3_dot", type), [=](std::size_t i) {
+	return dot(in.v3[i], in.v3[(i + 1) & mask]); }, 7 * s, 5);
+    single(name("vec3_cross", type), [=](std::size_t i) {
+	return cross(in.v3[i], in.v3[(i + 1) & mask]); }, 9 * s, 9);
+    single(name("mat33_det", type), [=](std::size_t i) {
+	return det(in.m33[i]); }, 10 * s, 14);
+    single(name("mat44_mul_vec4", type), [=](std::size_t i) {
+	return in.m44[i] * in.v4[i]; }, 24 * s, 28);
+    single(name("mat44_mul_mat44", type), [=](std::size_t i) {
+	return in.m44[i] * in.m44[(i + 1) & mask]; }, 48 * s, 112);
+    single(name("mat44_det", type), [=](std::size_t i) {
+	return det(in.m44[i]); }, 17 * s, 63);
+
+    const Vec3Array<Scalar> a3(in.v3.data(), batch);
+    const Vec4Array<Scalar> a4(in.v4.data(), batch);
+    const Mat33<Scalar> m33 = in.m33[0];
+    const Mat44<Scalar> m44 = in.m44[0];
+
+    bench::add(name("batch_vec3_dot", type), [=](std::size_t iterations) {
+	std::vector<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  dot(a3, a3, out.data());
+	  bench::do_not_optimize(out[0]);
+	}
+      }, batch, 7 * s, 5);
+
+    bench::add(name("batch_mat33_transform_vectors_soa", type), [=](std::size_t iterations) {
+	Vec3Array<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  transform_vectors(m33, a3, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, batch, 6 * s, 15);
+
+    bench::add(name("batch_mat44_transform_vectors_soa", type), [=](std::size_t iterations) {
+	Vec4Array<Scalar> out(batch);
+	for (std::size_t i = 0; i < iterations; ++i) {
+	  transform_vectors(m44, a4, out);
+	  bench::do_not_optimize(out.x1[0]);
+	}
+      }, batch, 8 * s, 28);
+  }
+}
+
+int main(int argc, char** argv) {
+  register_single<float>("float");
+  register_single<double>("double");
+  register_batched<float>("float");
+  register_batched<double>("double");
+  register_parallel<float>("float");
+  register_parallel<double>("double");
+  register_refined();
+  register_interval();
+  register_double_word();
+  register_half();
+  register_fixed<Fixed<16, 16> >("fixed16_16");
+  register_fixed<Fixed<4, 12> >("fixed4_12");
+  return bench::main(argc, argv);
+}
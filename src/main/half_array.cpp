@@ -0,0 +1,7 @@
+#include "verified_math/half_array.h"
+
+namespace verified_math {
+
+  VERIFIED_MATH_DEFINE_HALF_TEMPLATES(VERIFIED_MATH_HALF_ARRAY_TEMPLATES)
+
+}
@@ -0,0 +1,7 @@
+#include "verified_math/mat33_array.h"
+
+namespace verified_math {
+
+  VERIFIED_MATH_DEFINE_TEMPLATES(VERIFIED_MATH_MAT33_ARRAY_TEMPLATES)
+
+}
@@ -0,0 +1,7 @@
+#include "verified_math/mat44_array.h"
+
+namespace verified_math {
+
+  VERIFIED_MATH_DEFINE_TEMPLATES(VERIFIED_MATH_MAT44_ARRAY_TEMPLATES)
+
+}
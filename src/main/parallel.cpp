@@ -0,0 +1,7 @@
+#include "verified_math/parallel.h"
+
+namespace verified_math {
+
+  VERIFIED_MATH_DEFINE_TEMPLATES(VERIFIED_MATH_PARALLEL_TEMPLATES)
+
+}
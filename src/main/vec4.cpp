@@ -1 +1,7 @@
 #include "verified_math/vec4.h"
+
+namespace verified_math {
+
+  VERIFIED_MATH_DEFINE_TEMPLATES(VERIFIED_MATH_VEC4_TEMPLATES)
+
+}
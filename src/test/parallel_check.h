@@ -0,0 +1,229 @@
+#ifndef PARALLEL_CHECK_H
+#define PARALLEL_CHECK_H
+
+#include "gtest/gtest.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <mutex>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+/*
+  Parallel, sharded property checking.
+
+  The trials are split into fixed-size shards. Shard k draws its arguments
+  from a generator seeded with a hash of (seed, k), so trial i sees the same
+  arguments whatever the number of threads, and a run is reproducible from
+  its seed alone. Worker threads take shards in increasing order; when a
+  property fails, the counterexample reported is the one with the lowest
+  trial index, so the report is also independent of the thread count. A
+  property that throws fails at that trial, and the exception is reported
+  like any other counterexample rather than escaping the worker thread.
+
+  Usage mirrors checkpp:
+
+    EXPECT_TRUE(parallel_check::check(
+      parallel_check::Property<double, double>{ f }, parallel_check::trials(10000)));
+
+  trials(n) is the total number of trials, the same on every machine, so
+  whether a property passes does not depend on the thread count.
+
+  The environment variable VERIFIED_MATH_CHECK_THREADS overrides the number
+  of threads (default: the hardware concurrency),
+  VERIFIED_MATH_CHECK_TRIALS overrides the count returned by trials(), and
+  VERIFIED_MATH_CHECK_SEED overrides the seed.
+ */
+namespace parallel_check {
+
+  template<typename... Args>
+  struct Property {
+    std::function<bool(Args...)> f;
+  };
+
+  /*
+    Argument generators. Floating-point values have a random sign and a
+    magnitude spread log-uniformly over [1e-3, 1e6].
+   */
+  template<typename T>
+  struct Arbitrary;
+
+  template<>
+  struct Arbitrary<double> {
+    template<typename Rng>
+    static double generate(Rng& rng) {
+      std::uniform_real_distribution<double> mantissa(-1.0, 1.0);
+      std::uniform_real_distribution<double> exponent(-3.0, 6.0);
+      return mantissa(rng) * std::pow(10.0, exponent(rng));
+    }
+  };
+
+  template<>
+  struct Arbitrary<float> {
+    template<typename Rng>
+    static float generate(Rng& rng) {
+      return static_cast<float>(Arbitrary<double>::generate(rng));
+    }
+  };
+
+  template<>
+  struct Arbitrary<int> {
+    template<typename Rng>
+    static int generate(Rng& rng) {
+      std::uniform_int_distribution<int> d(-1000000, 1000000);
+      return d(rng);
+    }
+  };
+
+  namespace detail {
+
+    const std::uint64_t shard_size = 1024;
+
+    const std::uint64_t default_seed = 0x5eed5eed5eed5eedULL;
+
+    // SplitMix64 finalizer; decorrelates the seeds of adjacent shards.
+    inline std::uint64_t mix(std::uint64_t x) {
+      x += 0x9e3779b97f4a7c15ULL;
+      x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+      x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+      return x ^ (x >> 31);
+    }
+
+    inline std::uint64_t env_or(const char* name, std::uint64_t fallback) {
+      const char* value = std::getenv(name);
+      return value != nullptr && *value != '\0' ? std::strtoull(value, nullptr, 0) : fallback;
+    }
+
+    inline unsigned thread_count() {
+      const unsigned threads = static_cast<unsigned>(env_or("VERIFIED_MATH_CHECK_THREADS", 0));
+      return threads != 0 ? threads : std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    // Indices<0, ..., N - 1>, for unpacking a tuple into a call.
+    template<std::size_t... I>
+    struct Indices { };
+
+    template<std::size_t N, std::size_t... I>
+    struct MakeIndices : MakeIndices<N - 1, N - 1, I...> { };
+
+    template<std::size_t... I>
+    struct MakeIndices<0, I...> {
+      typedef Indices<I...> type;
+    };
+
+    template<typename... Args, std::size_t... I>
+    bool apply(const std::function<bool(Args...)>& f, const std::tuple<Args...>& args,
+	       Indices<I...>) {
+      return f(std::get<I>(args)...);
+    }
+
+    template<std::size_t I, std::size_t N>
+    struct Print {
+      template<typename Tuple>
+      static void run(std::ostream& out, const Tuple& args) {
+	out << (I == 0 ? "" : ", ") << std::get<I>(args);
+	Print<I + 1, N>::run(out, args);
+      }
+    };
+
+    template<std::size_t N>
+    struct Print<N, N> {
+      template<typename Tuple>
+      static void run(std::ostream&, const Tuple&) { }
+    };
+
+  }
+
+  inline std::uint64_t trials(std::uint64_t total) {
+    return detail::env_or("VERIFIED_MATH_CHECK_TRIALS", total);
+  }
+
+  template<typename... Args>
+  ::testing::AssertionResult check(const Property<Args...>& p, std::uint64_t trials,
+				   unsigned threads = 0) {
+    typedef std::tuple<Args...> Tuple;
+    typedef typename detail::MakeIndices<sizeof...(Args)>::type Indices;
+
+    const std::uint64_t seed = detail::env_or("VERIFIED_MATH_CHECK_SEED", detail::default_seed);
+    if (threads == 0) {
+      threads = detail::thread_count();
+    }
+
+    const std::uint64_t shards = (trials + detail::shard_size - 1) / detail::shard_size;
+    std::atomic<std::uint64_t> next_shard(0);
+    std::atomic<std::uint64_t> first_failure(std::numeric_limits<std::uint64_t>::max());
+    std::mutex report_mutex;
+    std::string report;
+
+    auto worker = [&]() {
+      for (;;) {
+	const std::uint64_t shard = next_shard.fetch_add(1);
+	const std::uint64_t begin = shard * detail::shard_size;
+	// Later shards cannot improve on a failure already found.
+	if (shard >= shards || begin > first_failure.load()) {
+	  return;
+	}
+	const std::uint64_t end = std::min(trials, begin + detail::shard_size);
+	std::mt19937_64 rng(detail::mix(seed ^ detail::mix(shard)));
+	for (std::uint64_t i = begin; i < end; ++i) {
+	  // Braced initialization draws the arguments left to right.
+	  const Tuple args{Arbitrary<Args>::generate(rng)...};
+	  bool holds = false;
+	  std::string thrown;
+	  try {
+	    holds = detail::apply(p.f, args, Indices());
+	  } catch (const std::exception& e) {
+	    thrown = std::string("exception: ") + e.what();
+	  } catch (...) {
+	    thrown = "unknown exception";
+	  }
+	  if (!holds) {
+	    std::lock_guard<std::mutex> lock(report_mutex);
+	    if (i < first_failure.load()) {
+	      first_failure.store(i);
+	      std::ostringstream out;
+	      out.precision(17);
+	      out << "falsified at trial " << i << " of " << trials
+		  << " (seed " << seed << ") with arguments (";
+	      detail::Print<0, sizeof...(Args)>::run(out, args);
+	      out << ")";
+	      if (!thrown.empty()) {
+		out << " by " << thrown;
+	      }
+	      report = out.str();
+	    }
+	    break;
+	  }
+	}
+      }
+    };
+
+    std::vector<std::thread> pool;
+    for (unsigned t = 1; t < threads; ++t) {
+      pool.push_back(std::thread(worker));
+    }
+    worker();
+    for (std::size_t t = 0; t < pool.size(); ++t) {
+      pool[t].join();
+    }
+
+    if (report.empty()) {
+      return ::testing::AssertionSuccess();
+    }
+    return ::testing::AssertionFailure() << report;
+  }
+
+}
+
+#endif // PARALLEL_CHECK_H
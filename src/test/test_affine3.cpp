@@ -0,0 +1,182 @@
+#include "verified_math/affine3.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <cfloat>
+
+#define epsilon 0.001
+
+namespace {
+  // Rotation about z, then y, then x.
+  verified_math::Mat33<double> rotation(double a, double b, double c) {
+    auto rx = verified_math::Mat33<double> {
+      1.0, 0.0, 0.0,
+      0.0, cos(a), -sin(a),
+      0.0, sin(a), cos(a)
+    };
+    auto ry = verified_math::Mat33<double> {
+      cos(b), 0.0, sin(b),
+      0.0, 1.0, 0.0,
+      -sin(b), 0.0, cos(b)
+    };
+    auto rz = verified_math::Mat33<double> {
+      cos(c), -sin(c), 0.0,
+      sin(c), cos(c), 0.0,
+      0.0, 0.0, 1.0
+    };
+    return rx * ry * rz;
+  }
+
+  bool close(const verified_math::Mat44<double>& m1, const verified_math::Mat44<double>& m2, double tol) {
+    const double* a = &m1.x11;
+    const double* b = &m2.x11;
+    for (int i = 0; i < 16; ++i) {
+      if (fabs(a[i] - b[i]) > tol) {
+	return false;
+      }
+    }
+    return true;
+  }
+
+  const verified_math::Mat44<double> eye = verified_math::Mat44<double> {
+    1.0, 0.0, 0.0, 0.0,
+    0.0, 1.0, 0.0, 0.0,
+    0.0, 0.0, 1.0, 0.0,
+    0.0, 0.0, 0.0, 1.0
+  };
+}
+
+TEST(TestAffine3, TestMat44RoundTripIsExact) {
+  auto round_trip = [](double x11, double x12, double x13, double x14,
+		       double x21, double x22, double x23, double x24,
+		       double x31, double x32, double x33, double x34) {
+    auto m = verified_math::Mat44<double> {
+      x11, x12, x13, x14,
+      x21, x22, x23, x24,
+      x31, x32, x33, x34,
+      0.0, 0.0, 0.0, 1.0
+    };
+
+    return close(verified_math::to_mat44(verified_math::Affine3<double>{m}), m, 0.0) &&
+      close(verified_math::to_mat44(verified_math::Rigid3<double>{m}), m, 0.0);
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> {
+			       round_trip }, 10000));
+}
+
+TEST(TestAffine3, TestCompositionMatchesMat44) {
+  auto composition = [](double x11, double x12, double x13, double x14,
+			double x21, double x22, double x23, double x24,
+			double x31, double x32, double x33, double x34,
+			double y11, double y12, double y13, double y14,
+			double y21, double y22, double y23, double y24,
+			double y31, double y32, double y33, double y34) {
+    auto m1 = verified_math::Mat44<double> {
+      x11, x12, x13, x14,
+      x21, x22, x23, x24,
+      x31, x32, x33, x34,
+      0.0, 0.0, 0.0, 1.0
+    };
+    auto m2 = verified_math::Mat44<double> {
+      y11, y12, y13, y14,
+      y21, y22, y23, y24,
+      y31, y32, y33, y34,
+      0.0, 0.0, 0.0, 1.0
+    };
+
+    auto a = verified_math::Affine3<double>{m1} * verified_math::Affine3<double>{m2};
+    auto m = m1 * m2;
+
+    auto scale = 1.0 + m1.l2_norm() * m2.l2_norm();
+    return close(verified_math::to_mat44(a), m, epsilon * scale);
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> {
+			       composition }, 10000));
+}
+
+TEST(TestAffine3, TestAffineInverse) {
+  auto affine_inverse = [](double x11, double x12, double x13, double x14,
+			   double x21, double x22, double x23, double x24,
+			   double x31, double x32, double x33, double x34) {
+    auto a = verified_math::Affine3<double> {
+      verified_math::Mat33<double>{x11, x12, x13,
+				   x21, x22, x23,
+				   x31, x32, x33},
+      verified_math::Vec3<double>{x14, x24, x34}
+    };
+
+    // As for the Mat44 inverse, the residual is bounded by the unit
+    // roundoff times the (Frobenius) condition number of the linear part;
+    // the translation adds |inverse(linear)| |t| = kappa |t| / |linear|.
+    auto kappa = sqrt(condition_number(a.linear));
+    if (!(kappa < 1e8)) {
+      return true;
+    }
+
+    auto prod = verified_math::to_mat44(verified_math::inverse(a) * a);
+    auto t = sqrt(x14 * x14 + x24 * x24 + x34 * x34) / sqrt(a.linear.l2_norm());
+
+    return close(prod, eye, 64 * DBL_EPSILON * kappa * (1.0 + t));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> {
+			       affine_inverse }, 10000));
+}
+
+TEST(TestAffine3, TestRigidInverse) {
+  auto rigid_inverse = [](double a, double b, double c,
+			  double t1, double t2, double t3) {
+    auto r = verified_math::Rigid3<double> {
+      rotation(a, b, c),
+      verified_math::Vec3<double>{t1, t2, t3}
+    };
+
+    auto scale = 1.0 + fabs(t1) + fabs(t2) + fabs(t3);
+    auto inv = verified_math::inverse(r);
+
+    return close(verified_math::to_mat44(inv * r), eye, epsilon * scale) &&
+      close(verified_math::to_mat44(r * inv), eye, epsilon * scale);
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double> {
+			       rigid_inverse }, 10000));
+}
+
+TEST(TestAffine3, TestRigidAgreesWithAffine) {
+  auto rigid_agrees = [](double a, double b, double c,
+			 double t1, double t2, double t3,
+			 double x1, double x2, double x3) {
+    auto r = verified_math::Rigid3<double> {
+      rotation(a, b, c),
+      verified_math::Vec3<double>{t1, t2, t3}
+    };
+    auto x = verified_math::Vec3<double>{x1, x2, x3};
+
+    auto y1 = verified_math::inverse(r) * x;
+    auto y2 = verified_math::inverse(static_cast<verified_math::Affine3<double> >(r)) * x;
+
+    auto tol = epsilon * (1.0 + fabs(t1) + fabs(t2) + fabs(t3) +
+			  fabs(x1) + fabs(x2) + fabs(x3));
+    return (fabs(y1.x1 - y2.x1) < tol &&
+	    fabs(y1.x2 - y2.x2) < tol &&
+	    fabs(y1.x3 - y2.x3) < tol);
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double> {
+			       rigid_agrees }, 10000));
+}
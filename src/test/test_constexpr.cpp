@@ -0,0 +1,163 @@
+#include "verified_math/vec3.h"
+#include "verified_math/vec4.h"
+#include "verified_math/mat33.h"
+#include "verified_math/mat44.h"
+#include "gtest/gtest.h"
+
+/*
+  Compile-time mirrors of the checkpp properties. The inputs are small
+  integers, so every result is exact and can be compared with ==.
+
+  The Mat44<double> products below go through the SIMD overload where there
+  is one; product() is the constexpr template it forwards to.
+ */
+namespace {
+  using verified_math::Vec3;
+  using verified_math::Vec4;
+  using verified_math::Mat33;
+  using verified_math::Mat44;
+
+  constexpr Vec3<double> v1 {1.0, -2.0, 3.0};
+  constexpr Vec3<double> v2 {4.0, 5.0, -6.0};
+  constexpr Vec3<double> v3 {-7.0, 8.0, 9.0};
+
+  constexpr Vec4<double> w1 {1.0, -2.0, 3.0, -4.0};
+  constexpr Vec4<double> w2 {5.0, 6.0, -7.0, 8.0};
+
+  constexpr Mat33<double> eye33 {
+    1.0, 0.0, 0.0,
+    0.0, 1.0, 0.0,
+    0.0, 0.0, 1.0
+  };
+
+  constexpr Mat33<double> a33 {
+    2.0, -1.0, 0.0,
+    1.0, 3.0, 2.0,
+    0.0, 1.0, 4.0
+  };
+
+  constexpr Mat33<double> b33 {
+    1.0, 2.0, -1.0,
+    0.0, 1.0, 3.0,
+    2.0, 0.0, 1.0
+  };
+
+  constexpr Mat44<double> eye44 {
+    1.0, 0.0, 0.0, 0.0,
+    0.0, 1.0, 0.0, 0.0,
+    0.0, 0.0, 1.0, 0.0,
+    0.0, 0.0, 0.0, 1.0
+  };
+
+  constexpr Mat44<double> a44 {
+    2.0, -1.0, 0.0, 1.0,
+    1.0, 3.0, 2.0, 0.0,
+    0.0, 1.0, 4.0, -1.0,
+    1.0, 0.0, 2.0, 3.0
+  };
+
+  constexpr Mat44<double> b44 {
+    1.0, 2.0, -1.0, 0.0,
+    0.0, 1.0, 3.0, 1.0,
+    2.0, 0.0, 1.0, -2.0,
+    1.0, 1.0, 0.0, 1.0
+  };
+
+  constexpr Mat44<float> a44f {
+    2.0f, -1.0f, 0.0f, 1.0f,
+    1.0f, 3.0f, 2.0f, 0.0f,
+    0.0f, 1.0f, 4.0f, -1.0f,
+    1.0f, 0.0f, 2.0f, 3.0f
+  };
+
+  constexpr Mat44<float> b44f {
+    1.0f, 2.0f, -1.0f, 0.0f,
+    0.0f, 1.0f, 3.0f, 1.0f,
+    2.0f, 0.0f, 1.0f, -2.0f,
+    1.0f, 1.0f, 0.0f, 1.0f
+  };
+
+  constexpr bool equal(const Vec3<double>& x, const Vec3<double>& y) {
+    return x.x1 == y.x1 && x.x2 == y.x2 && x.x3 == y.x3;
+  }
+
+  constexpr bool equal(const Vec4<double>& x, const Vec4<double>& y) {
+    return x.x1 == y.x1 && x.x2 == y.x2 && x.x3 == y.x3 && x.x4 == y.x4;
+  }
+
+  constexpr bool equal(const Mat33<double>& m1, const Mat33<double>& m2) {
+    return (m1.x11 == m2.x11 && m1.x12 == m2.x12 && m1.x13 == m2.x13 &&
+	    m1.x21 == m2.x21 && m1.x22 == m2.x22 && m1.x23 == m2.x23 &&
+	    m1.x31 == m2.x31 && m1.x32 == m2.x32 && m1.x33 == m2.x33);
+  }
+
+  constexpr bool equal(const Mat44<double>& m1, const Mat44<double>& m2) {
+    return (m1.x11 == m2.x11 && m1.x12 == m2.x12 && m1.x13 == m2.x13 && m1.x14 == m2.x14 &&
+	    m1.x21 == m2.x21 && m1.x22 == m2.x22 && m1.x23 == m2.x23 && m1.x24 == m2.x24 &&
+	    m1.x31 == m2.x31 && m1.x32 == m2.x32 && m1.x33 == m2.x33 && m1.x34 == m2.x34 &&
+	    m1.x41 == m2.x41 && m1.x42 == m2.x42 && m1.x43 == m2.x43 && m1.x44 == m2.x44);
+  }
+}
+
+/*
+  Vector algebra.
+ */
+static_assert(equal(v1 + v2, v2 + v1), "Vec3 addition is commutative");
+static_assert(equal((v1 + v2) + v3, v1 + (v2 + v3)), "Vec3 addition is associative");
+static_assert(equal(2.0 * v1, v1 * 2.0), "Vec3 scalar multiplication is commutative");
+static_assert(equal(3.0 * (v1 + v2), 3.0 * v1 + 3.0 * v2), "Vec3 distributivity");
+static_assert(equal(w1 + w2, w2 + w1), "Vec4 addition is commutative");
+static_assert(equal(w1 - w1, 0.0 * w1), "Vec4 additive inverse");
+
+static_assert(dot(v1, v2) == dot(v2, v1), "Vec3 dot is commutative");
+static_assert(dot(w1, w2) == dot(w2, w1), "Vec4 dot is commutative");
+static_assert(dot(cross(v1, v2), v1) == 0.0, "cross is orthogonal to its first argument");
+static_assert(dot(cross(v1, v2), v2) == 0.0, "cross is orthogonal to its second argument");
+static_assert(equal(cross(v1, v2), -1.0 * cross(v2, v1)), "cross is anticommutative");
+
+/*
+  Matrix algebra.
+ */
+static_assert(equal(eye33 * a33, a33 * eye33), "Mat33 identity commutes");
+static_assert(equal(transpose(transpose(a33)), a33), "Mat33 transpose is an involution");
+static_assert(equal(transpose(transpose(a44)), a44), "Mat44 transpose is an involution");
+static_assert(equal(transpose(a33 * b33), transpose(b33) * transpose(a33)),
+	      "Mat33 transpose reverses products");
+
+static_assert(det(eye33) == 1.0, "Mat33 det of the identity is one");
+static_assert(det(eye44) == 1.0, "Mat44 det of the identity is one");
+static_assert(det(a33) == det(transpose(a33)), "Mat33 det is transpose invariant");
+static_assert(det(a44) == det(transpose(a44)), "Mat44 det is transpose invariant");
+static_assert(det(a33 * b33) == det(a33) * det(b33), "Mat33 det is homomorphic");
+static_assert(det(2.0 * a33) == 8.0 * det(a33), "Mat33 det scales with the cube");
+
+static_assert(trace(a33 * b33) == trace(b33 * a33), "Mat33 trace of products commutes");
+static_assert(trace(a33 + b33) == trace(a33) + trace(b33), "Mat33 trace is additive");
+
+static_assert(equal(a33 * v1, Vec3<double>{4.0, 1.0, 10.0}), "Mat33 * Vec3");
+
+/*
+  Mat44 products. Without a way to detect constant evaluation the SIMD
+  overloads are not constexpr, and only product() folds.
+ */
+#if !defined(VERIFIED_MATH_SSE2) || defined(VERIFIED_MATH_HAS_IS_CONSTANT_EVALUATED)
+static_assert(equal(eye44 * a44, a44 * eye44), "Mat44 identity commutes");
+static_assert(det(a44 * b44) == det(a44) * det(b44), "Mat44 det is homomorphic");
+static_assert(trace(a44 * b44) == trace(b44 * a44), "Mat44 trace of products commutes");
+static_assert(trace(a44f * b44f) == trace(b44f * a44f), "Mat44<float> trace of products commutes");
+#endif
+static_assert(equal(product(eye44, a44), a44), "Mat44 product() is constexpr");
+
+TEST(TestConstexpr, TestValuesAreConstant) {
+  // The same functions are still usable at run time.
+  constexpr double d = det(a33);
+  constexpr double t = trace(a33);
+  EXPECT_EQ(d, det(a33));
+  EXPECT_EQ(t, trace(a33));
+
+#if !defined(VERIFIED_MATH_SSE2) || defined(VERIFIED_MATH_HAS_IS_CONSTANT_EVALUATED)
+  // Small integers, so the run-time SIMD product is exact too.
+  constexpr Mat44<double> p = a44 * b44;
+  EXPECT_TRUE(equal(p, a44 * b44));
+#endif
+}
@@ -0,0 +1,187 @@
+#include "verified_math/double_word.h"
+#include "verified_math/vec3.h"
+#include "verified_math/vec4.h"
+#include "verified_math/mat33.h"
+#include "verified_math/mat44.h"
+#include "verified_math/quat.h"
+#include "verified_math/eigen33.h"
+#include "verified_math/svd33.h"
+#include "verified_math/solve.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <cfloat>
+
+/*
+  Sums and products of two doubles are exact in DoubleDouble, which the
+  error-free transformations check directly. Elsewhere results are
+  compared with identities that hold to the 106-bit precision, about
+  1e-31 relative.
+ */
+using verified_math::DoubleDouble;
+using verified_math::FloatFloat;
+
+static const double dd_tol = 64 * DBL_EPSILON * DBL_EPSILON;
+
+static double value(const DoubleDouble& x) {
+  return x.hi() + x.lo();
+}
+
+TEST(TestDoubleWord, TestExactSumAndProduct) {
+  auto exact = [](double a, double b) {
+    if (!std::isfinite(a * b) || std::fabs(a * b) < DBL_MIN / DBL_EPSILON) {
+      return true;
+    }
+    const DoubleDouble s = DoubleDouble(a) + DoubleDouble(b);
+    const DoubleDouble d = DoubleDouble(a) - b;
+    const DoubleDouble p = a * DoubleDouble(b);
+    const double es = (a - (s.hi() - (s.hi() - a))) + (b - (s.hi() - a));
+    return s.hi() == a + b && s.lo() == es && d.hi() == a - b &&
+      p.hi() == a * b && p.lo() == std::fma(a, b, -(a * b));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double> { exact }, 10000));
+}
+
+TEST(TestDoubleWord, TestDivisionAndSqrt) {
+  auto accurate = [](double a, double b) {
+    if (b == 0 || !std::isfinite(a / b) || std::fabs(a / b) < DBL_MIN / DBL_EPSILON ||
+	std::fabs(a) < DBL_MIN / DBL_EPSILON) {
+      return true;
+    }
+    // a / b = q + r / b with the remainder r exact by fma; q.lo must be
+    // that correction to the double quotient.
+    const DoubleDouble q = DoubleDouble(a) / b;
+    const double r = std::fma(-q.hi(), b, a);
+    const bool div = std::fabs(q.lo() - r / b) <= 16 * DBL_EPSILON * std::fabs(q.lo()) +
+      dd_tol * std::fabs(q.hi());
+
+    // a^2 is exact, so its square root is |a|.
+    const DoubleDouble root = sqrt(DoubleDouble(a) * a);
+    return div && root.hi() == std::fabs(a) && std::fabs(root.lo()) <= dd_tol * std::fabs(a);
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double> { accurate }, 10000));
+
+  const DoubleDouble third = DoubleDouble(1) / 3;
+  EXPECT_LE(std::fabs(value(3 * third - 1)), dd_tol);
+  const DoubleDouble two = sqrt(DoubleDouble(2));
+  EXPECT_LE(std::fabs(value(two * two - 2)), dd_tol);
+  EXPECT_EQ(0.0, sqrt(DoubleDouble(0)).hi());
+  EXPECT_TRUE(std::isnan(sqrt(DoubleDouble(-1)).hi()));
+}
+
+TEST(TestDoubleWord, TestTrigonometry) {
+  for (int i = -40; i <= 40; ++i) {
+    const DoubleDouble x = DoubleDouble(i) / 7;
+    const DoubleDouble s = sin(x), c = cos(x);
+    EXPECT_LE(std::fabs(value(s * s + c * c - 1)), dd_tol) << i;
+    // The double results are within an ulp of the exact values.
+    EXPECT_LE(std::fabs(s.hi() - std::sin(value(x))), 4e-16) << i;
+    if (std::fabs(value(x)) < 3) {
+      EXPECT_LE(std::fabs(value(acos(c) - abs(x))), 4 * dd_tol) << i;
+    }
+  }
+  // sin(pi / 6) = 1 / 2, with pi / 6 from acos(sqrt(3) / 2).
+  const DoubleDouble pi_6 = acos(sqrt(DoubleDouble(3)) / 2);
+  EXPECT_LE(std::fabs(value(sin(pi_6) - DoubleDouble(0.5))), dd_tol);
+  EXPECT_LE(std::fabs(value(6 * pi_6 - acos(DoubleDouble(-1)))), 4 * dd_tol);
+}
+
+// A matrix with determinant 1 and condition number about 1e16 for
+// n = 100, 4e8 for n = 10: L L^T for the unit lower triangular L with
+// k = n + 1/3 below the diagonal. k is not a binary fraction, so unlike
+// an integer matrix its inverse is not computed exactly.
+template<typename Scalar>
+static verified_math::Mat44<Scalar> ill_conditioned(int n) {
+  const Scalar k = Scalar(n) + Scalar(1) / Scalar(3);
+  const verified_math::Mat44<Scalar> l{
+    1, 0, 0, 0,
+    k, 1, 0, 0,
+    k, k, 1, 0,
+    k, k, k, 1
+  };
+  return l * transpose(l);
+}
+
+template<typename Scalar>
+static double identity_error(const verified_math::Mat44<Scalar>& p) {
+  const Scalar* e = &p.x11;
+  double error = 0;
+  for (int i = 0; i < 16; ++i) {
+    const Scalar d = e[i] - Scalar(i % 5 == 0 ? 1 : 0);
+    error = std::max(error, std::fabs(double(d.hi())));
+  }
+  return error;
+}
+
+TEST(TestDoubleWord, TestIllConditionedInverse) {
+  const auto m = ill_conditioned<DoubleDouble>(100);
+  const auto md = ill_conditioned<double>(100);
+  EXPECT_LE(std::fabs(value(det(m) - 1)), 1e-12);
+  EXPECT_GT(verified_math::condition_number(md), 1e15);
+
+  // The double inverse has lost all its digits; the DoubleDouble one
+  // keeps about 15 of its 31.
+  const auto inv = inverse(m);
+  EXPECT_LT(identity_error(m * inv), 1e-12);
+  const auto pd = md * inverse(md);
+  EXPECT_GT(std::fabs(pd.x11 - 1) + std::fabs(pd.x21) + std::fabs(pd.x44 - 1), 1e-3);
+
+  const auto r = verified_math::try_inverse(m);
+  ASSERT_TRUE(r.ok);
+  EXPECT_GT(value(r.condition_estimate), 1e15);
+}
+
+TEST(TestDoubleWord, TestTemplates) {
+  typedef verified_math::Vec3<DoubleDouble> V;
+  const V x(DoubleDouble(1) / 3, 2, -0.5), y(0.25, -1, DoubleDouble(2) / 7);
+  EXPECT_LE(std::fabs(value(dot(cross(x, y), x))), dd_tol);
+
+  const verified_math::Mat33<DoubleDouble> m{
+    4, 1, DoubleDouble(1) / 3,
+    1, 3, 0.5,
+    DoubleDouble(1) / 3, 0.5, 2
+  };
+  const auto id = m * inverse(m);
+  EXPECT_LE(std::fabs(value(id.x11 - 1)) + std::fabs(value(id.x12)) + std::fabs(value(id.x33 - 1)),
+	    4 * dd_tol);
+
+  const auto b = verified_math::Vec3<DoubleDouble>(1, -2, DoubleDouble(1) / 7);
+  const auto r = m * verified_math::solve(m, b) - b;
+  EXPECT_LE(std::fabs(value(r.x1)) + std::fabs(value(r.x2)) + std::fabs(value(r.x3)), 16 * dd_tol);
+
+  // The closed-form eigensolver: m v = lambda v for the largest pair.
+  const auto eig = verified_math::symmetric_eigen(m);
+  const V v(eig.vectors.x13, eig.vectors.x23, eig.vectors.x33);
+  const V mv = m * v - eig.values.x3 * v;
+  EXPECT_LE(std::fabs(value(mv.x1)) + std::fabs(value(mv.x2)) + std::fabs(value(mv.x3)), 1e-28);
+
+  const auto svd = verified_math::svd(m);
+  const auto back = svd.u * verified_math::Mat33<DoubleDouble>{
+    svd.sigma.x1, 0, 0, 0, svd.sigma.x2, 0, 0, 0, svd.sigma.x3} * transpose(svd.v);
+  EXPECT_LE(std::fabs(value(back.x12 - m.x12)) + std::fabs(value(back.x31 - m.x31)), 1e-28);
+
+  const auto q = verified_math::from_axis_angle(V(0, 0, 1), DoubleDouble(1) / 3);
+  const auto half = verified_math::slerp(verified_math::Quat<DoubleDouble>(1, 0, 0, 0), q,
+					 DoubleDouble(0.5));
+  const auto twice = half * half;
+  EXPECT_LE(std::fabs(value(twice.w - q.w)) + std::fabs(value(twice.z - q.z)), 16 * dd_tol);
+}
+
+TEST(TestDoubleWord, TestFloatFloat) {
+  // 48 bits: the float inverse of a matrix with condition number 1e8 is
+  // useless, the FloatFloat one good to about 1e-6.
+  const auto m = ill_conditioned<FloatFloat>(10);
+  const auto md = ill_conditioned<float>(10);
+  EXPECT_LE(std::fabs((det(m) - 1).hi()), 1e-6f);
+  const auto p = m * inverse(m);
+  const FloatFloat* e = &p.x11;
+  for (int i = 0; i < 16; ++i) {
+    EXPECT_LT(std::fabs((e[i] - FloatFloat(i % 5 == 0 ? 1.0f : 0.0f)).hi()), 1e-6f) << i;
+  }
+  const auto pd = md * inverse(md);
+  EXPECT_GT(std::fabs(pd.x11 - 1) + std::fabs(pd.x12) + std::fabs(pd.x44 - 1), 1e-3f);
+  EXPECT_LE(std::fabs((sqrt(FloatFloat(2)) * sqrt(FloatFloat(2)) - 2).hi()), 1e-13f);
+}
@@ -0,0 +1,152 @@
+#include "verified_math/eigen33.h"
+#include "verified_math/parallel.h"
+#include "verified_math/quat.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <cfloat>
+#include <vector>
+
+/*
+  The decomposition is checked through its invariants: the eigenvalues sum
+  to the trace and multiply to the determinant, V is a rotation, and
+  V diag(values) V^T reconstructs m. Errors are measured relative to the
+  Frobenius norm of m.
+ */
+static verified_math::Mat33<double> symmetric(double a11, double a12, double a13,
+					      double a22, double a23, double a33) {
+  return verified_math::Mat33<double>{
+    a11, a12, a13,
+    a12, a22, a23,
+    a13, a23, a33
+  };
+}
+
+static bool is_decomposition(const verified_math::Mat33<double>& m,
+			     const verified_math::SymmetricEigen33<double>& e) {
+  const double tol = 64 * DBL_EPSILON;
+  const double norm = std::sqrt(m.l2_norm());
+  const auto& l = e.values;
+  const auto& v = e.vectors;
+
+  if (!(l.x1 <= l.x2 && l.x2 <= l.x3)) {
+    return false;
+  }
+  if (fabs(l.x1 + l.x2 + l.x3 - verified_math::trace(m)) > tol * norm) {
+    return false;
+  }
+  if (fabs(l.x1 * l.x2 * l.x3 - verified_math::det(m)) > tol * norm * norm * norm) {
+    return false;
+  }
+
+  const verified_math::Mat33<double> id{1, 0, 0, 0, 1, 0, 0, 0, 1};
+  if ((verified_math::transpose(v) * v - id).l2_norm() > tol * tol ||
+      verified_math::det(v) <= 0) {
+    return false;
+  }
+
+  const verified_math::Mat33<double> d{l.x1, 0, 0, 0, l.x2, 0, 0, 0, l.x3};
+  const auto r = v * d * verified_math::transpose(v) - m;
+  return r.l2_norm() <= tol * tol * m.l2_norm();
+}
+
+TEST(TestEigen33, TestDecomposition) {
+  auto decomposes = [](double a11, double a12, double a13,
+		       double a22, double a23, double a33) {
+    const auto m = symmetric(a11, a12, a13, a22, a23, a33);
+    return is_decomposition(m, verified_math::symmetric_eigen(m));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double> { decomposes }, 10000));
+}
+
+TEST(TestEigen33, TestRepeatedEigenvalues) {
+  // R diag(l) R^T with a double eigenvalue, where the closed form loses
+  // accuracy and the Jacobi refinement takes over.
+  auto decomposes = [](double w, double x, double y, double z, double l1, double l2) {
+    auto q = verified_math::Quat<double>(w, x, y, z);
+    if (!std::isfinite(q.l2_norm()) || q.l2_norm() < 1e-12) {
+      return true;
+    }
+    const auto r = verified_math::to_mat33(verified_math::normalize(q));
+    const verified_math::Mat33<double> d{l1, 0, 0, 0, l1, 0, 0, 0, l2};
+    const auto m = r * d * verified_math::transpose(r);
+    // Symmetrize the rounding of the product.
+    const auto s = symmetric(m.x11, m.x12, m.x13, m.x22, m.x23, m.x33);
+    return is_decomposition(s, verified_math::symmetric_eigen(s));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double> { decomposes }, 10000));
+}
+
+TEST(TestEigen33, TestSpecialMatrices) {
+  const auto zero = verified_math::symmetric_eigen(symmetric(0, 0, 0, 0, 0, 0));
+  EXPECT_EQ(0.0, zero.values.x1);
+  EXPECT_EQ(0.0, zero.values.x3);
+  EXPECT_EQ(1.0, zero.vectors.x11);
+  EXPECT_EQ(1.0, zero.vectors.x33);
+
+  const auto diagonal = verified_math::symmetric_eigen(symmetric(3, 0, 0, -1, 0, 2));
+  EXPECT_EQ(-1.0, diagonal.values.x1);
+  EXPECT_EQ(2.0, diagonal.values.x2);
+  EXPECT_EQ(3.0, diagonal.values.x3);
+  EXPECT_EQ(1.0, fabs(diagonal.vectors.x21));
+
+  const verified_math::Mat33<double> cases[] = {
+    symmetric(5, 0, 0, 5, 0, 5),
+    symmetric(1, 1, 1, 1, 1, 1),
+    symmetric(2, -1, 0, 2, -1, 2),
+    symmetric(1, 1e-9, 0, 1, 1e-9, 1),
+    symmetric(1e100, 1e99, 0, 1e100, 0, 1e100),
+    symmetric(1e-100, 1e-101, 0, 1e-100, 0, 1e-100),
+  };
+  for (const auto& m : cases) {
+    EXPECT_TRUE(is_decomposition(m, verified_math::symmetric_eigen(m)));
+  }
+
+  // Subnormal entries, whose reciprocal overflows: the values are those
+  // of the unscaled matrix to the precision the subnormals carry.
+  const double tiny = 1e-320;
+  const auto sub = verified_math::symmetric_eigen(symmetric(2 * tiny, tiny, 0, 2 * tiny, 0, 3 * tiny));
+  EXPECT_NEAR(1.0, sub.values.x1 / tiny, 1e-2);
+  EXPECT_NEAR(3.0, sub.values.x2 / tiny, 1e-2);
+  EXPECT_NEAR(3.0, sub.values.x3 / tiny, 1e-2);
+  EXPECT_NEAR(1.0, verified_math::det(sub.vectors), 1e-12);
+
+  // The covariance of points on a plane: one zero eigenvalue, with the
+  // plane normal as its eigenvector.
+  const auto cov = symmetric(2, 1, 0, 2, 0, 0);
+  const auto e = verified_math::symmetric_eigen(cov);
+  EXPECT_NEAR(0.0, e.values.x1, 1e-15);
+  EXPECT_NEAR(1.0, fabs(e.vectors.x31), 1e-15);
+}
+
+TEST(TestEigen33, TestBatchedMatchesSingle) {
+  verified_math::Mat33Array<double> m;
+  for (int i = 0; i < 101; ++i) {
+    m.push_back(symmetric(i, 1.0 - i, 0.5, 2.0 * i, -0.25 * i, 3.0));
+  }
+
+  verified_math::Vec3Array<double> values;
+  verified_math::Mat33Array<double> vectors;
+  verified_math::symmetric_eigen(m, values, vectors);
+
+  verified_math::ThreadPool pool(3);
+  verified_math::Vec3Array<double> values2;
+  verified_math::Mat33Array<double> vectors2;
+  verified_math::parallel_symmetric_eigen(m, values2, vectors2, verified_math::Partition(&pool, 1));
+
+  ASSERT_EQ(m.size(), values.size());
+  ASSERT_EQ(m.size(), vectors2.size());
+  for (std::size_t i = 0; i < m.size(); ++i) {
+    const auto e = verified_math::symmetric_eigen(m[i]);
+    EXPECT_EQ(e.values.x2, values[i].x2);
+    EXPECT_EQ(e.vectors.x23, vectors[i].x23);
+    EXPECT_EQ(e.values.x3, values2[i].x3);
+    EXPECT_EQ(e.vectors.x31, vectors2[i].x31);
+    EXPECT_TRUE(is_decomposition(m[i], e));
+  }
+}
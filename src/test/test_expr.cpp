@@ -0,0 +1,151 @@
+#include "verified_math/expr.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <type_traits>
+#include <utility>
+
+#define epsilon 0.001
+
+/*
+  Fused expressions should agree with the eager operators.
+ */
+namespace {
+  // Agreement up to rounding. FMA contraction may differ between the two
+  // paths, so the tolerance is relative to the magnitude of the terms, not
+  // of the (possibly cancelled) result.
+  template<typename T>
+  bool close(const T& x, const T& y, double scale) {
+    typedef verified_math::expr::Shape<T> S;
+    for (std::size_t i = 0; i < S::size; ++i) {
+      double a = S::data(x)[i];
+      double b = S::data(y)[i];
+      if (fabs(a - b) > epsilon * (1.0 + scale)) {
+	return false;
+      }
+    }
+    return true;
+  }
+
+  // Whether lazy(A) + lazy(B) and lazy(A) - lazy(B) are well formed.
+  template<typename A, typename B, typename = void>
+  struct can_combine : std::false_type { };
+
+  template<typename A, typename B>
+  struct can_combine<A, B, decltype(
+    (void)(verified_math::lazy(std::declval<A>()) + verified_math::lazy(std::declval<B>())),
+    (void)(verified_math::lazy(std::declval<A>()) - verified_math::lazy(std::declval<B>())))>
+    : std::true_type { };
+}
+
+TEST(TestExpr, TestMat44LinearCombination) {
+  auto linear_combination = [](double x11, double x12, double x13, double x14,
+			       double x21, double x22, double x23, double x24,
+			       double x31, double x32, double x33, double x34,
+			       double x41, double x42, double x43, double x44,
+			       double a, double b) {
+    auto m1 = verified_math::Mat44<double> {
+      x11, x12, x13, x14,
+      x21, x22, x23, x24,
+      x31, x32, x33, x34,
+      x41, x42, x43, x44
+    };
+    auto m2 = verified_math::transpose(m1);
+    auto m3 = a * m2;
+
+    using verified_math::lazy;
+    auto fused = verified_math::eval(a * lazy(m1) + b * lazy(m2) - lazy(m3));
+    auto eager = a * m1 + b * m2 - m3;
+
+    return close(fused, eager, (fabs(a) + fabs(b)) * m1.l2_norm());
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double> {
+			       linear_combination }, 10000));
+}
+
+TEST(TestExpr, TestMat33ProductsAreEager) {
+  auto products = [](double x11, double x12, double x13,
+		     double x21, double x22, double x23,
+		     double x31, double x32, double x33,
+		     double v1, double v2, double v3) {
+    auto m1 = verified_math::Mat33<double> {
+      x11, x12, x13,
+      x21, x22, x23,
+      x31, x32, x33
+    };
+    auto m2 = verified_math::transpose(m1);
+    auto v = verified_math::Vec3<double>{v1, v2, v3};
+
+    using verified_math::lazy;
+    auto fused_mat = verified_math::eval(lazy(m1) * (lazy(m1) + lazy(m2)) - 2.0 * lazy(m2));
+    auto eager_mat = m1 * (m1 + m2) - 2.0 * m2;
+
+    auto fused_vec = verified_math::eval((lazy(m1) - lazy(m2)) * lazy(v) + lazy(v));
+    auto eager_vec = (m1 - m2) * v + v;
+
+    auto norm = m1.l2_norm();
+    return (close(fused_mat, eager_mat, norm) &&
+	    close(fused_vec, eager_vec, norm * verified_math::dot(v, v)));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double,
+			     double, double, double> {
+			       products }, 10000));
+}
+
+TEST(TestExpr, TestVec4Chain) {
+  auto chain = [](double x1, double x2, double x3, double x4,
+		  double y1, double y2, double y3, double y4,
+		  double c) {
+    auto v = verified_math::Vec4<double>{x1, x2, x3, x4};
+    auto w = verified_math::Vec4<double>{y1, y2, y3, y4};
+
+    using verified_math::lazy;
+    auto fused = verified_math::eval(c * (lazy(v) - lazy(w)) + lazy(w) * c);
+    auto eager = c * (v - w) + w * c;
+
+    return close(fused, eager, fabs(c) * (dot(v, v) + dot(w, w)));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double,
+			     double> {
+			       chain }, 10000));
+}
+
+TEST(TestExpr, TestAssignToOperand) {
+  auto m = verified_math::Mat44<double> {
+    1.0, 2.0, 3.0, 4.0,
+    5.0, 6.0, 7.0, 8.0,
+    9.0, 10.0, 11.0, 12.0,
+    13.0, 14.0, 15.0, 16.0
+  };
+  auto expected = m * m + m;
+
+  using verified_math::lazy;
+  m = verified_math::eval(lazy(m) * lazy(m) + lazy(m));
+
+  EXPECT_TRUE(close(m, expected, 0.0));
+}
+
+TEST(TestExpr, TestMismatchedShapesAreRejected) {
+  using verified_math::Vec3;
+  using verified_math::Vec4;
+  using verified_math::Mat33;
+  using verified_math::Mat44;
+  static_assert(can_combine<Mat44<double>, Mat44<double> >::value, "same shape");
+  static_assert(can_combine<Vec3<float>, Vec3<float> >::value, "same shape");
+  static_assert(!can_combine<Mat44<double>, Mat33<double> >::value, "Mat44 and Mat33");
+  static_assert(!can_combine<Vec4<double>, Vec3<double> >::value, "Vec4 and Vec3");
+  static_assert(!can_combine<Mat33<double>, Vec3<double> >::value, "Mat33 and Vec3");
+  static_assert(!can_combine<Vec3<double>, Vec3<float> >::value, "double and float");
+  EXPECT_TRUE((can_combine<Mat33<double>, Mat33<double> >::value));
+}
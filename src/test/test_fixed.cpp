@@ -0,0 +1,296 @@
+#include "verified_math/fixed.h"
+#include "verified_math/vec3_array.h"
+#include "verified_math/vec4_array.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+/*
+  Fixed-point arithmetic is integer arithmetic, so most results are
+  checked exactly: against integer and dyadic values that double holds
+  exactly, against the rounding rules, and between the scalar templates
+  and the batched kernels. The golden values pin down the results that
+  every platform must reproduce bit for bit.
+ */
+using verified_math::Vec3;
+using verified_math::Vec4;
+using verified_math::Mat33;
+using verified_math::Mat44;
+
+typedef verified_math::Fixed<16, 16> Fixed;
+typedef verified_math::Fixed<4, 12> Short;
+
+static const double unit = std::ldexp(1.0, -16);
+
+namespace {
+  // Random values of magnitude below 8, whose products and sums of
+  // products are exact in double.
+  struct Sampler {
+    std::mt19937 rng{42};
+
+    Fixed operator()() {
+      return Fixed::from_raw(std::int32_t(rng() % (1u << 20)) - (1 << 19));
+    }
+  };
+
+  double value(Fixed x) {
+    return double(x);
+  }
+
+  // A multiple of 2^-32 rounded to a multiple of 2^-16, ties up.
+  double round_ties_up(double x) {
+    return std::floor(x / unit + 0.5) * unit;
+  }
+}
+
+TEST(TestFixed, TestConversions) {
+  EXPECT_EQ(3 << 15, Fixed(1.5).raw());
+  EXPECT_EQ(-(3 << 15), Fixed(-1.5).raw());
+  EXPECT_EQ(-(7 << 16), Fixed(-7).raw());
+  EXPECT_EQ(1, Fixed(unit / 2).raw());
+  EXPECT_EQ(-1, Fixed(-unit / 2).raw());
+  EXPECT_EQ(0, Fixed(unit / 2 - unit / 8).raw());
+  EXPECT_EQ(unit, double(Fixed::from_raw(1)));
+  EXPECT_EQ(-32768.0, double(std::numeric_limits<Fixed>::lowest()));
+  EXPECT_EQ(0.25f, float(Short(0.25)));
+
+  // Every value of the short format, and a sample of the long one,
+  // converts to double and back unchanged.
+  for (std::int32_t r = -32768; r < 32768; ++r) {
+    const Short s = Short::from_raw(std::int16_t(r));
+    EXPECT_EQ(r, Short(double(s)).raw()) << r;
+  }
+  std::mt19937 rng(3);
+  for (int i = 0; i < 100000; ++i) {
+    const Fixed x = Fixed::from_raw(std::int32_t(rng()));
+    EXPECT_EQ(x.raw(), Fixed(double(x)).raw());
+  }
+}
+
+TEST(TestFixed, TestArithmeticRules) {
+  const Fixed eps = std::numeric_limits<Fixed>::epsilon();
+  const Fixed max = std::numeric_limits<Fixed>::max();
+  const Fixed lowest = std::numeric_limits<Fixed>::lowest();
+
+  // Wraps around.
+  EXPECT_EQ(lowest, max + eps);
+  EXPECT_EQ(max, lowest - eps);
+  EXPECT_EQ(lowest, -lowest);
+  EXPECT_EQ(Fixed(-32768), Fixed(32768));
+
+  // Products round to nearest, ties up.
+  const Fixed half(0.5);
+  EXPECT_EQ(1, (eps * half).raw());
+  EXPECT_EQ(0, (-eps * half).raw());
+  EXPECT_EQ(1, (Fixed::from_raw(3) * Fixed(0.25)).raw());
+  EXPECT_EQ(-1, (Fixed::from_raw(-3) * Fixed(0.25)).raw());
+  EXPECT_EQ(Fixed(6), Fixed(-2) * Fixed(-3));
+  EXPECT_EQ(Fixed(-0.75), Fixed(1.5) * Fixed(-0.5));
+
+  // Quotients truncate; division by zero saturates.
+  EXPECT_EQ(21845, (Fixed(1) / Fixed(3)).raw());
+  EXPECT_EQ(-21845, (Fixed(-1) / Fixed(3)).raw());
+  EXPECT_EQ(Fixed(-2.5), Fixed(5) / Fixed(-2));
+  EXPECT_EQ(max, Fixed(1) / Fixed(0));
+  EXPECT_EQ(lowest, Fixed(-1) / Fixed(0));
+  EXPECT_EQ(Fixed(0), Fixed(0) / Fixed(0));
+
+  EXPECT_EQ(Fixed(3), sqrt(Fixed(9)));
+  EXPECT_EQ(Fixed(0.5), sqrt(Fixed(0.25)));
+  EXPECT_EQ(92681, sqrt(Fixed(2)).raw());
+  EXPECT_EQ(Fixed(0), sqrt(Fixed(-4)));
+  EXPECT_EQ(Short(1.5), sqrt(Short(2.25)));
+  EXPECT_EQ(Fixed(2), abs(Fixed(-2)));
+}
+
+TEST(TestFixed, TestProductsRoundOnce) {
+  auto rounded = [](double a, double b) {
+    // Dyadic values below 8 with 16 fraction bits, from the generator.
+    const Fixed x(std::fmod(a, 8.0)), y(std::fmod(b, 8.0));
+    const double q = value(x) / value(y);
+    return value(x * y) == round_ties_up(value(x) * value(y)) &&
+      (!(std::fabs(q) < 32767) || std::fabs(value(x / y) - q) < unit) &&
+      value(sqrt(abs(x))) <= std::sqrt(std::fabs(value(x))) &&
+      value(sqrt(abs(x))) + unit > std::sqrt(std::fabs(value(x)));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double> { rounded }, 10000));
+}
+
+TEST(TestFixed, TestWidenedDotAndCross) {
+  Sampler r;
+  for (int i = 0; i < 10000; ++i) {
+    const Vec3<Fixed> x{r(), r(), r()}, y{r(), r(), r()};
+    const Vec4<Fixed> u{r(), r(), r(), r()}, v{r(), r(), r(), r()};
+    const double x1 = value(x.x1), x2 = value(x.x2), x3 = value(x.x3);
+    const double y1 = value(y.x1), y2 = value(y.x2), y3 = value(y.x3);
+
+    // The exact results, rounded once.
+    EXPECT_EQ(round_ties_up(x1 * y1 + x2 * y2 + x3 * y3), value(dot(x, y)));
+    const Vec3<Fixed> c = cross(x, y);
+    EXPECT_EQ(round_ties_up(x2 * y3 - x3 * y2), value(c.x1));
+    EXPECT_EQ(round_ties_up(x3 * y1 - x1 * y3), value(c.x2));
+    EXPECT_EQ(round_ties_up(x1 * y2 - x2 * y1), value(c.x3));
+    EXPECT_EQ(round_ties_up(value(u.x1) * value(v.x1) + value(u.x2) * value(v.x2) +
+			    value(u.x3) * value(v.x3) + value(u.x4) * value(v.x4)),
+	      value(dot(u, v)));
+  }
+}
+
+TEST(TestFixed, TestWidenedDet) {
+  Sampler r;
+  for (int i = 0; i < 10000; ++i) {
+    const Mat33<Fixed> m{r(), r(), r(), r(), r(), r(), r(), r(), r()};
+    const Mat33<double> d{
+      value(m.x11), value(m.x12), value(m.x13),
+      value(m.x21), value(m.x22), value(m.x23),
+      value(m.x31), value(m.x32), value(m.x33)};
+    // Half a unit per minor times its entry, and the final rounding.
+    const double bound33 = (std::fabs(d.x11) + std::fabs(d.x12) + std::fabs(d.x13) + 1) * unit / 2;
+    EXPECT_LE(std::fabs(value(det(m)) - det(d)), bound33);
+
+    const Mat44<Fixed> n{r(), r(), r(), r(), r(), r(), r(), r(),
+	r(), r(), r(), r(), r(), r(), r(), r()};
+    const Mat44<double> e{
+      value(n.x11), value(n.x12), value(n.x13), value(n.x14),
+      value(n.x21), value(n.x22), value(n.x23), value(n.x24),
+      value(n.x31), value(n.x32), value(n.x33), value(n.x34),
+      value(n.x41), value(n.x42), value(n.x43), value(n.x44)};
+    // Each of the six products of minors errs by at most half a unit of
+    // each minor times the other, plus a quarter unit squared.
+    const double s[6] = {
+      e.x11 * e.x22 - e.x21 * e.x12, e.x11 * e.x23 - e.x21 * e.x13,
+      e.x11 * e.x24 - e.x21 * e.x14, e.x12 * e.x23 - e.x22 * e.x13,
+      e.x12 * e.x24 - e.x22 * e.x14, e.x13 * e.x24 - e.x23 * e.x14};
+    const double c[6] = {
+      e.x33 * e.x44 - e.x43 * e.x34, e.x32 * e.x44 - e.x42 * e.x34,
+      e.x32 * e.x43 - e.x42 * e.x33, e.x31 * e.x44 - e.x41 * e.x34,
+      e.x31 * e.x43 - e.x41 * e.x33, e.x31 * e.x42 - e.x41 * e.x32};
+    double bound44 = unit / 2;
+    for (int j = 0; j < 6; ++j) {
+      bound44 += (std::fabs(s[j]) + std::fabs(c[j]) + unit) * unit / 2;
+    }
+    EXPECT_LE(std::fabs(value(det(n)) - det(e)), bound44);
+  }
+
+  // Integer matrices have exact determinants.
+  const Mat33<Fixed> a{2, -3, 1, 4, 0, -5, 7, 6, 2};
+  EXPECT_EQ(Fixed(213), det(a));
+  const Mat44<Fixed> b{2, 0, 1, 3, -1, 4, 0, 2, 5, 1, -2, 0, 3, 3, 1, -4};
+  EXPECT_EQ(Fixed(353), det(b));
+}
+
+TEST(TestFixed, TestGenericTemplates) {
+  const Mat33<Fixed> m{2, 0, 0, 0, 4, 0, 0, 0, 8};
+  const Mat33<Fixed> inv = inverse(m);
+  EXPECT_EQ(Fixed(0.5), inv.x11);
+  EXPECT_EQ(Fixed(0.125), inv.x33);
+  EXPECT_EQ(Fixed(0), inv.x12);
+  EXPECT_EQ(Fixed(-1), transpose(Mat33<Fixed>{0, 0, 0, -1, 0, 0, 0, 0, 0}).x12);
+
+  const Mat44<Fixed> t{
+    1, 0, 0, 3,
+    0, 1, 0, -2,
+    0, 0, 1, Fixed(0.5),
+    0, 0, 0, 1};
+  const Vec4<Fixed> p = t * Vec4<Fixed>{1, 2, 3, 1};
+  EXPECT_EQ(Fixed(4), p.x1);
+  EXPECT_EQ(Fixed(0), p.x2);
+  EXPECT_EQ(Fixed(3.5), p.x3);
+  EXPECT_EQ(Fixed(1), p.x4);
+  const Mat44<Fixed> ti = inverse(t);
+  EXPECT_EQ(Fixed(-3), ti.x14);
+  EXPECT_EQ(Fixed(-0.5), ti.x34);
+
+  EXPECT_FALSE(try_inverse(Mat33<Fixed>{1, 2, 3, 2, 4, 6, 0, 1, 1}).ok);
+  EXPECT_TRUE(try_inverse(m).ok);
+
+  // The widened overloads are constexpr, as the templates are.
+  static_assert(det(Mat33<Fixed>{1, 2, 0, 0, 1, 0, 0, 0, 3}) == Fixed(3), "det");
+  static_assert(cross(Vec3<Fixed>{1, 0, 0}, Vec3<Fixed>{0, 1, 0}).x3 == Fixed(1), "cross");
+}
+
+namespace {
+  /*
+    The batched kernels against the scalar products, entry by entry, on
+    raw values over the whole range: wrapped results must agree too. The
+    arrays are longer than a kernel block and not a multiple of it.
+   */
+  template<typename X>
+  void check_batched() {
+    std::mt19937 rng(11);
+    auto r = [&]() { return X::from_raw(typename X::Rep(rng())); };
+    const Mat44<X> m{r(), r(), r(), r(), r(), r(), r(), r(),
+	r(), r(), r(), r(), r(), r(), r(), r()};
+    const Mat33<X> m3{r(), r(), r(), r(), r(), r(), r(), r(), r()};
+    std::vector<Vec4<X> > v;
+    std::vector<Vec3<X> > v3;
+    for (int i = 0; i < 601; ++i) {
+      v.push_back(Vec4<X>{r(), r(), r(), r()});
+      v3.push_back(Vec3<X>{r(), r(), r()});
+    }
+    const verified_math::Vec4Array<X> a(v.data(), v.size());
+    const verified_math::Vec3Array<X> a3(v3.data(), v3.size());
+
+    verified_math::Vec4Array<X> out;
+    verified_math::Vec3Array<X> out3;
+    std::vector<Vec4<X> > aos(v);
+    std::vector<Vec3<X> > aos3(v3);
+    std::vector<X> d(v.size()), d3(v3.size());
+    transform_vectors(m, a, out);
+    transform_vectors(m3, a3, out3);
+    transform_vectors(m, v.data(), aos.data(), v.size());
+    transform_vectors(m3, v3.data(), aos3.data(), v3.size());
+    dot(a, a, d.data());
+    dot(a3, a3, d3.data());
+    for (std::size_t i = 0; i < v.size(); ++i) {
+      const Vec4<X> w = m * v[i];
+      const Vec3<X> w3 = m3 * v3[i];
+      EXPECT_EQ(w.x1, out.x1[i]);
+      EXPECT_EQ(w.x4, out.x4[i]);
+      EXPECT_EQ(w.x2, aos[i].x2);
+      EXPECT_EQ(w3.x2, out3.x2[i]);
+      EXPECT_EQ(w3.x3, aos3[i].x3);
+      EXPECT_EQ(dot(v[i], v[i]), d[i]);
+      EXPECT_EQ(dot(v3[i], v3[i]), d3[i]);
+    }
+
+    // The ranged form leaves the rest of the output alone.
+    verified_math::Vec4Array<X> part(v.size());
+    transform_vectors(m, a, part, 250, 530);
+    EXPECT_EQ(X(0), part.x1[249]);
+    EXPECT_EQ(out.x3[250], part.x3[250]);
+    EXPECT_EQ(out.x4[529], part.x4[529]);
+    EXPECT_EQ(X(0), part.x4[530]);
+  }
+}
+
+TEST(TestFixed, TestBatchedKernelsMatchScalar) {
+  check_batched<Fixed>();
+  check_batched<Short>();
+}
+
+TEST(TestFixed, TestGoldenValues) {
+  // Results every platform must reproduce exactly; a change here breaks
+  // lockstep with other builds.
+  const Mat44<Fixed> m{
+    Fixed(1.25), Fixed(-0.3), Fixed(2.7), Fixed(0.01),
+    Fixed(0.9), Fixed(3.1), Fixed(-1.1), Fixed(0.4),
+    Fixed(-2.2), Fixed(0.6), Fixed(1.7), Fixed(-0.8),
+    Fixed(0.05), Fixed(-1.9), Fixed(0.3), Fixed(2.4)};
+  const Vec4<Fixed> v{Fixed(0.7), Fixed(-1.3), Fixed(2.9), Fixed(1)};
+  const Vec3<Fixed> a{Fixed(0.1), Fixed(0.2), Fixed(0.3)};
+  const Vec3<Fixed> b{Fixed(-1.7), Fixed(2.3), Fixed(0.9)};
+
+  const Vec4<Fixed> w = m * v;
+  EXPECT_EQ(596703, w.x1.raw());
+  EXPECT_EQ(378470, w.x4.raw());
+  EXPECT_EQ(4313632, det(m).raw());
+  EXPECT_EQ(9179, inverse(m).x23.raw());
+  EXPECT_EQ(-39322, cross(a, b).x2.raw());
+  EXPECT_EQ(196498, sqrt(dot(b, b)).raw());
+}
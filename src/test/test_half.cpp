@@ -0,0 +1,173 @@
+#include "verified_math/half.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <random>
+#include <vector>
+
+/*
+  The 16-bit formats are small enough to check every value: each decodes
+  exactly and encodes back to itself. Rounding from float is checked
+  against the nearest representable neighbours, and the bulk conversions
+  (F16C when available) against the scalar ones.
+ */
+using verified_math::Half;
+using verified_math::BFloat16;
+
+namespace {
+  bool is_nan_bits(std::uint16_t h) {
+    return (h & 0x7fffu) > 0x7c00u;
+  }
+
+  // The values of all 65536 encodings, by the bulk decode.
+  template<typename Storage>
+  std::vector<float> all_values() {
+    std::vector<Storage> s(65536);
+    for (std::size_t i = 0; i < s.size(); ++i) {
+      s[i] = Storage::from_bits(std::uint16_t(i));
+    }
+    std::vector<float> f(s.size());
+    verified_math::decode(s.data(), f.data(), s.size());
+    return f;
+  }
+}
+
+TEST(TestHalf, TestEveryValueRoundTrips) {
+  const std::vector<float> f = all_values<Half>();
+  for (std::uint32_t i = 0; i < 65536; ++i) {
+    const Half h = Half::from_bits(std::uint16_t(i));
+    if (is_nan_bits(std::uint16_t(i))) {
+      EXPECT_TRUE(std::isnan(f[i])) << i;
+      EXPECT_TRUE(is_nan_bits(Half(f[i]).bits())) << i;
+      continue;
+    }
+    EXPECT_EQ(float(h), f[i]) << i;
+    EXPECT_EQ(i, Half(f[i]).bits()) << i;
+  }
+
+  std::vector<Half> back(f.size());
+  verified_math::encode(f.data(), back.data(), f.size());
+  for (std::uint32_t i = 0; i < 65536; ++i) {
+    if (!is_nan_bits(std::uint16_t(i))) {
+      EXPECT_EQ(i, back[i].bits()) << i;
+    }
+  }
+}
+
+TEST(TestHalf, TestKnownValues) {
+  EXPECT_EQ(0x3c00u, Half(1.0f).bits());
+  EXPECT_EQ(0xc000u, Half(-2.0f).bits());
+  EXPECT_EQ(0x8000u, Half(-0.0f).bits());
+  EXPECT_EQ(0x7bffu, Half(65504.0f).bits());
+  EXPECT_EQ(0x7bffu, Half(65519.0f).bits());
+  EXPECT_EQ(0x7c00u, Half(65520.0f).bits());
+  EXPECT_EQ(0xfc00u, Half(-1e10f).bits());
+  EXPECT_EQ(0x0001u, Half(std::ldexp(1.0f, -24)).bits());
+  EXPECT_EQ(0x0400u, Half(std::ldexp(1.0f, -14)).bits());
+  // Ties go to even: 2^-25 to zero, 3 2^-25 up to 2^-23.
+  EXPECT_EQ(0x0000u, Half(std::ldexp(1.0f, -25)).bits());
+  EXPECT_EQ(0x0002u, Half(std::ldexp(3.0f, -25)).bits());
+  EXPECT_EQ(0x3c00u, Half(1.0f + std::ldexp(1.0f, -11)).bits());
+  EXPECT_EQ(0x3c02u, Half(1.0f + std::ldexp(3.0f, -11)).bits());
+  EXPECT_EQ(65504.0f, float(Half::from_bits(0x7bff)));
+  EXPECT_TRUE(std::isinf(float(Half::from_bits(0x7c00))));
+}
+
+TEST(TestHalf, TestRoundsToNearest) {
+  auto nearest = [](float x) {
+    if (!(std::fabs(x) < 65504.0f)) {
+      return true;
+    }
+    // The magnitude of the encoding is monotonic in its bits, so the
+    // neighbours of |h| are one bit pattern away.
+    const double a = std::fabs(x);
+    const std::uint16_t m = Half(x).bits() & 0x7fffu;
+    const double r = float(Half::from_bits(m));
+    const double up = float(Half::from_bits(std::uint16_t(m + 1)));
+    const double down = m == 0 ? -up : float(Half::from_bits(std::uint16_t(m - 1)));
+    const double err = std::fabs(r - a);
+    return err <= std::fabs(up - a) && err <= std::fabs(down - a) &&
+      err <= std::ldexp(1.0, -11) * a + std::ldexp(1.0, -25);
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<float> { nearest }, 10000));
+}
+
+TEST(TestHalf, TestBulkMatchesScalar) {
+  // Every length up to 40 for the eight-wide body and its tail.
+  std::vector<float> x;
+  for (int i = 0; i < 40; ++i) {
+    x.push_back(std::ldexp(float(i) - 19.7f, i % 19 - 12) * (1.0f + std::ldexp(float(i), -12)));
+  }
+  x[3] = 65520.0f;
+  x[5] = std::ldexp(3.0f, -25);
+  for (std::size_t n = 0; n <= x.size(); ++n) {
+    std::vector<Half> h(n);
+    std::vector<float> back(n);
+    verified_math::encode(x.data(), h.data(), n);
+    verified_math::decode(h.data(), back.data(), n);
+    for (std::size_t i = 0; i < n; ++i) {
+      EXPECT_EQ(Half(x[i]).bits(), h[i].bits()) << n << " " << i;
+      EXPECT_EQ(float(h[i]), back[i]) << n << " " << i;
+    }
+  }
+}
+
+TEST(TestHalf, TestBulkMatchesScalarOnRandomBits) {
+  // Every class of float: subnormal, normal, overflowing, infinite, NaN.
+  std::mt19937 rng(7);
+  std::vector<float> x(4099);
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    const std::uint32_t u = rng();
+    std::memcpy(&x[i], &u, sizeof u);
+    // Halfway and near-halfway cases of both formats.
+    if (i % 3 == 0) {
+      x[i] = std::ldexp(float(1 + 2 * (u % 2048)) / 4096, int(u % 48) - 30);
+    }
+  }
+  std::vector<Half> h(x.size());
+  std::vector<BFloat16> b(x.size());
+  verified_math::encode(x.data(), h.data(), x.size());
+  verified_math::encode(x.data(), b.data(), x.size());
+  for (std::size_t i = 0; i < x.size(); ++i) {
+    if (std::isnan(x[i])) {
+      EXPECT_TRUE(is_nan_bits(h[i].bits())) << i;
+      EXPECT_TRUE(std::isnan(float(b[i]))) << i;
+    } else {
+      EXPECT_EQ(Half(x[i]).bits(), h[i].bits()) << x[i];
+      EXPECT_EQ(BFloat16(x[i]).bits(), b[i].bits()) << x[i];
+    }
+  }
+}
+
+TEST(TestBFloat16, TestEveryValueRoundTrips) {
+  const std::vector<float> f = all_values<BFloat16>();
+  for (std::uint32_t i = 0; i < 65536; ++i) {
+    const BFloat16 b = BFloat16::from_bits(std::uint16_t(i));
+    if ((i & 0x7fffu) > 0x7f80u) {
+      EXPECT_TRUE(std::isnan(f[i])) << i;
+      EXPECT_TRUE(std::isnan(float(BFloat16(f[i])))) << i;
+      continue;
+    }
+    EXPECT_EQ(float(b), f[i]) << i;
+    EXPECT_EQ(i, BFloat16(f[i]).bits()) << i;
+  }
+}
+
+TEST(TestBFloat16, TestRounding) {
+  EXPECT_EQ(0x3f80u, BFloat16(1.0f).bits());
+  // 1 + 2^-8 is halfway between 1 and 1 + 2^-7: even is 1.
+  EXPECT_EQ(0x3f80u, BFloat16(1.0f + std::ldexp(1.0f, -8)).bits());
+  EXPECT_EQ(0x3f82u, BFloat16(1.0f + std::ldexp(3.0f, -8)).bits());
+  EXPECT_EQ(0x7f80u, BFloat16(3.4e38f).bits());
+  EXPECT_TRUE(std::isnan(float(BFloat16(std::nanf("")))));
+
+  auto relative = [](float x) {
+    const float r = float(BFloat16(x));
+    return std::fabs(double(r) - x) <= std::ldexp(1.0, -8) * std::fabs(x);
+  };
+  EXPECT_TRUE(checkpp::check(checkpp::Property<float> { relative }, 10000));
+}
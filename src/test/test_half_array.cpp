@@ -0,0 +1,209 @@
+#include "verified_math/half_array.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+/*
+  The kernels on 16-bit storage compute in float, so they should agree
+  with the float kernels applied to the decoded arrays: to float rounding
+  for float outputs and within one rounding of the storage format for
+  16-bit outputs. The arrays are longer than a kernel block and not a
+  multiple of it.
+ */
+using verified_math::Half;
+using verified_math::BFloat16;
+
+namespace {
+  const std::size_t array_size = 601;
+
+  // Relative precision: half an ulp of Half, of BFloat16.
+  template<typename Storage>
+  float unit_roundoff();
+
+  template<>
+  float unit_roundoff<Half>() {
+    return std::ldexp(1.0f, -11);
+  }
+
+  template<>
+  float unit_roundoff<BFloat16>() {
+    return std::ldexp(1.0f, -8);
+  }
+
+  // Unit-ish normals, with a zero vector in the mix.
+  verified_math::Vec3Array<float> normals(float x1, float x2, float x3) {
+    verified_math::Vec3Array<float> a;
+    for (std::size_t i = 0; i < array_size; ++i) {
+      const float s = std::sin(0.1f * i);
+      const float c = std::cos(0.37f * i);
+      a.push_back(verified_math::Vec3<float>{x1 + s, x2 * c, x3 - s * c});
+    }
+    a.set(17, verified_math::Vec3<float>{0, 0, 0});
+    return a;
+  }
+
+  bool close(float a, float b, float tol) {
+    return std::fabs(a - b) <= tol * (1.0f + std::fabs(b));
+  }
+
+  bool close(const verified_math::Vec3<float>& v1, const verified_math::Vec3<float>& v2, float tol) {
+    return close(v1.x1, v2.x1, tol) && close(v1.x2, v2.x2, tol) && close(v1.x3, v2.x3, tol);
+  }
+
+  // Bounded samples from the property generator.
+  float unit(float x) {
+    return std::sin(x);
+  }
+
+  template<typename Storage>
+  bool vec3_kernels(float x1, float x2, float x3, float y1, float y2, float y3) {
+    const float u = unit_roundoff<Storage>(), f = 8 * std::ldexp(1.0f, -24);
+    const verified_math::Vec3HalfArray<Storage> a(normals(unit(x1), unit(x2), unit(x3)));
+    const verified_math::Vec3HalfArray<Storage> b(normals(unit(y1), unit(y2), unit(y3)));
+    verified_math::Vec3Array<float> fa, fb;
+    decode(a, fa);
+    decode(b, fb);
+
+    std::vector<float> d(a.size()), fd(a.size());
+    verified_math::dot(a, b, d.data());
+    verified_math::dot(fa, fb, fd.data());
+
+    verified_math::Vec3Array<float> n, fn;
+    verified_math::Vec3HalfArray<Storage> nh;
+    verified_math::normalize(a, n);
+    verified_math::normalize(a, nh);
+    verified_math::normalize(fa, fn);
+
+    const verified_math::Mat33<float> m{
+      0.8f, -0.6f, 0.1f,
+      0.6f, 0.8f, -0.2f,
+      0.3f, 0.0f, 1.5f};
+    verified_math::Vec3Array<float> t, ft;
+    verified_math::Vec3HalfArray<Storage> th;
+    verified_math::transform_vectors(m, a, t);
+    verified_math::transform_vectors(m, a, th);
+    verified_math::transform_vectors(m, fa, ft);
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      if (!close(d[i], fd[i], f) ||
+	  !close(n[i], fn[i], f) || !close(nh[i], fn[i], 2 * u) ||
+	  !close(t[i], ft[i], f) || !close(th[i], ft[i], 2 * u)) {
+	return false;
+      }
+    }
+    return n[17].x1 == 0 && n[17].x2 == 0 && n[17].x3 == 0;
+  }
+
+  template<typename Storage>
+  bool vec4_kernels(float x1, float x2, float x3, float x4) {
+    const float u = unit_roundoff<Storage>(), f = 8 * std::ldexp(1.0f, -24);
+    verified_math::Vec4Array<float> v;
+    for (std::size_t i = 0; i < array_size; ++i) {
+      const float s = std::sin(0.1f * i);
+      v.push_back(verified_math::Vec4<float>{unit(x1) + s, unit(x2) - s, unit(x3) * s, unit(x4)});
+    }
+    const verified_math::Vec4HalfArray<Storage> a(v);
+    verified_math::Vec4Array<float> fa;
+    decode(a, fa);
+
+    std::vector<float> d(a.size()), fd(a.size());
+    verified_math::dot(a, a, d.data());
+    verified_math::dot(fa, fa, fd.data());
+
+    verified_math::Vec4Array<float> n, fn;
+    verified_math::Vec4HalfArray<Storage> nh;
+    verified_math::normalize(a, n);
+    verified_math::normalize(a, nh);
+    verified_math::normalize(fa, fn);
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      const verified_math::Vec4<float> p = n[i], q = nh[i], r = fn[i];
+      if (!close(d[i], fd[i], f) ||
+	  !close(p.x1, r.x1, f) || !close(p.x4, r.x4, f) ||
+	  !close(q.x1, r.x1, 2 * u) || !close(q.x2, r.x2, 2 * u) ||
+	  !close(q.x3, r.x3, 2 * u) || !close(q.x4, r.x4, 2 * u)) {
+	return false;
+      }
+    }
+    return true;
+  }
+}
+
+TEST(TestHalfArray, TestLanesAreAlignedAndPacked) {
+  verified_math::Vec3HalfArray<Half> a(7);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a.x1.data()) % verified_math::simd_alignment);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a.x3.data()) % verified_math::simd_alignment);
+  EXPECT_EQ(2u, sizeof(a.x2[0]));
+  // Value-initialized to +0.
+  EXPECT_EQ(0.0f, a[6].x2);
+}
+
+TEST(TestHalfArray, TestElementAccess) {
+  verified_math::Vec3HalfArray<Half> a;
+  a.push_back(verified_math::Vec3<float>{1.0f, -0.5f, 0.1f});
+  a.push_back(verified_math::Vec3<float>{65504.0f, 1e-7f, 1e6f});
+  EXPECT_EQ(2u, a.size());
+  EXPECT_EQ(-0.5f, a[0].x2);
+  EXPECT_EQ(float(Half(0.1f)), a[0].x3);
+  EXPECT_EQ(65504.0f, a[1].x1);
+  EXPECT_TRUE(std::isinf(a[1].x3));
+
+  a.set(0, verified_math::Vec3<float>{2.0f, 3.0f, 4.0f});
+  EXPECT_EQ(3.0f, a[0].x2);
+
+  verified_math::Vec4HalfArray<BFloat16> b(1);
+  b.set(0, verified_math::Vec4<float>{1.0f, 3e38f, -2.0f, 0.1f});
+  EXPECT_EQ(-2.0f, b[0].x3);
+  EXPECT_TRUE(close(b[0].x2, 3e38f, unit_roundoff<BFloat16>()));
+}
+
+TEST(TestHalfArray, TestVec3KernelsMatchFloat) {
+  EXPECT_TRUE(checkpp::check(checkpp::Property<float, float, float, float, float, float> {
+	vec3_kernels<Half> }, 50));
+  EXPECT_TRUE(checkpp::check(checkpp::Property<float, float, float, float, float, float> {
+	vec3_kernels<BFloat16> }, 50));
+}
+
+TEST(TestHalfArray, TestVec4KernelsMatchFloat) {
+  EXPECT_TRUE(checkpp::check(checkpp::Property<float, float, float, float> {
+	vec4_kernels<Half> }, 50));
+  EXPECT_TRUE(checkpp::check(checkpp::Property<float, float, float, float> {
+	vec4_kernels<BFloat16> }, 50));
+}
+
+TEST(TestHalfArray, TestRangesAndAliasing) {
+  const verified_math::Vec3HalfArray<Half> a(normals(0.3f, -0.7f, 0.2f));
+  const verified_math::Mat33<float> m{
+    0, 1, 0,
+    -1, 0, 0,
+    0, 0, 2};
+
+  // The ranged forms leave the rest of the output alone.
+  verified_math::Vec3Array<float> t(a.size());
+  verified_math::transform_vectors(m, a, t, 250, 530);
+  EXPECT_EQ(0.0f, t[249].x1);
+  EXPECT_EQ(0.0f, t[530].x3);
+  for (std::size_t i = 250; i < 530; ++i) {
+    EXPECT_EQ(a[i].x2, t[i].x1) << i;
+    EXPECT_EQ(-a[i].x1, t[i].x2) << i;
+    EXPECT_EQ(2 * a[i].x3, t[i].x3) << i;
+  }
+
+  // Normalization in place gives the same as into another array.
+  verified_math::Vec3HalfArray<Half> b = a, c;
+  verified_math::normalize(b, b);
+  verified_math::normalize(a, c);
+  for (std::size_t i = 0; i < a.size(); ++i) {
+    EXPECT_EQ(c.x1[i].bits(), b.x1[i].bits()) << i;
+    EXPECT_EQ(c.x3[i].bits(), b.x3[i].bits()) << i;
+  }
+
+  std::vector<float> d(a.size(), -1.0f);
+  verified_math::dot(a, a, d.data(), 1, 2);
+  EXPECT_EQ(-1.0f, d[0]);
+  EXPECT_EQ(-1.0f, d[2]);
+  EXPECT_NEAR(a[1].x1 * a[1].x1 + a[1].x2 * a[1].x2 + a[1].x3 * a[1].x3, d[1], 1e-6f);
+}
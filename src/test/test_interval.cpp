@@ -0,0 +1,182 @@
+#include "verified_math/interval.h"
+#include "verified_math/vec3.h"
+#include "verified_math/mat33.h"
+#include "verified_math/mat44.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cfenv>
+#include <cmath>
+#include <cfloat>
+#include <cstdint>
+
+/*
+  Enclosures are checked against exact references: the rounding error of
+  a double operation is itself a double (two-sum, fma), and integer
+  matrices have integer determinants that int64 holds exactly. The
+  comparisons go through long double, which holds both exactly on x86.
+ */
+typedef verified_math::Interval<double> I;
+
+static bool encloses(const I& a, long double exact) {
+  return a.lo() <= exact && exact <= a.hi();
+}
+
+// Whether a encloses s + e for the rounded result s and its error e,
+// strictly on the side of the error, and no wider than ulps units.
+static bool encloses_rounded(const I& a, double s, double e, int ulps = 2) {
+  const bool side = e > 0 ? a.hi() > s : (e < 0 ? a.lo() < s : true);
+  return a.lo() <= s && s <= a.hi() && side &&
+    a.hi() - a.lo() <= ulps * DBL_EPSILON * std::fabs(s) + DBL_MIN;
+}
+
+// Integer entries in (-2^bits, 2^bits) from the generator's doubles.
+static double integer(double x, int bits) {
+  return std::trunc(std::fmod(x * 4096, std::ldexp(1.0, bits)));
+}
+
+TEST(TestInterval, TestArithmeticEncloses) {
+  auto encloses_ops = [](double a, double b) {
+    if (!std::isfinite(a * b) || !std::isfinite(a / b) || b == 0) {
+      return true;
+    }
+    const double s = a + b, d = a - b, p = a * b, q = a / b;
+    // Exact errors of the round-to-nearest results.
+    const double bs = s - a, es = (a - (s - bs)) + (b - bs);
+    const double bd = d - a, ed = (a - (d - bd)) + (-b - bd);
+    const double ep = std::fma(a, b, -p);
+    // a / b - q = r / b with r exact.
+    const double r = std::fma(-q, b, a);
+    const double eq = (r > 0) == (b > 0) ? (r == 0 ? 0 : 1) : -1;
+
+    // Division multiplies by the reciprocal, so it rounds twice.
+    verified_math::RoundUpward guard;
+    const I x(a), y(b);
+    return encloses_rounded(x + y, s, es) && encloses_rounded(x - y, d, ed) &&
+      encloses_rounded(x * y, p, ep) && encloses_rounded(x / y, q, eq, 4) &&
+      (-x).lo() == -a && (-x).hi() == -a;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double> { encloses_ops }, 10000));
+}
+
+TEST(TestInterval, TestIntervalOperands) {
+  verified_math::RoundUpward guard;
+  const I a(-1, 2), b(3, 5);
+  EXPECT_EQ(-10.0, (a * -b).lo());
+  EXPECT_EQ(5.0, (a * -b).hi());
+  EXPECT_EQ(-5.0, (a * b).lo());
+  EXPECT_EQ(10.0, (a * b).hi());
+  EXPECT_EQ(-6.0, (a - b).lo());
+  EXPECT_EQ(-1.0, (a - b).hi());
+
+  const I third = I(1) / I(3);
+  EXPECT_LT(third.lo(), third.hi());
+  EXPECT_TRUE(contains(third, 1.0 / 3));
+
+  // Zero in the divisor: the whole line.
+  const I inf = b / a;
+  EXPECT_EQ(-INFINITY, inf.lo());
+  EXPECT_EQ(INFINITY, inf.hi());
+}
+
+TEST(TestInterval, TestRoundingRestored) {
+  ASSERT_EQ(FE_TONEAREST, std::fegetround());
+  {
+    verified_math::RoundUpward guard;
+    EXPECT_EQ(FE_UPWARD, std::fegetround());
+  }
+  EXPECT_EQ(FE_TONEAREST, std::fegetround());
+}
+
+TEST(TestInterval, TestMat33DetEnclosesExact) {
+  // 18-bit entries: the products are exact in int64 but not in double.
+  auto encloses_det = [](double x11, double x12, double x13,
+			 double x21, double x22, double x23,
+			 double x31, double x32, double x33) {
+    const double v[9] = {x11, x12, x13, x21, x22, x23, x31, x32, x33};
+    std::int64_t a[9];
+    for (int i = 0; i < 9; ++i) {
+      a[i] = std::int64_t(integer(v[i], 18));
+    }
+    const std::int64_t exact = a[0] * (a[4] * a[8] - a[5] * a[7]) +
+      a[1] * (a[5] * a[6] - a[3] * a[8]) + a[2] * (a[3] * a[7] - a[6] * a[4]);
+
+    verified_math::RoundUpward guard;
+    const verified_math::Mat33<I> m{
+      I(double(a[0])), I(double(a[1])), I(double(a[2])),
+      I(double(a[3])), I(double(a[4])), I(double(a[5])),
+      I(double(a[6])), I(double(a[7])), I(double(a[8]))};
+    return encloses(verified_math::det(m), (long double)exact);
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double> { encloses_det }, 10000));
+}
+
+TEST(TestInterval, TestMat44DetAndInverse) {
+  auto encloses_inverse = [](double x11, double x12, double x13, double x14,
+			     double x21, double x22, double x23, double x24,
+			     double x31, double x32, double x33, double x34) {
+    // 14-bit entries; the last row is fixed so that the generator's twelve
+    // values fill the rest.
+    const double v[16] = {x11, x12, x13, x14, x21, x22, x23, x24,
+			  x31, x32, x33, x34, 1, -2, 3, 5};
+    std::int64_t a[16];
+    for (int i = 0; i < 16; ++i) {
+      a[i] = std::int64_t(integer(v[i], 14));
+    }
+    // Laplace expansion by 2x2 minors of rows 1-2 and 3-4, as det(Mat44).
+    auto minor = [&](int r, int i, int j) {
+      return a[4 * r + i] * a[4 * (r + 1) + j] - a[4 * (r + 1) + i] * a[4 * r + j];
+    };
+    const std::int64_t exact =
+      minor(0, 0, 1) * minor(2, 2, 3) - minor(0, 0, 2) * minor(2, 1, 3) +
+      minor(0, 0, 3) * minor(2, 1, 2) + minor(0, 1, 2) * minor(2, 0, 3) -
+      minor(0, 1, 3) * minor(2, 0, 2) + minor(0, 2, 3) * minor(2, 0, 1);
+
+    verified_math::RoundUpward guard;
+    I e[16] = {I(0), I(0), I(0), I(0), I(0), I(0), I(0), I(0),
+	       I(0), I(0), I(0), I(0), I(0), I(0), I(0), I(0)};
+    for (int i = 0; i < 16; ++i) {
+      e[i] = I(double(a[i]));
+    }
+    const verified_math::Mat44<I> m{
+      e[0], e[1], e[2], e[3], e[4], e[5], e[6], e[7],
+      e[8], e[9], e[10], e[11], e[12], e[13], e[14], e[15]};
+    if (!encloses(verified_math::det(m), (long double)exact)) {
+      return false;
+    }
+    if (exact == 0) {
+      return true;
+    }
+
+    // The exact inverse lies in inverse(m), so m * inverse(m) contains I.
+    const auto p = m * verified_math::inverse(m);
+    const I* q = &p.x11;
+    for (int i = 0; i < 16; ++i) {
+      if (!contains(q[i], i % 5 == 0 ? 1.0 : 0.0)) {
+	return false;
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> { encloses_inverse }, 10000));
+}
+
+TEST(TestInterval, TestVec3) {
+  verified_math::RoundUpward guard;
+  const verified_math::Vec3<I> x(I(0.1), I(0.2), I(0.3));
+  const verified_math::Vec3<I> y(I(3), I(-1), I(0.5));
+  const I d = verified_math::dot(x, y);
+  // 0.3 - 0.2 + 0.15, in exact decimal arithmetic on the rounded inputs.
+  EXPECT_TRUE(contains(d, 0.25));
+  EXPECT_LT(width(d), 1e-15);
+
+  const auto c = verified_math::cross(x, x);
+  EXPECT_TRUE(contains(c.x1, 0.0) && contains(c.x2, 0.0) && contains(c.x3, 0.0));
+}
@@ -0,0 +1,184 @@
+#include "verified_math/mat.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <cstdint>
+
+#define epsilon 1e-6
+
+namespace {
+  template<std::size_t R, std::size_t C>
+  double max_abs(const verified_math::Mat<R, C, double>& m) {
+    double result = 0.0;
+    for (std::size_t k = 0; k < R * C; ++k) {
+      result = fmax(result, fabs(m.data[k]));
+    }
+    return result;
+  }
+
+  template<std::size_t N>
+  bool near_identity(const verified_math::Mat<N, N, double>& m, double tol) {
+    for (std::size_t i = 0; i < N; ++i) {
+      for (std::size_t j = 0; j < N; ++j) {
+	if (fabs(m(i, j) - (i == j ? 1.0 : 0.0)) > tol) {
+	  return false;
+	}
+      }
+    }
+    return true;
+  }
+
+  // A well-spread N x N matrix from a few samples.
+  template<std::size_t N>
+  verified_math::Mat<N, N, double> spread(double a, double b, double c) {
+    verified_math::Mat<N, N, double> m;
+    for (std::size_t k = 0; k < N * N; ++k) {
+      m.data[k] = sin(a * (k + 1)) + cos(b * k * k) + (k % (N + 1) == 0 ? c : 0.0);
+    }
+    return m;
+  }
+}
+
+TEST(TestMat, TestStorageIsAligned) {
+  EXPECT_EQ(sizeof(double) * 9, sizeof(verified_math::Mat<3, 3, double>));
+  EXPECT_EQ(sizeof(double) * 16, sizeof(verified_math::Mat<4, 4, double>));
+  EXPECT_EQ(32u, alignof(verified_math::Mat<4, 4, double>));
+  EXPECT_EQ(16u, alignof(verified_math::Mat<3, 4, float>));
+  EXPECT_EQ(32u, alignof(verified_math::Mat<6, 6, double>));
+}
+
+TEST(TestMat, TestAgreesWithMat33) {
+  auto agrees_with_mat33 = [](double x11, double x12, double x13,
+			      double x21, double x22, double x23,
+			      double x31, double x32, double x33) {
+    auto m = verified_math::Mat33<double> {
+      x11, x12, x13,
+      x21, x22, x23,
+      x31, x32, x33
+    };
+    auto g = verified_math::to_mat(m);
+
+    auto p1 = verified_math::to_mat(m * verified_math::transpose(m));
+    auto p2 = g * verified_math::transpose(g);
+
+    for (std::size_t k = 0; k < 9; ++k) {
+      if (p1.data[k] != p2.data[k]) {
+	return false;
+      }
+    }
+    return (verified_math::det(g) == verified_math::det(m) &&
+	    verified_math::trace(g) == verified_math::trace(m));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double> {
+			       agrees_with_mat33 }, 10000));
+}
+
+TEST(TestMat, TestAgreesWithMat44) {
+  auto agrees_with_mat44 = [](double x11, double x12, double x13, double x14,
+			      double x21, double x22, double x23, double x24,
+			      double x31, double x32, double x33, double x34,
+			      double x41, double x42, double x43, double x44) {
+    auto m = verified_math::Mat44<double> {
+      x11, x12, x13, x14,
+      x21, x22, x23, x24,
+      x31, x32, x33, x34,
+      x41, x42, x43, x44
+    };
+    auto g = verified_math::to_mat(m);
+    auto scale = max_abs(g);
+
+    auto d1 = verified_math::det(m);
+    auto d2 = verified_math::det(g);
+    auto inv = verified_math::inverse(g);
+
+    return (fabs(d1 - d2) <= epsilon * scale * scale * scale * scale &&
+	    (near_identity(g * inv, epsilon * scale * max_abs(inv)) || d2 == 0.0));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> {
+			       agrees_with_mat44 }, 10000));
+}
+
+TEST(TestMat, TestRectangularTransposeOfProduct) {
+  auto transpose_of_product = [](double a, double b, double c) {
+    auto m1 = verified_math::Mat<3, 4, double>{};
+    auto m2 = verified_math::Mat<4, 2, double>{};
+    for (std::size_t k = 0; k < 12; ++k) {
+      m1.data[k] = a * k - b;
+    }
+    for (std::size_t k = 0; k < 8; ++k) {
+      m2.data[k] = c - b * k;
+    }
+
+    verified_math::Mat<2, 3, double> t1 = verified_math::transpose(m1 * m2);
+    verified_math::Mat<2, 3, double> t2 = verified_math::transpose(m2) * verified_math::transpose(m1);
+
+    for (std::size_t k = 0; k < 6; ++k) {
+      if (t1.data[k] != t2.data[k]) {
+	return false;
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double> {
+	transpose_of_product }, 10000));
+}
+
+TEST(TestMat, TestSmallAndLargeInverses) {
+  auto inverses = [](double a, double b, double c) {
+    auto m2 = spread<2>(a, b, c);
+    auto m6 = spread<6>(a, b, c);
+
+    auto inv2 = verified_math::inverse(m2);
+    auto inv6 = verified_math::inverse(m6);
+
+    bool ok2 = verified_math::det(m2) == 0.0 ||
+      near_identity(m2 * inv2, epsilon * max_abs(m2) * max_abs(inv2));
+    bool ok6 = fabs(verified_math::det(m6)) < 1e-9 ||
+      near_identity(m6 * inv6, epsilon * max_abs(m6) * max_abs(inv6));
+    return ok2 && ok6;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double> {
+	inverses }, 10000));
+}
+
+TEST(TestMat, TestDetIsHomomorphic) {
+  auto det_homomorphic = [](double a, double b, double c) {
+    auto m1 = spread<6>(a, b, c);
+    auto m2 = spread<6>(b, c, a);
+
+    auto d = verified_math::det(m1 * m2);
+    auto d1 = verified_math::det(m1);
+    auto d2 = verified_math::det(m2);
+
+    auto scale = pow(6.0 * max_abs(m1) * max_abs(m2), 6);
+    return fabs(d - d1 * d2) <= epsilon * scale;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double> {
+	det_homomorphic }, 10000));
+}
+
+TEST(TestMat, TestVecOperations) {
+  auto v = verified_math::Vec<3, double>{{1.0, -2.0, 3.0}};
+  auto w = verified_math::to_vec(verified_math::Vec3<double>{4.0, 5.0, -6.0});
+
+  auto c = verified_math::to_vec3(verified_math::cross(v, w));
+  auto c3 = verified_math::cross(verified_math::to_vec3(v), verified_math::to_vec3(w));
+
+  EXPECT_EQ(c3.x1, c.x1);
+  EXPECT_EQ(c3.x2, c.x2);
+  EXPECT_EQ(c3.x3, c.x3);
+  EXPECT_EQ(-24.0, verified_math::dot(v, w));
+  EXPECT_EQ(5.0, (v + w)[0]);
+  EXPECT_EQ(3.0, (2.0 * v)[2] - (w - v)[0]);
+}
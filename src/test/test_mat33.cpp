@@ -4,6 +4,8 @@
 
 #include <iostream>
 #include <cmath>
+#include <cfloat>
+#include <vector>
 
 #define epsilon 0.1
 
@@ -272,3 +274,170 @@ TEST(TestMat33, TestMatMatTraceCommutative) {
     );
 }
 
+
+/*
+  Tests related to the batched transforms.
+ */
+TEST(TestMat33, TestTransformVectorsMatchesProduct) {
+  auto transform_matches_product = [](double x11, double x12, double x13,
+				      double x21, double x22, double x23,
+				      double x31, double x32, double x33,
+				      double v1, double v2, double v3) {
+    auto m = verified_math::Mat33<double> {
+      x11, x12, x13,
+      x21, x22, x23,
+      x31, x32, x33
+    };
+
+    std::vector<verified_math::Vec3<double> > aos;
+    for (int i = 0; i < 7; ++i) {
+      aos.push_back(verified_math::Vec3<double>{v1 + i, v2 * i, v3 - i});
+    }
+    auto soa = verified_math::Vec3Array<double>(aos.data(), aos.size());
+
+    auto aos_out = aos;
+    verified_math::Vec3Array<double> soa_out;
+    verified_math::transform_vectors(m, aos.data(), aos_out.data(), aos.size());
+    verified_math::transform_vectors(m, soa, soa_out);
+
+    for (std::size_t i = 0; i < aos.size(); ++i) {
+      auto expected = m * aos[i];
+      auto tol = epsilon * (1.0 + fabs(expected.x1) + fabs(expected.x2) + fabs(expected.x3));
+      if (fabs(aos_out[i].x1 - expected.x1) > tol ||
+	  fabs(aos_out[i].x2 - expected.x2) > tol ||
+	  fabs(aos_out[i].x3 - expected.x3) > tol ||
+	  fabs(soa_out[i].x1 - expected.x1) > tol ||
+	  fabs(soa_out[i].x2 - expected.x2) > tol ||
+	  fabs(soa_out[i].x3 - expected.x3) > tol) {
+	return false;
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double,
+			     double, double, double> {
+			       transform_matches_product }, 10000
+			     )
+	      );
+}
+
+/*
+  Tests related to try_inverse.
+ */
+TEST(TestMat33, TestTryInverseMatchesInverse) {
+  auto try_matches_inverse = [](double x11, double x12, double x13,
+				double x21, double x22, double x23,
+				double x31, double x32, double x33) {
+    auto m = verified_math::Mat33<double> {
+      x11, x12, x13,
+      x21, x22, x23,
+      x31, x32, x33
+    };
+
+    auto r = verified_math::try_inverse(m);
+    if (!r.ok) {
+      return std::isinf(r.condition_estimate) && r.inverse.l2_norm() == 0.0;
+    }
+
+    auto inv = verified_math::inverse(m);
+    auto kappa2 = verified_math::condition_number(m);
+    const double norm = sqrt(inv.l2_norm());
+    const double* p = &r.inverse.x11;
+    const double* q = &inv.x11;
+    for (int i = 0; i < 9; ++i) {
+      if (fabs(p[i] - q[i]) > 16 * DBL_EPSILON * norm) {
+	return false;
+      }
+    }
+    // det(m) and the adjugate determinant may contract their products into
+    // FMAs differently, so they agree to within the rounding of the terms
+    // (the permanent of |m|) rather than of the possibly cancelled result.
+    const double perm =
+      fabs(x11) * (fabs(x22) * fabs(x33) + fabs(x23) * fabs(x32)) +
+      fabs(x12) * (fabs(x21) * fabs(x33) + fabs(x23) * fabs(x31)) +
+      fabs(x13) * (fabs(x21) * fabs(x32) + fabs(x22) * fabs(x31));
+    return fabs(r.det - verified_math::det(m)) <= 16 * DBL_EPSILON * perm &&
+      fabs(r.condition_estimate * r.condition_estimate - kappa2) <= 1e-12 * kappa2;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double> {
+			       try_matches_inverse }, 10000
+			     )
+	      );
+}
+
+TEST(TestMat33, TestTryInverseRejectsSingular) {
+  auto singular = verified_math::Mat33<double> {
+    1.0, 2.0, 3.0,
+    2.0, 4.0, 6.0,
+    1.0, 0.0, 1.0
+  };
+  auto zero = verified_math::Mat33<double> {
+    0.0, 0.0, 0.0,
+    0.0, 0.0, 0.0,
+    0.0, 0.0, 0.0
+  };
+
+  for (auto m : {singular, zero}) {
+    auto r = verified_math::try_inverse(m);
+    EXPECT_FALSE(r.ok);
+    EXPECT_EQ(0.0, r.inverse.l2_norm());
+    EXPECT_TRUE(std::isinf(r.condition_estimate));
+  }
+
+  auto eye = verified_math::Mat33<double> {
+    2.0, 0.0, 0.0,
+    0.0, 2.0, 0.0,
+    0.0, 0.0, 2.0
+  };
+  auto r = verified_math::try_inverse(eye);
+  EXPECT_TRUE(r.ok);
+  EXPECT_EQ(8.0, r.det);
+  EXPECT_EQ(0.5, r.inverse.x22);
+  EXPECT_NEAR(3.0, r.condition_estimate, 1e-15);
+}
+
+TEST(TestMat33, TestTryInverseFloatExtremeScales) {
+  // s * a for s near the top and bottom of the float exponent range, and
+  // the scales where d * d or r1 r2 r3 would leave it without rescaling.
+  const auto a = verified_math::Mat33<double> {
+    2.0, 1.0, 0.0,
+    1.0, 3.0, 1.0,
+    0.0, 1.0, 4.0
+  };
+  const auto ra = verified_math::try_inverse(a);
+  const float scales[] = {
+    1e7f, 1e-8f, std::ldexp(1.0f, 120), std::ldexp(1.0f, -120)
+  };
+
+  for (float s : scales) {
+    const double* p = &a.x11;
+    float q[9];
+    for (int i = 0; i < 9; ++i) {
+      q[i] = static_cast<float>(p[i]) * s;
+    }
+    const auto m = verified_math::Mat33<float> {
+      q[0], q[1], q[2],
+      q[3], q[4], q[5],
+      q[6], q[7], q[8]
+    };
+
+    auto r = verified_math::try_inverse(m);
+    EXPECT_TRUE(r.ok) << s;
+    EXPECT_NEAR(ra.condition_estimate, r.condition_estimate, 1e-4 * ra.condition_estimate) << s;
+    const float* x = &r.inverse.x11;
+    const double* y = &ra.inverse.x11;
+    for (int i = 0; i < 9; ++i) {
+      EXPECT_NEAR(y[i], x[i] * static_cast<double>(s), 1e-5) << s << " " << i;
+    }
+    const double d = 18.0 * s * s * s;
+    if (d < FLT_MAX && d > FLT_MIN) {
+      EXPECT_NEAR(1.0, r.det / d, 1e-5) << s;
+    }
+  }
+}
@@ -0,0 +1,172 @@
+#include "verified_math/mat33_array.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+
+#define epsilon 1e-6
+
+/*
+  Tests for the batched determinant and inverse. Several matrices are
+  built from each sample so that the vectorized loop body is exercised.
+ */
+namespace {
+  const std::size_t array_size = 9;
+
+  verified_math::Mat33Array<double> make_array(double x11, double x12, double x13,
+					       double x21, double x22, double x23,
+					       double x31, double x32, double x33) {
+    verified_math::Mat33Array<double> a;
+    for (std::size_t i = 0; i < array_size; ++i) {
+      double s = 0.5 * i;
+      a.push_back(verified_math::Mat33<double>{
+	  x11 + s, x12, x13,
+	  x21, x22 - s, x23,
+	  x31, x32 * s, x33
+	});
+    }
+    return a;
+  }
+}
+
+TEST(TestMat33Array, TestBatchDetMatchesDet) {
+  auto batch_det = [](double x11, double x12, double x13,
+		      double x21, double x22, double x23,
+		      double x31, double x32, double x33) {
+    auto a = make_array(x11, x12, x13, x21, x22, x23, x31, x32, x33);
+
+    double dets[array_size];
+    double dets2[array_size];
+    unsigned char ok[array_size];
+    verified_math::Mat33Array<double> inv;
+    verified_math::det(a, dets);
+    verified_math::det_inverse(a, dets2, inv, ok);
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      auto m = a[i];
+      auto scale = 1.0 + m.l2_norm() * sqrt(m.l2_norm());
+      auto expected = verified_math::det(m);
+      if (fabs(dets[i] - expected) > epsilon * scale ||
+	  fabs(dets2[i] - expected) > epsilon * scale) {
+	return false;
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double> {
+			       batch_det }, 10000));
+}
+
+TEST(TestMat33Array, TestBatchInverse) {
+  auto batch_inverse = [](double x11, double x12, double x13,
+			  double x21, double x22, double x23,
+			  double x31, double x32, double x33) {
+    auto a = make_array(x11, x12, x13, x21, x22, x23, x31, x32, x33);
+
+    double dets[array_size];
+    unsigned char ok[array_size];
+    verified_math::Mat33Array<double> inv;
+    verified_math::det_inverse(a, dets, inv, ok);
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      if (!ok[i]) {
+	continue;
+      }
+      auto m = a[i];
+      auto prod = m * inv[i];
+      // Residual of m * inv(m) against the identity, relative to the
+      // magnitudes involved.
+      auto tol = epsilon * sqrt(m.l2_norm() * inv[i].l2_norm());
+      if (fabs(prod.x11 - 1.0) > tol || fabs(prod.x12) > tol || fabs(prod.x13) > tol ||
+	  fabs(prod.x21) > tol || fabs(prod.x22 - 1.0) > tol || fabs(prod.x23) > tol ||
+	  fabs(prod.x31) > tol || fabs(prod.x32) > tol || fabs(prod.x33 - 1.0) > tol) {
+	return false;
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double> {
+			       batch_inverse }, 10000));
+}
+
+TEST(TestMat33Array, TestSingularIsMasked) {
+  verified_math::Mat33Array<double> a;
+  a.push_back(verified_math::Mat33<double>{
+      1.0, 2.0, 3.0,
+      2.0, 4.0, 6.0,
+      0.0, 1.0, 1.0
+    });
+  a.push_back(verified_math::Mat33<double>{
+      0.0, 0.0, 0.0,
+      0.0, 0.0, 0.0,
+      0.0, 0.0, 0.0
+    });
+  a.push_back(verified_math::Mat33<double>{
+      2.0, 0.0, 0.0,
+      0.0, 2.0, 0.0,
+      0.0, 0.0, 2.0
+    });
+
+  double dets[3];
+  unsigned char ok[3];
+  verified_math::Mat33Array<double> inv;
+  verified_math::det_inverse(a, dets, inv, ok);
+
+  EXPECT_EQ(0, ok[0]);
+  EXPECT_EQ(0, ok[1]);
+  EXPECT_EQ(1, ok[2]);
+  EXPECT_EQ(0.0, inv[0].x11);
+  EXPECT_EQ(0.0, inv[1].x22);
+  EXPECT_EQ(0.5, inv[2].x33);
+}
+
+TEST(TestMat33Array, TestFloatExtremeScales) {
+  // d * d and r1 r2 r3 over- or underflow in float for these without the
+  // row scaling; the rows of the last entry differ by 2^200 in magnitude.
+  const float scales[] = { 1e7f, 1e-8f, std::ldexp(1.0f, 40), std::ldexp(1.0f, -40) };
+  verified_math::Mat33Array<float> a;
+  for (float s : scales) {
+    a.push_back(verified_math::Mat33<float>{
+	2.0f * s, 1.0f * s, 0.0f,
+	1.0f * s, 3.0f * s, 1.0f * s,
+	0.0f, 1.0f * s, 4.0f * s
+      });
+  }
+  const float big = std::ldexp(1.0f, 100), small = std::ldexp(1.0f, -100);
+  a.push_back(verified_math::Mat33<float>{
+      2.0f * big, 1.0f * big, 0.0f,
+      1.0f, 3.0f, 1.0f,
+      0.0f, 1.0f * small, 4.0f * small
+    });
+  a.push_back(verified_math::Mat33<float>{
+      1.0f * big, 2.0f * big, 3.0f * big,
+      2.0f * big, 4.0f * big, 6.0f * big,
+      0.0f, 1.0f * big, 1.0f * big
+    });
+
+  float dets[6];
+  unsigned char ok[6];
+  verified_math::Mat33Array<float> inv;
+  verified_math::det_inverse(a, dets, inv, ok);
+
+  for (std::size_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(1, ok[i]) << i;
+    const double s = i < 4 ? scales[i] : 1.0;
+    EXPECT_NEAR(1.0, dets[i] / (18.0 * s * s * s), 1e-5) << i;
+    const verified_math::Mat33<float> p = a[i] * inv[i];
+    EXPECT_NEAR(1.0f, p.x11, 1e-5f) << i;
+    EXPECT_NEAR(1.0f, p.x22, 1e-5f) << i;
+    EXPECT_NEAR(1.0f, p.x33, 1e-5f) << i;
+    EXPECT_NEAR(0.0f, p.x12, 1e-5f) << i;
+    EXPECT_NEAR(0.0f, p.x23, 1e-5f) << i;
+    EXPECT_NEAR(0.0f, p.x31, 1e-5f) << i;
+  }
+  EXPECT_EQ(0, ok[5]);
+  EXPECT_EQ(0.0f, inv[5].x11);
+}
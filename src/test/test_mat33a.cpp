@@ -0,0 +1,99 @@
+#include "verified_math/mat33a.h"
+#include "verified_math/aligned_allocator.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <cfloat>
+#include <vector>
+
+static_assert(sizeof(verified_math::Mat33A<float>) == 48, "Mat33A<float> rows are 16 bytes");
+static_assert(alignof(verified_math::Mat33A<float>) == 16, "Mat33A<float> is 16-byte aligned");
+static_assert(sizeof(verified_math::Mat33A<double>) == 96, "Mat33A<double> rows are 32 bytes");
+
+/*
+  The padded products agree with the packed ones. With FMA contraction the
+  roundings may differ, so entries are compared to within a few ulps of
+  the sum of the magnitudes of their terms.
+ */
+static bool close(float a, float b, float scale) {
+  return fabs(a - b) <= 4 * FLT_EPSILON * scale;
+}
+
+TEST(TestMat33A, TestProductsMatchMat33) {
+  auto matches_mat33 = [](double x11, double x12, double x13,
+			  double x21, double x22, double x23,
+			  double x31, double x32, double x33,
+			  double v1, double v2, double v3) {
+    auto m = verified_math::Mat33<float> {
+      float(x11), float(x12), float(x13),
+      float(x21), float(x22), float(x23),
+      float(x31), float(x32), float(x33)
+    };
+    auto v = verified_math::Vec3<float>(float(v1), float(v2), float(v3));
+    auto ma = verified_math::Mat33A<float>(m);
+    auto va = verified_math::Vec3A<float>(v);
+
+    auto mv = m * v;
+    auto mva = ma * va;
+    auto abs_m = verified_math::Mat33<float> {
+      fabsf(m.x11), fabsf(m.x12), fabsf(m.x13),
+      fabsf(m.x21), fabsf(m.x22), fabsf(m.x23),
+      fabsf(m.x31), fabsf(m.x32), fabsf(m.x33)
+    };
+    auto scale = abs_m * verified_math::Vec3<float>(fabsf(v.x1), fabsf(v.x2), fabsf(v.x3));
+    if (!close(mv.x1, mva.x1, scale.x1) || !close(mv.x2, mva.x2, scale.x2) ||
+	!close(mv.x3, mva.x3, scale.x3) || mva.pad != 0.0f) {
+      return false;
+    }
+
+    auto mm = m * m;
+    auto mma = ma * ma;
+    auto mm_scale = abs_m * abs_m;
+    auto back = verified_math::to_mat33(mma);
+    const float* p = &mm.x11;
+    const float* q = &back.x11;
+    const float* s = &mm_scale.x11;
+    for (int i = 0; i < 9; ++i) {
+      if (!close(p[i], q[i], s[i])) {
+	return false;
+      }
+    }
+    return mma.pad1 == 0.0f && mma.pad2 == 0.0f && mma.pad3 == 0.0f;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double,
+			     double, double, double> {
+			       matches_mat33 }, 10000
+			     )
+	      );
+}
+
+TEST(TestMat33A, TestTransformVectorsMatchesProduct) {
+  auto m = verified_math::Mat33A<float> {
+    1.0f, 2.0f, -3.0f,
+    0.5f, -1.0f, 4.0f,
+    2.0f, 0.0f, 1.0f
+  };
+
+  verified_math::aligned_vector<verified_math::Vec3A<float> > in;
+  for (int i = 0; i < 37; ++i) {
+    in.push_back(verified_math::Vec3A<float>(float(i), 1.0f - i, 0.25f * i));
+  }
+  verified_math::aligned_vector<verified_math::Vec3A<float> > out(in);
+  verified_math::transform_vectors(m, in.data(), out.data(), in.size());
+
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    auto expected = m * in[i];
+    EXPECT_FLOAT_EQ(expected.x1, out[i].x1);
+    EXPECT_FLOAT_EQ(expected.x2, out[i].x2);
+    EXPECT_FLOAT_EQ(expected.x3, out[i].x3);
+    EXPECT_EQ(0.0f, out[i].pad);
+  }
+
+  // In place.
+  verified_math::transform_vectors(m, in.data(), in.data(), in.size());
+  EXPECT_FLOAT_EQ(out[5].x2, in[5].x2);
+}
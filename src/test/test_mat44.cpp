@@ -1,11 +1,13 @@
 #include "verified_math/mat44.h"
 #include "verified_math/vec4.h"
 #include "gtest/gtest.h"
-#include "checkpp/checkpp.h"
+#include "parallel_check.h"
 
 #include <iostream>
 #include <cmath>
 #include <limits>
+#include <cfloat>
+#include <vector>
 
 #define epsilon 0.1
 
@@ -50,11 +52,11 @@ TEST(TestMat44, TestEyeCommutative) {
 	    fabs(prod1.x44 - prod2.x44) < epsilon);
   };
 
-    EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+    EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
 			       double, double, double, double, 
 			       double, double, double, double,
 			       double, double, double, double> {
-			       eye_commutative }, 10000
+			       eye_commutative }, parallel_check::trials(10000)
 			     )
 	      );
 }
@@ -74,44 +76,30 @@ TEST(TestMat44, TestMatInv) {
       x41, x42, x43, x44
     };
 
-    auto kappa = condition_number(m);
-    
-    auto inv_m = verified_math::inverse(m);
-
-    auto eye = verified_math::Mat44<double> {
-      1.0, 0.0, 0.0, 0.0,
-      0.0, 1.0, 0.0, 0.0,
-      0.0, 0.0, 1.0, 0.0,
-      0.0, 0.0, 0.0, 1.0
-    };
-      
-    auto prod = m * inv_m;
-
-    auto truth_val = (fabs(prod.x11 - eye.x11) < epsilon &&
-		      fabs(prod.x12 - eye.x12) < epsilon &&
-		      fabs(prod.x13 - eye.x13) < epsilon &&
-		      fabs(prod.x14 - eye.x14) < epsilon &&
-		      fabs(prod.x21 - eye.x21) < epsilon &&
-		      fabs(prod.x22 - eye.x22) < epsilon &&
-		      fabs(prod.x23 - eye.x23) < epsilon &&
-		      fabs(prod.x24 - eye.x24) < epsilon &&
-		      fabs(prod.x31 - eye.x31) < epsilon &&
-		      fabs(prod.x32 - eye.x32) < epsilon &&
-		      fabs(prod.x33 - eye.x33) < epsilon &&
-		      fabs(prod.x34 - eye.x34) < epsilon &&
-		      fabs(prod.x41 - eye.x41) < epsilon &&
-		      fabs(prod.x42 - eye.x42) < epsilon &&
-		      fabs(prod.x43 - eye.x43) < epsilon &&
-		      fabs(prod.x44 - eye.x44) < epsilon);
-		      
-
-      return truth_val || kappa > 1.1;
+    // The residual m * inverse(m) - I is bounded by a small multiple of
+    // the unit roundoff times the (Frobenius) condition number.
+    auto kappa = sqrt(condition_number(m));
+    if (!(kappa < 1e8)) {
+      return true;
+    }
+
+    auto prod = m * verified_math::inverse(m);
+
+    const double* p = &prod.x11;
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 4; ++j) {
+	if (fabs(p[4 * i + j] - (i == j ? 1.0 : 0.0)) > 64 * DBL_EPSILON * kappa) {
+	  return false;
+	}
+      }
+    }
+    return true;
   };
 
-  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
 			     double, double, double, double,
 			     double, double, double, double,
-			     double, double, double, double> { mat_inv }, 1000));      
+			     double, double, double, double> { mat_inv }, parallel_check::trials(100000)));
 }
 
 /*
@@ -153,11 +141,11 @@ TEST(TestMat44, TestDetTransposeInvariant) {
     return (fabs(det1 - det2) / fabs(det1)) < epsilon || kappa > 1.1 || kappa1 > 1.1;
   };
 
-  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
 			     double, double, double, double,
 			     double, double, double, double,
 			     double, double, double, double> {det_transpose_invariant},
-			     10000));
+			     parallel_check::trials(10000)));
 }
 
 TEST(TestMat44, TestMatInvInv) {
@@ -172,35 +160,29 @@ TEST(TestMat44, TestMatInvInv) {
 	  x41, x42, x43, x44
 	};
 
-	auto kappa = condition_number(m);
-
-	auto inv_m = verified_math::inverse(m);
-	auto inv_inv = verified_math::inverse(inv_m);
-	
-	auto truth_val = (fabs(inv_inv.x11 - m.x11) < epsilon &&
-			  fabs(inv_inv.x12 - m.x12) < epsilon &&
-			  fabs(inv_inv.x13 - m.x13) < epsilon &&
-			  fabs(inv_inv.x14 - m.x14) < epsilon &&
-			  fabs(inv_inv.x21 - m.x21) < epsilon &&
-			  fabs(inv_inv.x22 - m.x22) < epsilon &&
-			  fabs(inv_inv.x23 - m.x23) < epsilon &&
-			  fabs(inv_inv.x24 - m.x24) < epsilon &&
-			  fabs(inv_inv.x31 - m.x31) < epsilon &&
-			  fabs(inv_inv.x32 - m.x32) < epsilon &&
-			  fabs(inv_inv.x33 - m.x33) < epsilon &&
-			  fabs(inv_inv.x34 - m.x34) < epsilon &&
-			  fabs(inv_inv.x41 - m.x41) < epsilon &&
-			  fabs(inv_inv.x42 - m.x42) < epsilon &&
-			  fabs(inv_inv.x43 - m.x43) < epsilon &&
-			  fabs(inv_inv.x44 - m.x44) < epsilon);
-
-	return truth_val || kappa > 1.1;
+	// Each of the two inversions loses about log10(kappa) digits.
+	auto kappa = sqrt(condition_number(m));
+	if (!(kappa < 1e8)) {
+	  return true;
+	}
+
+	auto inv_inv = verified_math::inverse(verified_math::inverse(m));
+
+	const double norm = sqrt(m.l2_norm());
+	const double* p = &inv_inv.x11;
+	const double* q = &m.x11;
+	for (int i = 0; i < 16; ++i) {
+	  if (fabs(p[i] - q[i]) > 256 * DBL_EPSILON * kappa * norm) {
+	    return false;
+	  }
+	}
+	return true;
   };
   
-  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
 			     double, double, double, double,
 			     double, double, double, double,
-			     double, double, double, double> {inv_inv}, 10000));
+			     double, double, double, double> {inv_inv}, parallel_check::trials(10000)));
 }
 
 TEST(TestMat44, TestDetInverse) {
@@ -223,10 +205,10 @@ TEST(TestMat44, TestDetInverse) {
     return fabs(det1 - det2) < epsilon || kappa > 1.1;
   };
   
-  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
 			     double, double, double, double,
 			     double, double ,double, double,
-			     double, double, double, double> {det_inverse}, 10000));
+			     double, double, double, double> {det_inverse}, parallel_check::trials(10000)));
 }
 
 TEST(TestMat44, TestDetIsHomomorphic) {
@@ -260,7 +242,7 @@ TEST(TestMat44, TestDetIsHomomorphic) {
 	
   };
 	
-  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
 			     double, double, double, double,
 			     double, double, double, double,
 			     double, double, double, double,
@@ -269,7 +251,7 @@ TEST(TestMat44, TestDetIsHomomorphic) {
 			     double, double, double, double,
 			     double, double, double, double,
 			     double, double, double, double> {
-			       det_homomorphic }, 10000)
+			       det_homomorphic }, parallel_check::trials(10000))
 	      );      
 }
       
@@ -294,13 +276,13 @@ TEST(TestMat44, TestScalarPowerInDet) {
     return fabs(det1 - det2) < epsilon || kappa > 1.1;
   };
   
-  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
 			     double, double, double, double,
 			     double, double, double, double,
 			     double, double, double, double,
 			     double>{
 			       scalar_power_in_det
-				 }, 10000)
+				 }, parallel_check::trials(10000))
 	      );
 }
 
@@ -346,7 +328,7 @@ TEST(TestMat44, TestMatMatTraceCommutative) {
     
   };
   
-  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
 			     double, double, double, double,
 			     double, double, double, double,
 			     double, double, double, double,
@@ -356,8 +338,419 @@ TEST(TestMat44, TestMatMatTraceCommutative) {
 			     double, double, double, double,
 			     double, double, double, double> {
 			       mat_trace_commutative
-				 }, 10000
+				 }, parallel_check::trials(10000)
 			     )
 	      );
 }
 
+
+/*
+  Tests comparing the SIMD matrix product against the scalar template.
+  Calling operator*<Scalar> explicitly always selects the template.
+ */
+TEST(TestMat44, TestSimdProductMatchesScalar) {
+  auto simd_matches_scalar =
+    [](double x11, double x12, double x13, double x14,
+       double x21, double x22, double x23, double x24,
+       double x31, double x32, double x33, double x34,
+       double x41, double x42, double x43, double x44,
+
+       double y11, double y12, double y13, double y14,
+       double y21, double y22, double y23, double y24,
+       double y31, double y32, double y33, double y34,
+       double y41, double y42, double y43, double y44) {
+
+    auto m1 = verified_math::Mat44<double> {
+      x11, x12, x13, x14,
+      x21, x22, x23, x24,
+      x31, x32, x33, x34,
+      x41, x42, x43, x44
+    };
+
+    auto m2 = verified_math::Mat44<double> {
+      y11, y12, y13, y14,
+      y21, y22, y23, y24,
+      y31, y32, y33, y34,
+      y41, y42, y43, y44
+    };
+
+    auto prod1 = m1 * m2;
+    auto prod2 = verified_math::operator*<double>(m1, m2);
+
+    // Bit-for-bit without FMA; with FMA each entry is bounded by the
+    // rounding of the fused products.
+    auto tol = [](double a, double b, double c, double d) {
+#if defined(VERIFIED_MATH_FMA) || defined(__FMA__)
+      return 4 * DBL_EPSILON *
+        (fabs(a) + fabs(b) + fabs(c) + fabs(d));
+#else
+      (void)a; (void)b; (void)c; (void)d;
+      return 0.0;
+#endif
+    };
+
+    const double* p1 = &prod1.x11;
+    const double* p2 = &prod2.x11;
+    const double* a = &m1.x11;
+    const double* b = &m2.x11;
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 4; ++j) {
+	auto bound = tol(a[4 * i] * b[j], a[4 * i + 1] * b[4 + j],
+			 a[4 * i + 2] * b[8 + j], a[4 * i + 3] * b[12 + j]);
+	if (fabs(p1[4 * i + j] - p2[4 * i + j]) > bound) {
+	  return false;
+	}
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> {
+			       simd_matches_scalar
+				 }, parallel_check::trials(10000)
+			     )
+	      );
+}
+
+TEST(TestMat44, TestSimdFloatProductMatchesScalar) {
+  auto simd_matches_scalar =
+    [](double x11, double x12, double x13, double x14,
+       double x21, double x22, double x23, double x24,
+       double x31, double x32, double x33, double x34,
+       double x41, double x42, double x43, double x44,
+
+       double y11, double y12, double y13, double y14,
+       double y21, double y22, double y23, double y24,
+       double y31, double y32, double y33, double y34,
+       double y41, double y42, double y43, double y44) {
+
+    auto m1 = verified_math::Mat44<float> {
+      float(x11), float(x12), float(x13), float(x14),
+      float(x21), float(x22), float(x23), float(x24),
+      float(x31), float(x32), float(x33), float(x34),
+      float(x41), float(x42), float(x43), float(x44)
+    };
+
+    auto m2 = verified_math::Mat44<float> {
+      float(y11), float(y12), float(y13), float(y14),
+      float(y21), float(y22), float(y23), float(y24),
+      float(y31), float(y32), float(y33), float(y34),
+      float(y41), float(y42), float(y43), float(y44)
+    };
+
+    auto prod1 = m1 * m2;
+    auto prod2 = verified_math::operator*<float>(m1, m2);
+
+    const float* p1 = &prod1.x11;
+    const float* p2 = &prod2.x11;
+#if defined(VERIFIED_MATH_FMA) || defined(__FMA__)
+    const float* a = &m1.x11;
+    const float* b = &m2.x11;
+#endif
+    for (int i = 0; i < 4; ++i) {
+      for (int j = 0; j < 4; ++j) {
+#if defined(VERIFIED_MATH_FMA) || defined(__FMA__)
+	double bound = 4 * FLT_EPSILON *
+	  (fabs(a[4 * i] * b[j]) + fabs(a[4 * i + 1] * b[4 + j]) +
+	   fabs(a[4 * i + 2] * b[8 + j]) + fabs(a[4 * i + 3] * b[12 + j]));
+#else
+	double bound = 0.0;
+#endif
+	if (fabs(p1[4 * i + j] - p2[4 * i + j]) > bound) {
+	  return false;
+	}
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> {
+			       simd_matches_scalar
+				 }, parallel_check::trials(10000)
+			     )
+	      );
+}
+
+TEST(TestMat44, TestSimdFloatInverseMatchesScalar) {
+  auto simd_matches_scalar = [](double x11, double x12, double x13, double x14,
+				double x21, double x22, double x23, double x24,
+				double x31, double x32, double x33, double x34,
+				double x41, double x42, double x43, double x44) {
+    auto m = verified_math::Mat44<float> {
+      float(x11), float(x12), float(x13), float(x14),
+      float(x21), float(x22), float(x23), float(x24),
+      float(x31), float(x32), float(x33), float(x34),
+      float(x41), float(x42), float(x43), float(x44)
+    };
+
+    // Both are inverses by cofactors, rounded differently; they agree to
+    // within the conditioning of m.
+    auto kappa = sqrt(double(verified_math::condition_number(m)));
+    if (!(kappa < 1e3)) {
+      return true;
+    }
+
+    auto inv1 = verified_math::inverse(m);
+    auto inv2 = verified_math::inverse<float>(m);
+
+    const double norm = sqrt(double(inv2.l2_norm()));
+    const float* p1 = &inv1.x11;
+    const float* p2 = &inv2.x11;
+    for (int i = 0; i < 16; ++i) {
+      if (!(fabs(p1[i] - p2[i]) <= 64 * FLT_EPSILON * kappa * norm)) {
+	return false;
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> {
+			       simd_matches_scalar
+				 }, parallel_check::trials(10000)
+			     )
+	      );
+}
+
+/*
+  Tests related to the batched transforms.
+ */
+TEST(TestMat44, TestTransformVectorsMatchesProduct) {
+  auto transform_matches_product =
+    [](double x11, double x12, double x13, double x14,
+       double x21, double x22, double x23, double x24,
+       double x31, double x32, double x33, double x34,
+       double x41, double x42, double x43, double x44,
+       double v1, double v2, double v3, double v4) {
+    auto m = verified_math::Mat44<double> {
+      x11, x12, x13, x14,
+      x21, x22, x23, x24,
+      x31, x32, x33, x34,
+      x41, x42, x43, x44
+    };
+
+    std::vector<verified_math::Vec4<double> > aos;
+    for (int i = 0; i < 7; ++i) {
+      aos.push_back(verified_math::Vec4<double>{v1 + i, v2 * i, v3 - i, v4});
+    }
+    auto soa = verified_math::Vec4Array<double>(aos.data(), aos.size());
+
+    auto aos_out = aos;
+    verified_math::Vec4Array<double> soa_out;
+    verified_math::transform_vectors(m, aos.data(), aos_out.data(), aos.size());
+    verified_math::transform_vectors(m, soa, soa_out);
+
+    for (std::size_t i = 0; i < aos.size(); ++i) {
+      auto expected = m * aos[i];
+      auto tol = epsilon * (1.0 + fabs(expected.x1) + fabs(expected.x2) +
+			    fabs(expected.x3) + fabs(expected.x4));
+      if (fabs(aos_out[i].x1 - expected.x1) > tol ||
+	  fabs(aos_out[i].x2 - expected.x2) > tol ||
+	  fabs(aos_out[i].x3 - expected.x3) > tol ||
+	  fabs(aos_out[i].x4 - expected.x4) > tol ||
+	  fabs(soa_out[i].x1 - expected.x1) > tol ||
+	  fabs(soa_out[i].x2 - expected.x2) > tol ||
+	  fabs(soa_out[i].x3 - expected.x3) > tol ||
+	  fabs(soa_out[i].x4 - expected.x4) > tol) {
+	return false;
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> {
+			       transform_matches_product }, parallel_check::trials(10000)
+			     )
+	      );
+}
+
+TEST(TestMat44, TestTransformPointsAffine) {
+  auto transform_points_affine =
+    [](double x11, double x12, double x13, double x14,
+       double x21, double x22, double x23, double x24,
+       double x31, double x32, double x33, double x34,
+       double v1, double v2, double v3) {
+    // An affine matrix: the projective and affine paths must agree with
+    // the product on (v, 1).
+    auto m = verified_math::Mat44<double> {
+      x11, x12, x13, x14,
+      x21, x22, x23, x24,
+      x31, x32, x33, x34,
+      0.0, 0.0, 0.0, 1.0
+    };
+
+    std::vector<verified_math::Vec3<double> > aos;
+    for (int i = 0; i < 7; ++i) {
+      aos.push_back(verified_math::Vec3<double>{v1 + i, v2 * i, v3 - i});
+    }
+    auto soa = verified_math::Vec3Array<double>(aos.data(), aos.size());
+
+    auto projective = aos;
+    auto affine = aos;
+    verified_math::Vec3Array<double> soa_projective, soa_affine;
+    verified_math::transform_points(m, aos.data(), projective.data(), aos.size());
+    verified_math::transform_points_affine(m, aos.data(), affine.data(), aos.size());
+    verified_math::transform_points(m, soa, soa_projective);
+    verified_math::transform_points_affine(m, soa, soa_affine);
+
+    for (std::size_t i = 0; i < aos.size(); ++i) {
+      auto expected = m * verified_math::Vec4<double>{aos[i].x1, aos[i].x2, aos[i].x3, 1.0};
+      auto tol = epsilon * (1.0 + fabs(expected.x1) + fabs(expected.x2) + fabs(expected.x3));
+      const verified_math::Vec3<double> results[] = {
+	projective[i], affine[i], soa_projective[i], soa_affine[i]
+      };
+      for (int k = 0; k < 4; ++k) {
+	if (fabs(results[k].x1 - expected.x1) > tol ||
+	    fabs(results[k].x2 - expected.x2) > tol ||
+	    fabs(results[k].x3 - expected.x3) > tol) {
+	  return false;
+	}
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double> {
+			       transform_points_affine }, parallel_check::trials(10000)
+			     )
+	      );
+}
+
+/*
+  Tests related to try_inverse.
+ */
+TEST(TestMat44, TestTryInverseMatchesInverse) {
+  auto try_matches_inverse = [](double x11, double x12, double x13, double x14,
+				double x21, double x22, double x23, double x24,
+				double x31, double x32, double x33, double x34,
+				double x41, double x42, double x43, double x44) {
+    auto m = verified_math::Mat44<double> {
+      x11, x12, x13, x14,
+      x21, x22, x23, x24,
+      x31, x32, x33, x34,
+      x41, x42, x43, x44
+    };
+
+    auto r = verified_math::try_inverse(m);
+    if (!r.ok) {
+      return std::isinf(r.condition_estimate) && r.inverse.l2_norm() == 0.0;
+    }
+
+    auto inv = verified_math::inverse(m);
+    auto kappa2 = verified_math::condition_number(m);
+    const double norm = sqrt(inv.l2_norm());
+    const double* p = &r.inverse.x11;
+    const double* q = &inv.x11;
+    for (int i = 0; i < 16; ++i) {
+      if (fabs(p[i] - q[i]) > 16 * DBL_EPSILON * norm) {
+	return false;
+      }
+    }
+    // det(m) expands by minors rather than down the adjugate, so it agrees
+    // only to within the conditioning of m.
+    const double kappa = r.condition_estimate;
+    return fabs(r.det - verified_math::det(m)) <= 64 * DBL_EPSILON * kappa * fabs(r.det) &&
+      fabs(r.condition_estimate * r.condition_estimate - kappa2) <= 1e-12 * kappa2;
+  };
+
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> {
+			       try_matches_inverse
+				 }, parallel_check::trials(10000)
+			     )
+	      );
+}
+
+TEST(TestMat44, TestTryInverseRejectsSingular) {
+  auto singular = verified_math::Mat44<double> {
+    1.0, 2.0, 3.0, 4.0,
+    0.0, 1.0, 0.0, 1.0,
+    2.0, 4.0, 6.0, 8.0,
+    5.0, 0.0, 1.0, 2.0
+  };
+  auto r = verified_math::try_inverse(singular);
+  EXPECT_FALSE(r.ok);
+  EXPECT_EQ(0.0, r.inverse.l2_norm());
+  EXPECT_TRUE(std::isinf(r.condition_estimate));
+
+  auto scaled = verified_math::Mat44<double> {
+    0.0, 0.0, 0.0, 1e-3,
+    0.0, 0.0, 1e-3, 0.0,
+    0.0, 1e-3, 0.0, 0.0,
+    1e-3, 0.0, 0.0, 0.0
+  };
+  // A tiny determinant alone is not singularity: this is a scaled permutation.
+  r = verified_math::try_inverse(scaled);
+  EXPECT_TRUE(r.ok);
+  EXPECT_NEAR(1e3, r.inverse.x14, 1e-9);
+  EXPECT_NEAR(4.0, r.condition_estimate, 1e-12);
+}
+
+TEST(TestMat44, TestTryInverseFloatExtremeScales) {
+  // s * a for s near the top and bottom of the float exponent range, and
+  // the scales where d * d or r1 r2 r3 r4 would leave it without rescaling.
+  const auto a = verified_math::Mat44<double> {
+    2.0, 1.0, 0.0, 0.0,
+    1.0, 3.0, 1.0, 0.0,
+    0.0, 1.0, 4.0, 1.0,
+    0.0, 0.0, 1.0, 5.0
+  };
+  const auto ra = verified_math::try_inverse(a);
+  const float scales[] = {
+    1e5f, 1e-6f, std::ldexp(1.0f, 120), std::ldexp(1.0f, -120)
+  };
+
+  for (float s : scales) {
+    const double* p = &a.x11;
+    float q[16];
+    for (int i = 0; i < 16; ++i) {
+      q[i] = static_cast<float>(p[i]) * s;
+    }
+    const auto m = verified_math::Mat44<float> {
+      q[0], q[1], q[2], q[3],
+      q[4], q[5], q[6], q[7],
+      q[8], q[9], q[10], q[11],
+      q[12], q[13], q[14], q[15]
+    };
+
+    auto r = verified_math::try_inverse(m);
+    EXPECT_TRUE(r.ok) << s;
+    EXPECT_NEAR(ra.condition_estimate, r.condition_estimate, 1e-4 * ra.condition_estimate) << s;
+    const float* x = &r.inverse.x11;
+    const double* y = &ra.inverse.x11;
+    for (int i = 0; i < 16; ++i) {
+      EXPECT_NEAR(y[i], x[i] * static_cast<double>(s), 1e-5) << s << " " << i;
+    }
+    const double d = 85.0 * s * s * s * s;
+    if (d < FLT_MAX && d > FLT_MIN) {
+      EXPECT_NEAR(1.0, r.det / d, 1e-5) << s;
+    }
+  }
+}
@@ -0,0 +1,189 @@
+#include "verified_math/mat44_array.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+
+#define epsilon 1e-6
+
+/*
+  Tests for the batched determinant and inverse. Several matrices are
+  built from each sample so that the vectorized loop body is exercised.
+ */
+namespace {
+  const std::size_t array_size = 9;
+
+  verified_math::Mat44Array<double> make_array(double x11, double x12, double x13, double x14,
+					       double x21, double x22, double x23, double x24,
+					       double x31, double x32, double x33, double x34,
+					       double x41, double x42, double x43, double x44) {
+    verified_math::Mat44Array<double> a;
+    for (std::size_t i = 0; i < array_size; ++i) {
+      double s = 0.5 * i;
+      a.push_back(verified_math::Mat44<double>{
+	  x11 + s, x12, x13, x14,
+	  x21, x22 - s, x23, x24,
+	  x31, x32 * s, x33, x34,
+	  x41, x42, x43, x44 + s
+	});
+    }
+    return a;
+  }
+
+  double max_abs(const verified_math::Mat44<double>& m) {
+    const double* p = &m.x11;
+    double result = 0.0;
+    for (int i = 0; i < 16; ++i) {
+      result = fmax(result, fabs(p[i]));
+    }
+    return result;
+  }
+}
+
+TEST(TestMat44Array, TestBatchDetMatchesDet) {
+  auto batch_det = [](double x11, double x12, double x13, double x14,
+		      double x21, double x22, double x23, double x24,
+		      double x31, double x32, double x33, double x34,
+		      double x41, double x42, double x43, double x44) {
+    auto a = make_array(x11, x12, x13, x14, x21, x22, x23, x24,
+			x31, x32, x33, x34, x41, x42, x43, x44);
+
+    double dets[array_size];
+    double dets2[array_size];
+    unsigned char ok[array_size];
+    verified_math::Mat44Array<double> inv;
+    verified_math::det(a, dets);
+    verified_math::det_inverse(a, dets2, inv, ok);
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      auto m = a[i];
+      auto scale = 1.0 + pow(max_abs(m), 4);
+      auto expected = verified_math::det(m);
+      if (fabs(dets[i] - expected) > epsilon * scale ||
+	  fabs(dets2[i] - expected) > epsilon * scale) {
+	return false;
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> {
+			       batch_det }, 10000));
+}
+
+TEST(TestMat44Array, TestBatchInverse) {
+  auto batch_inverse = [](double x11, double x12, double x13, double x14,
+			  double x21, double x22, double x23, double x24,
+			  double x31, double x32, double x33, double x34,
+			  double x41, double x42, double x43, double x44) {
+    auto a = make_array(x11, x12, x13, x14, x21, x22, x23, x24,
+			x31, x32, x33, x34, x41, x42, x43, x44);
+
+    double dets[array_size];
+    unsigned char ok[array_size];
+    verified_math::Mat44Array<double> inv;
+    verified_math::det_inverse(a, dets, inv, ok);
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      if (!ok[i]) {
+	continue;
+      }
+      auto m = a[i];
+      auto prod = m * inv[i];
+      auto tol = epsilon * max_abs(m) * max_abs(inv[i]);
+      const double* p = &prod.x11;
+      for (int k = 0; k < 16; ++k) {
+	double expected = (k % 5 == 0) ? 1.0 : 0.0;
+	if (fabs(p[k] - expected) > tol) {
+	  return false;
+	}
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> {
+			       batch_inverse }, 10000));
+}
+
+TEST(TestMat44Array, TestSingularIsMasked) {
+  verified_math::Mat44Array<double> a;
+  a.push_back(verified_math::Mat44<double>{
+      1.0, 2.0, 3.0, 4.0,
+      2.0, 4.0, 6.0, 8.0,
+      0.0, 1.0, 1.0, 0.0,
+      1.0, 0.0, 0.0, 1.0
+    });
+  a.push_back(verified_math::Mat44<double>{
+      2.0, 0.0, 0.0, 0.0,
+      0.0, 2.0, 0.0, 0.0,
+      0.0, 0.0, 2.0, 0.0,
+      0.0, 0.0, 0.0, 2.0
+    });
+
+  double dets[2];
+  unsigned char ok[2];
+  verified_math::Mat44Array<double> inv;
+  verified_math::det_inverse(a, dets, inv, ok);
+
+  EXPECT_EQ(0, ok[0]);
+  EXPECT_EQ(1, ok[1]);
+  EXPECT_EQ(0.0, inv[0].x11);
+  EXPECT_EQ(0.5, inv[1].x44);
+  EXPECT_EQ(16.0, dets[1]);
+}
+
+TEST(TestMat44Array, TestFloatExtremeScales) {
+  // d * d and r1 r2 r3 r4 over- or underflow in float for these without
+  // the row scaling; the rows of the last entry differ by 2^200.
+  const float scales[] = { 1e5f, 1e-6f, std::ldexp(1.0f, 30), std::ldexp(1.0f, -30) };
+  verified_math::Mat44Array<float> a;
+  for (float s : scales) {
+    a.push_back(verified_math::Mat44<float>{
+	2.0f * s, 1.0f * s, 0.0f, 0.0f,
+	1.0f * s, 3.0f * s, 1.0f * s, 0.0f,
+	0.0f, 1.0f * s, 4.0f * s, 1.0f * s,
+	0.0f, 0.0f, 1.0f * s, 5.0f * s
+      });
+  }
+  const float big = std::ldexp(1.0f, 100), small = std::ldexp(1.0f, -100);
+  a.push_back(verified_math::Mat44<float>{
+      2.0f * big, 1.0f * big, 0.0f, 0.0f,
+      1.0f, 3.0f, 1.0f, 0.0f,
+      0.0f, 1.0f, 4.0f, 1.0f,
+      0.0f, 0.0f, 1.0f * small, 5.0f * small
+    });
+  a.push_back(verified_math::Mat44<float>{
+      1.0f * small, 2.0f * small, 3.0f * small, 4.0f * small,
+      2.0f * small, 4.0f * small, 6.0f * small, 8.0f * small,
+      0.0f, 1.0f * small, 1.0f * small, 0.0f,
+      1.0f * small, 0.0f, 0.0f, 1.0f * small
+    });
+
+  float dets[6];
+  unsigned char ok[6];
+  verified_math::Mat44Array<float> inv;
+  verified_math::det_inverse(a, dets, inv, ok);
+
+  for (std::size_t i = 0; i < 5; ++i) {
+    EXPECT_EQ(1, ok[i]) << i;
+    const double s = i < 4 ? scales[i] : 1.0;
+    EXPECT_NEAR(1.0, dets[i] / (85.0 * s * s * s * s), 1e-5) << i;
+    const verified_math::Mat44<float> p = a[i] * inv[i];
+    EXPECT_NEAR(1.0f, p.x11, 1e-5f) << i;
+    EXPECT_NEAR(1.0f, p.x22, 1e-5f) << i;
+    EXPECT_NEAR(1.0f, p.x33, 1e-5f) << i;
+    EXPECT_NEAR(1.0f, p.x44, 1e-5f) << i;
+    EXPECT_NEAR(0.0f, p.x12, 1e-5f) << i;
+    EXPECT_NEAR(0.0f, p.x34, 1e-5f) << i;
+    EXPECT_NEAR(0.0f, p.x41, 1e-5f) << i;
+  }
+  EXPECT_EQ(0, ok[5]);
+  EXPECT_EQ(0.0f, inv[5].x11);
+}
@@ -0,0 +1,73 @@
+#include "parallel_check.h"
+#include "gtest/gtest.h"
+
+#include <cmath>
+#include <stdexcept>
+#include <string>
+
+TEST(TestParallelCheck, TestTruePropertyPasses) {
+  auto square_nonnegative = [](double x) {
+    return x * x >= 0.0;
+  };
+
+  EXPECT_TRUE(parallel_check::check(parallel_check::Property<double> {
+	square_nonnegative }, 100000));
+}
+
+TEST(TestParallelCheck, TestFalsePropertyFails) {
+  auto small = [](double x, double y) {
+    return fabs(x) < 1e5 && fabs(y) < 1e5;
+  };
+
+  EXPECT_FALSE(parallel_check::check(parallel_check::Property<double, double> {
+	small }, 100000));
+}
+
+/*
+  The reported counterexample is the one with the lowest trial index, so it
+  does not depend on the number of threads.
+ */
+TEST(TestParallelCheck, TestCounterexampleIndependentOfThreads) {
+  auto rare = [](double x, double y, double z) {
+    return !(x > 9e5 && y > 0.0 && z < 0.0);
+  };
+
+  parallel_check::Property<double, double, double> p { rare };
+  std::string report = parallel_check::check(p, 200000, 1).message();
+  EXPECT_FALSE(report.empty());
+  for (unsigned threads = 2; threads <= 16; threads *= 2) {
+    EXPECT_EQ(report, std::string(parallel_check::check(p, 200000, threads).message()));
+  }
+}
+
+TEST(TestParallelCheck, TestRunIsReproducible) {
+  auto rare = [](double x) {
+    return x < 5e5;
+  };
+
+  parallel_check::Property<double> p { rare };
+  std::string first = parallel_check::check(p, 1000000, 3).message();
+  std::string second = parallel_check::check(p, 1000000, 5).message();
+  EXPECT_FALSE(first.empty());
+  EXPECT_EQ(first, second);
+}
+
+/*
+  A property that throws fails at that trial instead of terminating the
+  worker thread, and the report is the same for any number of threads.
+ */
+TEST(TestParallelCheck, TestThrowingPropertyFails) {
+  auto throws_rarely = [](double x) {
+    if (x > 9e5) {
+      throw std::domain_error("too large");
+    }
+    return true;
+  };
+
+  parallel_check::Property<double> p { throws_rarely };
+  std::string report = parallel_check::check(p, 200000, 1).message();
+  EXPECT_NE(std::string::npos, report.find("too large"));
+  for (unsigned threads = 2; threads <= 16; threads *= 2) {
+    EXPECT_EQ(report, std::string(parallel_check::check(p, 200000, threads).message()));
+  }
+}
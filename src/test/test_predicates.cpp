@@ -0,0 +1,192 @@
+#include "verified_math/predicates.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <cstdint>
+
+/*
+  The predicates are checked against exact integer determinants: with
+  integer coordinates of up to 28 bits for orient3d and 19 bits for
+  insphere, every product fits in a 128-bit integer. The near-degenerate
+  inputs are coplanar or cospherical integer points and their unit
+  perturbations, where double evaluation of the determinants gets signs
+  wrong.
+ */
+typedef __int128 Wide;
+typedef verified_math::Vec3<double> V;
+
+static int sign(Wide x) {
+  return x > 0 ? 1 : (x < 0 ? -1 : 0);
+}
+
+static int sign(double x) {
+  return x > 0 ? 1 : (x < 0 ? -1 : 0);
+}
+
+// Integer values in (-2^bits, 2^bits) from the generator's doubles.
+static std::int64_t integer(double x, int bits) {
+  return std::int64_t(std::trunc(std::fmod(x * 4096, std::ldexp(1.0, bits))));
+}
+
+struct P {
+  std::int64_t x, y, z;
+};
+
+static V point(const P& p) {
+  return V(double(p.x), double(p.y), double(p.z));
+}
+
+static Wide det3(const P& a, const P& b, const P& c) {
+  return Wide(a.x) * (Wide(b.y) * c.z - Wide(b.z) * c.y) +
+    Wide(a.y) * (Wide(b.z) * c.x - Wide(b.x) * c.z) +
+    Wide(a.z) * (Wide(b.x) * c.y - Wide(b.y) * c.x);
+}
+
+static P sub(const P& a, const P& b) {
+  return P{a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+static Wide orient3d_exact(const P& a, const P& b, const P& c, const P& d) {
+  return det3(sub(a, d), sub(b, d), sub(c, d));
+}
+
+// The 4 x 4 determinant with rows (p - e, |p - e|^2), along its last column.
+static Wide insphere_exact(const P& a, const P& b, const P& c, const P& d, const P& e) {
+  const P q[4] = {sub(a, e), sub(b, e), sub(c, e), sub(d, e)};
+  Wide lift[4];
+  for (int i = 0; i < 4; ++i) {
+    lift[i] = Wide(q[i].x) * q[i].x + Wide(q[i].y) * q[i].y + Wide(q[i].z) * q[i].z;
+  }
+  return -lift[0] * det3(q[1], q[2], q[3]) + lift[1] * det3(q[0], q[2], q[3]) -
+    lift[2] * det3(q[0], q[1], q[3]) + lift[3] * det3(q[0], q[1], q[2]);
+}
+
+TEST(TestPredicates, TestConventions) {
+  const V a(0, 0, 0), b(1, 0, 0), c(0, 1, 0), below(0, 0, -1);
+  EXPECT_GT(verified_math::orient3d(a, b, c, below), 0);
+  EXPECT_LT(verified_math::orient3d(b, a, c, below), 0);
+  EXPECT_EQ(0, verified_math::orient3d(a, b, c, V(3, -7, 0)));
+
+  EXPECT_GT(verified_math::insphere(a, b, c, below, V(0.25, 0.25, -0.25)), 0);
+  EXPECT_LT(verified_math::insphere(a, b, c, below, V(2, 2, 2)), 0);
+  EXPECT_EQ(0, verified_math::insphere(a, b, c, below, V(1, 1, 0)));
+  EXPECT_LT(verified_math::insphere(b, a, c, below, V(0.25, 0.25, -0.25)), 0);
+}
+
+TEST(TestPredicates, TestFilterIsDet) {
+  // Away from degeneracy the filter decides, and the result is det itself.
+  const V a(0.1, 0.7, -0.3), b(1.5, 0.2, 0.4), c(-0.6, 1.1, 0.9), d(0.3, -0.8, 0.05);
+  const verified_math::Mat33<double> m{
+    a.x1 - d.x1, a.x2 - d.x2, a.x3 - d.x3,
+    b.x1 - d.x1, b.x2 - d.x2, b.x3 - d.x3,
+    c.x1 - d.x1, c.x2 - d.x2, c.x3 - d.x3
+  };
+  EXPECT_EQ(verified_math::det(m), verified_math::orient3d(a, b, c, d));
+}
+
+TEST(TestPredicates, TestOrient3dNearCoplanar) {
+  // d lies on the plane through a, b and c, moved by at most one unit.
+  auto exact_sign = [](double ax, double ay, double az, double bx, double by, double bz,
+		       double cx, double cy, double cz, double s, double t, double e) {
+    const P a{integer(ax, 24), integer(ay, 24), integer(az, 24)};
+    const P b{integer(bx, 24), integer(by, 24), integer(bz, 24)};
+    const P c{integer(cx, 24), integer(cy, 24), integer(cz, 24)};
+    const std::int64_t u = integer(s, 2), v = integer(t, 2), w = integer(e, 2) % 2;
+    const P d{a.x + u * (b.x - a.x) + v * (c.x - a.x) + w,
+	a.y + u * (b.y - a.y) + v * (c.y - a.y),
+	a.z + u * (b.z - a.z) + v * (c.z - a.z) - w};
+    return sign(verified_math::orient3d(point(a), point(b), point(c), point(d))) ==
+      sign(orient3d_exact(a, b, c, d)) &&
+      sign(verified_math::orient3d(point(b), point(a), point(d), point(c))) ==
+      sign(orient3d_exact(b, a, d, c));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double, double, double,
+			     double, double, double, double, double, double> { exact_sign }, 10000));
+}
+
+TEST(TestPredicates, TestOrient3dUlpGrid) {
+  // Points d a few ulps around (0.5, 0.5, 0.5), on the plane x + y = 2z
+  // through a, b and c. orient3d = n . (a - d) with n = (b - a) x (c - a),
+  // evaluated exactly on the coordinates scaled by 2^53.
+  const P a{12, 12, 12}, b{24, 0, 12}, c{-2, 6, 2};
+  const P n{(b.y - a.y) * (c.z - a.z) - (b.z - a.z) * (c.y - a.y),
+      (b.z - a.z) * (c.x - a.x) - (b.x - a.x) * (c.z - a.z),
+      (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x)};
+  const Wide half = Wide(1) << 52;
+  int det_wrong = 0;
+  for (int i = -8; i < 8; ++i) {
+    for (int j = -8; j < 8; ++j) {
+      for (int k = -8; k < 8; ++k) {
+	const V d(0.5 + std::ldexp(double(i), -53), 0.5 + std::ldexp(double(j), -53),
+		  0.5 + std::ldexp(double(k), -53));
+	const Wide dx = half + i, dy = half + j, dz = half + k;
+	const Wide exact = n.x * ((Wide(a.x) << 53) - dx) + n.y * ((Wide(a.y) << 53) - dy) +
+	  n.z * ((Wide(a.z) << 53) - dz);
+	ASSERT_EQ(sign(exact), sign(verified_math::orient3d(point(a), point(b), point(c), d)))
+	  << i << " " << j << " " << k;
+
+	const verified_math::Mat33<double> m{
+	  a.x - d.x1, a.y - d.x2, a.z - d.x3,
+	  b.x - d.x1, b.y - d.x2, b.z - d.x3,
+	  c.x - d.x1, c.y - d.x2, c.z - d.x3
+	};
+	det_wrong += sign(verified_math::det(m)) != sign(exact);
+      }
+    }
+  }
+  // The inputs are hard: plain det gets some of them wrong.
+  EXPECT_GT(det_wrong, 0);
+}
+
+TEST(TestPredicates, TestInsphereNearCospherical) {
+  // Five points on the sphere through o with radius |(p, q, r)|, the last
+  // moved by at most one unit.
+  auto exact_sign = [](double ox, double oy, double oz, double p, double q, double r, double e) {
+    const P o{integer(ox, 18), integer(oy, 18), integer(oz, 18)};
+    const std::int64_t x = integer(p, 17), y = integer(q, 17), z = integer(r, 17);
+    const std::int64_t w = integer(e, 2) % 2;
+    const P a{o.x + x, o.y + y, o.z + z}, b{o.x + y, o.y + z, o.z + x};
+    const P c{o.x + z, o.y + x, o.z + y}, d{o.x - x, o.y - y, o.z - z};
+    const P f{o.x - y + w, o.y - z, o.z - x};
+    return sign(verified_math::insphere(point(a), point(b), point(c), point(d), point(f))) ==
+      sign(insphere_exact(a, b, c, d, f)) &&
+      sign(verified_math::insphere(point(b), point(f), point(c), point(a), point(d))) ==
+      sign(insphere_exact(b, f, c, a, d));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double, double,
+			     double, double> { exact_sign }, 10000));
+}
+
+TEST(TestPredicates, TestInsphereRandom) {
+  auto exact_sign = [](double ax, double ay, double az, double bx, double by, double bz,
+		       double cx, double cy, double cz, double dx, double dy, double dz) {
+    const P a{integer(ax, 19), integer(ay, 19), integer(az, 19)};
+    const P b{integer(bx, 19), integer(by, 19), integer(bz, 19)};
+    const P c{integer(cx, 19), integer(cy, 19), integer(cz, 19)};
+    const P d{integer(dx, 19), integer(dy, 19), integer(dz, 19)};
+    const P e{(a.x + b.x) / 2, (c.y + d.y) / 2, (a.z + d.z) / 2};
+    return sign(verified_math::insphere(point(a), point(b), point(c), point(d), point(e))) ==
+      sign(insphere_exact(a, b, c, d, e));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double, double, double,
+			     double, double, double, double, double, double> { exact_sign }, 10000));
+}
+
+TEST(TestPredicates, TestFloat) {
+  typedef verified_math::Vec3<float> F;
+  // Coplanar and cospherical points whose determinants round to nonzero
+  // in float.
+  const F a(1000.25f, 3.0f, 7.0f), b(3.0f, 1000.25f, 7.0f), c(7.0f, 3.0f, 1000.25f);
+  const F d(-1000.25f, -3.0f, -7.0f), e(-3.0f, -7.0f, -1000.25f);
+  EXPECT_EQ(0.0f, verified_math::insphere(a, b, c, d, e));
+  EXPECT_LT(verified_math::insphere(a, b, c, d, F(-3.0f, -7.0f, -1000.5f)) *
+	    verified_math::insphere(a, b, c, d, F(-3.0f, -7.0f, -1000.0f)), 0.0f);
+  // a, b, c and this point lie on the plane x + y + z = 1010.25.
+  EXPECT_EQ(0.0f, verified_math::orient3d(a, b, c, F(500.5f, 500.5f, 9.25f)));
+  EXPECT_LT(verified_math::orient3d(a, b, c, F(500.5f, 500.5f, 9.5f)) *
+	    verified_math::orient3d(a, b, c, F(500.5f, 500.5f, 9.0f)), 0.0f);
+}
@@ -0,0 +1,206 @@
+#include "verified_math/quat.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <cfloat>
+#include <vector>
+
+/*
+  The properties draw arbitrary quaternions and normalize them; draws whose
+  norm is tiny or not finite are vacuously true. Results are compared to
+  within a small multiple of the rounding error, relative to the size of
+  the vectors involved.
+ */
+static bool unit(double w, double x, double y, double z, verified_math::Quat<double>& q) {
+  auto r = verified_math::Quat<double>(w, x, y, z);
+  const double n = r.l2_norm();
+  if (!std::isfinite(n) || n < 1e-12) {
+    return false;
+  }
+  q = verified_math::normalize(r);
+  return true;
+}
+
+static bool close(const verified_math::Vec3<double>& a, const verified_math::Vec3<double>& b,
+		  double scale) {
+  return fabs(a.x1 - b.x1) <= 64 * DBL_EPSILON * scale &&
+    fabs(a.x2 - b.x2) <= 64 * DBL_EPSILON * scale &&
+    fabs(a.x3 - b.x3) <= 64 * DBL_EPSILON * scale;
+}
+
+static bool close(const verified_math::Mat33<double>& a, const verified_math::Mat33<double>& b) {
+  const double* p = &a.x11;
+  const double* q = &b.x11;
+  for (int i = 0; i < 9; ++i) {
+    if (fabs(p[i] - q[i]) > 64 * DBL_EPSILON) {
+      return false;
+    }
+  }
+  return true;
+}
+
+TEST(TestQuat, TestHamiltonProduct) {
+  const auto i = verified_math::Quat<double>(0, 1, 0, 0);
+  const auto j = verified_math::Quat<double>(0, 0, 1, 0);
+  const auto k = verified_math::Quat<double>(0, 0, 0, 1);
+
+  auto ij = i * j;
+  EXPECT_EQ(0.0, ij.w); EXPECT_EQ(0.0, ij.x); EXPECT_EQ(0.0, ij.y); EXPECT_EQ(1.0, ij.z);
+  auto ji = j * i;
+  EXPECT_EQ(-1.0, ji.z);
+  auto ijk = i * j * k;
+  EXPECT_EQ(-1.0, ijk.w); EXPECT_EQ(0.0, ijk.x); EXPECT_EQ(0.0, ijk.y); EXPECT_EQ(0.0, ijk.z);
+
+  constexpr auto c = verified_math::conjugate(verified_math::Quat<double>(1, 2, 3, 4));
+  static_assert(c.w == 1 && c.x == -2 && c.y == -3 && c.z == -4, "constexpr conjugate");
+}
+
+TEST(TestQuat, TestRotateMatchesMat33) {
+  auto matches = [](double w, double x, double y, double z,
+		    double v1, double v2, double v3) {
+    auto q = verified_math::Quat<double>(1, 0, 0, 0);
+    if (!unit(w, x, y, z, q)) {
+      return true;
+    }
+    auto v = verified_math::Vec3<double>(v1, v2, v3);
+    const double scale = std::sqrt(verified_math::dot(v, v));
+    return close(verified_math::rotate(q, v), verified_math::to_mat33(q) * v, scale);
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double> { matches }, 10000));
+}
+
+TEST(TestQuat, TestCompositionMatchesMat33Product) {
+  auto composes = [](double w1, double x1, double y1, double z1,
+		     double w2, double x2, double y2, double z2) {
+    auto q1 = verified_math::Quat<double>(1, 0, 0, 0);
+    auto q2 = verified_math::Quat<double>(1, 0, 0, 0);
+    if (!unit(w1, x1, y1, z1, q1) || !unit(w2, x2, y2, z2, q2)) {
+      return true;
+    }
+    return close(verified_math::to_mat33(q1 * q2),
+		 verified_math::to_mat33(q1) * verified_math::to_mat33(q2));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double> { composes }, 10000));
+}
+
+TEST(TestQuat, TestInverseUndoesRotation) {
+  auto undoes = [](double w, double x, double y, double z,
+		   double v1, double v2, double v3) {
+    auto q = verified_math::Quat<double>(1, 0, 0, 0);
+    if (!unit(w, x, y, z, q)) {
+      return true;
+    }
+    auto v = verified_math::Vec3<double>(v1, v2, v3);
+    auto back = verified_math::rotate(verified_math::inverse(q), verified_math::rotate(q, v));
+    return close(back, v, std::sqrt(verified_math::dot(v, v)));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double> { undoes }, 10000));
+}
+
+TEST(TestQuat, TestMat33RoundTrip) {
+  auto round_trips = [](double w, double x, double y, double z) {
+    auto q = verified_math::Quat<double>(1, 0, 0, 0);
+    if (!unit(w, x, y, z, q)) {
+      return true;
+    }
+    auto p = verified_math::from_mat33(verified_math::to_mat33(q));
+    // q and -q are the same rotation.
+    const double sign = verified_math::dot(p, q) < 0 ? -1.0 : 1.0;
+    auto d = sign * p - q;
+    return d.l2_norm() <= 64 * DBL_EPSILON * 64 * DBL_EPSILON;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double> {
+	round_trips }, 10000));
+
+  // Each branch of Shepperd's method: rotations by pi about each axis
+  // have trace -1 and a different largest diagonal entry.
+  const double pi = std::acos(-1.0);
+  const verified_math::Vec3<double> axes[] = {
+    verified_math::Vec3<double>(1, 0, 0),
+    verified_math::Vec3<double>(0, 1, 0),
+    verified_math::Vec3<double>(0, 0, 1)
+  };
+  for (const auto& axis : axes) {
+    auto q = verified_math::from_axis_angle(axis, pi);
+    auto p = verified_math::from_mat33(verified_math::to_mat33(q));
+    EXPECT_NEAR(1.0, fabs(verified_math::dot(p, q)), 1e-15);
+  }
+}
+
+TEST(TestQuat, TestToMat44) {
+  auto q = verified_math::normalize(verified_math::Quat<double>(0.5, -1.0, 2.0, 0.25));
+  auto m3 = verified_math::to_mat33(q);
+  auto m4 = verified_math::to_mat44(q);
+  EXPECT_EQ(m3.x11, m4.x11); EXPECT_EQ(m3.x12, m4.x12); EXPECT_EQ(m3.x13, m4.x13);
+  EXPECT_EQ(m3.x21, m4.x21); EXPECT_EQ(m3.x22, m4.x22); EXPECT_EQ(m3.x23, m4.x23);
+  EXPECT_EQ(m3.x31, m4.x31); EXPECT_EQ(m3.x32, m4.x32); EXPECT_EQ(m3.x33, m4.x33);
+  EXPECT_EQ(0.0, m4.x14); EXPECT_EQ(0.0, m4.x24); EXPECT_EQ(0.0, m4.x34);
+  EXPECT_EQ(0.0, m4.x41); EXPECT_EQ(0.0, m4.x42); EXPECT_EQ(0.0, m4.x43);
+  EXPECT_EQ(1.0, m4.x44);
+}
+
+TEST(TestQuat, TestBatchedRotateMatchesSingle) {
+  auto q = verified_math::normalize(verified_math::Quat<double>(0.3, -0.7, 0.2, 0.9));
+
+  std::vector<verified_math::Vec3<double> > in;
+  for (int i = 0; i < 37; ++i) {
+    in.push_back(verified_math::Vec3<double>(double(i), 1.0 - i, 0.25 * i));
+  }
+  std::vector<verified_math::Vec3<double> > out(in);
+  verified_math::rotate(q, in.data(), out.data(), in.size());
+
+  verified_math::Vec3Array<double> soa(in.data(), in.size());
+  verified_math::Vec3Array<double> soa_out;
+  verified_math::rotate(q, soa, soa_out);
+  ASSERT_EQ(in.size(), soa_out.size());
+
+  for (std::size_t i = 0; i < in.size(); ++i) {
+    auto expected = verified_math::rotate(q, in[i]);
+    const double scale = std::sqrt(verified_math::dot(in[i], in[i]));
+    EXPECT_TRUE(close(expected, out[i], scale));
+    EXPECT_TRUE(close(expected, soa_out[i], scale));
+  }
+
+  // In place.
+  verified_math::rotate(q, in.data(), in.data(), in.size());
+  EXPECT_EQ(out[5].x2, in[5].x2);
+}
+
+TEST(TestQuat, TestInterpolation) {
+  const auto z = verified_math::Vec3<double>(0, 0, 1);
+  const auto a = verified_math::from_axis_angle(z, 0.2);
+  const auto b = verified_math::from_axis_angle(z, 1.4);
+
+  // Endpoints.
+  auto s0 = verified_math::slerp(a, b, 0.0);
+  auto s1 = verified_math::slerp(a, b, 1.0);
+  EXPECT_NEAR(1.0, verified_math::dot(s0, a), 1e-15);
+  EXPECT_NEAR(1.0, verified_math::dot(s1, b), 1e-15);
+
+  // Constant angular speed: a quarter of the way is a quarter of the angle.
+  auto quarter = verified_math::slerp(a, b, 0.25);
+  EXPECT_NEAR(1.0, verified_math::dot(quarter, verified_math::from_axis_angle(z, 0.5)), 1e-15);
+  EXPECT_NEAR(1.0, quarter.l2_norm(), 1e-15);
+
+  // nlerp agrees at the midpoint, where the blend is symmetric.
+  auto mid = verified_math::nlerp(a, b, 0.5);
+  EXPECT_NEAR(1.0, verified_math::dot(mid, verified_math::from_axis_angle(z, 0.8)), 1e-15);
+  EXPECT_NEAR(1.0, mid.l2_norm(), 1e-15);
+
+  // The shorter arc: -b is the same rotation as b.
+  auto neg = verified_math::slerp(a, -1.0 * b, 0.25);
+  EXPECT_NEAR(1.0, verified_math::dot(neg, quarter), 1e-15);
+
+  // Nearly equal inputs take the nlerp path and stay unit.
+  auto c = verified_math::from_axis_angle(z, 0.2 + 1e-9);
+  auto near = verified_math::slerp(a, c, 0.5);
+  EXPECT_NEAR(1.0, near.l2_norm(), 1e-15);
+}
@@ -0,0 +1,359 @@
+#include "verified_math/solve.h"
+#include "verified_math/parallel.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cfloat>
+#include <vector>
+
+/*
+  LU with partial pivoting is backward stable: the residual b - m x is
+  small relative to |m| |x|, whatever the condition of m. The forward
+  error is then bounded by the condition number times that.
+ */
+static const double tol = 64 * DBL_EPSILON;
+
+template<typename Vec>
+static double norm(const Vec& v) {
+  return std::sqrt(verified_math::dot(v, v));
+}
+
+template<typename Mat, typename Vec>
+static bool small_residual(const Mat& m, const Vec& b, const Vec& x) {
+  return norm(b - m * x) <= tol * (std::sqrt(m.l2_norm()) * norm(x) + norm(b));
+}
+
+TEST(TestSolve, TestMat33Residual) {
+  auto solves = [](double x11, double x12, double x13,
+		   double x21, double x22, double x23,
+		   double x31, double x32, double x33) {
+    const verified_math::Mat33<double> m{x11, x12, x13, x21, x22, x23, x31, x32, x33};
+    const verified_math::Vec3<double> b(x11 - x33, x22, 1.0);
+    const verified_math::Lu33<double> lu(m);
+    if (!lu.ok()) {
+      return true;
+    }
+    const auto x = lu.solve(b);
+    return small_residual(m, b, x) && verified_math::solve(m, b).x2 == x.x2 &&
+      fabs(lu.det() - verified_math::det(m)) <= tol * std::pow(m.l2_norm(), 1.5);
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double> { solves }, 10000));
+}
+
+TEST(TestSolve, TestMat44Residual) {
+  auto solves = [](double x11, double x12, double x13, double x14,
+		   double x21, double x22, double x23, double x24,
+		   double x31, double x32, double x33, double x34) {
+    // The last row is a combination of the others plus a unit vector, so
+    // the generator's nine-digit spread reaches every row.
+    const verified_math::Mat44<double> m{
+      x11, x12, x13, x14,
+      x21, x22, x23, x24,
+      x31, x32, x33, x34,
+      x11 - x21, x32 + 1, x13, x24 - x34
+    };
+    const verified_math::Vec4<double> b(1.0, x12, -x23, x31);
+    const verified_math::Lu44<double> lu(m);
+    if (!lu.ok()) {
+      return true;
+    }
+    const auto x = lu.solve(b);
+    return small_residual(m, b, x) && verified_math::solve(m, b).x3 == x.x3;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> { solves }, 10000));
+}
+
+TEST(TestSolve, TestForwardError) {
+  // x0 is recovered to within the condition number; the adjugate-based
+  // inverse meets the same bound, so the two agree.
+  auto accurate = [](double x11, double x12, double x13,
+		     double x21, double x22, double x23,
+		     double x31, double x32, double x33) {
+    const verified_math::Mat33<double> m{x11, x12, x13, x21, x22, x23, x31, x32, x33};
+    const auto inv = verified_math::try_inverse(m);
+    if (!inv.ok || !(inv.condition_estimate < 1e8)) {
+      return true;
+    }
+    const verified_math::Vec3<double> x0(1.0, -2.0, 0.5);
+    const auto x = verified_math::solve(m, m * x0);
+    const double bound = tol * inv.condition_estimate * norm(x0);
+    return norm(x - x0) <= bound && norm(inv.inverse * (m * x0) - x0) <= 4 * bound;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double> { accurate }, 10000));
+}
+
+TEST(TestSolve, TestCholesky) {
+  // m^T m is positive semidefinite; adding a multiple of its trace keeps
+  // it well away from singular.
+  auto solves = [](double x11, double x12, double x13,
+		   double x21, double x22, double x23,
+		   double x31, double x32, double x33) {
+    const verified_math::Mat33<double> m{x11, x12, x13, x21, x22, x23, x31, x32, x33};
+    const auto mtm = verified_math::transpose(m) * m;
+    const double s = 0.1 * verified_math::trace(mtm);
+    const auto a = mtm + verified_math::Mat33<double>{s, 0, 0, 0, s, 0, 0, 0, s};
+    const verified_math::Cholesky33<double> c(a);
+    const verified_math::Vec3<double> b(x12, 1.0, -x31);
+    if (!c.ok()) {
+      return false;
+    }
+    const auto x = c.solve(b);
+    return small_residual(a, b, x) && norm(x - verified_math::solve(a, b)) <= 16 * tol * norm(x);
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double> { solves }, 10000));
+
+  const verified_math::Mat44<double> a{
+    4, 1, 0, 1,
+    1, 5, 2, 0,
+    0, 2, 6, 1,
+    1, 0, 1, 3
+  };
+  const verified_math::Cholesky44<double> c(a);
+  ASSERT_TRUE(c.ok());
+  const verified_math::Vec4<double> x0(1, 2, -1, 0.5);
+  const auto x = c.solve(a * x0);
+  EXPECT_LT(norm(x - x0), tol);
+}
+
+TEST(TestSolve, TestRejectsSingular) {
+  EXPECT_FALSE(verified_math::Lu33<double>(
+    verified_math::Mat33<double>{1, 2, 3, 2, 4, 6, 3, 6, 9}).ok());
+  EXPECT_FALSE(verified_math::Lu33<double>(
+    verified_math::Mat33<double>{0, 0, 0, 0, 0, 0, 0, 0, 0}).ok());
+  EXPECT_FALSE(verified_math::Lu44<double>(
+    verified_math::Mat44<double>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}).ok());
+  EXPECT_TRUE(verified_math::Lu33<double>(
+    1e-30 * verified_math::Mat33<double>{0, 1, 0, 0, 0, 1, 1, 0, 0}).ok());
+
+  // Indefinite, semidefinite and zero matrices are not positive definite.
+  EXPECT_FALSE(verified_math::Cholesky33<double>(
+    verified_math::Mat33<double>{1, 0, 0, 0, -1, 0, 0, 0, 1}).ok());
+  EXPECT_FALSE(verified_math::Cholesky33<double>(
+    verified_math::Mat33<double>{1, 1, 1, 1, 1, 1, 1, 1, 1}).ok());
+  EXPECT_FALSE(verified_math::Cholesky44<double>(
+    verified_math::Mat44<double>{0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0}).ok());
+  EXPECT_FALSE(verified_math::Cholesky33<double>(
+    verified_math::Mat33<double>{1, 2, 0, 2, 1, 0, 0, 0, 1}).ok());
+}
+
+TEST(TestSolve, TestFloatExtremeScales) {
+  // det * det and the product of squared row norms leave the float range
+  // at these scales; the row scaling keeps well-conditioned matrices.
+  const float scales[] = {
+    1e5f, 1e-6f, std::ldexp(1.0f, 120), std::ldexp(1.0f, -120)
+  };
+  for (float s : scales) {
+    const verified_math::Lu44<float> lu(s * verified_math::Mat44<float>{
+	2, 1, 0, 0, 1, 3, 1, 0, 0, 1, 4, 1, 0, 0, 1, 5});
+    EXPECT_TRUE(lu.ok()) << s;
+    const double d = 85.0 * s * s * s * s;
+    if (d < FLT_MAX && d > FLT_MIN) {
+      EXPECT_NEAR(1.0, lu.det() / d, 1e-5) << s;
+    }
+    // The solution of (s a) x = s b is that of a x = b.
+    const verified_math::Vec4<float> x = lu.solve(s * verified_math::Vec4<float>(3, 5, 6, 6));
+    EXPECT_NEAR(1.0f, x.x1, 1e-5f) << s;
+    EXPECT_NEAR(1.0f, x.x2, 1e-5f) << s;
+    EXPECT_NEAR(1.0f, x.x3, 1e-5f) << s;
+    EXPECT_NEAR(1.0f, x.x4, 1e-5f) << s;
+
+    const verified_math::Lu33<float> lu3(s * verified_math::Mat33<float>{
+	2, 1, 0, 1, 3, 1, 0, 1, 4});
+    EXPECT_TRUE(lu3.ok()) << s;
+  }
+  EXPECT_FALSE(verified_math::Lu44<float>(std::ldexp(1.0f, 120) * verified_math::Mat44<float>{
+	1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16}).ok());
+}
+
+TEST(TestSolve, TestBatchedMatchesSingle) {
+  verified_math::Mat33Array<double> m3;
+  verified_math::Vec3Array<double> b3;
+  verified_math::Mat44Array<double> m4;
+  verified_math::Vec4Array<double> b4;
+  for (int i = 0; i < 101; ++i) {
+    m3.push_back(verified_math::Mat33<double>{
+	double(i), 1.0 - i, 0.5, 2.0 * i, -0.25 * i, 3.0, 1.0, 0.5 * i, -double(i)});
+    b3.push_back(verified_math::Vec3<double>(1.0, double(i), -2.0));
+    m4.push_back(verified_math::Mat44<double>{
+	double(i), 1, 0, 2, 0, 3.0 - i, 1, 0, 1, 0, 0.5 * i, 1, 2, 1, 0, 1.0 + i});
+    b4.push_back(verified_math::Vec4<double>(double(i), 1, -1, 0.5));
+  }
+
+  verified_math::Vec3Array<double> x3, y3;
+  verified_math::Vec4Array<double> x4, y4;
+  std::vector<unsigned char> ok3(m3.size()), ok4(m4.size()), pok3(m3.size()), pok4(m4.size());
+  verified_math::solve(m3, b3, x3, ok3.data());
+  verified_math::solve(m4, b4, x4, ok4.data());
+
+  verified_math::ThreadPool pool(3);
+  verified_math::parallel_solve(m3, b3, y3, pok3.data(), verified_math::Partition(&pool, 1));
+  verified_math::parallel_solve(m4, b4, y4, pok4.data(), verified_math::Partition(&pool, 1));
+
+  ASSERT_EQ(m3.size(), x3.size());
+  ASSERT_EQ(m4.size(), y4.size());
+  for (std::size_t i = 0; i < m3.size(); ++i) {
+    const verified_math::Lu33<double> lu3(m3[i]);
+    const verified_math::Lu44<double> lu4(m4[i]);
+    EXPECT_EQ(lu3.ok() ? 1 : 0, ok3[i]);
+    EXPECT_EQ(lu4.ok() ? 1 : 0, pok4[i]);
+    EXPECT_EQ(ok3[i], pok3[i]);
+    EXPECT_EQ(ok4[i], pok4[i]);
+    if (lu3.ok()) {
+      EXPECT_EQ(lu3.solve(b3[i]).x1, x3[i].x1);
+      EXPECT_EQ(lu3.solve(b3[i]).x3, y3[i].x3);
+    }
+    if (lu4.ok()) {
+      EXPECT_EQ(lu4.solve(b4[i]).x2, x4[i].x2);
+      EXPECT_EQ(lu4.solve(b4[i]).x4, y4[i].x4);
+    }
+  }
+}
+
+/*
+  Mixed-precision refinement: the inverse is computed in float, yet a
+  converged solution is as accurate as the double LU solve.
+ */
+TEST(TestSolve, TestRefinedSolveAccuracy) {
+  auto accurate = [](double x11, double x12, double x13, double x14,
+		     double x21, double x22, double x23, double x24,
+		     double x31, double x32, double x33, double x34,
+		     double x41, double x42, double x43, double x44) {
+    const verified_math::Mat44<double> m{
+      x11, x12, x13, x14, x21, x22, x23, x24, x31, x32, x33, x34, x41, x42, x43, x44};
+    const verified_math::Vec4<double> x0(1.0, -2.0, 0.5, 3.0);
+    const auto r = verified_math::refined_solve(m, m * x0);
+
+    // Adding 4 max |m_ij| to the diagonal makes m diagonally dominant,
+    // well conditioned whatever the range of its entries.
+    const double* e = &m.x11;
+    double big = 0;
+    for (int i = 0; i < 16; ++i) {
+      big = std::max(big, std::fabs(e[i]));
+    }
+    const auto d = m + 4 * big * verified_math::Mat44<double>{
+      1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1, 0, 0, 0, 0, 1};
+    const auto rd = verified_math::refined_solve(d, d * x0);
+    return (!r.converged || norm(r.x - x0) <= tol * r.condition_estimate * norm(x0)) &&
+      rd.converged && norm(rd.x - x0) <= tol * rd.condition_estimate * norm(x0);
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double,
+			     double, double, double, double> { accurate }, 10000));
+
+  // Diagonally dominant matrices converge, while the float solve alone
+  // is only good to single precision.
+  const verified_math::Mat33<double> m{4, 1.0 / 3, 0.1, -0.7, 5, 1.0 / 7, 0.2, 0.3, 3};
+  const verified_math::Vec3<double> x0(0.1, 1.0 / 3, -2.0);
+  const auto r = verified_math::refined_solve(m, m * x0);
+  ASSERT_TRUE(r.converged);
+  EXPECT_LE(norm(r.x - x0), 4 * DBL_EPSILON * norm(x0));
+  const auto unrefined = verified_math::refined_solve(m, m * x0, 0);
+  EXPECT_FALSE(unrefined.converged);
+  EXPECT_GT(norm(unrefined.x - x0), 1e3 * DBL_EPSILON * norm(x0));
+}
+
+// H diag(1, 1, 1, d) H for the Householder reflection H along (1, 2, 3, 4),
+// with Frobenius condition number about sqrt(3) / d for small d.
+static verified_math::Mat44<double> conditioned(double d) {
+  const double v[4] = {1, 2, 3, 4};
+  double h[16], a[16];
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      h[4 * i + j] = (i == j ? 1.0 : 0.0) - v[i] * v[j] / 15;
+    }
+  }
+  for (int i = 0; i < 4; ++i) {
+    for (int j = 0; j < 4; ++j) {
+      a[4 * i + j] = h[4 * i] * h[j] + h[4 * i + 1] * h[4 + j] + h[4 * i + 2] * h[8 + j] +
+	d * h[4 * i + 3] * h[12 + j];
+    }
+  }
+  return verified_math::Mat44<double>{
+    a[0], a[1], a[2], a[3], a[4], a[5], a[6], a[7],
+    a[8], a[9], a[10], a[11], a[12], a[13], a[14], a[15]};
+}
+
+TEST(TestSolve, TestRefinedSolveConvergence) {
+  const verified_math::Vec4<double> x0(1.0, 1.0 / 3, -0.25, 2.0);
+
+  // kappa about 2e3 needs a third iteration.
+  const auto m = conditioned(1e-3);
+  const auto two = verified_math::refined_solve(m, m * x0);
+  EXPECT_GT(two.condition_estimate, 1e3);
+  EXPECT_FALSE(two.converged);
+  const auto three = verified_math::refined_solve(m, m * x0, 3);
+  ASSERT_TRUE(three.converged);
+  EXPECT_LE(norm(three.x - x0), tol * three.condition_estimate * norm(x0));
+
+  // At kappa u_float near 1 refinement stalls however long it runs.
+  const auto bad = conditioned(1e-8);
+  EXPECT_FALSE(verified_math::refined_solve(bad, bad * x0, 50).converged);
+  EXPECT_FALSE(verified_math::refined_solve(
+    verified_math::Mat44<double>{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15, 16},
+    x0).converged);
+}
+
+TEST(TestSolve, TestBatchedRefinedMatchesSingle) {
+  // More entries than a refinement block.
+  verified_math::Mat33Array<double> m3;
+  verified_math::Vec3Array<double> b3;
+  verified_math::Mat44Array<double> m4;
+  verified_math::Vec4Array<double> b4;
+  for (int i = 0; i < 301; ++i) {
+    m3.push_back(verified_math::Mat33<double>{
+	double(i), 1.0 - i, 0.5, 2.0 * i, -0.25 * i, 3.0, 1.0, 0.5 * i, -double(i)});
+    b3.push_back(verified_math::Vec3<double>(1.0, double(i), -2.0));
+    m4.push_back(i % 7 == 0 ? conditioned(std::pow(10.0, -(i % 9))) :
+		 verified_math::Mat44<double>{
+		   double(i), 1, 0, 2, 0, 3.0 - i, 1, 0, 1, 0, 0.5 * i, 1, 2, 1, 0, 1.0 + i});
+    b4.push_back(verified_math::Vec4<double>(double(i), 1, -1, 0.5));
+  }
+
+  verified_math::Vec3Array<double> x3, y3;
+  verified_math::Vec4Array<double> x4, y4;
+  std::vector<unsigned char> ok3(m3.size()), ok4(m4.size()), pok3(m3.size()), pok4(m4.size());
+  verified_math::refined_solve(m3, b3, x3, ok3.data());
+  verified_math::refined_solve(m4, b4, x4, ok4.data());
+
+  verified_math::ThreadPool pool(3);
+  verified_math::parallel_refined_solve(m3, b3, y3, pok3.data(), verified_math::Partition(&pool, 1));
+  verified_math::parallel_refined_solve(m4, b4, y4, pok4.data(), verified_math::Partition(&pool, 1));
+
+  ASSERT_EQ(m3.size(), x3.size());
+  ASSERT_EQ(m4.size(), y4.size());
+  int converged = 0;
+  for (std::size_t i = 0; i < m3.size(); ++i) {
+    const auto r3 = verified_math::refined_solve(m3[i], b3[i]);
+    const auto r4 = verified_math::refined_solve(m4[i], b4[i]);
+    EXPECT_EQ(r3.converged ? 1 : 0, ok3[i]) << i;
+    EXPECT_EQ(r4.converged ? 1 : 0, ok4[i]) << i;
+    EXPECT_EQ(ok3[i], pok3[i]);
+    EXPECT_EQ(ok4[i], pok4[i]);
+    EXPECT_EQ(x3[i].x2, y3[i].x2);
+    EXPECT_EQ(x4[i].x3, y4[i].x3);
+    if (r3.converged) {
+      EXPECT_LE(norm(r3.x - x3[i]), tol * r3.condition_estimate * norm(r3.x)) << i;
+    }
+    if (r4.converged) {
+      EXPECT_LE(norm(r4.x - x4[i]), tol * r4.condition_estimate * norm(r4.x)) << i;
+      ++converged;
+    }
+  }
+  EXPECT_GT(converged, 200);
+}
@@ -0,0 +1,187 @@
+#include "verified_math/svd33.h"
+#include "verified_math/parallel.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <cfloat>
+#include <vector>
+
+/*
+  Errors are measured relative to the Frobenius norm of the input: the
+  kernel runs a fixed number of sweeps, so these properties also check
+  that the count is enough.
+ */
+static const double tol = 256 * DBL_EPSILON;
+
+static const verified_math::Mat33<double> id{1, 0, 0, 0, 1, 0, 0, 0, 1};
+
+static bool is_rotation(const verified_math::Mat33<double>& r) {
+  return (verified_math::transpose(r) * r - id).l2_norm() <= tol * tol &&
+    fabs(verified_math::det(r) - 1) <= tol;
+}
+
+static verified_math::Mat33<double> diagonal(const verified_math::Vec3<double>& d) {
+  return verified_math::Mat33<double>{d.x1, 0, 0, 0, d.x2, 0, 0, 0, d.x3};
+}
+
+static bool is_svd(const verified_math::Mat33<double>& m, const verified_math::Svd33<double>& d) {
+  const double norm = std::sqrt(m.l2_norm());
+  const auto& s = d.sigma;
+  if (!(s.x1 >= s.x2 && s.x2 >= fabs(s.x3))) {
+    return false;
+  }
+  if (!is_rotation(d.u) || !is_rotation(d.v)) {
+    return false;
+  }
+  // The product of the singular values is det(m), sign included.
+  if (fabs(s.x1 * s.x2 * s.x3 - verified_math::det(m)) > tol * norm * norm * norm) {
+    return false;
+  }
+  const auto r = d.u * diagonal(s) * verified_math::transpose(d.v) - m;
+  return r.l2_norm() <= tol * tol * m.l2_norm();
+}
+
+TEST(TestSvd33, TestDecomposition) {
+  auto decomposes = [](double x11, double x12, double x13,
+		       double x21, double x22, double x23,
+		       double x31, double x32, double x33) {
+    const verified_math::Mat33<double> m{x11, x12, x13, x21, x22, x23, x31, x32, x33};
+    return is_svd(m, verified_math::svd(m));
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double> { decomposes }, 10000));
+}
+
+TEST(TestSvd33, TestTransposeAndInverse) {
+  // m^T has the same singular values, and for a well-conditioned m,
+  // V diag(1 / sigma) U^T is its inverse.
+  auto consistent = [](double x11, double x12, double x13,
+		       double x21, double x22, double x23,
+		       double x31, double x32, double x33) {
+    const verified_math::Mat33<double> m{x11, x12, x13, x21, x22, x23, x31, x32, x33};
+    const auto d = verified_math::svd(m);
+    const auto dt = verified_math::svd(verified_math::transpose(m));
+    const double s1 = d.sigma.x1;
+    if (fabs(d.sigma.x1 - dt.sigma.x1) > tol * s1 ||
+	fabs(d.sigma.x2 - dt.sigma.x2) > tol * s1 ||
+	fabs(d.sigma.x3 - dt.sigma.x3) > tol * s1) {
+      return false;
+    }
+
+    const double kappa = s1 / fabs(d.sigma.x3);
+    if (!(kappa < 1e6)) {
+      return true;
+    }
+    const verified_math::Vec3<double> inv_s(1 / d.sigma.x1, 1 / d.sigma.x2, 1 / d.sigma.x3);
+    const auto inv = d.v * diagonal(inv_s) * verified_math::transpose(d.u);
+    const auto ref = verified_math::inverse(m);
+    return (inv - ref).l2_norm() <= (tol * kappa) * (tol * kappa) * ref.l2_norm();
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double> { consistent }, 10000));
+}
+
+TEST(TestSvd33, TestPolar) {
+  auto decomposes = [](double x11, double x12, double x13,
+		       double x21, double x22, double x23,
+		       double x31, double x32, double x33) {
+    const verified_math::Mat33<double> m{x11, x12, x13, x21, x22, x23, x31, x32, x33};
+    const auto p = verified_math::polar(m);
+    const double norm2 = m.l2_norm();
+    return is_rotation(p.r) &&
+      (p.s - verified_math::transpose(p.s)).l2_norm() <= tol * tol * norm2 &&
+      (p.r * p.s - m).l2_norm() <= tol * tol * norm2;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double,
+			     double, double, double> { decomposes }, 10000));
+
+  // A rotation is its own rotation factor.
+  const double c = std::cos(0.7), s = std::sin(0.7);
+  const verified_math::Mat33<double> r{c, -s, 0, s, c, 0, 0, 0, 1};
+  const auto p = verified_math::polar(2.0 * r);
+  EXPECT_LT((p.r - r).l2_norm(), 1e-28);
+  EXPECT_LT((p.s - 2.0 * id).l2_norm(), 1e-28);
+}
+
+TEST(TestSvd33, TestSpecialMatrices) {
+  const verified_math::Mat33<double> cases[] = {
+    verified_math::Mat33<double>{0, 0, 0, 0, 0, 0, 0, 0, 0},
+    id,
+    -1.0 * id,
+    verified_math::Mat33<double>{1, 2, 3, 2, 4, 6, 3, 6, 9},
+    verified_math::Mat33<double>{0, 0, 1, 0, 1, 0, 1, 0, 0},
+    verified_math::Mat33<double>{1, 1e-9, 0, 0, 1, 1e-9, 0, 0, 1},
+    verified_math::Mat33<double>{0, 1, 0, 0, 0, 1, 0, 0, 0},
+    1e100 * verified_math::Mat33<double>{3, -1, 2, 0, 1, 5, 4, 4, -2},
+    1e-100 * verified_math::Mat33<double>{3, -1, 2, 0, 1, 5, 4, 4, -2},
+  };
+  for (const auto& m : cases) {
+    EXPECT_TRUE(is_svd(m, verified_math::svd(m)));
+  }
+
+  // Subnormal entries, whose reciprocal overflows: sigma is that of the
+  // unscaled matrix to the precision the subnormals carry.
+  const verified_math::Mat33<double> a{3, -1, 2, 0, 1, 5, 4, 4, -2};
+  const double tiny = 1e-320;
+  const auto unit = verified_math::svd(a);
+  const auto sub = verified_math::svd(tiny * a);
+  EXPECT_NEAR(unit.sigma.x1, sub.sigma.x1 / tiny, 1e-2 * unit.sigma.x1);
+  EXPECT_NEAR(unit.sigma.x2, sub.sigma.x2 / tiny, 1e-2 * unit.sigma.x1);
+  EXPECT_NEAR(unit.sigma.x3, sub.sigma.x3 / tiny, 1e-2 * unit.sigma.x1);
+
+  // A reflection: det < 0 puts the sign on sigma3.
+  const auto r = verified_math::svd(verified_math::Mat33<double>{1, 0, 0, 0, 1, 0, 0, 0, -1});
+  EXPECT_NEAR(1.0, r.sigma.x1, tol);
+  EXPECT_NEAR(1.0, r.sigma.x2, tol);
+  EXPECT_NEAR(-1.0, r.sigma.x3, tol);
+}
+
+TEST(TestSvd33, TestBatchedMatchesSingle) {
+  verified_math::Mat33Array<double> m;
+  for (int i = 0; i < 101; ++i) {
+    m.push_back(verified_math::Mat33<double>{
+	double(i), 1.0 - i, 0.5, 2.0 * i, -0.25 * i, 3.0, 1.0, 0.5 * i, -double(i)});
+  }
+
+  verified_math::Mat33Array<double> u, v, r, s;
+  verified_math::Vec3Array<double> sigma;
+  verified_math::svd(m, u, sigma, v);
+  verified_math::polar(m, r, s);
+
+  verified_math::ThreadPool pool(3);
+  verified_math::Mat33Array<double> u2, v2;
+  verified_math::Vec3Array<double> sigma2;
+  verified_math::parallel_svd(m, u2, sigma2, v2, verified_math::Partition(&pool, 1));
+
+  // Bit-for-bit without FMA; with FMA the straight-line and the
+  // vectorized kernels may fuse different products, so they agree to
+  // rounding. The blocks always agree with each other.
+#if defined(VERIFIED_MATH_FMA) || defined(__FMA__)
+  const double same = tol;
+#else
+  const double same = 0.0;
+#endif
+
+  ASSERT_EQ(m.size(), sigma.size());
+  ASSERT_EQ(m.size(), sigma2.size());
+  for (std::size_t i = 0; i < m.size(); ++i) {
+    const auto d = verified_math::svd(m[i]);
+    const auto p = verified_math::polar(m[i]);
+    const double norm = std::sqrt(m[i].l2_norm());
+    EXPECT_NEAR(d.sigma.x2, sigma[i].x2, same * norm);
+    EXPECT_NEAR(d.u.x12, u[i].x12, same);
+    EXPECT_NEAR(d.v.x31, v[i].x31, same);
+    EXPECT_NEAR(p.r.x21, r[i].x21, same);
+    EXPECT_NEAR(p.s.x13, s[i].x13, same * norm);
+    EXPECT_EQ(sigma[i].x3, sigma2[i].x3);
+    EXPECT_EQ(u[i].x23, u2[i].x23);
+    EXPECT_TRUE(is_svd(m[i], d));
+  }
+}
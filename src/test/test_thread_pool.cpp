@@ -0,0 +1,158 @@
+#include "verified_math/parallel.h"
+#include "gtest/gtest.h"
+
+#include <atomic>
+#include <cmath>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+TEST(TestThreadPool, TestParallelForCoversRangeOnce) {
+  verified_math::ThreadPool pool(4);
+  const std::size_t n = 100003;
+  std::vector<std::atomic<int> > hits(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    hits[i] = 0;
+  }
+
+  verified_math::parallel_for(0, n, [&](std::size_t b, std::size_t e) {
+      for (std::size_t i = b; i < e; ++i) {
+	++hits[i];
+      }
+    }, verified_math::Partition(&pool, 1000));
+
+  for (std::size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(1, hits[i].load());
+  }
+}
+
+TEST(TestThreadPool, TestSerialBelowThreshold) {
+  verified_math::ThreadPool pool(4);
+  const std::thread::id caller = std::this_thread::get_id();
+  bool same_thread = false;
+  verified_math::parallel_for(0, 1000, [&](std::size_t, std::size_t) {
+      same_thread = std::this_thread::get_id() == caller;
+    }, verified_math::Partition(&pool, 1001));
+  EXPECT_TRUE(same_thread);
+}
+
+TEST(TestThreadPool, TestNestedParallelFor) {
+  verified_math::ThreadPool pool(3);
+  std::atomic<std::size_t> total(0);
+  verified_math::Partition p(&pool, 1);
+  verified_math::parallel_for(0, 64, [&](std::size_t b, std::size_t e) {
+      for (std::size_t i = b; i < e; ++i) {
+	verified_math::parallel_for(0, 1000, [&](std::size_t bb, std::size_t ee) {
+	    total += ee - bb;
+	  }, p);
+      }
+    }, p);
+  EXPECT_EQ(64000u, total.load());
+}
+
+TEST(TestThreadPool, TestExceptionPropagates) {
+  verified_math::ThreadPool pool(4);
+  EXPECT_THROW(verified_math::parallel_for(0, 100000, [](std::size_t b, std::size_t e) {
+	if (b <= 50000 && 50000 < e) {
+	  throw std::runtime_error("chunk failed");
+	}
+      }, verified_math::Partition(&pool, 1)), std::runtime_error);
+}
+
+/*
+  The reduction combines chunks in range order, so it does not depend on
+  the number of threads.
+ */
+TEST(TestThreadPool, TestReduceIsDeterministic) {
+  const std::size_t n = 1 << 20;
+  std::vector<double> x(n);
+  for (std::size_t i = 0; i < n; ++i) {
+    x[i] = std::sin(double(i)) * std::pow(10.0, double(i % 17) - 8.0);
+  }
+  auto sum = [&](std::size_t b, std::size_t e) {
+    double s = 0.0;
+    for (std::size_t i = b; i < e; ++i) {
+      s += x[i];
+    }
+    return s;
+  };
+  auto plus = [](double a, double b) { return a + b; };
+
+  verified_math::ThreadPool two(2);
+  verified_math::ThreadPool five(5);
+  verified_math::Partition p2(&two, 1);
+  verified_math::Partition p5(&five, 1);
+  // Both split the range into the same 40 chunks.
+  p2.chunks_per_thread = 20;
+  p5.chunks_per_thread = 8;
+  double r2 = verified_math::parallel_reduce(0, n, 0.0, sum, plus, p2);
+  double r5 = verified_math::parallel_reduce(0, n, 0.0, sum, plus, p5);
+  EXPECT_EQ(r2, r5);
+  EXPECT_EQ(r5, verified_math::parallel_reduce(0, n, 0.0, sum, plus, p5));
+  EXPECT_NEAR(sum(0, n), r5, 1e-9 * std::fabs(r5));
+}
+
+TEST(TestThreadPool, TestParallelTransformMatchesSerial) {
+  verified_math::ThreadPool pool(4);
+  verified_math::Partition p(&pool, 1);
+
+  auto m = verified_math::Mat44<double> {
+    1.0, 2.0, 3.0, 4.0,
+    -1.0, 0.5, 0.0, 2.0,
+    0.25, 3.0, -2.0, 1.0,
+    0.0, 0.0, 0.0, 1.0
+  };
+  const std::size_t n = 50000;
+  std::vector<verified_math::Vec4<double> > aos;
+  for (std::size_t i = 0; i < n; ++i) {
+    double t = double(i);
+    aos.push_back(verified_math::Vec4<double>{std::sin(t), std::cos(t), t * 1e-3, 1.0});
+  }
+  verified_math::Vec4Array<double> soa(aos.data(), n);
+
+  auto serial = aos;
+  auto parallel = aos;
+  verified_math::transform_vectors(m, aos.data(), serial.data(), n);
+  verified_math::parallel_transform(m, aos.data(), parallel.data(), n, p);
+
+  verified_math::Vec4Array<double> soa_out;
+  verified_math::parallel_transform(m, soa, soa_out, p);
+
+  for (std::size_t i = 0; i < n; ++i) {
+    ASSERT_EQ(serial[i].x1, parallel[i].x1);
+    ASSERT_EQ(serial[i].x4, parallel[i].x4);
+    ASSERT_EQ(serial[i].x2, soa_out[i].x2);
+    ASSERT_EQ(serial[i].x3, soa_out[i].x3);
+  }
+
+  std::vector<double> norms(n);
+  verified_math::parallel_transform(serial.data(), norms.data(), n,
+				    [](const verified_math::Vec4<double>& v) { return dot(v, v); }, p);
+  EXPECT_EQ(dot(serial[n - 1], serial[n - 1]), norms[n - 1]);
+}
+
+TEST(TestThreadPool, TestParallelDetInverseMatchesSerial) {
+  verified_math::ThreadPool pool(4);
+  const std::size_t n = 20000;
+  std::vector<verified_math::Mat33<double> > ms;
+  for (std::size_t i = 0; i < n; ++i) {
+    double t = double(i);
+    ms.push_back(verified_math::Mat33<double>{
+	2.0 + std::sin(t), std::cos(t), 0.5,
+	  0.25, 1.0 + t * 1e-4, std::sin(3 * t),
+	  i % 7 == 0 ? 0.0 : 1.0, 0.0, i % 7 == 0 ? 0.0 : 2.0});
+  }
+  verified_math::Mat33Array<double> m(ms.data(), n);
+
+  std::vector<double> d1(n), d2(n);
+  std::vector<unsigned char> ok1(n), ok2(n);
+  verified_math::Mat33Array<double> inv1(n), inv2;
+  verified_math::det_inverse(m, d1.data(), inv1, ok1.data());
+  verified_math::parallel_det_inverse(m, d2.data(), inv2, ok2.data(),
+				      verified_math::Partition(&pool, 1));
+
+  EXPECT_EQ(d1, d2);
+  EXPECT_EQ(ok1, ok2);
+  EXPECT_TRUE(inv1.x11 == inv2.x11);
+  EXPECT_TRUE(inv1.x33 == inv2.x33);
+}
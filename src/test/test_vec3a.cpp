@@ -0,0 +1,52 @@
+#include "verified_math/vec3a.h"
+#include "verified_math/aligned_allocator.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <cstdint>
+
+static_assert(sizeof(verified_math::Vec3A<float>) == 16, "Vec3A<float> is one 128-bit lane");
+static_assert(alignof(verified_math::Vec3A<float>) == 16, "Vec3A<float> is 16-byte aligned");
+static_assert(sizeof(verified_math::Vec3A<double>) == 32, "Vec3A<double> is one 256-bit lane");
+static_assert(alignof(verified_math::Vec3A<double>) == 32, "Vec3A<double> is 32-byte aligned");
+
+TEST(TestVec3A, TestAlignedVectorStorage) {
+  verified_math::aligned_vector<verified_math::Vec3A<double> > v;
+  for (int i = 0; i < 100; ++i) {
+    v.push_back(verified_math::Vec3A<double>(i, 2.0 * i, 3.0 * i));
+  }
+  for (std::size_t i = 0; i < v.size(); ++i) {
+    EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(&v[i]) % 32);
+    EXPECT_EQ(0.0, v[i].pad);
+  }
+}
+
+TEST(TestVec3A, TestMatchesVec3) {
+  auto matches_vec3 = [](double x1, double x2, double x3,
+			 double y1, double y2, double y3, double c) {
+    auto x = verified_math::Vec3<double>(x1, x2, x3);
+    auto y = verified_math::Vec3<double>(y1, y2, y3);
+    auto xa = verified_math::Vec3A<double>(x);
+    auto ya = verified_math::Vec3A<double>(y);
+
+    auto same = [](const verified_math::Vec3<double>& a, const verified_math::Vec3A<double>& b) {
+      return a.x1 == b.x1 && a.x2 == b.x2 && a.x3 == b.x3 && b.pad == 0.0;
+    };
+
+    auto round_trip = verified_math::to_vec3(xa);
+    return same(x + y, xa + ya) &&
+      same(x - y, xa - ya) &&
+      same(c * x, c * xa) &&
+      same(x * c, xa * c) &&
+      same(cross(x, y), cross(xa, ya)) &&
+      dot(x, y) == dot(xa, ya) &&
+      round_trip.x1 == x1 && round_trip.x2 == x2 && round_trip.x3 == x3;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double,
+			     double, double, double, double> {
+			       matches_vec3 }, 10000
+			     )
+	      );
+}
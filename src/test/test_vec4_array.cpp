@@ -0,0 +1,138 @@
+#include "verified_math/vec4_array.h"
+#include "gtest/gtest.h"
+#include "checkpp/checkpp.h"
+
+#include <cmath>
+#include <cstdint>
+
+#define epsilon 0.001
+
+/*
+  The batched kernels should agree with the single-vector operations.
+  Arrays of several elements are built from each sample so that the
+  vectorized body and the scalar tail of the loops are both exercised.
+ */
+namespace {
+  const std::size_t array_size = 11;
+
+  verified_math::Vec4Array<double> make_array(double x1, double x2, double x3, double x4) {
+    verified_math::Vec4Array<double> a;
+    for (std::size_t i = 0; i < array_size; ++i) {
+      double s = 1.0 + 0.25 * i;
+      a.push_back(verified_math::Vec4<double>{s * x1, x2 - s, s * x3, x4 + s});
+    }
+    return a;
+  }
+
+  // Agreement up to rounding, relative to the magnitude of the values.
+  bool close(double a, double b) {
+    return fabs(a - b) <= epsilon * (1.0 + fabs(b));
+  }
+
+  bool close(const verified_math::Vec4<double>& v1, const verified_math::Vec4<double>& v2) {
+    return (close(v1.x1, v2.x1) &&
+	    close(v1.x2, v2.x2) &&
+	    close(v1.x3, v2.x3) &&
+	    close(v1.x4, v2.x4));
+  }
+}
+
+TEST(TestVec4Array, TestLanesAreAligned) {
+  auto a = verified_math::Vec4Array<float>(7);
+
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a.x1.data()) % verified_math::simd_alignment);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a.x2.data()) % verified_math::simd_alignment);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a.x3.data()) % verified_math::simd_alignment);
+  EXPECT_EQ(0u, reinterpret_cast<std::uintptr_t>(a.x4.data()) % verified_math::simd_alignment);
+}
+
+TEST(TestVec4Array, TestViewRoundTrip) {
+  auto view_round_trip = [](double x1, double x2, double x3, double x4) {
+    auto v = verified_math::Vec4<double>{x1, x2, x3, x4};
+    auto a = verified_math::Vec4Array<double>(&v, 1);
+
+    return (a[0].x1 == v.x1 && a[0].x2 == v.x2 &&
+	    a[0].x3 == v.x3 && a[0].x4 == v.x4);
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double> {
+	view_round_trip }, 10000));
+}
+
+TEST(TestVec4Array, TestBatchedAlgebra) {
+  auto batched_algebra = [](double x1, double x2, double x3, double x4,
+			    double y1, double y2, double y3, double y4,
+			    double c) {
+    auto a = make_array(x1, x2, x3, x4);
+    auto b = make_array(y1, y2, y3, y4);
+
+    verified_math::Vec4Array<double> sum, diff, scaled;
+    verified_math::add(a, b, sum);
+    verified_math::sub(a, b, diff);
+    verified_math::scale(c, a, scaled);
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      if (!close(sum[i], a[i] + b[i]) ||
+	  !close(diff[i], a[i] - b[i]) ||
+	  !close(scaled[i], c * a[i])) {
+	return false;
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double, double> {
+			       batched_algebra }, 10000));
+}
+
+TEST(TestVec4Array, TestBatchedDot) {
+  auto batched_dot = [](double x1, double x2, double x3, double x4,
+			double y1, double y2, double y3, double y4) {
+    auto a = make_array(x1, x2, x3, x4);
+    auto b = make_array(y1, y2, y3, y4);
+
+    double dots[array_size];
+    verified_math::dot(a, b, dots);
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      if (!close(dots[i], verified_math::dot(a[i], b[i]))) {
+	return false;
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double,
+			     double, double, double, double> {
+			       batched_dot }, 10000));
+}
+
+TEST(TestVec4Array, TestNormalizeIsUnit) {
+  auto normalize_is_unit = [](double x1, double x2, double x3, double x4) {
+    auto a = make_array(x1, x2, x3, x4);
+
+    verified_math::Vec4Array<double> unit;
+    verified_math::normalize(a, unit);
+
+    for (std::size_t i = 0; i < a.size(); ++i) {
+      if (fabs(verified_math::dot(unit[i], unit[i]) - 1.0) > epsilon) {
+	return false;
+      }
+    }
+    return true;
+  };
+
+  EXPECT_TRUE(checkpp::check(checkpp::Property<double, double, double, double> {
+	normalize_is_unit }, 10000));
+}
+
+TEST(TestVec4Array, TestNormalizeZeroIsZero) {
+  auto a = verified_math::Vec4Array<double>(3);
+  verified_math::normalize(a, a);
+
+  EXPECT_EQ(0.0, a[1].x1);
+  EXPECT_EQ(0.0, a[1].x2);
+  EXPECT_EQ(0.0, a[1].x3);
+  EXPECT_EQ(0.0, a[1].x4);
+}